@@ -23,6 +23,7 @@
 
 #include <QSettings>
 #include <QDateTime>
+#include <QSize>
 #include <QDebug>
 #include <iostream>
 
@@ -69,7 +70,16 @@ void CLIProcessor::parseCLIArgsPreConfig(const QStringList& argList)
 		          << "--projection-type       : Specify projection type, e.g. stereographic\n"
 		          << "--restore-defaults      : Delete existing config.ini and use defaults\n"
 		          << "--multires-image        : With filename / URL argument, specify a\n"
-		          << "                          multi-resolution image to load\n";
+		          << "                          multi-resolution image to load\n"
+		          << "--profile               : With filename argument, write the time spent\n"
+		          << "                          in each module in CSV format on exit\n"
+		          << "--benchmark             : Render the scenarios in an off-screen buffer\n"
+		          << "                          without window, print the frame times and exit.\n"
+		          << "                          Argument is a scenario file or \"builtin\"\n"
+		          << "--benchmark-frames      : Number of measured frames per scenario\n"
+		          << "--benchmark-size        : Size of the off-screen buffer, e.g. 1024x768\n"
+		          << "--benchmark-computations: Measure the computations outside of any\n"
+		          << "                          rendering instead of the frame scenarios\n";
 		exit(0);
 	}
 
@@ -116,7 +126,10 @@ void CLIProcessor::parseCLIArgsPostConfig(const QStringList& argList, QSettings*
 	int fullScreen, altitude;
 	float fov;
 	QString landscapeId, homePlanet, longitude, latitude, skyDate, skyTime;
-	QString projectionType, screenshotDir, multiresImage, startupScript;
+	QString projectionType, screenshotDir, multiresImage, startupScript, profileFile;
+	QString benchmark, benchmarkSize;
+	int benchmarkFrames;
+	bool benchmarkComputations;
 	try
 	{
 		fullScreen = argsGetYesNoOption(argList, "-f", "--full-screen", -1);
@@ -132,6 +145,11 @@ void CLIProcessor::parseCLIArgsPostConfig(const QStringList& argList, QSettings*
 		screenshotDir = argsGetOptionWithArg(argList, "", "--screenshot-dir", "").toString();
 		multiresImage = argsGetOptionWithArg(argList, "", "--multires-image", "").toString();
 		startupScript = argsGetOptionWithArg(argList, "", "--startup-script", "").toString();
+		profileFile = argsGetOptionWithArg(argList, "", "--profile", "").toString();
+		benchmark = argsGetOptionWithArg(argList, "", "--benchmark", "").toString();
+		benchmarkFrames = argsGetOptionWithArg(argList, "", "--benchmark-frames", 200).toInt();
+		benchmarkSize = argsGetOptionWithArg(argList, "", "--benchmark-size", "1024x768").toString();
+		benchmarkComputations = argsGetOption(argList, "", "--benchmark-computations");
 	}
 	catch (std::runtime_error& e)
 	{
@@ -213,6 +231,25 @@ void CLIProcessor::parseCLIArgsPostConfig(const QStringList& argList, QSettings*
 		qApp->setProperty("onetime_startup_script", startupScript);
 	}
 
+	if (!profileFile.isEmpty())
+	{
+		qApp->setProperty("onetime_profile_file", profileFile);
+	}
+
+	if (!benchmark.isEmpty() || benchmarkComputations)
+	{
+		QRegExp sizeRx("(\\d+)x(\\d+)");
+		QSize size(1024, 768);
+		if (sizeRx.exactMatch(benchmarkSize))
+			size = QSize(sizeRx.cap(1).toInt(), sizeRx.cap(2).toInt());
+		else
+			qWarning() << "WARNING: --benchmark-size argument has unrecognised format (I want WIDTHxHEIGHT)";
+		qApp->setProperty("onetime_benchmark", benchmark);
+		qApp->setProperty("onetime_benchmark_frames", benchmarkFrames);
+		qApp->setProperty("onetime_benchmark_size", size);
+		qApp->setProperty("onetime_benchmark_computations", benchmarkComputations);
+	}
+
 	if (fov>0.0) confSettings->setValue("navigation/init_fov", fov);
 	if (!projectionType.isEmpty()) confSettings->setValue("projection/type", projectionType);
 	if (!screenshotDir.isEmpty())
@@ -0,0 +1,739 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "StelBenchmark.hpp"
+#include "StelApp.hpp"
+#include "StelCore.hpp"
+#include "StelMovementMgr.hpp"
+#include "StelPainter.hpp"
+#include "StelUtils.hpp"
+#include "StelSphereGeometry.hpp"
+#include "RefractionExtinction.hpp"
+#include "StelToneReproducer.hpp"
+#include "StelModuleMgr.hpp"
+#include "SolarSystem.hpp"
+#include "Orbit.hpp"
+#include "MinorBodyCatalog.hpp"
+#include "EclipseGeometry.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <QSettings>
+#include <QStringList>
+#include <QVector>
+#include <QDebug>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTemporaryFile>
+#include <QTextStream>
+#include <QFile>
+#include <QPainter>
+#include <QGLPixelBuffer>
+#include <QGLFramebufferObject>
+#include <QtOpenGL>
+
+// Number of frames rendered before measuring a scenario, so that movements and fading are done
+static const int NB_WARMUP_FRAMES = 30;
+// Simulated time between two frames in second
+static const double FRAME_DELTA_TIME = 1./60.;
+// Number of random region pairs of the spherical geometry benchmark
+static const int NB_GEOMETRY_PAIRS = 1000;
+// Number of random Julian days of the date conversion benchmark, converted by blocks of DATE_BLOCK_SIZE
+static const int NB_DATES = 100000;
+static const int DATE_BLOCK_SIZE = 1000;
+// Range of the random Julian days: years -4000 to 4000
+static const double MIN_DATE_JD = 260424.5;
+static const double MAX_DATE_JD = 3182030.5;
+// Number of altitudes of the refraction benchmark, between -10 and 90 degrees, refracted by blocks of REFRACTION_BLOCK_SIZE
+static const int NB_REFRACTION_ALTITUDES = 100000;
+static const int REFRACTION_BLOCK_SIZE = 1000;
+// Number of random luminances and colors of the tone reproducer benchmark, converted by blocks of TONE_BLOCK_SIZE
+static const int NB_TONE_VALUES = 100000;
+static const int TONE_BLOCK_SIZE = 1000;
+// Number of time steps of the Solar System benchmark, as during a time-lapse of SOLAR_SYSTEM_STEP_JD days per frame
+static const int NB_SOLAR_SYSTEM_STEPS = 2000;
+static const double SOLAR_SYSTEM_START_JD = 2455927.5;
+static const double SOLAR_SYSTEM_STEP_JD = 0.5;
+// Number of synthetic orbits of the Kepler solver benchmark, and number of dates at which they are computed
+static const int NB_KEPLER_ORBITS = 100000;
+static const int NB_KEPLER_DATES = 20;
+// Number of synthetic minor planets of the minor body catalogue benchmark
+static const int NB_MINOR_BODIES = 100000;
+
+// The lunar eclipses are listed decade by decade over the 21st century
+static const int NB_ECLIPSE_DECADES = 10;
+static const double ECLIPSE_START_JD = 2451910.5;
+static const double DECADE_JD = 3652.5;
+// Number of frames of the position cache benchmark, and number of times each position is queried during a frame
+static const int NB_POSITION_CACHE_FRAMES = 100;
+static const int NB_POSITION_QUERIES = 20;
+
+// Return a random direction uniformly distributed on the sphere
+static Vec3d randomDirection()
+{
+	Vec3d dir;
+	const double ra = 2.*M_PI*qrand()/RAND_MAX;
+	const double dec = std::asin(2.*qrand()/RAND_MAX-1.);
+	StelUtils::spheToRect(ra, dec, dir);
+	return dir;
+}
+
+// Return a random cap with a radius between minRadius and maxRadius in degree
+static SphericalRegionP randomCap(double minRadius, double maxRadius)
+{
+	const Vec3d dir = randomDirection();
+	const double radius = (minRadius+(maxRadius-minRadius)*qrand()/RAND_MAX)*M_PI/180.;
+	return SphericalRegionP(new SphericalCap(dir, std::cos(radius)));
+}
+
+// Return a random convex quad with a half size between minSize and maxSize in degree
+static SphericalConvexPolygon randomConvexQuad(double minSize, double maxSize)
+{
+	const Vec3d center = randomDirection();
+	Vec3d u = center^Vec3d(0,0,1);
+	if (u.lengthSquared()<1e-10)
+		u = center^Vec3d(1,0,0);
+	u.normalize();
+	const Vec3d v = center^u;
+	const double size = std::tan((minSize+(maxSize-minSize)*qrand()/RAND_MAX)*M_PI/180.);
+	QVector<Vec3d> contour;
+	contour << center+(u+v)*size << center+(v-u)*size << center-(u+v)*size << center+(u-v)*size;
+	for (int i=0;i<contour.size();++i)
+		contour[i].normalize();
+	if (!SphericalConvexPolygon::checkValidContour(contour))
+		std::reverse(contour.begin(), contour.end());
+	return SphericalConvexPolygon(contour);
+}
+
+// Print the statistics of a list of durations in ms as a line of the CSV output
+static void printStats(const QString& name, const QVector<double>& times)
+{
+	const int nb = times.size();
+	QVector<double> sorted(times);
+	std::sort(sorted.begin(), sorted.end());
+	double sum = 0.;
+	foreach (double t, sorted)
+		sum += t;
+	const double mean = sum/nb;
+	std::cout << qPrintable(name) << ',' << nb << ','
+		  << sorted.first() << ',' << mean << ',' << sorted.at(nb/2) << ','
+		  << sorted.at(qMin(nb-1, (int)(0.95*nb))) << ',' << sorted.last() << ','
+		  << 1000./mean << std::endl;
+}
+
+StelBenchmark::StelBenchmark(QSettings* aconf, const QString& ascenarioFile, int anbFrames, const QSize& asize, bool acomputations)
+	: conf(aconf), scenarioFile(ascenarioFile), nbFrames(anbFrames), size(asize), computations(acomputations)
+{
+	Q_ASSERT(conf);
+	if (nbFrames<1)
+		nbFrames = 1;
+}
+
+QList<StelBenchmark::Scenario> StelBenchmark::getBuiltinScenarios()
+{
+	QList<Scenario> res;
+	Scenario s;
+	s.jday = 2455927.5;	// 2012-01-01 0h UT
+
+	s.name = "galactic_center_60deg";
+	s.fov = 60.;
+	s.ra = 266.4;
+	s.dec = -28.9;
+	res << s;
+
+	s.name = "orion_20deg";
+	s.fov = 20.;
+	s.ra = 83.8;
+	s.dec = -5.4;
+	res << s;
+
+	s.name = "virgo_cluster_2deg";
+	s.fov = 2.;
+	s.ra = 187.7;
+	s.dec = 12.4;
+	res << s;
+
+	s.name = "pleiades_0.5deg";
+	s.fov = 0.5;
+	s.ra = 56.75;
+	s.dec = 24.1;
+	res << s;
+
+	s.name = "all_sky_fisheye";
+	s.fov = 180.;
+	s.ra = 0.;
+	s.dec = 90.;
+	s.projection = "ProjectionFisheye";
+	res << s;
+
+	s.name = "all_sky_cylinder";
+	s.fov = 175.;
+	s.ra = 0.;
+	s.dec = 0.;
+	s.projection = "ProjectionCylinder";
+	res << s;
+
+	return res;
+}
+
+QList<StelBenchmark::Scenario> StelBenchmark::loadScenarios(const QString& fileName)
+{
+	QList<Scenario> res;
+	QSettings file(fileName, QSettings::IniFormat);
+	if (file.status()!=QSettings::NoError)
+	{
+		qWarning() << "ERROR while parsing benchmark scenarios file" << fileName;
+		return res;
+	}
+	foreach (const QString& group, file.childGroups())
+	{
+		Scenario s;
+		s.name = group;
+		file.beginGroup(group);
+		s.jday = file.value("jday", -1.).toDouble();
+		s.fov = file.value("fov", 60.).toDouble();
+		s.ra = file.value("ra", 0.).toDouble();
+		s.dec = file.value("dec", 0.).toDouble();
+		s.projection = file.value("projection", "").toString();
+		file.endGroup();
+		res << s;
+	}
+	return res;
+}
+
+int StelBenchmark::run()
+{
+	QList<Scenario> scenarios;
+	if (!computations)
+	{
+		if (scenarioFile.isEmpty() || scenarioFile=="builtin")
+			scenarios = getBuiltinScenarios();
+		else
+			scenarios = loadScenarios(scenarioFile);
+		if (scenarios.isEmpty())
+		{
+			qWarning() << "ERROR: no benchmark scenario to run";
+			return 1;
+		}
+	}
+
+	// Create an off-screen GL context
+	QGLFormat glFormat(QGL::StencilBuffer | QGL::DepthBuffer);
+	if (!QGLPixelBuffer::hasOpenGLPbuffers())
+	{
+		qWarning() << "ERROR: off-screen GL buffers are not supported on this system, can't run the benchmark";
+		return 1;
+	}
+	QGLPixelBuffer pixelBuffer(size, glFormat);
+	if (!pixelBuffer.isValid() || !pixelBuffer.makeCurrent())
+	{
+		qWarning() << "ERROR: could not create an off-screen GL context, can't run the benchmark";
+		return 1;
+	}
+	qDebug() << "Benchmark GL renderer:" << QString((const char*)glGetString(GL_RENDERER));
+
+	// Render into a framebuffer object when possible, else directly into the pixel buffer
+	QGLFramebufferObject* fbo = NULL;
+	if (QGLFramebufferObject::hasOpenGLFramebufferObjects())
+		fbo = new QGLFramebufferObject(size, QGLFramebufferObject::CombinedDepthStencil);
+
+	StelPainter::initSystemGLInfo(const_cast<QGLContext*>(QGLContext::currentContext()));
+	QPainter* qPainter = fbo ? new QPainter(fbo) : new QPainter(&pixelBuffer);
+	StelPainter::setQPainter(qPainter);
+
+	StelApp::initStatic();
+	StelApp* app = new StelApp();
+	app->glWindowHasBeenResized(0, 0, size.width(), size.height());
+	app->init(conf);
+
+	// Make the measures independent from the current time and from user interactions
+	StelCore* core = app->getCore();
+	core->setZeroTimeSpeed();
+	core->getMovementMgr()->setFlagTracking(false);
+
+	if (computations)
+	{
+		runComputationBenchmarks();
+	}
+	else
+	{
+		std::cout << "scenario,frames,min_ms,mean_ms,median_ms,p95_ms,max_ms,fps" << std::endl;
+		foreach (const Scenario& s, scenarios)
+			runScenario(s);
+	}
+
+	StelPainter::setQPainter(NULL);
+	delete qPainter;
+	delete app;
+	StelApp::deinitStatic();
+	delete fbo;
+	return 0;
+}
+
+void StelBenchmark::runScenario(const Scenario& scenario)
+{
+	StelApp& app = StelApp::getInstance();
+	StelCore* core = app.getCore();
+	StelMovementMgr* mvMgr = core->getMovementMgr();
+
+	if (!scenario.projection.isEmpty())
+		core->setCurrentProjectionTypeKey(scenario.projection);
+	if (scenario.jday>=0.)
+		core->setJDay(scenario.jday);
+	Vec3d dir;
+	StelUtils::spheToRect(scenario.ra*M_PI/180., scenario.dec*M_PI/180., dir);
+	mvMgr->setViewDirectionJ2000(dir);
+	mvMgr->zoomTo(scenario.fov, 0.001f);
+
+	QVector<double> frameTimes(nbFrames);
+	QElapsedTimer timer;
+	for (int i=-NB_WARMUP_FRAMES;i<nbFrames;++i)
+	{
+		// Let the texture loading threads deliver their results, this is not part of the measure
+		QCoreApplication::processEvents();
+		timer.start();
+		app.update(FRAME_DELTA_TIME);
+		app.draw();
+		glFinish();
+		if (i>=0)
+			frameTimes[i] = timer.nsecsElapsed()/1000000.;
+	}
+
+	printStats(scenario.name, frameTimes);
+}
+
+void StelBenchmark::runComputationBenchmarks()
+{
+	// Each row gives the times of the blocks of operations named by the measure, and the number of blocks per second
+	std::cout << "measure,blocks,min_ms,mean_ms,median_ms,p95_ms,max_ms,blocks_per_s" << std::endl;
+	runSphericalGeometryBenchmark();
+	runDateConversionBenchmark();
+	runRefractionBenchmark();
+	runToneReproducerBenchmark();
+	runSolarSystemBenchmark();
+	runKeplerBenchmark();
+	runMinorBodyBenchmark();
+	runEclipseBenchmark();
+	runPositionCacheBenchmark();
+}
+
+void StelBenchmark::runSphericalGeometryBenchmark()
+{
+	qsrand(1);
+	QVector<SphericalConvexPolygon> polygons;
+	QVector<SphericalConvexPolygon> viewports;
+	QVector<SphericalCap> caps;
+	for (int i=0;i<NB_GEOMETRY_PAIRS;++i)
+	{
+		polygons << randomConvexQuad(0.1, 20.);
+		viewports << randomConvexQuad(1., 60.);
+		caps << *static_cast<SphericalCap*>(randomCap(0.1, 60.).data());
+	}
+
+	QVector<double> fastTimes(NB_GEOMETRY_PAIRS);
+	QVector<double> octahedronTimes(NB_GEOMETRY_PAIRS);
+	QElapsedTimer timer;
+	for (int i=0;i<NB_GEOMETRY_PAIRS;++i)
+	{
+		const SphericalConvexPolygon& poly = polygons.at(i);
+		const SphericalConvexPolygon& viewport = viewports.at(i);
+		const SphericalCap& cap = caps.at(i);
+
+		// Accumulate the results so that the operations can't be optimized away
+		double results = 0.;
+		timer.start();
+		results += poly.intersects(viewport);
+		results += cap.intersects(poly);
+		results += cap.contains(poly);
+		results += poly.getIntersection(viewport)->getArea();
+		fastTimes[i] = timer.nsecsElapsed()/1000000.;
+
+		timer.start();
+		const OctahedronPolygon polyOct = poly.getOctahedronPolygon();
+		const OctahedronPolygon capOct = cap.getOctahedronPolygon();
+		results += polyOct.intersects(viewport.getOctahedronPolygon());
+		results += capOct.intersects(polyOct);
+		results += capOct.contains(polyOct);
+		OctahedronPolygon intersection(polyOct);
+		intersection.inPlaceIntersection(viewport.getOctahedronPolygon());
+		results += intersection.getArea();
+		octahedronTimes[i] = timer.nsecsElapsed()/1000000.;
+		Q_UNUSED(results);
+	}
+	printStats("spherical_geometry_closed_form", fastTimes);
+	printStats("spherical_geometry_octahedron", octahedronTimes);
+}
+
+void StelBenchmark::runDateConversionBenchmark()
+{
+	qsrand(1);
+	// A sorted table with one row per hour like the ones of the ephemeris exports
+	QVector<double> tableJDs(NB_DATES);
+	const double tableStart = MIN_DATE_JD+(MAX_DATE_JD-MIN_DATE_JD)*qrand()/RAND_MAX;
+	for (int i=0;i<NB_DATES;++i)
+		tableJDs[i] = tableStart+i/24.;
+
+	const int nbBlocks = NB_DATES/DATE_BLOCK_SIZE;
+	QVector<double> scalarTimes(nbBlocks);
+	QVector<double> batchTimes(nbBlocks);
+	QVector<double> shiftTimes(nbBlocks);
+	QElapsedTimer timer;
+	for (int b=0;b<nbBlocks;++b)
+	{
+		const double* jds = tableJDs.constData()+b*DATE_BLOCK_SIZE;
+		timer.start();
+		QStringList scalarStrings;
+		for (int i=0;i<DATE_BLOCK_SIZE;++i)
+			scalarStrings << StelUtils::julianDayToISO8601String(jds[i]);
+		scalarTimes[b] = timer.nsecsElapsed()/1000000.;
+
+		timer.start();
+		const QStringList batchStrings = StelUtils::julianDaysToISO8601Strings(jds, DATE_BLOCK_SIZE);
+		batchTimes[b] = timer.nsecsElapsed()/1000000.;
+
+		timer.start();
+		float shiftSum = 0.f;
+		for (int i=0;i<DATE_BLOCK_SIZE;++i)
+			shiftSum += StelUtils::getGMTShiftFromQT(jds[i]);
+		shiftTimes[b] = timer.nsecsElapsed()/1000000.;
+		Q_UNUSED(shiftSum);
+	}
+	printStats("iso8601_scalar_1000", scalarTimes);
+	printStats("iso8601_batch_1000", batchTimes);
+	printStats("gmt_shift_1000", shiftTimes);
+}
+
+void StelBenchmark::runRefractionBenchmark()
+{
+	QVector<Vec3d> altAzPos(NB_REFRACTION_ALTITUDES);
+	for (int i=0;i<NB_REFRACTION_ALTITUDES;++i)
+	{
+		const double alt = (-10.+100.*i/(NB_REFRACTION_ALTITUDES-1))*M_PI/180.;
+		StelUtils::spheToRect(0.3*i, alt, altAzPos[i]);
+	}
+
+	Refraction refraction;
+
+	// Measure the formulas and the table on blocks of vectors
+	const int nbBlocks = NB_REFRACTION_ALTITUDES/REFRACTION_BLOCK_SIZE;
+	QVector<double> formulaTimes(nbBlocks);
+	QVector<double> tableTimes(nbBlocks);
+	QVector<Vec3d> v(REFRACTION_BLOCK_SIZE);
+	QElapsedTimer timer;
+	for (int b=0;b<nbBlocks;++b)
+	{
+		const Vec3d* block = altAzPos.constData()+b*REFRACTION_BLOCK_SIZE;
+		qCopy(block, block+REFRACTION_BLOCK_SIZE, v.begin());
+		timer.start();
+		for (int i=0;i<REFRACTION_BLOCK_SIZE;++i)
+		{
+			const double length = v[i].length();
+			v[i][2] = std::sin(refraction.forwardAltitude(180./M_PI*std::asin(v[i][2]/length))*M_PI/180.)*length;
+		}
+		formulaTimes[b] = timer.nsecsElapsed()/1000000.;
+
+		qCopy(block, block+REFRACTION_BLOCK_SIZE, v.begin());
+		timer.start();
+		refraction.forward(v.data(), REFRACTION_BLOCK_SIZE);
+		tableTimes[b] = timer.nsecsElapsed()/1000000.;
+	}
+	printStats("refraction_formulas_1000", formulaTimes);
+	printStats("refraction_table_1000", tableTimes);
+}
+
+void StelBenchmark::runToneReproducerBenchmark()
+{
+	qsrand(1);
+	// Luminances between 1e-6 and 1e6 cd/m^2 with a uniform distribution of their log, and random xyY colors
+	QVector<float> luminances(NB_TONE_VALUES);
+	QVector<float> lnLuminances(NB_TONE_VALUES);
+	QVector<Vec3f> colors(NB_TONE_VALUES);
+	for (int i=0;i<NB_TONE_VALUES;++i)
+	{
+		lnLuminances[i] = (float)((-6.+12.*qrand()/RAND_MAX)*std::log(10.));
+		luminances[i] = std::exp(lnLuminances[i]);
+		colors[i].set(0.2f+0.3f*qrand()/RAND_MAX, 0.2f+0.3f*qrand()/RAND_MAX, luminances[i]);
+	}
+
+	StelToneReproducer eye;
+
+	// Measure the exact formulas and the lookup tables on blocks of values
+	const int nbBlocks = NB_TONE_VALUES/TONE_BLOCK_SIZE;
+	QVector<double> exactTimes(nbBlocks);
+	QVector<double> tableTimes(nbBlocks);
+	QVector<double> exactColorTimes(nbBlocks);
+	QVector<double> tableColorTimes(nbBlocks);
+	QVector<float> adapted(TONE_BLOCK_SIZE);
+	QVector<Vec3f> rgb(TONE_BLOCK_SIZE);
+	QElapsedTimer timer;
+	for (int b=0;b<nbBlocks;++b)
+	{
+		const float* block = lnLuminances.constData()+b*TONE_BLOCK_SIZE;
+		timer.start();
+		for (int i=0;i<TONE_BLOCK_SIZE;++i)
+			adapted[i] = eye.adaptLuminanceScaledLnExact(block[i], 0.7f);
+		exactTimes[b] = timer.nsecsElapsed()/1000000.;
+
+		timer.start();
+		eye.adaptLuminanceScaledLn(block, adapted.data(), TONE_BLOCK_SIZE, 0.7f);
+		tableTimes[b] = timer.nsecsElapsed()/1000000.;
+
+		const Vec3f* colorBlock = colors.constData()+b*TONE_BLOCK_SIZE;
+		qCopy(colorBlock, colorBlock+TONE_BLOCK_SIZE, rgb.begin());
+		timer.start();
+		for (int i=0;i<TONE_BLOCK_SIZE;++i)
+			eye.xyYToRGBExact(rgb[i]);
+		exactColorTimes[b] = timer.nsecsElapsed()/1000000.;
+
+		qCopy(colorBlock, colorBlock+TONE_BLOCK_SIZE, rgb.begin());
+		timer.start();
+		eye.xyYToRGB((float*)rgb.data(), TONE_BLOCK_SIZE);
+		tableColorTimes[b] = timer.nsecsElapsed()/1000000.;
+	}
+	printStats("tone_adapt_exact_1000", exactTimes);
+	printStats("tone_adapt_table_1000", tableTimes);
+	printStats("tone_xyY_exact_1000", exactColorTimes);
+	printStats("tone_xyY_table_1000", tableColorTimes);
+}
+
+void StelBenchmark::runSolarSystemBenchmark()
+{
+	SolarSystem* ssystem = GETSTELMODULE(SolarSystem);
+	const Vec3d observerPos = StelApp::getInstance().getCore()->getObserverHeliocentricEclipticPos();
+	const bool flagParallelPositions = ssystem->getFlagParallelPositions();
+	const bool flagLightTravelTime = ssystem->getFlagLightTravelTime();
+
+	QElapsedTimer timer;
+	for (int lightTime=0;lightTime<2;++lightTime)
+	{
+		ssystem->setFlagLightTravelTime(lightTime==1);
+		QVector<double> times[2];
+		for (int parallel=0;parallel<2;++parallel)
+		{
+			ssystem->setFlagParallelPositions(parallel==1);
+			// Start far from the measured dates, so that the planets and the ephemeris caches are in the same state for both runs
+			ssystem->computePositions(SOLAR_SYSTEM_START_JD-100000., observerPos);
+			times[parallel].resize(NB_SOLAR_SYSTEM_STEPS);
+			for (int i=0;i<NB_SOLAR_SYSTEM_STEPS;++i)
+			{
+				timer.start();
+				ssystem->computePositions(SOLAR_SYSTEM_START_JD+i*SOLAR_SYSTEM_STEP_JD, observerPos);
+				times[parallel][i] = timer.nsecsElapsed()/1000000.;
+			}
+		}
+
+		const QString suffix = lightTime==1 ? "_light_time" : "";
+		printStats("solar_system_serial"+suffix, times[0]);
+		printStats("solar_system_parallel"+suffix, times[1]);
+	}
+
+	ssystem->setFlagParallelPositions(flagParallelPositions);
+	ssystem->setFlagLightTravelTime(flagLightTravelTime);
+}
+
+// Create a comet orbit with random elements
+static CometOrbit* randomCometOrbit(double minEccentricity, double maxEccentricity)
+{
+	const double q = 0.1+5.*qrand()/RAND_MAX;
+	const double e = minEccentricity+(maxEccentricity-minEccentricity)*qrand()/RAND_MAX;
+	const double k = 0.01720209895;
+	const double n = (e==1.) ? k*(1.5/q)*std::sqrt(0.5/q) : k/std::pow(q/std::fabs(1.-e), 1.5);
+	return new CometOrbit(q, e, M_PI*qrand()/RAND_MAX, 2.*M_PI*qrand()/RAND_MAX, 2.*M_PI*qrand()/RAND_MAX, 2455927.5, n, 0., 0., 0.);
+}
+
+void StelBenchmark::runKeplerBenchmark()
+{
+	qsrand(1);
+
+	// Measure the positions of minor planet like orbits and of comet orbits, one by one and in batch
+	QVector<EllipticalOrbit*> ellipticalOrbits(NB_KEPLER_ORBITS);
+	QVector<CometOrbit*> cometOrbits(NB_KEPLER_ORBITS);
+	for (int i=0;i<NB_KEPLER_ORBITS;++i)
+	{
+		const double e = 0.4*qrand()/RAND_MAX;
+		const double a = 1.5+3.5*qrand()/RAND_MAX;
+		const double period = 365.25*a*std::sqrt(a);
+		ellipticalOrbits[i] = new EllipticalOrbit(a*(1.-e), e, 0.5*qrand()/RAND_MAX, 2.*M_PI*qrand()/RAND_MAX, 2.*M_PI*qrand()/RAND_MAX,
+							 2.*M_PI*qrand()/RAND_MAX, period, 2455927.5, 0., 0., 0.);
+		cometOrbits[i] = randomCometOrbit(0.5, 1.2);
+	}
+	QVector<Vec3d> positions(NB_KEPLER_ORBITS);
+	QVector<Vec3d> batchPositions(NB_KEPLER_ORBITS);
+	QVector<double> scalarTimes(NB_KEPLER_DATES);
+	QVector<double> batchTimes(NB_KEPLER_DATES);
+	QVector<double> cometScalarTimes(NB_KEPLER_DATES);
+	QVector<double> cometBatchTimes(NB_KEPLER_DATES);
+	QElapsedTimer timer;
+	for (int d=0;d<NB_KEPLER_DATES;++d)
+	{
+		const double jd = 2455927.5+1000.*d;
+		timer.start();
+		for (int i=0;i<NB_KEPLER_ORBITS;++i)
+			ellipticalOrbits.at(i)->positionAtTimevInVSOP87Coordinates(jd, positions[i]);
+		scalarTimes[d] = timer.nsecsElapsed()/1000000.;
+		timer.start();
+		EllipticalOrbit::positionsAtTimeInVSOP87Coordinates(ellipticalOrbits.constData(), NB_KEPLER_ORBITS, jd, batchPositions.data());
+		batchTimes[d] = timer.nsecsElapsed()/1000000.;
+
+		timer.start();
+		for (int i=0;i<NB_KEPLER_ORBITS;++i)
+			cometOrbits.at(i)->positionAtTimevInVSOP87Coordinates(jd, positions[i]);
+		cometScalarTimes[d] = timer.nsecsElapsed()/1000000.;
+		timer.start();
+		CometOrbit::positionsAtTimeInVSOP87Coordinates(cometOrbits.constData(), NB_KEPLER_ORBITS, jd, batchPositions.data());
+		cometBatchTimes[d] = timer.nsecsElapsed()/1000000.;
+	}
+	printStats("kepler_elliptical_scalar_100000", scalarTimes);
+	printStats("kepler_elliptical_batch_100000", batchTimes);
+	printStats("kepler_comet_scalar_100000", cometScalarTimes);
+	printStats("kepler_comet_batch_100000", cometBatchTimes);
+
+	qDeleteAll(ellipticalOrbits);
+	qDeleteAll(cometOrbits);
+}
+
+void StelBenchmark::runMinorBodyBenchmark()
+{
+	qsrand(1);
+
+	// Write a MPCORB.DAT like file of main belt asteroids, with the epoch 2013 April 18
+	QTemporaryFile sourceFile;
+	if (!sourceFile.open())
+	{
+		qWarning() << "WARNING: can't create the minor body benchmark file";
+		return;
+	}
+	{
+		QTextStream out(&sourceFile);
+		out << "MINOR PLANET CENTER ORBIT DATABASE (MPCORB)\n\n";
+		out << QString("-").repeated(160) << "\n";
+		for (int i=0;i<NB_MINOR_BODIES;++i)
+		{
+			const double a = 2.+1.5*qrand()/RAND_MAX;
+			const QString record = QString().sprintf("%-7d %5.2f %5.2f K134I %9.5f  %9.5f  %9.5f  %9.5f  %9.7f %11.8f %11.7f",
+				i+1, 10.+10.*qrand()/RAND_MAX, 0.15, 360.*qrand()/RAND_MAX, 360.*qrand()/RAND_MAX, 360.*qrand()/RAND_MAX,
+				30.*qrand()/RAND_MAX, 0.3*qrand()/RAND_MAX, 0.9856076686/(a*std::sqrt(a)), a);
+			out << record.leftJustified(166, ' ') << QString("(%1) Benchmark%1").arg(i+1) << "\n";
+		}
+	}
+	sourceFile.close();
+	const QString cacheFile = sourceFile.fileName()+".cache";
+
+	QElapsedTimer timer;
+	MinorBodyCatalog catalog;
+	timer.start();
+	catalog.compile(sourceFile.fileName());
+	QVector<double> compileTimes(1, timer.nsecsElapsed()/1000000.);
+	catalog.save(cacheFile);
+	timer.start();
+	MinorBodyCatalog loadedCatalog;
+	const bool loaded = loadedCatalog.load(cacheFile, QStringList() << sourceFile.fileName());
+	QVector<double> loadTimes(1, timer.nsecsElapsed()/1000000.);
+	QFile::remove(cacheFile);
+	if (!loaded)
+	{
+		qWarning() << "WARNING: can't load the minor body benchmark cache file";
+		return;
+	}
+
+	// Measure the bulk positions corrected for the light travel time and the ones of the orbit objects
+	QVector<EllipticalOrbit*> orbits(loadedCatalog.size());
+	for (int i=0;i<orbits.size();++i)
+		orbits[i] = loadedCatalog.createOrbit(i);
+	const Vec3d observerPos(-0.9, 0.4, 0.);
+	QVector<Vec3d> positions;
+	QVector<Vec3d> orbitPositions(orbits.size());
+	QVector<float> magnitudes;
+	QVector<double> bulkTimes(NB_KEPLER_DATES);
+	QVector<double> orbitTimes(NB_KEPLER_DATES);
+	for (int d=0;d<NB_KEPLER_DATES;++d)
+	{
+		const double jd = 2456400.5+100.*d;
+		timer.start();
+		loadedCatalog.computePositions(jd, positions, &observerPos);
+		loadedCatalog.computeMagnitudes(positions, observerPos, magnitudes);
+		bulkTimes[d] = timer.nsecsElapsed()/1000000.;
+		timer.start();
+		for (int i=0;i<orbits.size();++i)
+		{
+			orbits.at(i)->positionAtTimevInVSOP87Coordinates(jd, orbitPositions[i]);
+			const double lightTime = (orbitPositions.at(i)-observerPos).length()*(AU/(SPEED_OF_LIGHT*86400));
+			orbits.at(i)->positionAtTimevInVSOP87Coordinates(jd-lightTime, orbitPositions[i]);
+		}
+		orbitTimes[d] = timer.nsecsElapsed()/1000000.;
+	}
+	qDeleteAll(orbits);
+
+	printStats("minor_bodies_compile_100000", compileTimes);
+	printStats("minor_bodies_load_100000", loadTimes);
+	printStats("minor_bodies_bulk_100000", bulkTimes);
+	printStats("minor_bodies_orbits_100000", orbitTimes);
+}
+
+void StelBenchmark::runEclipseBenchmark()
+{
+	QElapsedTimer timer;
+	QVector<double> times(NB_ECLIPSE_DECADES);
+	for (int d=0;d<NB_ECLIPSE_DECADES;++d)
+	{
+		const double startJD = ECLIPSE_START_JD+d*DECADE_JD;
+		timer.start();
+		EclipseGeometry::findLunarEclipses(startJD, startJD+DECADE_JD);
+		times[d] = timer.nsecsElapsed()/1000000.;
+	}
+	printStats("lunar_eclipses_decade", times);
+}
+
+void StelBenchmark::runPositionCacheBenchmark()
+{
+	StelCore* core = StelApp::getInstance().getCore();
+	const QList<PlanetP>& planets = GETSTELMODULE(SolarSystem)->getAllPlanets();
+
+	QElapsedTimer timer;
+	QVector<double> times[2];
+	times[0].resize(NB_POSITION_CACHE_FRAMES);
+	times[1].resize(NB_POSITION_CACHE_FRAMES);
+	for (int f=0;f<NB_POSITION_CACHE_FRAMES;++f)
+	{
+		// Start a new frame, also because the previous benchmarks moved the planets without the core
+		core->update(0.);
+
+		double sums[2] = {0., 0.};
+		timer.start();
+		foreach (const PlanetP& p, planets)
+		{
+			for (int q=0;q<NB_POSITION_QUERIES;++q)
+				sums[0] += p->getAltAzPosApparent(core)[2];
+		}
+		times[0][f] = timer.nsecsElapsed()/1000000.;
+
+		timer.start();
+		foreach (const PlanetP& p, planets)
+		{
+			for (int q=0;q<NB_POSITION_QUERIES;++q)
+				sums[1] += core->j2000ToAltAz(p->getJ2000EquatorialPos(core), StelCore::RefractionOn)[2];
+		}
+		times[1][f] = timer.nsecsElapsed()/1000000.;
+		Q_UNUSED(sums);
+	}
+
+	printStats("positions_cached", times[0]);
+	printStats("positions_computed", times[1]);
+}
@@ -0,0 +1,133 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _STELBENCHMARK_HPP_
+#define _STELBENCHMARK_HPP_
+
+#include <QString>
+#include <QList>
+#include <QSize>
+
+class QSettings;
+
+//! @class StelBenchmark
+//! Run Stellarium without any window and measure the frame times for a list of scenarios.
+//! The sky is rendered in an off-screen GL buffer, so that no visible window is needed.
+//! On a machine without GPU, the Mesa software renderer (llvmpipe) can be used through
+//! a virtual X server such as Xvfb.
+//! Each scenario defines the date, the field of view, the viewing direction and optionally
+//! the projection type. After a few warm-up frames, a fixed number of frames is rendered and
+//! the frame time statistics are printed on the standard output.
+//! In computations mode, the frame scenarios are replaced by the measures of the spherical geometry operations, the date conversions,
+//! the refraction, the tone reproduction, the Solar System positions, the Kepler solvers, the minor body catalogue,
+//! the lunar eclipse search and the position cache outside of any rendering, printed with their own CSV header.
+//! Only the timings are measured here, the correctness of these computations is checked by the tests in src/tests.
+//! Scenarios can be loaded from an ini file with one group per scenario, e.g.:
+//! @code
+//! [milky_way_wide]
+//! jday = 2455927.5
+//! fov = 180
+//! ra = 266.4
+//! dec = -28.9
+//! projection = ProjectionFisheye
+//! @endcode
+class StelBenchmark
+{
+public:
+	//! @struct Scenario
+	//! One camera/time/FOV configuration to measure.
+	struct Scenario
+	{
+		Scenario() : jday(-1.), fov(60.), ra(0.), dec(0.) {;}
+		QString name;
+		//! The Julian day, or -1 to keep the startup date
+		double jday;
+		//! The field of view in degree
+		double fov;
+		//! The J2000 right ascension of the viewing direction in degree
+		double ra;
+		//! The J2000 declination of the viewing direction in degree
+		double dec;
+		//! The projection type key, or empty to keep the current projection
+		QString projection;
+	};
+
+	//! @param conf the main configuration.
+	//! @param scenarioFile an ini file containing the scenarios, or "builtin" to use the built-in scenarios.
+	//! @param nbFrames the number of measured frames per scenario.
+	//! @param size the size of the off-screen buffer in pixel.
+	//! @param computations if true, measure the computations instead of the frame scenarios.
+	StelBenchmark(QSettings* conf, const QString& scenarioFile, int nbFrames, const QSize& size, bool computations=false);
+
+	//! Initialize Stellarium in an off-screen buffer and run all the scenarios, or all the computation measures.
+	//! @return the process exit code, 0 on success.
+	int run();
+
+	//! Get the list of built-in scenarios.
+	static QList<Scenario> getBuiltinScenarios();
+
+	//! Load the list of scenarios from an ini file.
+	static QList<Scenario> loadScenarios(const QString& fileName);
+
+private:
+	//! Render and measure one scenario, and print its statistics.
+	void runScenario(const Scenario& scenario);
+
+	//! Run all the measures of the computations outside of any rendering.
+	void runComputationBenchmarks();
+
+	//! Measure the closed-form intersection tests and intersections between random convex polygons and caps,
+	//! and the generic OctahedronPolygon algorithms on the same regions.
+	void runSphericalGeometryBenchmark();
+
+	//! Measure the ISO8601 formatting of a sorted table of dates, one date at a time and in batch, and the GMT shift queries.
+	void runDateConversionBenchmark();
+
+	//! Measure the refraction formulas and the refraction table.
+	void runRefractionBenchmark();
+
+	//! Measure the exact formulas and the lookup tables of the StelToneReproducer.
+	void runToneReproducerBenchmark();
+
+	//! Measure the Solar System positions over a time-lapse computed in one thread and in parallel,
+	//! with and without light travel time.
+	void runSolarSystemBenchmark();
+
+	//! Measure the positions of 100000 synthetic orbits computed one by one and in batch.
+	void runKeplerBenchmark();
+
+	//! Measure the compilation and the loading of a minor body catalogue of 100000 synthetic asteroids,
+	//! and its bulk positions compared to the ones of the orbit objects.
+	void runMinorBodyBenchmark();
+
+	//! Measure the search of the lunar eclipses of the 21st century decade by decade.
+	void runEclipseBenchmark();
+
+	//! Measure the queries of the apparent positions of the Solar System bodies several times per frame,
+	//! through the position cache of the StelObject and computed at each query.
+	void runPositionCacheBenchmark();
+
+	QSettings* conf;
+	QString scenarioFile;
+	int nbFrames;
+	QSize size;
+	bool computations;
+};
+
+#endif // _STELBENCHMARK_HPP_
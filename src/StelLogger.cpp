@@ -28,6 +28,7 @@
 // Init statics variables.
 QFile StelLogger::logFile;
 QString StelLogger::log;
+QMutex StelLogger::logMutex;
 
 void StelLogger::init(const QString& logFilePath)
 {
@@ -306,6 +307,7 @@ void StelLogger::debugLogHandler(QtMsgType, const char* msg)
 void StelLogger::writeLog(QString msg)
 {
 	msg += "\n";
+	QMutexLocker locker(&logMutex);
 	logFile.write(qPrintable(msg), msg.size());
 	log += msg;
 }
@@ -159,7 +159,7 @@ protected:
 };
 
 StelMainGraphicsView::StelMainGraphicsView(QWidget* parent)
-	: QGraphicsView(parent), backItem(NULL), gui(NULL),
+	: QGraphicsView(parent), backItem(NULL), mainSkyItem(NULL), gui(NULL),
 #ifndef DISABLE_SCRIPTING
 	scriptAPIProxy(NULL), scriptMgr(NULL),
 #endif
@@ -167,7 +167,7 @@ StelMainGraphicsView::StelMainGraphicsView(QWidget* parent)
 	  flagInvertScreenShotColors(false),
 	  screenShotPrefix("stellarium-"),
 	  screenShotDir(""),
-	  cursorTimeout(-1.f), flagCursorTimeout(false), minFpsTimer(NULL), maxfps(10000.f)
+	  cursorTimeout(-1.f), flagCursorTimeout(false), minFpsTimer(NULL), maxfps(10000.f), lastGovernedFrame(0)
 {
 	StelApp::initStatic();
 
@@ -244,6 +244,8 @@ void StelMainGraphicsView::init(QSettings* conf)
 	setCursorTimeout(conf->value("gui/mouse_cursor_timeout", 10.f).toFloat());
 	maxfps = conf->value("video/maximum_fps",10000.f).toFloat();
 	minfps = conf->value("video/minimum_fps",10000.f).toFloat();
+	setFlagAdaptiveQuality(conf->value("video/flag_adaptive_quality", false).toBool());
+	setAdaptiveQualityTargetFps(conf->value("video/adaptive_quality_target_fps", 30.f).toFloat());
 
 	StelPainter::initSystemGLInfo(glContext);
 
@@ -318,6 +320,15 @@ void StelMainGraphicsView::drawBackground(QPainter*, const QRectF&)
 		QTimer::singleShot(dur<5 ? 5 : dur, this, SLOT(updateScene()));
 	}
 
+	// Adapt the rendering quality to the time spent on the last complete frame.
+	// Quality is only traded for speed during the interaction window, full quality returns when the view is still.
+	if (mainSkyItem && mainSkyItem->getNbFramesPainted()!=lastGovernedFrame && StelApp::getInstance().getCore())
+	{
+		lastGovernedFrame = mainSkyItem->getNbFramesPainted();
+		qualityGovernor.addFrame(mainSkyItem->getLastFrameDuration(), now-lastEventTimeSec<2.5);
+		StelApp::getInstance().getCore()->setRenderingQuality(qualityGovernor.getQuality());
+	}
+
 	// Manage cursor timeout
 	if (cursorTimeout>0.f && (now-lastEventTimeSec>cursorTimeout) && flagCursorTimeout)
 	{
@@ -23,6 +23,7 @@
 #include <QGraphicsView>
 #include <QCoreApplication>
 #include <QEventLoop>
+#include "StelQualityGovernor.hpp"
 
 class QGLWidget;
 class QResizeEvent;
@@ -104,6 +105,15 @@ public slots:
 	//! Get the current maximum frames per second.
 	float getMaxFps() {return maxfps;}
 
+	//! Set whether the rendering quality is lowered when frames are too slow during interactions.
+	void setFlagAdaptiveQuality(bool b) {qualityGovernor.setFlagEnabled(b);}
+	//! Get whether the rendering quality is lowered when frames are too slow during interactions.
+	bool getFlagAdaptiveQuality() const {return qualityGovernor.getFlagEnabled();}
+	//! Set the frame rate that the adaptive quality tries to reach during interactions.
+	void setAdaptiveQualityTargetFps(float fps) {qualityGovernor.setTargetFrameDuration(1./qMax(1.f, fps));}
+	//! Get the frame rate that the adaptive quality tries to reach during interactions.
+	float getAdaptiveQualityTargetFps() const {return 1./qualityGovernor.getTargetFrameDuration();}
+
 	//! Updates the scene and process all events
 	void updateScene() {
 
@@ -186,6 +196,11 @@ private:
 	float minfps;
 	//! The maximum desired frame rate in frame per second.
 	float maxfps;
+
+	//! Adapt the rendering quality to the frame time
+	StelQualityGovernor qualityGovernor;
+	//! The last frame reported to the qualityGovernor
+	int lastGovernedFrame;
 };
 
 
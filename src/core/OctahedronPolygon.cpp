@@ -23,10 +23,34 @@
 #include "glues.h"
 
 #include <QFile>
+#include <QCache>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QCryptographicHash>
 
 const Vec3d OctahedronPolygon::sideDirections[] = {	Vec3d(1,1,1), Vec3d(1,1,-1),Vec3d(-1,1,1),Vec3d(-1,1,-1),
 	Vec3d(1,-1,1),Vec3d(1,-1,-1),Vec3d(-1,-1,1),Vec3d(-1,-1,-1)};
 
+// Maximum memory used by the memo of boolean operation results in byte
+static const int MEMO_MAX_COST = 16000000;
+
+// Number of boolean operations a polygon must be an operand of before its results are memoized
+static const int MEMO_MIN_OPERATIONS = 2;
+
+// The memo of boolean operation results, shared by all the instances.
+// Function statics are used so that polygons created during static initialization can use it.
+static QCache<QByteArray, OctahedronPolygon>& getMemo()
+{
+	static QCache<QByteArray, OctahedronPolygon> memo(MEMO_MAX_COST);
+	return memo;
+}
+
+static QMutex& getMemoMutex()
+{
+	static QMutex mutex;
+	return mutex;
+}
+
 inline bool intersectsBoundingCap(const Vec3d& n1, double d1, const Vec3d& n2, double d2)
 {
 	const double a = d1*d2 - n1*n2;
@@ -93,7 +117,7 @@ QString SubContour::toJSON() const
 	return res;
 };
 
-OctahedronPolygon::OctahedronPolygon(const QVector<Vec3d>& contour) : fillCachedVertexArray(StelVertexArray::Triangles), outlineCachedVertexArray(StelVertexArray::Lines)
+OctahedronPolygon::OctahedronPolygon(const QVector<Vec3d>& contour) : fillCachedVertexArray(StelVertexArray::Triangles), outlineCachedVertexArray(StelVertexArray::Lines), nbOperations(0)
 {
 	sides.resize(8);
 	appendSubContour(SubContour(contour));
@@ -101,7 +125,7 @@ OctahedronPolygon::OctahedronPolygon(const QVector<Vec3d>& contour) : fillCached
 	updateVertexArray();
 }
 
-OctahedronPolygon::OctahedronPolygon(const QVector<QVector<Vec3d> >& contours) : fillCachedVertexArray(StelVertexArray::Triangles), outlineCachedVertexArray(StelVertexArray::Lines)
+OctahedronPolygon::OctahedronPolygon(const QVector<QVector<Vec3d> >& contours) : fillCachedVertexArray(StelVertexArray::Triangles), outlineCachedVertexArray(StelVertexArray::Lines), nbOperations(0)
 {
 	sides.resize(8);
 	foreach (const QVector<Vec3d>& contour, contours)
@@ -110,7 +134,7 @@ OctahedronPolygon::OctahedronPolygon(const QVector<QVector<Vec3d> >& contours) :
 	updateVertexArray();
 }
 
-OctahedronPolygon::OctahedronPolygon(const SubContour& initContour)
+OctahedronPolygon::OctahedronPolygon(const SubContour& initContour) : nbOperations(0)
 {
 	sides.resize(8);
 	appendSubContour(initContour);
@@ -119,7 +143,7 @@ OctahedronPolygon::OctahedronPolygon(const SubContour& initContour)
 }
 
 
-OctahedronPolygon::OctahedronPolygon(const QList<OctahedronPolygon>& octs) : fillCachedVertexArray(StelVertexArray::Triangles), outlineCachedVertexArray(StelVertexArray::Lines)
+OctahedronPolygon::OctahedronPolygon(const QList<OctahedronPolygon>& octs) : fillCachedVertexArray(StelVertexArray::Triangles), outlineCachedVertexArray(StelVertexArray::Lines), nbOperations(0)
 {
 	sides.resize(8);
 	foreach (const OctahedronPolygon& oct, octs)
@@ -455,6 +479,9 @@ void OctahedronPolygon::updateVertexArray()
 	}
 	gluesDeleteTess(tess);
 	computeBoundingCap();
+	// The content changed, the polygon is not a memoization candidate anymore
+	updateContentHash();
+	nbOperations = 0;
 
 #ifndef NDEBUG
 	// Check that all triangles are properly oriented
@@ -574,6 +601,76 @@ void OctahedronPolygon::tesselate(TessWindingRule windingRule)
 	gluesDeleteTess(tess);
 }
 
+void OctahedronPolygon::updateContentHash()
+{
+	// Hash the raw vertex data, the EdgeVertex padding bytes are skipped as they are not initialized
+	QCryptographicHash hash(QCryptographicHash::Md5);
+	for (int i=0;i<sides.size();++i)
+	{
+		const int nbContours = sides[i].size();
+		hash.addData((const char*)&nbContours, sizeof(int));
+		foreach (const SubContour& c, sides[i])
+		{
+			const int nbVertices = c.size();
+			hash.addData((const char*)&nbVertices, sizeof(int));
+			foreach (const EdgeVertex& v, c)
+			{
+				hash.addData((const char*)v.vertex.data(), 3*sizeof(double));
+				const char flag = v.edgeFlag ? 1 : 0;
+				hash.addData(&flag, 1);
+			}
+		}
+	}
+	contentHash = hash.result();
+}
+
+QByteArray OctahedronPolygon::getOperationKey(char op, const OctahedronPolygon& mpoly) const
+{
+	// Only the polygons reused in several operations, like the footprints of the sky images, are worth memoizing.
+	// The temporary ones, like the intermediate results or a viewport which changes at each frame, don't fill the memo.
+	const int nb = nbOperations.fetchAndAddRelaxed(1)+1;
+	const int mpolyNb = mpoly.nbOperations.fetchAndAddRelaxed(1)+1;
+	// The default constructed polygons have no hash, their keys could be mistaken for the ones of the opposite operation
+	if (nb<MEMO_MIN_OPERATIONS || mpolyNb<MEMO_MIN_OPERATIONS || contentHash.isEmpty() || mpoly.contentHash.isEmpty())
+		return QByteArray();
+	return QByteArray(1, op) + contentHash + mpoly.contentHash;
+}
+
+bool OctahedronPolygon::lookupMemo(const QByteArray& key)
+{
+	if (key.isEmpty())
+		return false;
+	QMutexLocker locker(&getMemoMutex());
+	const OctahedronPolygon* cached = getMemo().object(key);
+	if (cached==NULL)
+		return false;
+	// The vectors are implicitly shared, this doesn't copy the vertices
+	*this = *cached;
+	nbOperations = 0;
+	return true;
+}
+
+void OctahedronPolygon::insertInMemo(const QByteArray& key) const
+{
+	if (key.isEmpty())
+		return;
+	// Approximate memory used by the vertices
+	int cost = (fillCachedVertexArray.vertex.size()+outlineCachedVertexArray.vertex.size())*sizeof(Vec3d);
+	for (int i=0;i<sides.size();++i)
+	{
+		foreach (const SubContour& c, sides[i])
+			cost += c.size()*sizeof(EdgeVertex);
+	}
+	QMutexLocker locker(&getMemoMutex());
+	getMemo().insert(key, new OctahedronPolygon(*this), cost);
+}
+
+void OctahedronPolygon::clearMemo()
+{
+	QMutexLocker locker(&getMemoMutex());
+	getMemo().clear();
+}
+
 
 QString OctahedronPolygon::toJson() const
 {
@@ -595,36 +692,56 @@ void OctahedronPolygon::inPlaceIntersection(const OctahedronPolygon& mpoly)
 {
 	if (!intersectsBoundingCap(capN, capD, mpoly.capN, mpoly.capD))
 		return;
+	applyIntersection(mpoly, getOperationKey('I', mpoly));
+}
+
+void OctahedronPolygon::applyIntersection(const OctahedronPolygon& mpoly, const QByteArray& key)
+{
+	if (lookupMemo(key))
+		return;
 	append(mpoly);
 	tesselate(WindingAbsGeqTwo);
-	//tesselate(WindingPositive);
 	updateVertexArray();
+	insertInMemo(key);
 }
 
 void OctahedronPolygon::inPlaceUnion(const OctahedronPolygon& mpoly)
 {
+	applyUnion(mpoly, getOperationKey('U', mpoly));
+}
+
+void OctahedronPolygon::applyUnion(const OctahedronPolygon& mpoly, const QByteArray& key)
+{
+	if (lookupMemo(key))
+		return;
 	const bool intersect = intersectsBoundingCap(capN, capD, mpoly.capN, mpoly.capD);
 	append(mpoly);
 	if (intersect)
 		tesselate(WindingPositive);
 	updateVertexArray();
+	insertInMemo(key);
 }
 
 void OctahedronPolygon::inPlaceSubtraction(const OctahedronPolygon& mpoly)
 {
 	if (!intersectsBoundingCap(capN, capD, mpoly.capN, mpoly.capD))
 		return;
+	const QByteArray key = getOperationKey('S', mpoly);
+	if (lookupMemo(key))
+		return;
 	appendReversed(mpoly);
 	tesselate(WindingPositive);
 	updateVertexArray();
+	insertInMemo(key);
 }
 
 bool OctahedronPolygon::intersects(const OctahedronPolygon& mpoly) const
 {
 	if (!intersectsBoundingCap(capN, capD, mpoly.capN, mpoly.capD))
 		return false;
+	// The key is computed by this polygon so that it keeps track of its own reuse and hash
 	OctahedronPolygon resOct(*this);
-	resOct.inPlaceIntersection(mpoly);
+	resOct.applyIntersection(mpoly, getOperationKey('I', mpoly));
 	return !resOct.isEmpty();
 }
 
@@ -632,8 +749,9 @@ bool OctahedronPolygon::contains(const OctahedronPolygon& mpoly) const
 {
 	if (!containsBoundingCap(capN, capD, mpoly.capN, mpoly.capD))
 		return false;
+	// The key is computed by this polygon so that it keeps track of its own reuse and hash
 	OctahedronPolygon resOct(*this);
-	resOct.inPlaceUnion(mpoly);
+	resOct.applyUnion(mpoly, getOperationKey('U', mpoly));
 	return resOct.getArea()-getArea()<0.00000000001;
 }
 
@@ -900,5 +1018,7 @@ QDataStream& operator>>(QDataStream& in, OctahedronPolygon& p)
 	in >> p.outlineCachedVertexArray;
 	in >> p.capN;
 	in >> p.capD;
+	p.updateContentHash();
+	p.nbOperations = 0;
 	return in;
 }
@@ -23,6 +23,8 @@
 #include <QVector>
 #include <QDebug>
 #include <QVarLengthArray>
+#include <QByteArray>
+#include <QAtomicInt>
 #include "VecMath.hpp"
 #include "StelVertexArray.hpp"
 
@@ -62,7 +64,7 @@ public:
 class OctahedronPolygon
 {
 public:
-	OctahedronPolygon() : fillCachedVertexArray(StelVertexArray::Triangles), outlineCachedVertexArray(StelVertexArray::Lines), capN(1,0,0), capD(-2.)
+	OctahedronPolygon() : fillCachedVertexArray(StelVertexArray::Triangles), outlineCachedVertexArray(StelVertexArray::Lines), capN(1,0,0), capD(-2.), nbOperations(0)
 	{sides.resize(8);}
 
 	//! Create the OctahedronContour by splitting the passed SubContour on the 8 sides of the octahedron.
@@ -107,6 +109,9 @@ public:
 
 	QString toJson() const;
 
+	//! Empty the memo of tesselation and boolean operation results shared by all the instances.
+	static void clearMemo();
+
 private:
 	// For unit tests
 	friend class TestStelSphericalGeometry;
@@ -135,6 +140,22 @@ private:
 	//! Tesselate the contours per side, producing a list of triangles subcontours according to the given rule.
 	void tesselate(TessWindingRule rule);
 
+	//! Set this polygon as the intersection of itself with mpoly, using the result stored in the memo for key if any.
+	void applyIntersection(const OctahedronPolygon& mpoly, const QByteArray& key);
+	//! Set this polygon as the union of itself with mpoly, using the result stored in the memo for key if any.
+	void applyUnion(const OctahedronPolygon& mpoly, const QByteArray& key);
+
+	//! Compute the hash of the content of the sides, called each time the content changes.
+	void updateContentHash();
+	//! Get the memo key of a boolean operation between this polygon and mpoly, or an empty key if it can't be memoized.
+	//! Only the polygons already used in a previous operation are memoization candidates.
+	QByteArray getOperationKey(char op, const OctahedronPolygon& mpoly) const;
+	//! Replace this polygon by the result stored in the memo for the given key.
+	//! @return false if the key is not in the memo.
+	bool lookupMemo(const QByteArray& key);
+	//! Store a copy of this polygon in the memo for the given key.
+	void insertInMemo(const QByteArray& key) const;
+
 	QVector<SubContour> tesselateOneSideLineLoop(struct GLUEStesselator* tess, int sidenb) const;
 	QVector<Vec3d> tesselateOneSideTriangles(struct GLUEStesselator* tess, int sidenb) const;
 	QVarLengthArray<QVector<SubContour>,8 > sides;
@@ -146,6 +167,12 @@ private:
 	void computeBoundingCap();
 	Vec3d capN;
 	double capD;
+	//! Hash of the content of the sides, or empty for a default constructed polygon.
+	//! It is computed with the content so that the const operations only read it, possibly from several threads.
+	QByteArray contentHash;
+	//! Number of boolean operations this polygon was an operand of since its content last changed.
+	//! It is atomic because the const intersects() and contains() also count their operations.
+	mutable QAtomicInt nbOperations;
 
 	static const Vec3d sideDirections[];
 	static int getSideNumber(const Vec3d& v) {return v[0]>=0. ?  (v[1]>=0. ? (v[2]>=0.?0:1) : (v[2]>=0.?4:5))   :   (v[1]>=0. ? (v[2]>=0.?2:3) : (v[2]>=0.?6:7));}
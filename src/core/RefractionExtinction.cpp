@@ -121,14 +121,12 @@ const double Refraction::MIN_GEO_ALTITUDE_RAD=Refraction::MIN_GEO_ALTITUDE_DEG*M
 const double Refraction::MIN_GEO_ALTITUDE_SIN=std::sin(Refraction::MIN_GEO_ALTITUDE_RAD);
 const double Refraction::MIN_APP_ALTITUDE_RAD=Refraction::MIN_APP_ALTITUDE_DEG*M_PI/180.0;
 const double Refraction::MIN_APP_ALTITUDE_SIN=std::sin(Refraction::MIN_APP_ALTITUDE_RAD);
-const float Refraction::MIN_GEO_ALTITUDE_DEG_F=(float)Refraction::MIN_GEO_ALTITUDE_DEG;
-const float Refraction::MIN_GEO_ALTITUDE_RAD_F=(float)Refraction::MIN_GEO_ALTITUDE_RAD;
-const float Refraction::MIN_GEO_ALTITUDE_SIN_F=(float)Refraction::MIN_GEO_ALTITUDE_SIN;
-const float Refraction::MIN_APP_ALTITUDE_DEG_F=(float)Refraction::MIN_APP_ALTITUDE_DEG;
-const float Refraction::MIN_APP_ALTITUDE_RAD_F=(float)Refraction::MIN_APP_ALTITUDE_RAD;
-const float Refraction::MIN_APP_ALTITUDE_SIN_F=(float)Refraction::MIN_APP_ALTITUDE_SIN;
-const double Refraction::TRANSITION_WIDTH_GEO_DEG_F=(float)Refraction::TRANSITION_WIDTH_GEO_DEG;
-const double Refraction::TRANSITION_WIDTH_APP_DEG_F=(float)Refraction::TRANSITION_WIDTH_APP_DEG;
+const double Refraction::BENNETT_MIN_APP_ALTITUDE_DEG=0.22879;
+
+// Number of intervals of the refraction tables per unit of sine of the altitude, i.e. about 0.014 degree near the horizon
+static const int TABLE_DENSITY = 4096;
+// Offset in degree to evaluate the formulas just inside of a table segment at its ends
+static const double TABLE_BREAK_EPSILON_DEG = 1e-9;
 
 Refraction::Refraction() : //pressure(1013.f), temperature(10.f),
 	preTransfoMat(Mat4d::identity()), invertPreTransfoMat(Mat4d::identity()), preTransfoMatf(Mat4f::identity()), invertPreTransfoMatf(Mat4f::identity()),
@@ -166,54 +164,75 @@ void Refraction::updatePrecomputed()
 {
 	press_temp_corr_Bennett=pressure/1010.f * 283.f/(273.f+temperature) / 60.f;
 	press_temp_corr_Saemundson=1.02f*press_temp_corr_Bennett;
+
+	const double forwardBreaks[] = {MIN_GEO_ALTITUDE_DEG-TRANSITION_WIDTH_GEO_DEG, MIN_GEO_ALTITUDE_DEG, 90.};
+	buildTable(forwardTable, forwardBreaks, 2, true);
+	const double backwardBreaks[] = {MIN_APP_ALTITUDE_DEG-TRANSITION_WIDTH_APP_DEG, MIN_APP_ALTITUDE_DEG, BENNETT_MIN_APP_ALTITUDE_DEG, 90.};
+	buildTable(backwardTable, backwardBreaks, 3, false);
 }
 
-void Refraction::forward(Vec3d& altAzPos) const
+void Refraction::buildTable(Table& table, const double* breakAltitudes, int nbSegments, bool isForward) const
 {
-	altAzPos.transfo4d(preTransfoMat);
-	const double length = altAzPos.length();
+	Q_ASSERT(nbSegments<=MAX_TABLE_SEGMENTS);
+	table.nbSegments = nbSegments;
+	table.values.clear();
+	table.breaks[0] = std::sin(breakAltitudes[0]*M_PI/180.);
+	for (int k=0;k<nbSegments;++k)
+	{
+		const double a = table.breaks[k];
+		const double b = std::sin(breakAltitudes[k+1]*M_PI/180.);
+		const int n = qMax(2, (int)std::ceil((b-a)*TABLE_DENSITY));
+		table.breaks[k+1] = b;
+		table.offsets[k] = table.values.size();
+		table.sizes[k] = n;
+		table.scales[k] = n/(b-a);
+		for (int j=0;j<=n;++j)
+		{
+			double alt_deg = 180./M_PI*std::asin(qMin(1., a+(b-a)*j/n));
+			if (j==0)
+				alt_deg += TABLE_BREAK_EPSILON_DEG;
+			else if (j==n)
+				alt_deg -= TABLE_BREAK_EPSILON_DEG;
+			const double refracted_alt_deg = isForward ? forwardAltitude(alt_deg) : backwardAltitude(alt_deg);
+			table.values.append(std::sin(refracted_alt_deg*M_PI/180.));
+		}
+	}
+}
 
-	double geom_alt_deg=180./M_PI*std::asin(altAzPos[2]/length);
+double Refraction::forwardAltitude(double geom_alt_deg) const
+{
 	if (geom_alt_deg > Refraction::MIN_GEO_ALTITUDE_DEG)
 	{
 		// refraction from Saemundsson, S&T1986 p70 / in Meeus, Astr.Alg.
 		float r=press_temp_corr_Saemundson / std::tan((geom_alt_deg+10.3f/(geom_alt_deg+5.11f))*M_PI/180.f) + 0.0019279f;
 		geom_alt_deg += r;
 		if (geom_alt_deg > 90.) geom_alt_deg=90.; // SAFETY
-		altAzPos[2]=std::sin(geom_alt_deg*M_PI/180.)*length;
 	}
 	else if(geom_alt_deg>Refraction::MIN_GEO_ALTITUDE_DEG-Refraction::TRANSITION_WIDTH_GEO_DEG)
 	{
 		// Avoids the jump near -5 by interpolating linearly between MIN_GEO_ALTITUDE_DEG and bottom of transition zone
 		float r_min=press_temp_corr_Saemundson / std::tan((Refraction::MIN_GEO_ALTITUDE_DEG+10.3f/(Refraction::MIN_GEO_ALTITUDE_DEG+5.11f))*M_PI/180.f) + 0.0019279f;
 		geom_alt_deg += r_min*(geom_alt_deg-(Refraction::MIN_GEO_ALTITUDE_DEG-Refraction::TRANSITION_WIDTH_GEO_DEG))/Refraction::TRANSITION_WIDTH_GEO_DEG;
-		altAzPos[2]=std::sin(geom_alt_deg*M_PI/180.)*length;
 	}
-	altAzPos.transfo4d(postTransfoMat);
+	return geom_alt_deg;
 }
 
 //Bennett's formula is not a strict inverse of Saemundsson's. There is a notable discrepancy (alt!=backward(forward(alt))) for
 // geometric altitudes <-.3deg.  This is not a problem in real life, but if a user switches off landscape, click-identify may pose a problem.
 // Below this altitude, we therefore use a polynomial fit that should represent a close inverse of Saemundsson.
-void Refraction::backward(Vec3d& altAzPos) const
+double Refraction::backwardAltitude(double obs_alt_deg) const
 {
-	altAzPos.transfo4d(invertPostTransfoMat);
-	// going from apparent (observed) position to geometrical position.
-	const double length = altAzPos.length();
-	double obs_alt_deg=180./M_PI*std::asin(altAzPos[2]/length);
-	if (obs_alt_deg > 0.22879)
+	if (obs_alt_deg > Refraction::BENNETT_MIN_APP_ALTITUDE_DEG)
 	{
 		// refraction directly from Bennett, in Meeus, Astr.Alg.
 		float r=press_temp_corr_Bennett / std::tan((obs_alt_deg+7.31/(obs_alt_deg+4.4f))*M_PI/180.f) + 0.0013515f;
 		obs_alt_deg -= r;
-		altAzPos[2]=std::sin(obs_alt_deg*M_PI/180.)*length;
 	}
 	else if (obs_alt_deg > Refraction::MIN_APP_ALTITUDE_DEG)
 	{
 		// backward refraction from polynomial fit against Saemundson[-5...-0.3]
 		float r=(((((0.0444*obs_alt_deg+.7662)*obs_alt_deg+4.9746)*obs_alt_deg+13.599)*obs_alt_deg+8.052)*obs_alt_deg-11.308)*obs_alt_deg+34.341;
 		obs_alt_deg -= press_temp_corr_Bennett*r;
-		altAzPos[2]=std::sin(obs_alt_deg*M_PI/180.)*length;
 	}
 	else if (obs_alt_deg > Refraction::MIN_APP_ALTITUDE_DEG-Refraction::TRANSITION_WIDTH_APP_DEG)
 	{
@@ -223,8 +242,24 @@ void Refraction::backward(Vec3d& altAzPos) const
 			      +8.052)*Refraction::MIN_APP_ALTITUDE_DEG-11.308)*Refraction::MIN_APP_ALTITUDE_DEG+34.341;
 		r_min*=press_temp_corr_Bennett;
 		obs_alt_deg -= r_min*(obs_alt_deg-(Refraction::MIN_APP_ALTITUDE_DEG-Refraction::TRANSITION_WIDTH_APP_DEG))/Refraction::TRANSITION_WIDTH_APP_DEG;
-		altAzPos[2]=std::sin(obs_alt_deg*M_PI/180.)*length;
 	}
+	return obs_alt_deg;
+}
+
+void Refraction::forward(Vec3d& altAzPos) const
+{
+	altAzPos.transfo4d(preTransfoMat);
+	const double length = altAzPos.length();
+	altAzPos[2] = forwardTable.lookup(altAzPos[2]/length)*length;
+	altAzPos.transfo4d(postTransfoMat);
+}
+
+void Refraction::backward(Vec3d& altAzPos) const
+{
+	altAzPos.transfo4d(invertPostTransfoMat);
+	// going from apparent (observed) position to geometrical position.
+	const double length = altAzPos.length();
+	altAzPos[2] = backwardTable.lookup(altAzPos[2]/length)*length;
 	altAzPos.transfo4d(invertPreTransfoMat);
 }
 
@@ -232,59 +267,42 @@ void Refraction::forward(Vec3f& altAzPos) const
 {
 	altAzPos.transfo4d(preTransfoMatf);
 	const float length = altAzPos.length();
-	float geom_alt_deg=180.f/M_PI*std::asin(altAzPos[2]/length);
-	if (geom_alt_deg > Refraction::MIN_GEO_ALTITUDE_DEG_F)
-	{
-		// refraction from Saemundsson, S&T1986 p70 / in Meeus, Astr.Alg.
-		float r=press_temp_corr_Saemundson / std::tan((geom_alt_deg+10.3f/(geom_alt_deg+5.11f))*M_PI/180.f) + 0.0019279f;
-		geom_alt_deg += r;
-		if (geom_alt_deg > 90.f) geom_alt_deg=90.f; // SAFETY
-		altAzPos[2]=std::sin(geom_alt_deg*M_PI/180.f)*length;
-	}
-	else if(geom_alt_deg>Refraction::MIN_GEO_ALTITUDE_DEG_F-Refraction::TRANSITION_WIDTH_GEO_DEG_F)
-	{
-		// Avoids the jump below -5 by interpolating linearly between MIN_GEO_ALTITUDE_DEG_F and bottom of transition zone
-		float r_m5=press_temp_corr_Saemundson / std::tan((Refraction::MIN_GEO_ALTITUDE_DEG_F+10.3f/(Refraction::MIN_GEO_ALTITUDE_DEG_F+5.11f))*M_PI/180.f) + 0.0019279f;
-		geom_alt_deg += r_m5*(geom_alt_deg-(Refraction::MIN_GEO_ALTITUDE_DEG_F-Refraction::TRANSITION_WIDTH_GEO_DEG_F))/Refraction::TRANSITION_WIDTH_GEO_DEG_F;
-		altAzPos[2]=std::sin(geom_alt_deg*M_PI/180.)*length;
-	}
+	altAzPos[2] = (float)forwardTable.lookup(altAzPos[2]/length)*length;
 	altAzPos.transfo4d(postTransfoMatf);
 }
 
 void Refraction::backward(Vec3f& altAzPos) const
 {
 	altAzPos.transfo4d(invertPostTransfoMatf);
-	// going from observed position/magnitude to geometrical position and atmosphere-free mag.
 	const float length = altAzPos.length();
-	float obs_alt_deg=180.f/M_PI*std::asin(altAzPos[2]/length);
-	if (obs_alt_deg > 0.22879f)
-	{
-		// refraction from Bennett, in Meeus, Astr.Alg.
-		float r=press_temp_corr_Bennett / std::tan((obs_alt_deg+7.31f/(obs_alt_deg+4.4f))*M_PI/180.f) + 0.0013515f;
-		obs_alt_deg -= r;
-		altAzPos[2]=std::sin(obs_alt_deg*M_PI/180.f)*length;
-	}
-	else if (obs_alt_deg > Refraction::MIN_APP_ALTITUDE_DEG_F)
-	{
-		// backward refraction from polynomial fit against Saemundson[-5...-0.3]
-		float r=(((((0.0444f*obs_alt_deg+.7662f)*obs_alt_deg+4.9746f)*obs_alt_deg+13.599f)*obs_alt_deg+8.052f)*obs_alt_deg-11.308f)*obs_alt_deg+34.341f;
-		obs_alt_deg -= press_temp_corr_Bennett*r;
-		altAzPos[2]=std::sin(obs_alt_deg*M_PI/180.f)*length;
-	}
-	else if (obs_alt_deg > Refraction::MIN_APP_ALTITUDE_DEG_F-Refraction::TRANSITION_WIDTH_APP_DEG_F)
-	{
-		// Compute top value from polynome, apply linear interpolation
-		float r_min=(((((0.0444f*Refraction::MIN_APP_ALTITUDE_DEG_F+.7662f)*Refraction::MIN_APP_ALTITUDE_DEG_F
-				+4.9746f)*Refraction::MIN_APP_ALTITUDE_DEG_F+13.599f)*Refraction::MIN_APP_ALTITUDE_DEG_F
-			      +8.052f)*Refraction::MIN_APP_ALTITUDE_DEG_F-11.308f)*Refraction::MIN_APP_ALTITUDE_DEG_F+34.341f;
-
-		r_min*=press_temp_corr_Bennett;
-		obs_alt_deg -= r_min*(obs_alt_deg-(Refraction::MIN_APP_ALTITUDE_DEG_F-Refraction::TRANSITION_WIDTH_APP_DEG_F))/Refraction::TRANSITION_WIDTH_APP_DEG_F;
-		altAzPos[2]=std::sin(obs_alt_deg*M_PI/180.f)*length;
-	}
+	altAzPos[2] = (float)backwardTable.lookup(altAzPos[2]/length)*length;
 	altAzPos.transfo4d(invertPreTransfoMatf);
 }
 
+void Refraction::forward(Vec3d* altAzPos, int num) const
+{
+	for (int i=0;i<num;++i)
+		forward(altAzPos[i]);
+}
+
+void Refraction::backward(Vec3d* altAzPos, int num) const
+{
+	for (int i=0;i<num;++i)
+		backward(altAzPos[i]);
+}
+
+void Refraction::forward(Vec3f* altAzPos, int num) const
+{
+	for (int i=0;i<num;++i)
+		forward(altAzPos[i]);
+}
+
+void Refraction::backward(Vec3f* altAzPos, int num) const
+{
+	for (int i=0;i<num;++i)
+		backward(altAzPos[i]);
+}
+
 void Refraction::setPressure(float p)
 {
 	pressure=p;
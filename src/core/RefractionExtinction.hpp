@@ -30,6 +30,7 @@
 
 #include "VecMath.hpp"
 #include "StelProjector.hpp"
+#include <QVector>
 
 //! @class Extinction
 //! This class performs extinction computations, following literature from atmospheric optics and astronomy.
@@ -96,6 +97,9 @@ private:
 //! (1) only if atmosphere effects are true
 //! (2) only for celestial objects, never for landscape images
 //! (3) only for terrestrial locations, not on Moon/Mars/Saturn etc
+//! The refraction formulas are tabulated when the pressure or temperature change, as the sine of the
+//! refracted altitude against the sine of the altitude, so that forward/backward only need one
+//! interpolation and no trigonometric function. The maximum deviation from the formulas is about 0.05 arcsec.
 
 class Refraction: public StelProjector::ModelViewTranform
 {
@@ -122,6 +126,17 @@ public:
 	//! Note that forward/backward are no absolute reverse operations!
 	void backward(Vec3f& altAzPos) const;
 
+	//! Apply or remove refraction for arrays of num position vectors.
+	void forward(Vec3d* altAzPos, int num) const;
+	void backward(Vec3d* altAzPos, int num) const;
+	void forward(Vec3f* altAzPos, int num) const;
+	void backward(Vec3f* altAzPos, int num) const;
+
+	//! Compute the apparent altitude from the geometrical altitude in degree with the refraction formulas, without using the table.
+	double forwardAltitude(double geom_alt_deg) const;
+	//! Compute the geometrical altitude from the apparent altitude in degree with the refraction formulas, without using the table.
+	double backwardAltitude(double obs_alt_deg) const;
+
 	void combine(const Mat4d& m)
 	{
 		setPreTransfoMat(preTransfoMat*m);
@@ -129,7 +144,7 @@ public:
 
 	Mat4d getApproximateLinearTransfo() const {return postTransfoMat*preTransfoMat;}
 
-	StelProjector::ModelViewTranformP clone() const {Refraction* refr = new Refraction(); *refr=*this; return StelProjector::ModelViewTranformP(refr);}
+	StelProjector::ModelViewTranformP clone() const {return StelProjector::ModelViewTranformP(new Refraction(*this));}
 
 	//! Set surface air pressure (mbars), influences refraction computation.
 	void setPressure(float p_mbar);
@@ -144,8 +159,48 @@ public:
 	void setPostTransfoMat(const Mat4d& m);
 
 private:
+	//! Maximum number of segments of a table
+	static const int MAX_TABLE_SEGMENTS = 3;
+
+	//! @struct Table
+	//! The sine of the refracted altitude tabulated against the sine of the altitude, with a linear interpolation.
+	//! The table is made of segments with a uniform sampling, ending where the formulas have a discontinuity
+	//! or a discontinuous derivative so that the interpolation is exact there. Below the first segment there
+	//! is no refraction. The values are implicitly shared between the copies of the Refraction.
+	struct Table
+	{
+		//! Return the sine of the refracted altitude for the sine of the altitude s.
+		double lookup(double s) const
+		{
+			if (s<=breaks[0])
+				return s;
+			int k = 0;
+			while (k<nbSegments-1 && s>breaks[k+1])
+				++k;
+			const double u = (s-breaks[k])*scales[k];
+			int i = (int)u;
+			if (i>=sizes[k])
+				i = sizes[k]-1;
+			const double* v = values.constData()+offsets[k]+i;
+			return v[0]+(u-i)*(v[1]-v[0]);
+		}
+
+		int nbSegments;
+		//! Sines of the altitudes at the ends of the segments
+		double breaks[MAX_TABLE_SEGMENTS+1];
+		//! Index in values of the first sample of each segment
+		int offsets[MAX_TABLE_SEGMENTS];
+		//! Number of intervals of each segment
+		int sizes[MAX_TABLE_SEGMENTS];
+		//! Number of intervals per unit of sine in each segment
+		double scales[MAX_TABLE_SEGMENTS];
+		QVector<double> values;
+	};
+
 	//! Update precomputed variables.
 	void updatePrecomputed();
+	//! Fill a table from the formulas, between the altitudes in degree of breakAltitudes.
+	void buildTable(Table& table, const double* breakAltitudes, int nbSegments, bool isForward) const;
 
 	//! These 3 Atmosphere parameters can be controlled by GUI.
 	//! Pressure[mbar] (1013)
@@ -156,6 +211,9 @@ private:
 	float press_temp_corr_Saemundson;
 	//! Numerator of refraction formula, to be cached for speed.
 	float press_temp_corr_Bennett;
+	//! The tabulated formulas for the current pressure and temperature.
+	Table forwardTable;
+	Table backwardTable;
 
 	//! These constants are usable for experiments with the limits of refraction effects.
 	static const double MIN_GEO_ALTITUDE_DEG;
@@ -164,16 +222,10 @@ private:
 	static const double MIN_APP_ALTITUDE_DEG;
 	static const double MIN_APP_ALTITUDE_RAD;
 	static const double MIN_APP_ALTITUDE_SIN;
-	static const float MIN_GEO_ALTITUDE_DEG_F;
-	static const float MIN_GEO_ALTITUDE_RAD_F;
-	static const float MIN_GEO_ALTITUDE_SIN_F;
-	static const float MIN_APP_ALTITUDE_DEG_F;
-	static const float MIN_APP_ALTITUDE_RAD_F;
-	static const float MIN_APP_ALTITUDE_SIN_F;
 	static const double TRANSITION_WIDTH_GEO_DEG;
-	static const double TRANSITION_WIDTH_GEO_DEG_F;
 	static const double TRANSITION_WIDTH_APP_DEG;
-	static const double TRANSITION_WIDTH_APP_DEG_F;
+	//! Apparent altitude above which the Bennett formula is used for backward refraction
+	static const double BENNETT_MIN_APP_ALTITUDE_DEG;
 
 	//! Used to pretransform coordinates into AltAz frame.
 	Mat4d preTransfoMat;
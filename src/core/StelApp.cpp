@@ -47,6 +47,7 @@
 #include "StelGuiBase.hpp"
 #include "StelPainter.hpp"
 #include "StelMovementMgr.hpp"
+#include "StelProfiler.hpp"
 
 #include "blackberry/SensorMgr.h"
 
@@ -64,6 +65,7 @@
 #include <QMessageBox>
 #include <QNetworkDiskCache>
 #include <QNetworkReply>
+#include <QElapsedTimer>
 #include <cstdlib>
 
 // Initialize static variables
@@ -86,7 +88,7 @@ void StelApp::deinitStatic()
  Create and initialize the main Stellarium application.
 *************************************************************************/
 StelApp::StelApp(QObject* parent)
-	: QObject(parent), core(NULL), stelGui(NULL), fps(0),
+	: QObject(parent), core(NULL), stelGui(NULL), profiler(NULL), fps(0),
 	  frame(0), timefr(0.), timeBase(0.), flagNightVision(false),
 	  confSettings(NULL), initialized(false), saveProjW(-1), saveProjH(-1), drawState(0)
 {
@@ -110,6 +112,7 @@ StelApp::StelApp(QObject* parent)
 	singleton = this;
 
 	moduleMgr = new StelModuleMgr();
+	profiler = new StelProfiler();
 }
 
 /*************************************************************************
@@ -117,6 +120,9 @@ StelApp::StelApp(QObject* parent)
 *************************************************************************/
 StelApp::~StelApp()
 {
+	if (!profileFileName.isEmpty())
+		profiler->writeCSV(profileFileName);
+
 	qDebug() << qPrintable(QString("Downloaded %1 files (%2 kbytes) in a session of %3 sec (average of %4 kB/s + %5 files from cache (%6 kB)).").arg(nbDownloadedFiles).arg(totalDownloadedSize/1024).arg(getTotalRunTime()).arg((double)(totalDownloadedSize/1024)/getTotalRunTime()).arg(nbUsedCache).arg(totalUsedCacheSize/1024));
 
 	stelObjectMgr->unSelect();
@@ -134,6 +140,7 @@ StelApp::~StelApp()
 	delete textureMgr; textureMgr=NULL;
 	delete planetLocationMgr; planetLocationMgr=NULL;
 	delete moduleMgr; moduleMgr=NULL; // Delete the secondary instance
+	delete profiler; profiler=NULL;
 
 	Q_ASSERT(singleton);
 	singleton = NULL;
@@ -206,10 +213,30 @@ void StelApp::setupHttpProxy()
 	}
 }
 
+void StelApp::initModule(StelModule* m)
+{
+	moduleMgr->waitForPreload(m);
+	QElapsedTimer timer;
+	timer.start();
+	m->init();
+	const qint64 initDuration = timer.elapsed();
+	const qint64 preloadDuration = moduleMgr->getPreloadDuration(m);
+	if (preloadDuration>=0)
+		qDebug() << qPrintable(QString("Startup: %1 initialized in %2 ms (+ %3 ms of data loading in a worker thread)").arg(m->objectName()).arg(initDuration).arg(preloadDuration));
+	else
+		qDebug() << qPrintable(QString("Startup: %1 initialized in %2 ms").arg(m->objectName()).arg(initDuration));
+}
+
 void StelApp::init(QSettings* conf)
 {
+	QElapsedTimer startupTimer;
+	startupTimer.start();
 	confSettings = conf;
 
+	if (qApp->property("onetime_profile_file").isValid())
+		profileFileName = qApp->property("onetime_profile_file").toString();
+	profiler->setFlagShowOverlay(confSettings->value("main/flag_show_profiler", false).toBool());
+
 	core = new StelCore();
 	if (saveProjW!=-1 && saveProjH!=-1)
 		core->windowHasBeenResized(0, 0, saveProjW, saveProjH);
@@ -254,9 +281,15 @@ void StelApp::init(QSettings* conf)
 
 	// Stel Object Data Base manager
 	stelObjectMgr = new StelObjectMgr();
-	stelObjectMgr->init();
+	initModule(stelObjectMgr);
 	getModuleMgr().registerModule(stelObjectMgr);
 
+	// The star and nebula catalogues are parsed in worker threads while the main thread
+	// carries on with the initializations requiring openGL or the other modules
+	StarMgr* hip_stars = new StarMgr();
+	NebulaMgr* nebulas = new NebulaMgr();
+	moduleMgr->startPreload(QList<StelModule*>() << hip_stars << nebulas);
+
 	localeMgr = new StelLocaleMgr();
 	skyCultureMgr = new StelSkyCultureMgr();
 	planetLocationMgr = new StelLocationMgr();
@@ -265,29 +298,27 @@ void StelApp::init(QSettings* conf)
 
 	// Init the solar system first
 	SolarSystem* ssystem = new SolarSystem();
-	ssystem->init();
+	initModule(ssystem);
 	getModuleMgr().registerModule(ssystem);
 
 	// Load hipparcos stars & names
-	StarMgr* hip_stars = new StarMgr();
-	hip_stars->init();
+	initModule(hip_stars);
 	getModuleMgr().registerModule(hip_stars);
 
 	core->init();
 
 	// Init nebulas
-	NebulaMgr* nebulas = new NebulaMgr();
-	nebulas->init();
+	initModule(nebulas);
 	getModuleMgr().registerModule(nebulas);
 
 	// Init milky way
 	MilkyWay* milky_way = new MilkyWay();
-	milky_way->init();
+	initModule(milky_way);
 	getModuleMgr().registerModule(milky_way);
 
 	// Init sky image manager
 	skyImageMgr = new StelSkyLayerMgr();
-	skyImageMgr->init();
+	initModule(skyImageMgr);
 	getModuleMgr().registerModule(skyImageMgr);
 
 	// Init audio manager
@@ -295,32 +326,35 @@ void StelApp::init(QSettings* conf)
 
 	// Constellations
 	ConstellationMgr* asterisms = new ConstellationMgr(hip_stars);
-	asterisms->init();
+	initModule(asterisms);
 	getModuleMgr().registerModule(asterisms);
 
 	// Landscape, atmosphere & cardinal points section
 	LandscapeMgr* landscape = new LandscapeMgr();
-	landscape->init();
+	initModule(landscape);
 	getModuleMgr().registerModule(landscape);
 
 	GridLinesMgr* gridLines = new GridLinesMgr();
-	gridLines->init();
+	initModule(gridLines);
 	getModuleMgr().registerModule(gridLines);
 
 	// Meteors
 	MeteorMgr* meteors = new MeteorMgr(10, 60);
-	meteors->init();
+	initModule(meteors);
 	getModuleMgr().registerModule(meteors);
 
 	// User labels
 	LabelMgr* skyLabels = new LabelMgr();
-	skyLabels->init();
+	initModule(skyLabels);
 	getModuleMgr().registerModule(skyLabels);
 
+	QElapsedTimer skyCultureTimer;
+	skyCultureTimer.start();
 	skyCultureMgr->init();
+	qDebug() << qPrintable(QString("Startup: sky culture loaded in %1 ms").arg(skyCultureTimer.elapsed()));
 
 	SensorMgr* sensor = new SensorMgr();
-	sensor->init();
+	initModule(sensor);
 	getModuleMgr().registerModule(sensor);
 
 	// Initialisation of the color scheme
@@ -333,6 +367,7 @@ void StelApp::init(QSettings* conf)
 	updateI18n();
 
 	initialized = true;
+	qDebug() << qPrintable(QString("Startup: StelApp initialized in %1 ms").arg(startupTimer.elapsed()));
 }
 
 // Load and initialize external modules (plugins)
@@ -340,16 +375,21 @@ void StelApp::initPlugIns()
 {
 	// Load dynamically all the modules found in the modules/ directories
 	// which are configured to be loaded at startup
+	QList<StelModule*> plugins;
 	foreach (StelModuleMgr::PluginDescriptor i, moduleMgr->getPluginsList())
 	{
 		if (i.loadAtStartup==false)
 			continue;
 		StelModule* m = moduleMgr->loadPlugin(i.info.id);
 		if (m!=NULL)
-		{
-			moduleMgr->registerModule(m, true);
-			m->init();
-		}
+			plugins << m;
+	}
+	// Plugins data are loaded in worker threads while the previous plugins are initialized
+	moduleMgr->startPreload(plugins);
+	foreach (StelModule* m, plugins)
+	{
+		moduleMgr->registerModule(m, true);
+		initModule(m);
 	}
 }
 
@@ -368,14 +408,18 @@ void StelApp::update(double deltaTime)
 		timeBase+=1.;
 	}
 
+	profiler->beginSection(StelProfiler::PhaseUpdate, core);
 	core->update(deltaTime);
+	profiler->endSection();
 
 	moduleMgr->update();
 
 	// Send the event to every StelModule
 	foreach (StelModule* i, moduleMgr->getCallOrders(StelModule::ActionUpdate))
 	{
+		profiler->beginSection(StelProfiler::PhaseUpdate, i);
 		i->update(deltaTime);
+		profiler->endSection();
 	}
 
 	stelObjectMgr->update(deltaTime);
@@ -388,7 +432,9 @@ bool StelApp::drawPartial()
 	{
 		if (!initialized)
 			return false;
+		profiler->beginSection(StelProfiler::PhaseDraw, core);
 		core->preDraw();
+		profiler->endSection();
 		drawState = 1;
 		return true;
 	}
@@ -397,12 +443,23 @@ bool StelApp::drawPartial()
 	int index = drawState - 1;
 	if (index < modules.size())
 	{
-		if (modules[index]->drawPartial(core))
+		profiler->beginSection(StelProfiler::PhaseDraw, modules[index]);
+		const bool again = modules[index]->drawPartial(core);
+		profiler->endSection();
+		if (again)
 			return true;
 		drawState++;
 		return true;
 	}
+	profiler->beginSection(StelProfiler::PhaseDraw, core);
 	core->postDraw();
+	profiler->endSection();
+	if (profiler->getFlagShowOverlay())
+	{
+		StelPainter sPainter(core->getProjection2d());
+		profiler->drawOverlay(sPainter);
+	}
+	profiler->endFrame();
 	drawState = 0;
 	return false;
 }
@@ -516,6 +573,15 @@ double StelApp::getTotalRunTime()
 	return (double)(StelApp::qtime->elapsed())/1000.;
 }
 
+void StelApp::setFlagShowProfiler(bool b)
+{
+	profiler->setFlagShowOverlay(b);
+}
+
+bool StelApp::getFlagShowProfiler() const
+{
+	return profiler->getFlagShowOverlay();
+}
 
 void StelApp::reportFileDownloadFinished(QNetworkReply* reply)
 {
@@ -39,6 +39,7 @@ class StelLocationMgr;
 class StelSkyLayerMgr;
 class StelAudioMgr;
 class StelGuiBase;
+class StelProfiler;
 
 //! @class StelApp
 //! Singleton main Stellarium application class.
@@ -109,6 +110,9 @@ public:
 	//! Get the audio manager
 	StelAudioMgr* getStelAudioMgr() {return audioMgr;}
 
+	//! Get the profiler measuring the time spent in each module at each frame.
+	StelProfiler& getProfiler() {return *profiler;}
+
 	//! Get the core of the program.
 	//! It is the one which provide the projection, navigation and tone converter.
 	//! @return the StelCore instance of the program
@@ -173,6 +177,11 @@ public slots:
 	//! Return the time since when stellarium is running in second.
 	static double getTotalRunTime();
 
+	//! Set flag for displaying the time spent in each module on top of the sky.
+	void setFlagShowProfiler(bool b);
+	//! Get flag for displaying the time spent in each module on top of the sky.
+	bool getFlagShowProfiler() const;
+
 	//! Report that a download occured. This is used for statistics purposes.
 	//! Connect this slot to QNetworkAccessManager::finished() slot to obtain statistics at the end of the program.
 	void reportFileDownloadFinished(QNetworkReply* reply);
@@ -224,6 +233,9 @@ private:
 	//! Get proxy settings from config file... if not set use http_proxy env var
 	void setupHttpProxy();
 
+	//! Wait for the end of the module preload, initialize it in the main thread and log the time spent.
+	void initModule(class StelModule* m);
+
 	// The audio manager.  Must execute in the main thread.
 	StelAudioMgr* audioMgr;
 
@@ -231,6 +243,11 @@ private:
 
 	StelGuiBase* stelGui;
 
+	// Measure the time spent in each module
+	StelProfiler* profiler;
+	// The file in which the profiling results are written on exit, empty if not requested
+	QString profileFileName;
+
 	float fps;
 	int frame;
 	double timefr, timeBase;		// Used for fps counter
@@ -32,7 +32,7 @@
 #include <QSettings>
 
 StelAppGraphicsWidget::StelAppGraphicsWidget()
-	: paintState(0), useBuffers(false), backgroundBuffer(NULL), foregroundBuffer(NULL), viewportEffect(NULL), doPaint(true)
+	: paintState(0), currentFrameDuration(0.), lastFrameDuration(0.), nbFramesPainted(0), useBuffers(false), backgroundBuffer(NULL), foregroundBuffer(NULL), viewportEffect(NULL), doPaint(true)
 {
 	previousPaintTime = StelApp::getTotalRunTime();
 	setFocusPolicy(Qt::StrongFocus);
@@ -162,7 +162,8 @@ void StelAppGraphicsWidget::paint(QPainter* painter, const QStyleOptionGraphicsI
 	// Don't even try to draw if we don't have a core yet (fix a bug during splash screen)
 	if (!stelApp || !stelApp->getCore() || !doPaint)
 		return;
-	
+
+	const double paintStartTime = StelApp::getTotalRunTime();
 	StelPainter::setQPainter(painter);
 
 	if (useBuffers)
@@ -206,6 +207,15 @@ void StelAppGraphicsWidget::paint(QPainter* painter, const QStyleOptionGraphicsI
 	}
 	StelPainter::setQPainter(NULL);
 	previousPaintFrameTime = StelApp::getTotalRunTime();
+
+	currentFrameDuration += previousPaintFrameTime-paintStartTime;
+	if (paintState==0)
+	{
+		// The frame is complete
+		lastFrameDuration = currentFrameDuration;
+		currentFrameDuration = 0.;
+		++nbFramesPainted;
+	}
 }
 
 //! Swap the buffers
@@ -51,6 +51,12 @@ public:
 
 	//! Set whether widget repaint are necessary.
 	void setDoPaint(bool b) {doPaint=b;}
+
+	//! Get the time spent rendering the last complete frame in second.
+	//! When a frame is split over several paint() calls, the time of all the calls is summed.
+	double getLastFrameDuration() const {return lastFrameDuration;}
+	//! Get the number of complete frames rendered so far.
+	int getNbFramesPainted() const {return nbFramesPainted;}
 	
 protected:
 	virtual void keyPressEvent(QKeyEvent* event);
@@ -75,6 +81,11 @@ private:
 	//! The state of paintPartial method
 	int paintState;
 
+	//! Rendering time of the frame currently being painted
+	double currentFrameDuration;
+	double lastFrameDuration;
+	int nbFramesPainted;
+
 	//! set to true to use buffers
 	bool useBuffers;
 	//! The framebuffer where we are currently drawing the scene
@@ -52,7 +52,7 @@ const double StelCore::JD_HOUR  =0.041666666666666666666;
 const double StelCore::JD_DAY   =1.;
 
 
-StelCore::StelCore() : movementMgr(NULL), geodesicGrid(NULL), currentProjectionType(ProjectionStereographic), position(NULL), timeSpeed(JD_SECOND), JDay(0.), useGPS(true), lastGPSLocation(NULL)
+StelCore::StelCore() : movementMgr(NULL), geodesicGrid(NULL), currentProjectionType(ProjectionStereographic), renderingQuality(1.f), position(NULL), timeSpeed(JD_SECOND), JDay(0.), useGPS(true), lastGPSLocation(NULL)
 {
 	toneConverter = new StelToneReproducer();
 
@@ -266,6 +266,9 @@ void StelCore::preDraw()
 	currentProjectorParams.zNear = 0.000001;
 	currentProjectorParams.zFar = 50.;
 
+	// The modules updated the positions of their objects since the time step started
+	frameCounter.ref();
+
 	skyDrawer->preDraw();
 
 	// Clear areas not redrawn by main viewport (i.e. fisheye square viewport)
@@ -366,31 +369,94 @@ void StelCore::lookAtJ2000(const Vec3d& pos, const Vec3d& aup)
 }
 
 
+// Convert a double precision matrix to single precision
+static Mat4f toMat4f(const Mat4d& m)
+{
+	return Mat4f(m[0], m[1], m[2], m[3], m[4], m[5], m[6], m[7], m[8], m[9], m[10], m[11], m[12], m[13], m[14], m[15]);
+}
+
 void StelCore::updateTransformMatrices()
 {
-	matAltAzToEquinoxEqu = position->getRotAltAzToEquatorial(JDay);
-	matEquinoxEquToAltAz = matAltAzToEquinoxEqu.transpose();
+	FrameTransforms* t = &frameTransforms;
+	t->JDay = JDay;
+	t->longitude = position->getCurrentLocation().longitude;
+	t->homePlanet = position->getHomePlanet().data();
+	// The sideral time of the Earth includes a nutation series, so compute it only once
+	t->localSideralTime = position->getLocalSiderealTime(JDay);
+	t->matAltAzToEquinoxEqu = position->getRotAltAzToEquatorialFromSiderealTime(t->localSideralTime);
+	t->matEquinoxEquToAltAz = t->matAltAzToEquinoxEqu.transpose();
+
+	t->matEquinoxEquToJ2000 = matVsop87ToJ2000 * position->getRotEquatorialToVsop87();
+	t->matJ2000ToEquinoxEqu = t->matEquinoxEquToJ2000.transpose();
+	t->matJ2000ToAltAz = t->matEquinoxEquToAltAz*t->matJ2000ToEquinoxEqu;
+	t->matAltAzToJ2000 = t->matEquinoxEquToJ2000*t->matAltAzToEquinoxEqu;
+	t->matGalacticToAltAz = t->matJ2000ToAltAz*matGalacticToJ2000;
+	t->matObservercentricEclipticToAltAz = t->matJ2000ToAltAz*matVsop87ToJ2000;
+
+	const Vec3d centerVsop87Pos = position->getCenterVsop87Pos();
+	const double distanceFromCenter = position->getDistanceFromCenter();
+	t->matHeliocentricEclipticToEquinoxEqu = t->matJ2000ToEquinoxEqu * matVsop87ToJ2000 * Mat4d::translation(-centerVsop87Pos);
 
-	matEquinoxEquToJ2000 = matVsop87ToJ2000 * position->getRotEquatorialToVsop87();
-	matJ2000ToEquinoxEqu = matEquinoxEquToJ2000.transpose();
-	matJ2000ToAltAz = matEquinoxEquToAltAz*matJ2000ToEquinoxEqu;
+	// These two next have to take into account the position of the observer on the earth
+	Mat4d tmp = matJ2000ToVsop87 * t->matEquinoxEquToJ2000 * t->matAltAzToEquinoxEqu;
 
-	matHeliocentricEclipticToEquinoxEqu = matJ2000ToEquinoxEqu * matVsop87ToJ2000 * Mat4d::translation(-position->getCenterVsop87Pos());
+	t->matAltAzToHeliocentricEcliptic =  Mat4d::translation(centerVsop87Pos) * tmp *
+						  Mat4d::translation(Vec3d(0.,0., distanceFromCenter));
 
-	// These two next have to take into account the position of the observer on the earth
-	Mat4d tmp = matJ2000ToVsop87 * matEquinoxEquToJ2000 * matAltAzToEquinoxEqu;
+	t->matHeliocentricEclipticToAltAz =  Mat4d::translation(Vec3d(0.,0.,-distanceFromCenter)) * tmp.transpose() *
+						  Mat4d::translation(-centerVsop87Pos);
+	t->matHeliocentricEclipticToEarthPosEquinoxEqu = t->matAltAzToEquinoxEqu*t->matHeliocentricEclipticToAltAz;
+
+	t->matJ2000ToAltAzf = toMat4f(t->matJ2000ToAltAz);
+
+	frameCounter.ref();
+}
+
+// Apply the rotation part of m to an array of vectors
+template <class T, class M> static void rotateArray(const M& m, Vector3<T>* v, int count)
+{
+	for (int i=0;i<count;++i)
+		v[i] = m.multiplyWithoutTranslation(v[i]);
+}
 
-	matAltAzToHeliocentricEcliptic =  Mat4d::translation(position->getCenterVsop87Pos()) * tmp *
-						  Mat4d::translation(Vec3d(0.,0., position->getDistanceFromCenter()));
+void StelCore::j2000ToAltAz(Vec3d* v, int count, RefractionMode refMode) const
+{
+	rotateArray(frameTransforms.matJ2000ToAltAz, v, count);
+	if (useRefraction(refMode))
+		skyDrawer->getRefraction().forward(v, count);
+}
+
+void StelCore::j2000ToAltAz(Vec3f* v, int count, RefractionMode refMode) const
+{
+	rotateArray(frameTransforms.matJ2000ToAltAzf, v, count);
+	if (useRefraction(refMode))
+		skyDrawer->getRefraction().forward(v, count);
+}
+
+void StelCore::altAzToJ2000(Vec3d* v, int count, RefractionMode refMode) const
+{
+	if (useRefraction(refMode))
+		skyDrawer->getRefraction().backward(v, count);
+	rotateArray(frameTransforms.matAltAzToJ2000, v, count);
+}
+
+void StelCore::equinoxEquToAltAz(Vec3d* v, int count, RefractionMode refMode) const
+{
+	rotateArray(frameTransforms.matEquinoxEquToAltAz, v, count);
+	if (useRefraction(refMode))
+		skyDrawer->getRefraction().forward(v, count);
+}
 
-	matHeliocentricEclipticToAltAz =  Mat4d::translation(Vec3d(0.,0.,-position->getDistanceFromCenter())) * tmp.transpose() *
-						  Mat4d::translation(-position->getCenterVsop87Pos());
+void StelCore::j2000ToEquinoxEqu(Vec3d* v, int count) const
+{
+	rotateArray(frameTransforms.matJ2000ToEquinoxEqu, v, count);
 }
 
 // Return the observer heliocentric position
 Vec3d StelCore::getObserverHeliocentricEclipticPos() const
 {
-	return Vec3d(matAltAzToHeliocentricEcliptic[12], matAltAzToHeliocentricEcliptic[13], matAltAzToHeliocentricEcliptic[14]);
+	const Mat4d& m = frameTransforms.matAltAzToHeliocentricEcliptic;
+	return Vec3d(m[12], m[13], m[14]);
 }
 
 // Set the location to use by default at startup
@@ -554,7 +620,11 @@ void StelCore::addSiderealDays(double d)
 // Get the sideral time shifted by the observer longitude
 double StelCore::getLocalSideralTime() const
 {
-	return (position->getHomePlanet()->getSiderealTime(JDay)+position->getCurrentLocation().longitude)*M_PI/180.;
+	// The date or the observer may have been changed since the last time step
+	if (frameTransforms.JDay==JDay && frameTransforms.longitude==position->getCurrentLocation().longitude &&
+		frameTransforms.homePlanet==position->getHomePlanet().data())
+		return frameTransforms.localSideralTime;
+	return position->getLocalSiderealTime(JDay);
 }
 
 //! Get the duration of a sideral day for the current observer in day.
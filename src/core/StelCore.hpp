@@ -28,12 +28,14 @@
 #include <QString>
 #include <QStringList>
 #include <QTime>
+#include <QAtomicInt>
 
 class StelToneReproducer;
 class StelSkyDrawer;
 class StelGeodesicGrid;
 class StelMovementMgr;
 class StelObserver;
+class Planet;
 
 //! @class StelCore
 //! Main class for Stellarium core processing.
@@ -155,70 +157,77 @@ public:
 
 	Vec3d altAzToEquinoxEqu(const Vec3d& v, RefractionMode refMode=RefractionAuto) const
 	{
-		if (refMode==RefractionOff || skyDrawer==false || (refMode==RefractionAuto && skyDrawer->getFlagHasAtmosphere()==false))
-			return matAltAzToEquinoxEqu*v;
+		if (!useRefraction(refMode))
+			return frameTransforms.matAltAzToEquinoxEqu*v;
 		Vec3d r(v);
 		skyDrawer->getRefraction().backward(r);
-		r.transfo4d(matAltAzToEquinoxEqu);
+		r.transfo4d(frameTransforms.matAltAzToEquinoxEqu);
 		return r;
 	}
 	Vec3d equinoxEquToAltAz(const Vec3d& v, RefractionMode refMode=RefractionAuto) const
 	{
-		if (refMode==RefractionOff || skyDrawer==false || (refMode==RefractionAuto && skyDrawer->getFlagHasAtmosphere()==false))
-			return matEquinoxEquToAltAz*v;
+		if (!useRefraction(refMode))
+			return frameTransforms.matEquinoxEquToAltAz*v;
 		Vec3d r(v);
-		r.transfo4d(matEquinoxEquToAltAz);
+		r.transfo4d(frameTransforms.matEquinoxEquToAltAz);
 		skyDrawer->getRefraction().forward(r);
 		return r;
 	}
 	Vec3d altAzToJ2000(const Vec3d& v, RefractionMode refMode=RefractionAuto) const
 	{
-		if (refMode==RefractionOff || skyDrawer==false || (refMode==RefractionAuto && skyDrawer->getFlagHasAtmosphere()==false))
-			return matEquinoxEquToJ2000*matAltAzToEquinoxEqu*v;
+		if (!useRefraction(refMode))
+			return frameTransforms.matAltAzToJ2000*v;
 		Vec3d r(v);
 		skyDrawer->getRefraction().backward(r);
-		r.transfo4d(matEquinoxEquToJ2000*matAltAzToEquinoxEqu);
+		r.transfo4d(frameTransforms.matAltAzToJ2000);
 		return r;
 	}
 	Vec3d j2000ToAltAz(const Vec3d& v, RefractionMode refMode=RefractionAuto) const
 	{
-		if (refMode==RefractionOff || skyDrawer==false || (refMode==RefractionAuto && skyDrawer->getFlagHasAtmosphere()==false))
-			return matJ2000ToAltAz*v;
+		if (!useRefraction(refMode))
+			return frameTransforms.matJ2000ToAltAz*v;
 		Vec3d r(v);
-		r.transfo4d(matJ2000ToAltAz);
+		r.transfo4d(frameTransforms.matJ2000ToAltAz);
 		skyDrawer->getRefraction().forward(r);
 		return r;
 	}
+	//! Transform arrays of vectors in place, with the same results as the functions above applied to each vector.
+	void j2000ToAltAz(Vec3d* v, int count, RefractionMode refMode=RefractionAuto) const;
+	void j2000ToAltAz(Vec3f* v, int count, RefractionMode refMode=RefractionAuto) const;
+	void altAzToJ2000(Vec3d* v, int count, RefractionMode refMode=RefractionAuto) const;
+	void equinoxEquToAltAz(Vec3d* v, int count, RefractionMode refMode=RefractionAuto) const;
+	void j2000ToEquinoxEqu(Vec3d* v, int count) const;
+
 	Vec3d galacticToJ2000(const Vec3d& v) const {return matGalacticToJ2000*v;}
-	Vec3d equinoxEquToJ2000(const Vec3d& v) const {return matEquinoxEquToJ2000*v;}
-	Vec3d j2000ToEquinoxEqu(const Vec3d& v) const {return matJ2000ToEquinoxEqu*v;}
+	Vec3d equinoxEquToJ2000(const Vec3d& v) const {return frameTransforms.matEquinoxEquToJ2000*v;}
+	Vec3d j2000ToEquinoxEqu(const Vec3d& v) const {return frameTransforms.matJ2000ToEquinoxEqu*v;}
 	Vec3d j2000ToGalactic(const Vec3d& v) const {return matJ2000ToGalactic*v;}
 
 	//! Transform vector from heliocentric ecliptic coordinate to altazimuthal
 	Vec3d heliocentricEclipticToAltAz(const Vec3d& v, RefractionMode refMode=RefractionAuto) const
 	{
-		if (refMode==RefractionOff || skyDrawer==false || (refMode==RefractionAuto && skyDrawer->getFlagHasAtmosphere()==false))
-			return matHeliocentricEclipticToAltAz*v;
+		if (!useRefraction(refMode))
+			return frameTransforms.matHeliocentricEclipticToAltAz*v;
 		Vec3d r(v);
-		r.transfo4d(matHeliocentricEclipticToAltAz);
+		r.transfo4d(frameTransforms.matHeliocentricEclipticToAltAz);
 		skyDrawer->getRefraction().forward(r);
 		return r;
 	}
 
 	//! Transform from heliocentric coordinate to equatorial at current equinox (for the planet where the observer stands)
-	Vec3d heliocentricEclipticToEquinoxEqu(const Vec3d& v) const {return matHeliocentricEclipticToEquinoxEqu*v;}
+	Vec3d heliocentricEclipticToEquinoxEqu(const Vec3d& v) const {return frameTransforms.matHeliocentricEclipticToEquinoxEqu*v;}
 	//! Transform vector from heliocentric coordinate to false equatorial : equatorial
 	//! coordinate but centered on the observer position (usefull for objects close to earth)
-	Vec3d heliocentricEclipticToEarthPosEquinoxEqu(const Vec3d& v) const {return matAltAzToEquinoxEqu*matHeliocentricEclipticToAltAz*v;}
+	Vec3d heliocentricEclipticToEarthPosEquinoxEqu(const Vec3d& v) const {return frameTransforms.matHeliocentricEclipticToEarthPosEquinoxEqu*v;}
 
 	//! Get the modelview matrix for heliocentric ecliptic (Vsop87) drawing
 	StelProjector::ModelViewTranformP getHeliocentricEclipticModelViewTransform(RefractionMode refMode=RefractionAuto) const
 	{
-		if (refMode==RefractionOff || skyDrawer==false || (refMode==RefractionAuto && skyDrawer->getFlagHasAtmosphere()==false))
-			return StelProjector::ModelViewTranformP(new StelProjector::Mat4dTransform(matAltAzModelView*matHeliocentricEclipticToAltAz));
+		if (!useRefraction(refMode))
+			return StelProjector::ModelViewTranformP(new StelProjector::Mat4dTransform(matAltAzModelView*frameTransforms.matHeliocentricEclipticToAltAz));
 		Refraction* refr = new Refraction(skyDrawer->getRefraction());
 		// The pretransform matrix will convert from input coordinates to AltAz needed by the refraction function.
-		refr->setPreTransfoMat(matHeliocentricEclipticToAltAz);
+		refr->setPreTransfoMat(frameTransforms.matHeliocentricEclipticToAltAz);
 		refr->setPostTransfoMat(matAltAzModelView);
 		return StelProjector::ModelViewTranformP(refr);
 	}
@@ -226,11 +235,11 @@ public:
 	//! Get the modelview matrix for observer-centric ecliptic (Vsop87) drawing
 	StelProjector::ModelViewTranformP getObservercentricEclipticModelViewTransform(RefractionMode refMode=RefractionAuto) const
 	{
-		if (refMode==RefractionOff || skyDrawer==false || (refMode==RefractionAuto && skyDrawer->getFlagHasAtmosphere()==false))
-			return StelProjector::ModelViewTranformP(new StelProjector::Mat4dTransform(matAltAzModelView*matJ2000ToAltAz*matVsop87ToJ2000));
+		if (!useRefraction(refMode))
+			return StelProjector::ModelViewTranformP(new StelProjector::Mat4dTransform(matAltAzModelView*frameTransforms.matObservercentricEclipticToAltAz));
 		Refraction* refr = new Refraction(skyDrawer->getRefraction());
 		// The pretransform matrix will convert from input coordinates to AltAz needed by the refraction function.
-		refr->setPreTransfoMat(matJ2000ToAltAz*matVsop87ToJ2000);
+		refr->setPreTransfoMat(frameTransforms.matObservercentricEclipticToAltAz);
 		refr->setPostTransfoMat(matAltAzModelView);
 		return StelProjector::ModelViewTranformP(refr);
 	}
@@ -238,11 +247,11 @@ public:
 	//! Get the modelview matrix for observer-centric equatorial at equinox drawing
 	StelProjector::ModelViewTranformP getEquinoxEquModelViewTransform(RefractionMode refMode=RefractionAuto) const
 	{
-		if (refMode==RefractionOff || skyDrawer==false || (refMode==RefractionAuto && skyDrawer->getFlagHasAtmosphere()==false))
-			return StelProjector::ModelViewTranformP(new StelProjector::Mat4dTransform(matAltAzModelView*matEquinoxEquToAltAz));
+		if (!useRefraction(refMode))
+			return StelProjector::ModelViewTranformP(new StelProjector::Mat4dTransform(matAltAzModelView*frameTransforms.matEquinoxEquToAltAz));
 		Refraction* refr = new Refraction(skyDrawer->getRefraction());
 		// The pretransform matrix will convert from input coordinates to AltAz needed by the refraction function.
-		refr->setPreTransfoMat(matEquinoxEquToAltAz);
+		refr->setPreTransfoMat(frameTransforms.matEquinoxEquToAltAz);
 		refr->setPostTransfoMat(matAltAzModelView);
 		return StelProjector::ModelViewTranformP(refr);
 	}
@@ -250,7 +259,7 @@ public:
 	//! Get the modelview matrix for observer-centric altazimuthal drawing
 	StelProjector::ModelViewTranformP getAltAzModelViewTransform(RefractionMode refMode=RefractionAuto) const
 	{
-		if (refMode==RefractionOff || skyDrawer==false || (refMode==RefractionAuto && skyDrawer->getFlagHasAtmosphere()==false))
+		if (!useRefraction(refMode))
 			return StelProjector::ModelViewTranformP(new StelProjector::Mat4dTransform(matAltAzModelView));
 		Refraction* refr = new Refraction(skyDrawer->getRefraction());
 		// The pretransform matrix will convert from input coordinates to AltAz needed by the refraction function.
@@ -261,11 +270,11 @@ public:
 	//! Get the modelview matrix for observer-centric J2000 equatorial drawing
 	StelProjector::ModelViewTranformP getJ2000ModelViewTransform(RefractionMode refMode=RefractionAuto) const
 	{
-		if (refMode==RefractionOff || skyDrawer==false || (refMode==RefractionAuto && skyDrawer->getFlagHasAtmosphere()==false))
-			return StelProjector::ModelViewTranformP(new StelProjector::Mat4dTransform(matAltAzModelView*matEquinoxEquToAltAz*matJ2000ToEquinoxEqu));
+		if (!useRefraction(refMode))
+			return StelProjector::ModelViewTranformP(new StelProjector::Mat4dTransform(matAltAzModelView*frameTransforms.matJ2000ToAltAz));
 		Refraction* refr = new Refraction(skyDrawer->getRefraction());
 		// The pretransform matrix will convert from input coordinates to AltAz needed by the refraction function.
-		refr->setPreTransfoMat(matEquinoxEquToAltAz*matJ2000ToEquinoxEqu);
+		refr->setPreTransfoMat(frameTransforms.matJ2000ToAltAz);
 		refr->setPostTransfoMat(matAltAzModelView);
 		return StelProjector::ModelViewTranformP(refr);
 	}
@@ -273,11 +282,11 @@ public:
 	//! Get the modelview matrix for observer-centric Galactic equatorial drawing
 	StelProjector::ModelViewTranformP getGalacticModelViewTransform(RefractionMode refMode=RefractionAuto) const
 	{
-		if (refMode==RefractionOff || skyDrawer==false || (refMode==RefractionAuto && skyDrawer->getFlagHasAtmosphere()==false))
-			return StelProjector::ModelViewTranformP(new StelProjector::Mat4dTransform(matAltAzModelView*matEquinoxEquToAltAz*matJ2000ToEquinoxEqu*matGalacticToJ2000));
+		if (!useRefraction(refMode))
+			return StelProjector::ModelViewTranformP(new StelProjector::Mat4dTransform(matAltAzModelView*frameTransforms.matGalacticToAltAz));
 		Refraction* refr = new Refraction(skyDrawer->getRefraction());
 		// The pretransform matrix will convert from input coordinates to AltAz needed by the refraction function.
-		refr->setPreTransfoMat(matEquinoxEquToAltAz*matJ2000ToEquinoxEqu*matGalacticToJ2000);
+		refr->setPreTransfoMat(frameTransforms.matGalacticToAltAz);
 		refr->setPostTransfoMat(matAltAzModelView);
 		return StelProjector::ModelViewTranformP(refr);
 	}
@@ -291,6 +300,17 @@ public:
 	//! Rotation matrix from J2000 to Galactic reference frame, using FITS convention.
 	static const Mat4d matGalacticToJ2000;
 
+	//! Get the frame counter. It is incremented when the time step starts, and when the drawing starts once
+	//! the modules updated the positions of their objects, so that the positions derived from the transformation
+	//! matrices can be cached until it changes. It can be read from any thread.
+	int getFrameCounter() const {return frameCounter;}
+
+	//! Return whether the refraction is added for the given mode.
+	bool useRefraction(RefractionMode refMode) const
+	{
+		return !(refMode==RefractionOff || skyDrawer==false || (refMode==RefractionAuto && skyDrawer->getFlagHasAtmosphere()==false));
+	}
+
 	//! Return the observer heliocentric ecliptic position
 	Vec3d getObserverHeliocentricEclipticPos() const;
 
@@ -322,6 +342,13 @@ public:
 	QString getStartupTimeMode() {return startupTimeMode;}
 	void setStartupTimeMode(const QString& s);
 
+	//! Get the rendering quality, between 0 (lowest) and 1 (full quality).
+	//! Modules use it to reduce the amount of work done when rendering is too slow.
+	float getRenderingQuality() const {return renderingQuality;}
+	//! Set the rendering quality, between 0 (lowest) and 1 (full quality).
+	//! It is usually managed automatically by the StelQualityGovernor.
+	void setRenderingQuality(float q) {renderingQuality=q;}
+
 public slots:
 	//! Set the current ProjectionType to use
 	void setCurrentProjectionType(ProjectionType type);
@@ -471,21 +498,49 @@ private:
 	// The currently used projection type
 	ProjectionType currentProjectionType;
 
+	// The current rendering quality, between 0 and 1
+	float renderingQuality;
+
 	// Parameters to use when creating new instances of StelProjector
 	StelProjector::StelProjectorParams currentProjectorParams;
 
 	void updateTransformMatrices();
 	void updateTime(double deltaTime);
 
-	// Matrices used for every coordinate transfo
-	Mat4d matHeliocentricEclipticToAltAz;	// Transform from heliocentric ecliptic (Vsop87) to observer-centric altazimuthal coordinate
-	Mat4d matAltAzToHeliocentricEcliptic;	// Transform from observer-centric altazimuthal coordinate to heliocentric ecliptic (Vsop87)
-	Mat4d matAltAzToEquinoxEqu;				// Transform from observer-centric altazimuthal coordinate to Earth Equatorial
-	Mat4d matEquinoxEquToAltAz;				// Transform from observer-centric altazimuthal coordinate to Earth Equatorial
-	Mat4d matHeliocentricEclipticToEquinoxEqu;// Transform from heliocentric ecliptic (Vsop87) to earth equatorial coordinate
-	Mat4d matEquinoxEquToJ2000;
-	Mat4d matJ2000ToEquinoxEqu;
-	Mat4d matJ2000ToAltAz;
+	//! @struct FrameTransforms
+	//! The transformation matrices between the reference frames for one date and one observer position,
+	//! computed once per time step. The matrices to altazimuthal frame don't include the refraction,
+	//! they are the pre-transform matrices used by the refraction for each frame.
+	struct FrameTransforms
+	{
+		FrameTransforms() : JDay(0.), longitude(0.f), homePlanet(NULL), localSideralTime(0.) {;}
+		//! The Julian Day, observer longitude and home planet for which the matrices were computed
+		double JDay;
+		float longitude;
+		const Planet* homePlanet;
+		//! The sideral time shifted by the observer longitude in radian
+		double localSideralTime;
+
+		Mat4d matHeliocentricEclipticToAltAz;	// Transform from heliocentric ecliptic (Vsop87) to observer-centric altazimuthal coordinate
+		Mat4d matAltAzToHeliocentricEcliptic;	// Transform from observer-centric altazimuthal coordinate to heliocentric ecliptic (Vsop87)
+		Mat4d matAltAzToEquinoxEqu;				// Transform from observer-centric altazimuthal coordinate to Earth Equatorial
+		Mat4d matEquinoxEquToAltAz;				// Transform from Earth Equatorial to observer-centric altazimuthal coordinate
+		Mat4d matHeliocentricEclipticToEquinoxEqu;// Transform from heliocentric ecliptic (Vsop87) to earth equatorial coordinate
+		Mat4d matHeliocentricEclipticToEarthPosEquinoxEqu;// Same as above but centered on the observer position
+		Mat4d matEquinoxEquToJ2000;
+		Mat4d matJ2000ToEquinoxEqu;
+		Mat4d matJ2000ToAltAz;
+		Mat4d matAltAzToJ2000;
+		Mat4d matGalacticToAltAz;
+		Mat4d matObservercentricEclipticToAltAz;
+
+		//! Single precision version for the code working with Vec3f
+		Mat4f matJ2000ToAltAzf;
+	};
+	// Matrices used for every coordinate transfo, for the current time step
+	FrameTransforms frameTransforms;
+	// Incremented at each time step and before drawing, see getFrameCounter()
+	QAtomicInt frameCounter;
 
 	Mat4d matAltAzModelView;				// Modelview matrix for observer-centric altazimuthal drawing
 	Mat4d invertMatAltAzModelView;			// Inverted modelview matrix for observer-centric altazimuthal drawing
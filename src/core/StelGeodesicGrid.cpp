@@ -35,9 +35,18 @@ Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
 #include "StelGeodesicGrid.hpp"
 
 #include <QDebug>
+#include <algorithm>
 #include <cmath>
 #include <cstdlib>
 
+// Number of search results kept in the cache
+static const int SEARCH_CACHE_SIZE = 4;
+// Maximum displacement of the region for which a previous search result is updated incrementally,
+// above it most zones need to be tested again and a full search is faster
+static const double MAX_INCREMENTAL_SHIFT = 0.02;
+// Upper bound of the margin of a point inside a cap
+static const double MAX_CAP_MARGIN = 2.;
+
 static const float icosahedron_G = 0.5*(1.0+sqrt(5.0));
 static const float icosahedron_b = 1.0/sqrt(1.0+icosahedron_G*icosahedron_G);
 static const float icosahedron_a = icosahedron_b*icosahedron_G;
@@ -88,7 +97,7 @@ static const TopLevelTriangle icosahedron_triangles[20] =
         {{ 8, 9, 5}}  //  8
     };
 
-StelGeodesicGrid::StelGeodesicGrid(const int lev) : maxLevel(lev<0?0:lev), lastMaxSearchlevel(-1)
+StelGeodesicGrid::StelGeodesicGrid(const int lev) : maxLevel(lev<0?0:lev)
 {
 	if (maxLevel > 0)
 	{
@@ -112,7 +121,7 @@ StelGeodesicGrid::StelGeodesicGrid(const int lev) : maxLevel(lev<0?0:lev), lastM
 	{
 		triangles = 0;
 	}
-	cacheSearchResult = new GeodesicSearchResult(*this);
+	spareSearchResult = new GeodesicSearchResult(*this);
 }
 
 StelGeodesicGrid::~StelGeodesicGrid(void)
@@ -122,8 +131,10 @@ StelGeodesicGrid::~StelGeodesicGrid(void)
 		for (int i=maxLevel-1;i>=0;i--) delete[] triangles[i];
 		delete[] triangles;
 	}
-	delete cacheSearchResult;
-	cacheSearchResult = NULL;
+	qDeleteAll(searchCache);
+	searchCache.clear();
+	delete spareSearchResult;
+	spareSearchResult = NULL;
 }
 
 void StelGeodesicGrid::getTriangleCorners(int lev,int index,
@@ -318,75 +329,86 @@ int StelGeodesicGrid::getZoneNumberForPoint(const Vec3f &v,int searchLevel) cons
 }
 
 
+// Return the distance of a point to the border of a cap, along the cap normal, positive inside
+static inline double capMargin(const SphericalCap& cap, const Vec3f& v)
+{
+	return v[0]*cap.n[0]+v[1]*cap.n[1]+v[2]*cap.n[2]-cap.d;
+}
+
 // First iteration on the icosahedron base triangles
-void StelGeodesicGrid::searchZones(const QVector<SphericalCap>& convex,
-                               int **inside_list,int **border_list,
-                               int maxSearchLevel) const
+void StelGeodesicGrid::searchZones(const QVector<SphericalCap>& convex, GeodesicSearchResult& result) const
 {
-	if (maxSearchLevel < 0) maxSearchLevel = 0;
-	else if (maxSearchLevel > maxLevel) maxSearchLevel = maxLevel;
-#if defined __STRICT_ANSI__ || !defined __GNUC__
-	int *halfs_used = new int[convex.size()];
-#else
-	int halfs_used[convex.size()];
-#endif
-	for (int h=0;h<(int)convex.size();h++) {halfs_used[h] = h;}
-#if defined __STRICT_ANSI__ || !defined __GNUC__
-	bool *corner_inside[12];
-	for(int ci=0; ci < 12; ci++) corner_inside[ci]= new bool[convex.size()];
-#else
-	bool corner_inside[12][convex.size()];
-#endif
-	for (int h=0;h<convex.size();h++)
+	const int nbCaps = convex.size();
+	std::vector<double> corner_margins(12*nbCaps+1);
+	for (int h=0;h<nbCaps;h++)
 	{
 		const SphericalCap& half_space(convex.at(h));
 		for (int i=0;i<12;i++)
 		{
-			corner_inside[i][h] = half_space.contains(icosahedron_corners[i]);
+			corner_margins[i*nbCaps+h] = capMargin(half_space, icosahedron_corners[i]);
 		}
 	}
 	for (int i=0;i<20;i++)
 	{
 		searchZones(0,i,
-		            convex,halfs_used,convex.size(),
-		            corner_inside[icosahedron_triangles[i].corners[0]],
-		            corner_inside[icosahedron_triangles[i].corners[1]],
-		            corner_inside[icosahedron_triangles[i].corners[2]],
-		            inside_list,border_list,maxSearchLevel);
+		            convex,&result.usedCapsBuffer[0],nbCaps,
+		            &corner_margins[icosahedron_triangles[i].corners[0]*nbCaps],
+		            &corner_margins[icosahedron_triangles[i].corners[1]*nbCaps],
+		            &corner_margins[icosahedron_triangles[i].corners[2]*nbCaps],
+		            MAX_CAP_MARGIN,result);
+	}
+}
+
+void StelGeodesicGrid::searchZonesFrom(int lev, int index, const QVector<SphericalCap>& convex, GeodesicSearchResult& result) const
+{
+	const int nbCaps = convex.size();
+	Vec3f c0, c1, c2;
+	getTriangleCorners(lev, index, c0, c1, c2);
+	// The last slice of the scratch buffer is not used by the recursion
+	double* corner_margins = &result.edgeMarginsBuffer[3*(maxLevel+1)*nbCaps];
+	for (int h=0;h<nbCaps;h++)
+	{
+		const SphericalCap& half_space(convex.at(h));
+		corner_margins[h] = capMargin(half_space, c0);
+		corner_margins[nbCaps+h] = capMargin(half_space, c1);
+		corner_margins[2*nbCaps+h] = capMargin(half_space, c2);
 	}
-#if defined __STRICT_ANSI__ || !defined __GNUC__
-	delete[] halfs_used;
-	for(int ci=0; ci < 12; ci++) delete[] corner_inside[ci];
-#endif
+	searchZones(lev,index,
+	            convex,&result.usedCapsBuffer[0],nbCaps,
+	            corner_margins,corner_margins+nbCaps,corner_margins+2*nbCaps,
+	            MAX_CAP_MARGIN,result);
 }
 
 void StelGeodesicGrid::searchZones(int lev,int index,
 								   const QVector<SphericalCap>&convex,
                                const int *indexOfUsedSphericalCaps,
                                const int halfSpacesUsed,
-                               const bool *corner0_inside,
-                               const bool *corner1_inside,
-                               const bool *corner2_inside,
-                               int **inside_list,int **border_list,
-                               const int maxSearchLevel) const
+                               const double *corner0_margin,
+                               const double *corner1_margin,
+                               const double *corner2_margin,
+                               double insideMargin,
+                               GeodesicSearchResult& result) const
 {
-#if defined __STRICT_ANSI__ || !defined __GNUC__
-	int *halfs_used = new int[halfSpacesUsed];
-#else
-	int halfs_used[halfSpacesUsed];
-#endif
+	// Each level uses its own slice of the scratch buffers, so that nothing is allocated during the recursion
+	const int nbCaps = convex.size();
+	int *halfs_used = &result.usedCapsBuffer[(lev+1)*nbCaps];
 	int halfs_used_count = 0;
+	double outsideMargin = -1.;
 	for (int h=0;h<halfSpacesUsed;h++)
 	{
 		const int i = indexOfUsedSphericalCaps[h];
-		if (!corner0_inside[i] && !corner1_inside[i] && !corner2_inside[i])
+		const double m0 = corner0_margin[i];
+		const double m1 = corner1_margin[i];
+		const double m2 = corner2_margin[i];
+		if (m0<0. && m1<0. && m2<0.)
 		{
 			// totally outside this SphericalCap
-			return;
+			outsideMargin = qMax(outsideMargin, -qMax(m0, qMax(m1, m2)));
 		}
-		else if (corner0_inside[i] && corner1_inside[i] && corner2_inside[i])
+		else if (m0>=0. && m1>=0. && m2>=0.)
 		{
 			// totally inside this SphericalCap
+			insideMargin = qMin(insideMargin, qMin(m0, qMin(m1, m2)));
 		}
 		else
 		{
@@ -394,66 +416,68 @@ void StelGeodesicGrid::searchZones(int lev,int index,
 			halfs_used[halfs_used_count++] = i;
 		}
 	}
-	if (halfs_used_count == 0)
+	GeodesicSearchResult::Level& level = result.levels[lev];
+	if (outsideMargin>0.)
+	{
+		level.outside.push_back(index);
+		level.outsideMargins.push_back(outsideMargin);
+	}
+	else if (halfs_used_count == 0)
 	{
 		// this triangle(lev,index) lies inside all halfspaces
-		**inside_list = index;
-		(*inside_list)++;
+		level.inside.push_back(index);
+		level.insideMargins.push_back(insideMargin);
 	}
 	else
 	{
-		(*border_list)--;
-		**border_list = index;
-		if (lev < maxSearchLevel)
+		level.border.push_back(index);
+		if (lev < result.maxSearchLevel)
 		{
 			const Triangle &t(triangles[lev][index]);
-			lev++;
-			index <<= 2;
-			inside_list++;
-			border_list++;
-#if defined __STRICT_ANSI__ || !defined __GNUC__
-			bool *edge0_inside = new bool[convex.size()];
-			bool *edge1_inside = new bool[convex.size()];
-			bool *edge2_inside = new bool[convex.size()];
-#else
-			bool edge0_inside[convex.size()];
-			bool edge1_inside[convex.size()];
-			bool edge2_inside[convex.size()];
-#endif
+			double *edge0_margin = &result.edgeMarginsBuffer[3*lev*nbCaps];
+			double *edge1_margin = edge0_margin+nbCaps;
+			double *edge2_margin = edge1_margin+nbCaps;
 			for (int h=0;h<halfs_used_count;h++)
 			{
 				const int i = halfs_used[h];
 				const SphericalCap& half_space(convex.at(i));
-				edge0_inside[i] = half_space.contains(t.e0);
-				edge1_inside[i] = half_space.contains(t.e1);
-				edge2_inside[i] = half_space.contains(t.e2);
+				edge0_margin[i] = capMargin(half_space, t.e0);
+				edge1_margin[i] = capMargin(half_space, t.e1);
+				edge2_margin[i] = capMargin(half_space, t.e2);
 			}
+			lev++;
+			index <<= 2;
 			searchZones(lev,index+0,
 			            convex,halfs_used,halfs_used_count,
-			            corner0_inside,edge2_inside,edge1_inside,
-			            inside_list,border_list,maxSearchLevel);
+			            corner0_margin,edge2_margin,edge1_margin,
+			            insideMargin,result);
 			searchZones(lev,index+1,
 			            convex,halfs_used,halfs_used_count,
-			            edge2_inside,corner1_inside,edge0_inside,
-			            inside_list,border_list,maxSearchLevel);
+			            edge2_margin,corner1_margin,edge0_margin,
+			            insideMargin,result);
 			searchZones(lev,index+2,
 			            convex,halfs_used,halfs_used_count,
-			            edge1_inside,edge0_inside,corner2_inside,
-			            inside_list,border_list,maxSearchLevel);
+			            edge1_margin,edge0_margin,corner2_margin,
+			            insideMargin,result);
 			searchZones(lev,index+3,
 			            convex,halfs_used,halfs_used_count,
-			            edge0_inside,edge1_inside,edge2_inside,
-			            inside_list,border_list,maxSearchLevel);
-#if defined __STRICT_ANSI__ || !defined __GNUC__
-			delete[] edge0_inside;
-			delete[] edge1_inside;
-			delete[] edge2_inside;
-#endif
+			            edge0_margin,edge1_margin,edge2_margin,
+			            insideMargin,result);
 		}
 	}
-#if defined __STRICT_ANSI__ || !defined __GNUC__
-	delete[] halfs_used;
-#endif
+}
+
+// Return an upper bound of the change of the margins of any point on the sphere between two regions
+static double computeRegionShift(const QVector<SphericalCap>& r1, const QVector<SphericalCap>& r2)
+{
+	Q_ASSERT(r1.size()==r2.size());
+	double shift = 0.;
+	for (int i=0;i<r1.size();++i)
+	{
+		shift = qMax(shift, (r1.at(i).n-r2.at(i).n).length()+std::fabs(r1.at(i).d-r2.at(i).d));
+	}
+	// Account for the rounding errors of the float corners
+	return shift+1e-6;
 }
 
 /*************************************************************************
@@ -461,59 +485,181 @@ void StelGeodesicGrid::searchZones(int lev,int index,
 *************************************************************************/
 const GeodesicSearchResult* StelGeodesicGrid::search(const QVector<SphericalCap>& convex, int maxSearchLevel) const
 {
-	// Try to use the cached version
-	if (maxSearchLevel==lastMaxSearchlevel && convex==lastSearchRegion)
+	maxSearchLevel = qBound(0, maxSearchLevel, maxLevel);
+
+	// Try to use a cached version, a deeper search also gives the result for the lower levels
+	for (int i=0;i<searchCache.size();++i)
 	{
-		return cacheSearchResult;
+		GeodesicSearchResult* r = searchCache.at(i);
+		if (r->maxSearchLevel>=maxSearchLevel && r->region==convex)
+		{
+			searchCache.move(i, 0);
+			return r;
+		}
 	}
-	// Else recompute it and update cache parameters
-	lastMaxSearchlevel = maxSearchLevel;
-	lastSearchRegion = convex;
-	cacheSearchResult->search(convex, maxSearchLevel);
-	return cacheSearchResult;
+
+	// Else update the result of the closest region if it moved only slightly, or recompute it
+	const GeodesicSearchResult* previous = NULL;
+	double shift = MAX_INCREMENTAL_SHIFT;
+	foreach (const GeodesicSearchResult* r, searchCache)
+	{
+		if (r->maxSearchLevel!=maxSearchLevel || r->region.size()!=convex.size())
+			continue;
+		const double s = computeRegionShift(r->region, convex);
+		if (s<shift)
+		{
+			shift = s;
+			previous = r;
+		}
+	}
+	GeodesicSearchResult* result = spareSearchResult;
+	if (previous)
+		result->searchIncremental(*previous, convex, shift);
+	else
+		result->search(convex, maxSearchLevel);
+
+	// The least recently used result will be overwritten by the next search
+	searchCache.prepend(result);
+	if (searchCache.size()>SEARCH_CACHE_SIZE)
+		spareSearchResult = searchCache.takeLast();
+	else
+		spareSearchResult = new GeodesicSearchResult(*this);
+	return result;
 }
 
 
 GeodesicSearchResult::GeodesicSearchResult(const StelGeodesicGrid &grid)
-		:grid(grid),
-		zones(new int*[grid.getMaxLevel()+1]),
-		inside(new int*[grid.getMaxLevel()+1]),
-		border(new int*[grid.getMaxLevel()+1])
+		:grid(grid), maxSearchLevel(-1), levels(grid.getMaxLevel()+1)
 {
-	for (int i=0;i<=grid.getMaxLevel();i++)
-	{
-		zones[i] = new int[StelGeodesicGrid::nrOfZones(i)];
-	}
 }
 
 GeodesicSearchResult::~GeodesicSearchResult(void)
 {
-	for (int i=grid.getMaxLevel();i>=0;i--)
+}
+
+void GeodesicSearchResult::clear(const QVector<SphericalCap>& convex, int amaxSearchLevel)
+{
+	region = convex;
+	maxSearchLevel = qBound(0, amaxSearchLevel, grid.getMaxLevel());
+	for (unsigned int i=0;i<levels.size();i++)
 	{
-		delete[] zones[i];
+		// clear() keeps the allocated memory for the next searches
+		levels[i].inside.clear();
+		levels[i].insideMargins.clear();
+		levels[i].border.clear();
+		levels[i].outside.clear();
+		levels[i].outsideMargins.clear();
 	}
-	delete[] border;
-	delete[] inside;
-	delete[] zones;
+	const int nbCaps = convex.size();
+	usedCapsBuffer.resize((grid.getMaxLevel()+2)*nbCaps+1);
+	for (int h=0;h<nbCaps;h++)
+		usedCapsBuffer[h] = h;
+	edgeMarginsBuffer.resize(3*(grid.getMaxLevel()+2)*nbCaps+1);
+}
+
+void GeodesicSearchResult::search(const QVector<SphericalCap>& convex, int amaxSearchLevel)
+{
+	clear(convex, amaxSearchLevel);
+	grid.searchZones(region, *this);
 }
 
-void GeodesicSearchResult::search(const QVector<SphericalCap>& convex, int maxSearchLevel)
+void GeodesicSearchResult::searchIncremental(const GeodesicSearchResult& previous, const QVector<SphericalCap>& convex, double shift)
 {
-	for (int i=grid.getMaxLevel();i>=0;i--)
+	Q_ASSERT(&previous!=this);
+	Q_ASSERT(previous.region.size()==convex.size());
+	clear(convex, previous.maxSearchLevel);
+
+	// The zones of a level are all the children of the border zones of the previous level.
+	// Children of a zone which was on the border and still is are taken from the previous result,
+	// the zones which may have changed are searched again.
+	std::vector<int> stableBorder, nextStableBorder;
+	for (int lev=0;lev<=maxSearchLevel;++lev)
 	{
-		inside[i] = zones[i];
-		border[i] = zones[i]+StelGeodesicGrid::nrOfZones(i);
+		const Level& prev = previous.levels[lev];
+		Level& cur = levels[lev];
+
+		// Zones far enough from the region border keep their status, others are searched again
+		for (unsigned int i=0;i<prev.inside.size();++i)
+		{
+			const int index = prev.inside[i];
+			if (lev>0 && !std::binary_search(stableBorder.begin(), stableBorder.end(), index>>2))
+				continue;
+			if (prev.insideMargins[i]>shift)
+			{
+				cur.inside.push_back(index);
+				cur.insideMargins.push_back(prev.insideMargins[i]-shift);
+			}
+			else
+				grid.searchZonesFrom(lev, index, region, *this);
+		}
+		for (unsigned int i=0;i<prev.outside.size();++i)
+		{
+			const int index = prev.outside[i];
+			if (lev>0 && !std::binary_search(stableBorder.begin(), stableBorder.end(), index>>2))
+				continue;
+			if (prev.outsideMargins[i]>shift)
+			{
+				cur.outside.push_back(index);
+				cur.outsideMargins.push_back(prev.outsideMargins[i]-shift);
+			}
+			else
+				grid.searchZonesFrom(lev, index, region, *this);
+		}
+
+		// Border zones are classified again without recursion
+		nextStableBorder.clear();
+		for (unsigned int i=0;i<prev.border.size();++i)
+		{
+			const int index = prev.border[i];
+			if (lev>0 && !std::binary_search(stableBorder.begin(), stableBorder.end(), index>>2))
+				continue;
+			Vec3f c0, c1, c2;
+			grid.getTriangleCorners(lev, index, c0, c1, c2);
+			double insideMargin = MAX_CAP_MARGIN;
+			double outsideMargin = -1.;
+			bool onBorder = false;
+			foreach (const SphericalCap& cap, region)
+			{
+				const double m0 = capMargin(cap, c0);
+				const double m1 = capMargin(cap, c1);
+				const double m2 = capMargin(cap, c2);
+				if (m0<0. && m1<0. && m2<0.)
+					outsideMargin = qMax(outsideMargin, -qMax(m0, qMax(m1, m2)));
+				else if (m0>=0. && m1>=0. && m2>=0.)
+					insideMargin = qMin(insideMargin, qMin(m0, qMin(m1, m2)));
+				else
+					onBorder = true;
+			}
+			if (outsideMargin>0.)
+			{
+				cur.outside.push_back(index);
+				cur.outsideMargins.push_back(outsideMargin);
+			}
+			else if (!onBorder)
+			{
+				cur.inside.push_back(index);
+				cur.insideMargins.push_back(insideMargin);
+			}
+			else
+			{
+				cur.border.push_back(index);
+				if (lev<maxSearchLevel)
+					nextStableBorder.push_back(index);
+			}
+		}
+		std::sort(nextStableBorder.begin(), nextStableBorder.end());
+		stableBorder.swap(nextStableBorder);
 	}
-	grid.searchZones(convex,inside,border,maxSearchLevel);
 }
 
 void GeodesicSearchInsideIterator::reset(void)
 {
 	level = 0;
 	maxCount = 1<<(maxLevel<<1); // 4^maxLevel
-	indexP = r.zones[0];
-	endP = r.inside[0];
-	index = (*indexP) * maxCount;
+	const std::vector<int>& zones = r.levels[0].inside;
+	indexP = zones.empty() ? NULL : &zones[0];
+	endP = indexP + zones.size();
+	index = (indexP < endP) ? (*indexP) * maxCount : 0;
 	count = (indexP < endP) ? 0 : maxCount;
 }
 
@@ -531,10 +677,11 @@ int GeodesicSearchInsideIterator::next(void)
 	{
 		level++;
 		maxCount >>= 2;
-		indexP = r.zones[level];
-		endP = r.inside[level];
-		if (indexP < endP)
+		const std::vector<int>& zones = r.levels[level].inside;
+		if (!zones.empty())
 		{
+			indexP = &zones[0];
+			endP = indexP + zones.size();
 			index = (*indexP) * maxCount;
 			count = 1;
 			return index;
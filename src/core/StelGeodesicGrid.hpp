@@ -37,6 +37,9 @@ Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
 
 #include "StelSphereGeometry.hpp"
 
+#include <vector>
+#include <QList>
+
 class GeodesicSearchResult;
 
 //! @class StelGeodesicGrid
@@ -77,7 +80,11 @@ public:
 	int getPartnerTriangle(int lev, int index) const;
 	
 	//! Return a search result matching the given spatial region
-	//! The result is cached, meaning that it is very fast to search the same region consecutively
+	//! The last results are cached, meaning that it is very fast to search again one of the recently
+	//! searched regions, and a result for a given maxSearchLevel is also used for lower levels.
+	//! When the region only moved slightly since a previous search, the previous result is updated
+	//! incrementally: only the zones close to the region border are tested again.
+	//! The returned result stays valid until a few other regions have been searched.
 	//! @return a GeodesicSearchResult instance which must be used with GeodesicSearchBorderIterator and GeodesicSearchInsideIterator
 	const GeodesicSearchResult* search(const QVector<SphericalCap>& convex, int maxSearchLevel) const;
 
@@ -85,23 +92,19 @@ private:
 	friend class GeodesicSearchResult;
 	
 	//! Find all zones that lie fully(inside) or partly(border)
-	//! in the intersection of the given half spaces.
+	//! in the intersection of the given half spaces, and store them in the result.
 	//! The result is accurate when (0,0,0) lies on the border of
 	//! each half space. If this is not the case,
 	//! the result may be inaccurate, because it is assumed, that
 	//! a zone lies in a half space when its 3 corners lie in this half space.
-	//! inside[l] points to the begin of an integer array of size nrOfZones(l),
-	//! border[l] points to one after the end of the same integer array.
-	//! The array will be filled from the beginning with the inside zone numbers
-	//! and from the end with the border zone numbers of the given level l
-	//! for 0<=l<=getMaxLevel().
-	//! inside[l] will not contain zones that are already contained
-	//! in inside[l1] for some l1 < l.
-	//! In order to restrict search depth set maxSearchLevel < maxLevel,
-	//! for full search depth set maxSearchLevel = maxLevel,
-	void searchZones(const QVector<SphericalCap>& convex,
-					 int **inside,int **border,int maxSearchLevel) const;
+	//! The inside zones of a level will not contain zones that are already contained
+	//! in the inside zones of a lower level.
+	//! The search depth is the maxSearchLevel of the result.
+	void searchZones(const QVector<SphericalCap>& convex, GeodesicSearchResult& result) const;
 	
+	//! Search the zones starting from the given triangle, which is tested against all the half spaces.
+	void searchZonesFrom(int lev, int index, const QVector<SphericalCap>& convex, GeodesicSearchResult& result) const;
+
 	const Vec3f& getTriangleCorner(int lev, int index, int cornerNumber) const;
 	void initTriangle(int lev,int index,
 					  const Vec3f &c0,
@@ -118,10 +121,11 @@ private:
 	                 const QVector<SphericalCap>& convex,
 	                 const int *indexOfUsedSphericalCaps,
 	                 const int halfSpacesUsed,
-	                 const bool *corner0_inside,
-	                 const bool *corner1_inside,
-	                 const bool *corner2_inside,
-	                 int **inside,int **border,int maxSearchLevel) const;
+	                 const double *corner0_margin,
+	                 const double *corner1_margin,
+	                 const double *corner2_margin,
+	                 double insideMargin,
+	                 GeodesicSearchResult& result) const;
 
 	const int maxLevel;
 	struct Triangle
@@ -132,12 +136,17 @@ private:
 	// 20*(4^0+4^1+...+4^n)=20*(4*(4^n)-1)/3 triangles total
 	// 2+10*4^n corners
 	
-	//! A cached search result used to avoid doing twice the same search
-	mutable GeodesicSearchResult* cacheSearchResult;
-	mutable int lastMaxSearchlevel;
-	mutable QVector<SphericalCap> lastSearchRegion;
+	//! The cached search results, the most recently used first
+	mutable QList<GeodesicSearchResult*> searchCache;
+	//! A result which is not in the cache, reused for the next search
+	mutable GeodesicSearchResult* spareSearchResult;
 };
 
+//! @class GeodesicSearchResult
+//! The zones of a StelGeodesicGrid found inside or on the border of a region.
+//! For each level, the zones fully outside the region which were tested during the search are also kept,
+//! together with a lower bound of the distance between the zones corners and the region border.
+//! This allows to update the result incrementally when the region moves by less than this distance.
 class GeodesicSearchResult
 {
 public:
@@ -149,31 +158,50 @@ private:
 	friend class GeodesicSearchBorderIterator;
 	friend class StelGeodesicGrid;
 	
+	//! @struct Level
+	//! The search result for one level of the grid.
+	//! The margins are lower bounds of |n*c-d| for the corners c of the zone and the caps (n,d) which
+	//! put the zone inside or outside the region.
+	struct Level
+	{
+		std::vector<int> inside;
+		std::vector<float> insideMargins;
+		std::vector<int> border;
+		std::vector<int> outside;
+		std::vector<float> outsideMargins;
+	};
+
+	//! Clear the result before a new search.
+	void clear(const QVector<SphericalCap>& convex, int maxSearchLevel);
 	void search(const QVector<SphericalCap>& convex, int maxSearchLevel);
+	//! Compute the result for a region which differs only slightly from the region of a previous result.
+	//! @param previous the previous result, searched at the same maximum level with the same number of caps.
+	//! @param shift an upper bound of the displacement of the caps.
+	void searchIncremental(const GeodesicSearchResult& previous, const QVector<SphericalCap>& convex, double shift);
 	
 	const StelGeodesicGrid &grid;
-	int **const zones;
-	int **const inside;
-	int **const border;
+	//! The searched region
+	QVector<SphericalCap> region;
+	//! The maximum level of the search
+	int maxSearchLevel;
+	std::vector<Level> levels;
+	//! Scratch buffers for the recursive search, one slice of size region.size() per level
+	std::vector<int> usedCapsBuffer;
+	std::vector<double> edgeMarginsBuffer;
 };
 
 class GeodesicSearchBorderIterator
 {
 public:
 	GeodesicSearchBorderIterator(const GeodesicSearchResult &ar,int alevel)
-		: r(ar),level((alevel<0)?0:(alevel>ar.grid.getMaxLevel())
-			             ?ar.grid.getMaxLevel():alevel),
-			end(ar.zones[GeodesicSearchBorderIterator::level]+
-			    StelGeodesicGrid::nrOfZones(GeodesicSearchBorderIterator::level))
+		: zones(ar.levels[(alevel<0)?0:(alevel>ar.grid.getMaxLevel())?ar.grid.getMaxLevel():alevel].border)
 	{reset();}
-	void reset(void) {index = r.border[level];}
+	void reset(void) {index = 0;}
 	int next(void) // returns -1 when finished
-	{if (index < end) {return *index++;} return -1;}
+	{if (index < zones.size()) {return zones[index++];} return -1;}
 private:
-	const GeodesicSearchResult &r;
-	const int level;
-	const int *const end;
-	const int *index;
+	const std::vector<int>& zones;
+	size_t index;
 };
 
 
@@ -191,8 +219,8 @@ private:
 	const int maxLevel;
 	int level;
 	int maxCount;
-	int *indexP;
-	int *endP;
+	const int *indexP;
+	const int *endP;
 	int index;
 	int count;
 };
@@ -21,6 +21,7 @@
 #define _STELMODULE_HPP_
 
 #include <QString>
+#include <QStringList>
 #include <QObject>
 
 // Predeclaration
@@ -60,6 +61,17 @@ public:
 	//! If the initialization takes significant time, the progress should be displayed on the loading bar.
 	virtual void init() = 0;
 
+	//! Load the data which need neither openGL nor the other modules, typically by parsing catalog files.
+	//! This is called before init() from a worker thread, possibly at the same time as the preload of
+	//! other modules and as the main thread initialization. It must therefore only access the module own
+	//! members and must not create textures or QObjects, connect signals, or read the settings.
+	//! The default implementation does nothing.
+	//! @return false if the data could not be loaded, in which case init() must not try to load it again.
+	virtual bool preload() {return true;}
+
+	//! Get the names of the modules whose preload() must be finished before this module preload() starts.
+	virtual QStringList getPreloadDependencies() const {return QStringList();}
+
 	//! Called before the module will be delete, and before the openGL context is suppressed.
 	//! Deinitialize all openGL texture in this method.
 	virtual void deinit() {;}
@@ -20,6 +20,11 @@
 #include <QDebug>
 #include <QPluginLoader>
 #include <QSettings>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QElapsedTimer>
+#include <QSet>
+#include <stdexcept>
 
 #include "StelModuleMgr.hpp"
 #include "StelApp.hpp"
@@ -42,6 +47,12 @@ StelModuleMgr::StelModuleMgr() : callingListsToRegenerate(true), pluginDescripto
 
 StelModuleMgr::~StelModuleMgr()
 {
+	// Don't let worker threads run on deleted modules
+	preloadMutex.lock();
+	const QList<StelModule*> preloaded = preloads.keys();
+	preloadMutex.unlock();
+	foreach (StelModule* m, preloaded)
+		waitForPreload(m);
 }
 
 // Regenerate calling lists if necessary
@@ -280,3 +291,124 @@ QList<StelModuleMgr::PluginDescriptor> StelModuleMgr::getPluginsList()
 	pluginDescriptorListLoaded = true;
 	return pluginDescriptorList.values();
 }
+
+//! Run the preload of one module in a worker thread
+class StelModulePreloadTask : public QRunnable
+{
+public:
+	StelModulePreloadTask(StelModuleMgr* amgr, StelModule* am) : mgr(amgr), module(am) {;}
+	virtual void run()
+	{
+		QElapsedTimer timer;
+		timer.start();
+		bool succeeded = false;
+		try
+		{
+			succeeded = module->preload();
+		}
+		catch (std::runtime_error& e)
+		{
+			qWarning() << "ERROR while preloading module" << module->objectName() << ":" << e.what();
+		}
+		if (!succeeded)
+			qWarning() << "ERROR: the preload of module" << module->objectName() << "failed";
+		mgr->preloadFinished(module, succeeded, timer.elapsed());
+	}
+private:
+	StelModuleMgr* mgr;
+	StelModule* module;
+};
+
+void StelModuleMgr::startPreload(const QList<StelModule*>& mods)
+{
+	QMutexLocker locker(&preloadMutex);
+	QMap<QString, StelModule*> byName;
+	foreach (StelModule* m, mods)
+	{
+		Q_ASSERT(!preloads.contains(m));
+		byName.insert(m->objectName(), m);
+		preloads.insert(m, PreloadState());
+	}
+	foreach (StelModule* m, mods)
+	{
+		foreach (const QString& dep, m->getPreloadDependencies())
+		{
+			if (byName.contains(dep))
+				preloads[m].dependencies << byName.value(dep);
+		}
+	}
+
+	// Check that the dependencies have no cycle by resolving them in order, else ignore them for the remaining modules
+	QSet<StelModule*> resolved;
+	bool progress = true;
+	while (progress && resolved.size()<mods.size())
+	{
+		progress = false;
+		foreach (StelModule* m, mods)
+		{
+			if (resolved.contains(m))
+				continue;
+			bool ready = true;
+			foreach (StelModule* d, preloads[m].dependencies)
+				ready = ready && resolved.contains(d);
+			if (ready)
+			{
+				resolved.insert(m);
+				progress = true;
+			}
+		}
+	}
+	foreach (StelModule* m, mods)
+	{
+		if (!resolved.contains(m))
+		{
+			qWarning() << "WARNING: cyclic preload dependencies for module" << m->objectName() << ", ignore them.";
+			preloads[m].dependencies.clear();
+		}
+	}
+
+	startReadyPreloads();
+}
+
+void StelModuleMgr::startReadyPreloads()
+{
+	for (QMap<StelModule*, PreloadState>::Iterator iter=preloads.begin();iter!=preloads.end();++iter)
+	{
+		if (iter->started)
+			continue;
+		bool ready = true;
+		foreach (StelModule* d, iter->dependencies)
+			ready = ready && preloads.value(d).finished;
+		if (!ready)
+			continue;
+		iter->started = true;
+		QThreadPool::globalInstance()->start(new StelModulePreloadTask(this, iter.key()));
+	}
+}
+
+void StelModuleMgr::preloadFinished(StelModule* m, bool succeeded, qint64 duration)
+{
+	QMutexLocker locker(&preloadMutex);
+	PreloadState& state = preloads[m];
+	state.finished = true;
+	state.succeeded = succeeded;
+	state.duration = duration;
+	startReadyPreloads();
+	preloadCondition.wakeAll();
+}
+
+StelModuleMgr::PreloadStatus StelModuleMgr::waitForPreload(StelModule* m)
+{
+	QMutexLocker locker(&preloadMutex);
+	if (!preloads.contains(m))
+		return PreloadNotStarted;
+	while (!preloads.value(m).finished)
+		preloadCondition.wait(&preloadMutex);
+	return preloads.value(m).succeeded ? PreloadSucceeded : PreloadFailed;
+}
+
+qint64 StelModuleMgr::getPreloadDuration(StelModule* m)
+{
+	QMutexLocker locker(&preloadMutex);
+	return preloads.value(m).duration;
+}
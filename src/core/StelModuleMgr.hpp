@@ -23,6 +23,8 @@
 #include <QObject>
 #include <QMap>
 #include <QList>
+#include <QMutex>
+#include <QWaitCondition>
 #include "StelModule.hpp"
 #include "StelPluginInterface.hpp"
 
@@ -75,6 +77,28 @@ public:
 	//! Get the list of all the currently registered modules
 	QList<StelModule*> getAllModules() {return modules.values();}
 
+	//! Start the StelModule::preload() of the given modules in the global pool of worker threads.
+	//! The preload of a module is started only once the preload of all its dependencies is finished,
+	//! dependencies on modules which are not in the list are ignored. The method returns immediately.
+	//! @param mods the modules to preload, they don't need to be registered yet.
+	void startPreload(const QList<StelModule*>& mods);
+
+	//! Result of the preload of a module.
+	enum PreloadStatus
+	{
+		PreloadNotStarted,	//!< No preload was started for the module
+		PreloadSucceeded,	//!< StelModule::preload() returned true
+		PreloadFailed		//!< StelModule::preload() returned false or threw an exception
+	};
+
+	//! Block until the preload of the given module is finished.
+	//! Return immediately if no preload was started for this module.
+	//! @return the result of the preload.
+	PreloadStatus waitForPreload(StelModule* m);
+
+	//! Get the time spent in the preload of the given module in ms, or -1 if it was not preloaded.
+	qint64 getPreloadDuration(StelModule* m);
+
 	//! Get the list of modules in the correct order for calling the given action
 	const QList<StelModule*>& getCallOrders(StelModule::StelModuleActionName action)
 	{
@@ -101,10 +125,17 @@ public:
 	QList<PluginDescriptor> getPluginsList();
 
 private:
+	friend class StelModulePreloadTask;
+
 	//! Generate properly sorted calling lists for each action (e,g, draw, update)
 	//! according to modules orders dependencies
 	void generateCallingLists();
 
+	//! Start the pending preloads whose dependencies are all finished, preloadMutex must be locked
+	void startReadyPreloads();
+	//! Called from the worker thread when the preload of a module is finished
+	void preloadFinished(StelModule* m, bool succeeded, qint64 duration);
+
 	//! The main module list associating name:pointer
 	QMap<QString, StelModule*> modules;
 
@@ -116,6 +147,23 @@ private:
 
 	QMap<QString, StelModuleMgr::PluginDescriptor> pluginDescriptorList;
 	bool pluginDescriptorListLoaded;
+
+	//! The state of the preload of one module
+	struct PreloadState
+	{
+		PreloadState() : started(false), finished(false), succeeded(false), duration(-1) {;}
+		//! The modules which must be preloaded before this one
+		QList<StelModule*> dependencies;
+		bool started;
+		bool finished;
+		bool succeeded;
+		qint64 duration;
+	};
+	QMap<StelModule*, PreloadState> preloads;
+	//! Protect preloads, which is accessed from the worker threads
+	QMutex preloadMutex;
+	//! Signaled each time the preload of a module is finished
+	QWaitCondition preloadCondition;
 };
 
 #endif // _STELMODULEMGR_HPP_
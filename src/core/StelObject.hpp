@@ -21,6 +21,7 @@
 #define _STELOBJECT_HPP_
 
 #include <QString>
+#include <QAtomicInt>
 #include "VecMath.hpp"
 #include "StelObjectType.hpp"
 #include "StelRegionObject.hpp"
@@ -61,6 +62,7 @@ public:
 	//! A pre-defined set of specifiers for the getInfoString flags argument to getInfoString
 	static const InfoStringGroup ShortInfo = (InfoStringGroup)(Name|CatalogNumber|Magnitude|RaDecJ2000);
 
+	StelObject() {positionCache.frame=0; positionCache.validPositions=0;}
 	virtual ~StelObject() {}
 
 	//! Default implementation of the getRegion method.
@@ -85,9 +87,12 @@ public:
 	virtual QString getNameI18n() const = 0;
 
 	//! Get observer-centered equatorial coordinates at equinox J2000
+	//! It is not cached as it is implemented by every subclass and can be called with a NULL core,
+	//! the positions derived from it cache it internally for the current frame instead.
 	virtual Vec3d getJ2000EquatorialPos(const StelCore* core) const = 0;
 
 	//! Get observer-centered equatorial coordinate at the current equinox
+	//! The derived positions below are computed once per frame of the StelCore, and cached until the next frame.
 	//! The frame has it's Z axis at the planet's current rotation axis
 	//! At time 2000-01-01 this frame is almost the same as J2000, but ONLY if the observer is on earth
 	Vec3d getEquinoxEquatorialPos(const StelCore* core) const;
@@ -146,6 +151,41 @@ protected:
 
 	//! Apply post processing on the info string
 	void postProcessInfoString(QString& str, const InfoStringGroup& flags) const;
+
+private:
+	//! @enum CachedPosition
+	//! The positions kept in the position cache.
+	enum CachedPosition
+	{
+		J2000Pos,
+		EquinoxEquPos,
+		AltAzPosGeometric,
+		AltAzPosApparent,
+		NbCachedPositions
+	};
+
+	//! @struct PositionCache
+	//! The positions computed during one frame of the StelCore.
+	struct PositionCache
+	{
+		//! The StelCore frame counter when the positions were computed
+		int frame;
+		//! Bit field of the positions computed during this frame, by CachedPosition
+		int validPositions;
+		Vec3d positions[NbCachedPositions];
+	};
+
+	//! Return a position from the cache, computing it if it was not computed yet during the current frame.
+	//! The cache is a sequence lock: the readers never wait, and they compute the position themselves when
+	//! another thread is writing in the cache, so that it can be used from the worker threads.
+	Vec3d getCachedPosition(const StelCore* core, CachedPosition which) const;
+
+	//! Compute a position of the cache.
+	Vec3d computeCachedPosition(const StelCore* core, CachedPosition which) const;
+
+	//! Odd while the cache is being written, incremented by 2 at each write
+	mutable QAtomicInt positionSequence;
+	mutable PositionCache positionCache;
 };
 
 #endif // _STELOBJECT_HPP_
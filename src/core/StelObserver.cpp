@@ -199,7 +199,12 @@ double StelObserver::getDistanceFromCenter(void) const
 	return getHomePlanet()->getRadius() + (currentLocation.altitude/(1000*AU));
 }
 
-Mat4d StelObserver::getRotAltAzToEquatorial(double jd) const
+double StelObserver::getLocalSiderealTime(double jd) const
+{
+	return (getHomePlanet()->getSiderealTime(jd)+currentLocation.longitude)*M_PI/180.;
+}
+
+Mat4d StelObserver::getRotAltAzToEquatorialFromSiderealTime(double localSiderealTime) const
 {
 	double lat = currentLocation.latitude;
 	// TODO: Figure out how to keep continuity in sky as reach poles
@@ -207,8 +212,7 @@ Mat4d StelObserver::getRotAltAzToEquatorial(double jd) const
 	// This is a kludge
 	if( lat > 89.5 )  lat = 89.5;
 	if( lat < -89.5 ) lat = -89.5;
-	return Mat4d::zrotation((getHomePlanet()->getSiderealTime(jd)+currentLocation.longitude)*M_PI/180.)
-		* Mat4d::yrotation((90.-lat)*M_PI/180.);
+	return Mat4d::zrotation(localSiderealTime) * Mat4d::yrotation((90.-lat)*M_PI/180.);
 }
 
 Mat4d StelObserver::getRotEquatorialToVsop87(void) const
@@ -48,7 +48,13 @@ public:
 	Vec3d getCenterVsop87Pos(void) const;
 	//! Get the distance between observer and home planet center in AU
 	double getDistanceFromCenter(void) const;
-	Mat4d getRotAltAzToEquatorial(double jd) const;
+	Mat4d getRotAltAzToEquatorial(double jd) const {return getRotAltAzToEquatorialFromSiderealTime(getLocalSiderealTime(jd));}
+	//! Get the rotation from altazimuthal to equatorial frame for a local sidereal time, so that
+	//! callers which already know it don't compute the sidereal time of the home planet again.
+	//! @param localSiderealTime the sidereal time shifted by the observer longitude in radian.
+	Mat4d getRotAltAzToEquatorialFromSiderealTime(double localSiderealTime) const;
+	//! Get the sidereal time of the home planet shifted by the observer longitude in radian.
+	double getLocalSiderealTime(double jd) const;
 	Mat4d getRotEquatorialToVsop87(void) const;
 
 	virtual const QSharedPointer<Planet> getHomePlanet(void) const;
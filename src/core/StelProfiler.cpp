@@ -0,0 +1,302 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "StelProfiler.hpp"
+#include "StelPainter.hpp"
+#include "StelProjector.hpp"
+
+#include <algorithm>
+#include <QFile>
+#include <QTextStream>
+#include <QDebug>
+#include <QtOpenGL>
+
+#ifndef USE_OPENGL_ES2
+// The GL timer query entry points are resolved at runtime, they are not part of the GL 1.1 headers
+#ifndef GL_TIME_ELAPSED
+ #define GL_TIME_ELAPSED 0x88BF
+#endif
+#ifndef GL_QUERY_RESULT
+ #define GL_QUERY_RESULT 0x8866
+#endif
+#ifndef GL_QUERY_RESULT_AVAILABLE
+ #define GL_QUERY_RESULT_AVAILABLE 0x8867
+#endif
+typedef void (APIENTRY *StelGenQueriesFunc)(GLsizei n, GLuint* ids);
+typedef void (APIENTRY *StelDeleteQueriesFunc)(GLsizei n, const GLuint* ids);
+typedef void (APIENTRY *StelBeginQueryFunc)(GLenum target, GLuint id);
+typedef void (APIENTRY *StelEndQueryFunc)(GLenum target);
+typedef void (APIENTRY *StelGetQueryObjectuivFunc)(GLuint id, GLenum pname, GLuint* params);
+static StelGenQueriesFunc stelGenQueries = NULL;
+static StelDeleteQueriesFunc stelDeleteQueries = NULL;
+static StelBeginQueryFunc stelBeginQuery = NULL;
+static StelEndQueryFunc stelEndQuery = NULL;
+static StelGetQueryObjectuivFunc stelGetQueryObjectuiv = NULL;
+#endif
+
+// Maximum number of GL queries waiting for their result, above that GPU timing is skipped
+static const int MAX_PENDING_QUERIES = 256;
+
+StelProfiler::Section::Section(Phase aphase, const QString& aname, int historySize)
+	: phase(aphase), name(aname), currentNs(0), touched(false), historyIndex(0), nbSamples(0),
+	  gpuHistoryIndex(0), nbGpuSamples(0)
+{
+	history.resize(historySize);
+	gpuHistory.resize(historySize);
+}
+
+StelProfiler::Stats StelProfiler::Section::computeStats() const
+{
+	Stats s;
+	s.name = name;
+	s.phase = phase;
+	s.nbFrames = nbSamples;
+	if (nbSamples==0)
+		return s;
+
+	QVector<float> sorted(nbSamples);
+	double sum = 0.;
+	for (int i=0;i<nbSamples;++i)
+	{
+		sorted[i] = history.at(i);
+		sum += sorted.at(i);
+	}
+	std::sort(sorted.begin(), sorted.end());
+	s.min = sorted.first();
+	s.max = sorted.last();
+	s.mean = sum/nbSamples;
+	s.p95 = sorted.at(qMin(nbSamples-1, (int)(0.95*nbSamples)));
+
+	if (nbGpuSamples>0)
+	{
+		double gpuSum = 0.;
+		for (int i=0;i<nbGpuSamples;++i)
+			gpuSum += gpuHistory.at(i);
+		s.gpuMean = gpuSum/nbGpuSamples;
+	}
+	return s;
+}
+
+StelProfiler::StelProfiler(int ahistorySize)
+	: historySize(ahistorySize), frameSection(PhaseDraw, "Frame", ahistorySize), currentSection(NULL),
+	  flagShowOverlay(false), gpuTimerSupported(false), gpuTimerChecked(false), currentQuery(0)
+{
+	Q_ASSERT(historySize>0);
+	frameTimer.start();
+}
+
+StelProfiler::~StelProfiler()
+{
+#ifndef USE_OPENGL_ES2
+	if (gpuTimerSupported && QGLContext::currentContext())
+	{
+		foreach (const PendingQuery& q, pendingQueries)
+			freeQueries.append(q.id);
+		if (!freeQueries.isEmpty())
+			stelDeleteQueries(freeQueries.size(), freeQueries.constData());
+	}
+#endif
+	qDeleteAll(sections);
+}
+
+StelProfiler::Section* StelProfiler::getSection(Phase phase, const QObject* owner)
+{
+	const QPair<const QObject*, int> key(owner, (int)phase);
+	QHash<QPair<const QObject*, int>, Section*>::iterator iter = sections.find(key);
+	if (iter!=sections.end())
+		return iter.value();
+	const QString name = owner->objectName().isEmpty() ? QString(owner->metaObject()->className()) : owner->objectName();
+	Section* s = new Section(phase, name, historySize);
+	sections.insert(key, s);
+	return s;
+}
+
+void StelProfiler::beginSection(Phase phase, const QObject* owner)
+{
+	Q_ASSERT(currentSection==NULL);
+	currentSection = getSection(phase, owner);
+
+#ifndef USE_OPENGL_ES2
+	if (!gpuTimerChecked && QGLContext::currentContext())
+	{
+		gpuTimerChecked = true;
+		const QString extensions = QString((const char*)glGetString(GL_EXTENSIONS));
+		if (extensions.contains("GL_ARB_timer_query") || extensions.contains("GL_EXT_timer_query"))
+		{
+			const QGLContext* ctx = QGLContext::currentContext();
+			stelGenQueries = (StelGenQueriesFunc)ctx->getProcAddress("glGenQueries");
+			stelDeleteQueries = (StelDeleteQueriesFunc)ctx->getProcAddress("glDeleteQueries");
+			stelBeginQuery = (StelBeginQueryFunc)ctx->getProcAddress("glBeginQuery");
+			stelEndQuery = (StelEndQueryFunc)ctx->getProcAddress("glEndQuery");
+			stelGetQueryObjectuiv = (StelGetQueryObjectuivFunc)ctx->getProcAddress("glGetQueryObjectuiv");
+			gpuTimerSupported = stelGenQueries && stelDeleteQueries && stelBeginQuery && stelEndQuery && stelGetQueryObjectuiv;
+		}
+		qDebug() << "GPU timer queries for profiling:" << (gpuTimerSupported ? "available" : "not available");
+	}
+
+	// Only the drawing phase has meaningful GPU times
+	if (gpuTimerSupported && phase==PhaseDraw && pendingQueries.size()<MAX_PENDING_QUERIES)
+	{
+		if (freeQueries.isEmpty())
+		{
+			GLuint id;
+			stelGenQueries(1, &id);
+			freeQueries.append(id);
+		}
+		currentQuery = freeQueries.last();
+		freeQueries.pop_back();
+		stelBeginQuery(GL_TIME_ELAPSED, currentQuery);
+	}
+#endif
+	sectionTimer.start();
+}
+
+void StelProfiler::endSection()
+{
+	Q_ASSERT(currentSection!=NULL);
+	currentSection->currentNs += sectionTimer.nsecsElapsed();
+	currentSection->touched = true;
+#ifndef USE_OPENGL_ES2
+	if (currentQuery!=0)
+	{
+		stelEndQuery(GL_TIME_ELAPSED);
+		PendingQuery q;
+		q.id = currentQuery;
+		q.section = currentSection;
+		pendingQueries.append(q);
+		currentQuery = 0;
+	}
+#endif
+	currentSection = NULL;
+}
+
+void StelProfiler::collectGpuQueries()
+{
+#ifndef USE_OPENGL_ES2
+	if (pendingQueries.isEmpty())
+		return;
+	// Queries complete in order, stop at the first one which is not yet available
+	int nbDone = 0;
+	foreach (const PendingQuery& q, pendingQueries)
+	{
+		GLuint available = 0;
+		stelGetQueryObjectuiv(q.id, GL_QUERY_RESULT_AVAILABLE, &available);
+		if (!available)
+			break;
+		GLuint ns = 0;
+		stelGetQueryObjectuiv(q.id, GL_QUERY_RESULT, &ns);
+		Section* s = q.section;
+		s->gpuHistory[s->gpuHistoryIndex] = ns/1000000.f;
+		s->gpuHistoryIndex = (s->gpuHistoryIndex+1)%historySize;
+		s->nbGpuSamples = qMin(s->nbGpuSamples+1, historySize);
+		freeQueries.append(q.id);
+		++nbDone;
+	}
+	pendingQueries.remove(0, nbDone);
+#endif
+}
+
+void StelProfiler::endFrame()
+{
+	Q_ASSERT(currentSection==NULL);
+	foreach (Section* s, sections)
+	{
+		if (!s->touched)
+			continue;
+		s->history[s->historyIndex] = s->currentNs/1000000.f;
+		s->historyIndex = (s->historyIndex+1)%historySize;
+		s->nbSamples = qMin(s->nbSamples+1, historySize);
+		s->currentNs = 0;
+		s->touched = false;
+	}
+
+	frameSection.history[frameSection.historyIndex] = frameTimer.nsecsElapsed()/1000000.f;
+	frameSection.historyIndex = (frameSection.historyIndex+1)%historySize;
+	frameSection.nbSamples = qMin(frameSection.nbSamples+1, historySize);
+	frameTimer.restart();
+
+	collectGpuQueries();
+}
+
+static bool statsLessThan(const StelProfiler::Stats& s1, const StelProfiler::Stats& s2)
+{
+	if (s1.phase!=s2.phase)
+		return s1.phase<s2.phase;
+	return s1.mean>s2.mean;
+}
+
+QList<StelProfiler::Stats> StelProfiler::getStats() const
+{
+	QList<Stats> res;
+	foreach (const Section* s, sections)
+		res << s->computeStats();
+	qSort(res.begin(), res.end(), statsLessThan);
+	return res;
+}
+
+StelProfiler::Stats StelProfiler::getFrameStats() const
+{
+	return frameSection.computeStats();
+}
+
+bool StelProfiler::writeCSV(const QString& fileName) const
+{
+	QFile file(fileName);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+	{
+		qWarning() << "Can't write profiling results to" << fileName;
+		return false;
+	}
+	QTextStream out(&file);
+	out << "phase,name,frames,min_ms,mean_ms,p95_ms,max_ms,gpu_mean_ms\n";
+	QList<Stats> all = getStats();
+	all << getFrameStats();
+	foreach (const Stats& s, all)
+	{
+		out << (s.phase==PhaseUpdate ? "update" : "draw") << ',' << s.name << ',' << s.nbFrames << ','
+			<< s.min << ',' << s.mean << ',' << s.p95 << ',' << s.max << ',' << s.gpuMean << '\n';
+	}
+	file.close();
+	qDebug() << "Profiling results written to" << fileName;
+	return true;
+}
+
+void StelProfiler::drawOverlay(StelPainter& sPainter) const
+{
+	const StelProjectorP& prj = sPainter.getProjector();
+	const int lineHeight = sPainter.getFontMetrics().height();
+	float x = prj->getViewportPosX() + 10;
+	float y = prj->getViewportPosY() + prj->getViewportHeight() - 10 - lineHeight;
+
+	sPainter.setColor(1.f, 1.f, 0.5f, 0.9f);
+	const Stats frame = getFrameStats();
+	sPainter.drawText(x, y, QString("Frame: mean %1 ms, p95 %2 ms, max %3 ms").arg(frame.mean, 0, 'f', 2).arg(frame.p95, 0, 'f', 2).arg(frame.max, 0, 'f', 2));
+	y -= lineHeight;
+	foreach (const Stats& s, getStats())
+	{
+		QString line = QString("%1 %2: %3 / %4 / %5 ms").arg(s.phase==PhaseUpdate ? "update" : "draw")
+			.arg(s.name).arg(s.mean, 0, 'f', 2).arg(s.p95, 0, 'f', 2).arg(s.max, 0, 'f', 2);
+		if (s.gpuMean>=0.)
+			line += QString(" (GPU %1 ms)").arg(s.gpuMean, 0, 'f', 2);
+		sPainter.drawText(x, y, line);
+		y -= lineHeight;
+		if (y<prj->getViewportPosY())
+			break;
+	}
+}
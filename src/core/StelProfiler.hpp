@@ -0,0 +1,152 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _STELPROFILER_HPP_
+#define _STELPROFILER_HPP_
+
+#include <QString>
+#include <QList>
+#include <QHash>
+#include <QPair>
+#include <QVector>
+#include <QElapsedTimer>
+
+class StelPainter;
+class QObject;
+
+//! @class StelProfiler
+//! Record the time spent in each module for each phase of a frame.
+//! StelApp measures every call to StelModule::update and StelModule::draw and reports
+//! it here, together with the time spent in StelCore. The wall time of a section is always
+//! measured, the GPU time is measured as well using GL timer queries when the driver supports them.
+//! Statistics are computed over a rolling window of the last frames.
+//! The measures are cheap enough to be left always on.
+class StelProfiler
+{
+public:
+	//! @enum Phase the phase of the frame in which a section is measured.
+	enum Phase
+	{
+		PhaseUpdate=0,	//!< StelCore and StelModule updates
+		PhaseDraw=1		//!< StelCore and StelModule drawing
+	};
+
+	//! @struct Stats
+	//! Rolling statistics about one section, all times are in milliseconds.
+	struct Stats
+	{
+		Stats() : phase(PhaseUpdate), nbFrames(0), min(0.), mean(0.), p95(0.), max(0.), gpuMean(-1.) {;}
+		//! The name of the measured section, typically the module name
+		QString name;
+		Phase phase;
+		//! The number of frames on which the statistics are computed
+		int nbFrames;
+		double min;
+		double mean;
+		//! 95th percentile of the frame times
+		double p95;
+		double max;
+		//! Mean GPU time, or -1 if not available
+		double gpuMean;
+	};
+
+	//! @param historySize the number of frames on which the rolling statistics are computed.
+	StelProfiler(int historySize=300);
+	~StelProfiler();
+
+	//! Start measuring a section.
+	//! Sections can't be nested, and the same section can be measured several times in a frame,
+	//! in which case the times are summed.
+	//! @param owner the measured object, typically a StelModule. The sections are identified by their phase and owner,
+	//! and named after the owner object name, or its class name if it has none.
+	void beginSection(Phase phase, const QObject* owner);
+	//! Stop measuring the current section.
+	void endSection();
+
+	//! Commit the times measured since the last call as a new frame.
+	void endFrame();
+
+	//! Get the statistics of all the sections measured so far, sorted by phase and decreasing mean time.
+	QList<Stats> getStats() const;
+	//! Get the statistics of the total frame time.
+	Stats getFrameStats() const;
+
+	//! Write the statistics of all the sections in a CSV file.
+	//! @return false if the file could not be written.
+	bool writeCSV(const QString& fileName) const;
+
+	//! Draw the statistics on top of the sky.
+	void drawOverlay(StelPainter& sPainter) const;
+
+	//! Get whether the statistics are drawn on top of the sky.
+	bool getFlagShowOverlay() const {return flagShowOverlay;}
+	//! Set whether the statistics are drawn on top of the sky.
+	void setFlagShowOverlay(bool b) {flagShowOverlay=b;}
+
+private:
+	//! Rolling history of a measured section
+	struct Section
+	{
+		Section(Phase aphase, const QString& aname, int historySize);
+		//! Compute the statistics on the current history
+		Stats computeStats() const;
+
+		Phase phase;
+		QString name;
+		//! Time accumulated in the current frame in nanoseconds
+		qint64 currentNs;
+		bool touched;
+		//! Circular buffer of the last frame times in milliseconds
+		QVector<float> history;
+		int historyIndex;
+		int nbSamples;
+		//! Circular buffer of the last GPU times in milliseconds
+		QVector<float> gpuHistory;
+		int gpuHistoryIndex;
+		int nbGpuSamples;
+	};
+
+	Section* getSection(Phase phase, const QObject* owner);
+
+	//! Collect the results of the GPU queries which are available
+	void collectGpuQueries();
+
+	int historySize;
+	QHash<QPair<const QObject*, int>, Section*> sections;
+	Section frameSection;
+	Section* currentSection;
+	QElapsedTimer sectionTimer;
+	QElapsedTimer frameTimer;
+	bool flagShowOverlay;
+
+	//! Whether GL timer queries can be used
+	bool gpuTimerSupported;
+	bool gpuTimerChecked;
+	//! Queries issued and not yet read back
+	struct PendingQuery
+	{
+		unsigned int id;
+		Section* section;
+	};
+	QVector<PendingQuery> pendingQueries;
+	QVector<unsigned int> freeQueries;
+	unsigned int currentQuery;
+};
+
+#endif // _STELPROFILER_HPP_
@@ -0,0 +1,77 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "StelQualityGovernor.hpp"
+
+#include <QtGlobal>
+
+// Number of frames to measure after a quality change before taking a new decision
+static const int MIN_FRAMES_BETWEEN_CHANGES = 10;
+// Weight of the last frame in the smoothed frame duration
+static const double SMOOTHING_FACTOR = 0.2;
+// The quality is lowered above this fraction of the target frame duration
+static const double LOWER_THRESHOLD = 1.15;
+// The quality is raised below this fraction of the target frame duration
+static const double RAISE_THRESHOLD = 0.6;
+// Lowering is faster than raising so that slow frames are quickly avoided
+static const float LOWER_STEP = 0.2f;
+static const float RAISE_STEP = 0.1f;
+
+StelQualityGovernor::StelQualityGovernor() : flagEnabled(false), quality(1.f), targetFrameDuration(1./30.),
+	averageFrameDuration(0.), nbFramesSinceChange(0)
+{
+}
+
+void StelQualityGovernor::setFlagEnabled(bool b)
+{
+	flagEnabled = b;
+	if (!flagEnabled)
+		setQuality(1.f);
+}
+
+void StelQualityGovernor::setQuality(float q)
+{
+	quality = qBound(0.f, q, 1.f);
+	averageFrameDuration = 0.;
+	nbFramesSinceChange = 0;
+}
+
+void StelQualityGovernor::addFrame(double frameDuration, bool interacting)
+{
+	if (!flagEnabled)
+		return;
+
+	// The view is still, the frame rate doesn't matter anymore
+	if (!interacting)
+	{
+		if (quality<1.f)
+			setQuality(1.f);
+		return;
+	}
+
+	averageFrameDuration = nbFramesSinceChange==0 ? frameDuration :
+		averageFrameDuration+SMOOTHING_FACTOR*(frameDuration-averageFrameDuration);
+	if (++nbFramesSinceChange<MIN_FRAMES_BETWEEN_CHANGES)
+		return;
+
+	if (averageFrameDuration>targetFrameDuration*LOWER_THRESHOLD && quality>0.f)
+		setQuality(quality-LOWER_STEP);
+	else if (averageFrameDuration<targetFrameDuration*RAISE_THRESHOLD && quality<1.f)
+		setQuality(quality+RAISE_STEP);
+}
@@ -0,0 +1,67 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _STELQUALITYGOVERNOR_HPP_
+#define _STELQUALITYGOVERNOR_HPP_
+
+//! @class StelQualityGovernor
+//! Choose the rendering quality so that the frame time stays close to a target while the user interacts.
+//! The quality is a value between 0 (lowest) and 1 (full quality) which is applied through
+//! StelCore::setRenderingQuality(), each module then reduces its own work accordingly
+//! (fainter stars, atmosphere grid, sphere tessellation, labels, sky image tiles resolution).
+//! To avoid oscillations, the quality is changed by discrete steps, only after a minimum
+//! number of frames, and the thresholds for lowering and raising it are far apart.
+//! When the view is still, full quality is restored. It is disabled by default, see video/flag_adaptive_quality.
+class StelQualityGovernor
+{
+public:
+	StelQualityGovernor();
+
+	//! Report the time spent rendering the last complete frame.
+	//! @param frameDuration the rendering time in second, excluding the idle time between frames.
+	//! @param interacting true if the user is currently interacting with the view.
+	void addFrame(double frameDuration, bool interacting);
+
+	//! Get the quality to use for the next frames, between 0 and 1.
+	float getQuality() const {return quality;}
+
+	//! Set whether the quality is adapted, if false the quality is always 1.
+	void setFlagEnabled(bool b);
+	//! Get whether the quality is adapted.
+	bool getFlagEnabled() const {return flagEnabled;}
+
+	//! Set the target rendering time of a frame in second.
+	void setTargetFrameDuration(double d) {targetFrameDuration=d;}
+	//! Get the target rendering time of a frame in second.
+	double getTargetFrameDuration() const {return targetFrameDuration;}
+
+private:
+	//! Change the quality and restart the measures
+	void setQuality(float q);
+
+	bool flagEnabled;
+	float quality;
+	double targetFrameDuration;
+	//! Smoothed frame duration since the last quality change
+	double averageFrameDuration;
+	//! Number of frames since the last quality change
+	int nbFramesSinceChange;
+};
+
+#endif // _STELQUALITYGOVERNOR_HPP_
@@ -50,6 +50,8 @@
 // The 0.025 corresponds to the maximum eye resolution in degree
 #define EYE_RESOLUTION (0.25f)
 #define MAX_LINEAR_RADIUS 8.f
+// Number of magnitudes removed from the faint end of point sources at the lowest rendering quality
+#define MAX_QUALITY_MAG_REDUCTION 2.5f
 
 StelSkyDrawer::StelSkyDrawer(StelCore* acore) : core(acore), starsShaderProgram(NULL)
 {
@@ -58,6 +60,7 @@ StelSkyDrawer::StelSkyDrawer(StelCore* acore) : core(acore), starsShaderProgram(
 	inScale = 1.f;
 	bortleScaleIndex = 3;
 	limitMagnitude = -100.f;
+	qualityLimitMagnitude = 100.f;
 	limitLuminance = 0;
 	oldLum=-1.f;
 	maxLum = 0.f;
@@ -267,7 +270,11 @@ void StelSkyDrawer::update(double)
 	starLinearScale = std::pow(35.f*2.0f*starAbsoluteScaleF, 1.40f/2.f*starRelativeScale);
 
 	// update limit mag
+	qualityLimitMagnitude = 100.f;
 	limitMagnitude = computeLimitMagnitude();
+	// Drop the faintest point sources when the rendering is too slow. Each magnitude
+	// removed roughly divides the number of displayed stars by 3
+	qualityLimitMagnitude = limitMagnitude-(1.f-core->getRenderingQuality())*MAX_QUALITY_MAG_REDUCTION;
 
 	// update limit luminance
 	limitLuminance = computeLimitLuminance();
@@ -365,6 +372,12 @@ float StelSkyDrawer::luminanceToSurfacebrightness(float lum)
 // Compute RMag and CMag from magnitude for a point source.
 bool StelSkyDrawer::computeRCMag(float mag, float rcMag[2]) const
 {
+	if (mag>qualityLimitMagnitude)
+	{
+		rcMag[0] = rcMag[1] = 0.f;
+		return false;
+	}
+
 	rcMag[0] = eye->adaptLuminanceScaledLn(pointSourceMagToLnLuminance(mag), starRelativeScale*1.40f/2.f);
 	rcMag[0]*=starLinearScale;
 
@@ -603,6 +616,20 @@ void StelSkyDrawer::postDrawSky3dModel(StelPainter* painter, const Vec3f& v, flo
 	flagStarTwinkle = false;
 
 	float rcm[2];
+	computeSky3dModelRCMag(pixRadius, mag, rcm);
+
+	if (!noStarHalo)
+	{
+		preDrawPointSource(painter);
+		drawPointSource(painter, v,rcm,color);
+		postDrawPointSource(painter);
+	}
+	flagStarTwinkle=save;
+}
+
+// Compute the halo of a 3D model
+bool StelSkyDrawer::computeSky3dModelRCMag(float pixRadius, float mag, float rcm[2])
+{
 	computeRCMag(mag, rcm);
 
 	// We now have the radius and luminosity of the small halo
@@ -639,14 +666,7 @@ void StelSkyDrawer::postDrawSky3dModel(StelPainter* painter, const Vec3f& v, flo
 			reportLuminanceInFov(qMin(700.f, qMin(wl/50, (60.f*60.f)/(f*f)*6.f)));
 		}
 	}
-
-	if (!noStarHalo)
-	{
-		preDrawPointSource(painter);
-		drawPointSource(painter, v,rcm,color);
-		postDrawPointSource(painter);
-	}
-	flagStarTwinkle=save;
+	return rcm[0]>0.f;
 }
 
 float StelSkyDrawer::findWorldLumForMag(float mag, float targetRadius)
@@ -77,6 +77,14 @@ public:
 	//! @param color the object halo RGB color
 	void postDrawSky3dModel(StelPainter* p, const Vec3f& v, float illuminatedArea, float mag, const Vec3f& color = Vec3f(1.f,1.f,1.f));
 
+	//! Compute the radius and luminance of the halo of a 3D model, as drawn by postDrawSky3dModel().
+	//! The halo can then be drawn with drawPointSource(), so that the halos of many small models are drawn in one pass.
+	//! @param pixRadius the radius of the model disk in pixels
+	//! @param mag the source integrated magnitude
+	//! @param rcMag array of 2 floats receiving the radius and luminance
+	//! @return false if the halo is too faint to be displayed
+	bool computeSky3dModelRCMag(float pixRadius, float mag, float rcMag[2]);
+
 	//! Compute RMag and CMag from magnitude.
 	//! @param mag the object integrated V magnitude
 	//! @param rcMag array of 2 floats containing the radius and luminance
@@ -264,6 +272,8 @@ private:
 
 	//! Current magnitude limit for point sources
 	float limitMagnitude;
+	//! Point sources fainter than this are skipped to save time when the rendering quality is lowered
+	float qualityLimitMagnitude;
 
 	//! Current magnitude luminance
 	float limitLuminance;
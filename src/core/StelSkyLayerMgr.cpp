@@ -176,6 +176,9 @@ void StelSkyLayerMgr::loadingStateChanged(bool b)
 	Q_ASSERT(tile!=0);
 	SkyLayerElem* elem = skyLayerElemForLayer(tile);
 	Q_ASSERT(elem!=NULL);
+	// No progress bar when running without GUI, e.g. in benchmark mode
+	if (StelApp::getInstance().getGui()==NULL)
+		return;
 	if (b)
 	{
 		Q_ASSERT(elem->progressBar==NULL);
@@ -201,7 +204,8 @@ void StelSkyLayerMgr::percentLoadedChanged(int percentage)
 	Q_ASSERT(tile!=0);
 	SkyLayerElem* elem = skyLayerElemForLayer(tile);
 	Q_ASSERT(elem!=NULL);
-	Q_ASSERT(elem->progressBar!=NULL);
+	if (elem->progressBar==NULL)
+		return;
 	elem->progressBar->setValue(percentage);
 }
 
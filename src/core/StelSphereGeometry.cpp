@@ -308,11 +308,23 @@ SphericalRegionP SphericalRegion::getSubtractionDefault(const SphericalRegion* r
 // Returns whether a SphericalPolygon is contained into the region.
 bool SphericalCap::contains(const SphericalConvexPolygon& cvx) const
 {
-	foreach (const Vec3d& v, cvx.getConvexContour())
+	const QVector<Vec3d>& contour = cvx.getConvexContour();
+	foreach (const Vec3d& v, contour)
 	{
 		if (!contains(v))
 			return false;
 	}
+	if (d>=0. || contour.isEmpty())
+		return true;
+	// A cap larger than a half sphere is not convex, the polygon edges or inside can still reach the complementary cap
+	const SphericalCap complement(-n, -d);
+	if (cvx.contains(complement.n))
+		return false;
+	for (int i=0;i<contour.size();++i)
+	{
+		if (complement.intersectsArc(contour.at(i), contour.at((i+1)%contour.size())))
+			return false;
+	}
 	return true;
 }
 
@@ -323,32 +335,43 @@ bool SphericalCap::containsTriangle(const Vec3d* v) const
 
 bool SphericalCap::intersectsTriangle(const Vec3d* v) const
 {
-	if (contains(*v) || contains(*(v+1)) || contains(*(v+2)))
-		return true;
-	// No points of the triangle are inside the cap
-	if (d<=0)
-		return false;
+	return intersectsConvexContour(v, 3);
+}
 
-	if (!sideHalfSpaceIntersects(*v, *(v+1), *this) || !sideHalfSpaceIntersects(*(v+1), *(v+2), *this) || !sideHalfSpaceIntersects(*(v+2), *v, *this))
+bool SphericalCap::intersectsArc(const Vec3d& a, const Vec3d& b) const
+{
+	// The point of the great circle the closest to the cap center must be in the cap and on the arc
+	Vec3d m = a^b;
+	const double mLength = m.length();
+	if (mLength<1e-15)
 		return false;
-
-	// Warning!!!! There is a last case which is not managed!
-	// When all the points of the polygon are outside the circle but the halfspace of the corner the closest to the
-	// circle intersects the circle halfspace..
-	return true;
+	m *= 1./mLength;
+	const double nm = n*m;
+	if (nm*nm>=1.)
+		return false;
+	// Cosinus of the distance between the cap center and the great circle
+	const double cosDist = std::sqrt(1.-nm*nm);
+	if (cosDist<d)
+		return false;
+	const Vec3d p = n-m*nm;
+	return (a^p)*m>=0. && (p^b)*m>=0.;
 }
 
 bool SphericalCap::intersectsConvexContour(const Vec3d* vertice, int nbVertice) const
 {
+	if (nbVertice==0)
+		return false;
 	for (int i=0;i<nbVertice;++i)
 	{
 		if (contains(vertice[i]))
 			return true;
 	}
-	// No points of the convex polygon are inside the cap
+	// No points of the convex polygon are inside the cap. If the cap is larger than a half
+	// sphere, the polygon is then fully inside the complementary convex cap.
 	if (d<=0)
 		return false;
 
+	// Quick rejection if one side of the polygon separates it from the cap
 	for (int i=0;i<nbVertice-1;++i)
 	{
 		if (!sideHalfSpaceIntersects(vertice[i], vertice[i+1], *this))
@@ -357,19 +380,42 @@ bool SphericalCap::intersectsConvexContour(const Vec3d* vertice, int nbVertice)
 	if (!sideHalfSpaceIntersects(vertice[nbVertice-1], vertice[0], *this))
 		return false;
 
-	// Warning!!!! There is a last case which is not managed!
-	// When all the points of the polygon are outside the circle but the halfspace of the corner the closest to the
-	// circle intersects the circle halfspace..
-	return true;
+	// Else the cap is either fully inside the polygon, or it crosses at least one of the edges
+	bool centerInside = true;
+	for (int i=0;i<nbVertice && centerInside;++i)
+		centerInside = sideHalfSpaceContains(vertice[(i+1)%nbVertice], vertice[i], n);
+	if (centerInside)
+		return true;
+	for (int i=0;i<nbVertice;++i)
+	{
+		if (intersectsArc(vertice[i], vertice[(i+1)%nbVertice]))
+			return true;
+	}
+	return false;
 }
 
 // Returns whether a SphericalPolygon intersects the region.
 bool SphericalCap::intersects(const SphericalConvexPolygon& cvx) const
 {
-	// TODO This algo returns sometimes false positives!!
 	return intersectsConvexContour(cvx.getConvexContour().constData(), cvx.getConvexContour().size());
 }
 
+SphericalRegionP SphericalCap::getIntersection(const SphericalConvexPolygon& cvx) const
+{
+	return cvx.getIntersection(*this);
+}
+
+SphericalRegionP SphericalCap::getIntersection(const SphericalCap& cap) const
+{
+	if (!intersects(cap))
+		return EmptySphericalRegion::staticInstance;
+	if (contains(cap))
+		return SphericalRegionP(new SphericalCap(cap));
+	if (cap.contains(*this))
+		return SphericalRegionP(new SphericalCap(*this));
+	return SphericalRegion::getIntersection(cap);
+}
+
 bool SphericalCap::intersects(const SphericalPolygon& polyBase) const
 {
 	// Go through the full list of triangle
@@ -991,6 +1037,81 @@ bool SphericalConvexPolygon::intersects(const SphericalPolygon& poly) const
 	return false;
 }
 
+// Clip a convex contour by the halfspaces with aperture 90 deg of the given normals.
+// The contour is clipped in place, using the buffer for the intermediate results.
+static void clipConvexContour(QVarLengthArray<Vec3d, 16>& contour, const Vec3d* normals, int nbNormals)
+{
+	QVarLengthArray<Vec3d, 16> buffer;
+	for (int i=0;i<nbNormals && contour.size()>2;++i)
+	{
+		const Vec3d& m = normals[i];
+		buffer.clear();
+		for (int j=0;j<contour.size();++j)
+		{
+			const Vec3d& a = contour.at(j);
+			const Vec3d& b = contour.at((j+1)%contour.size());
+			const double da = m*a;
+			const double db = m*b;
+			if (da>=0.)
+				buffer.append(a);
+			// A vertex on the great circle is already added as a or as the next b, so only strict crossings add a point
+			if (da*db<0.)
+			{
+				// The edge crosses the great circle, add the crossing point
+				Vec3d v = a*(-db)+b*da;
+				v.normalize();
+				if (da<0.)
+					v = -v;
+				buffer.append(v);
+			}
+		}
+		contour = buffer;
+	}
+}
+
+// Create the region for a clipped contour, which is empty if the contour is degenerated.
+static SphericalRegionP createClippedRegion(const QVarLengthArray<Vec3d, 16>& contour)
+{
+	if (contour.size()<3)
+		return EmptySphericalRegion::staticInstance;
+	QVector<Vec3d> resContour;
+	resContour.reserve(contour.size());
+	for (int i=0;i<contour.size();++i)
+		resContour.append(contour.at(i));
+	return SphericalRegionP(new SphericalConvexPolygon(resContour));
+}
+
+SphericalRegionP SphericalConvexPolygon::getIntersection(const SphericalConvexPolygon& cvx) const
+{
+	if (!intersects(cvx))
+		return EmptySphericalRegion::staticInstance;
+	QVarLengthArray<Vec3d, 16> normals;
+	const QVector<Vec3d>& other = cvx.contour;
+	for (int i=0;i<other.size();++i)
+		normals.append(other.at((i+1)%other.size())^other.at(i));
+	QVarLengthArray<Vec3d, 16> res;
+	res.append(contour.constData(), contour.size());
+	clipConvexContour(res, normals.constData(), normals.size());
+	return createClippedRegion(res);
+}
+
+SphericalRegionP SphericalConvexPolygon::getIntersection(const SphericalCap& cap) const
+{
+	if (!intersects(cap))
+		return EmptySphericalRegion::staticInstance;
+	if (cap.contains(*this))
+		return SphericalRegionP(new SphericalConvexPolygon(contour));
+	if (contains(cap))
+		return SphericalRegionP(new SphericalCap(cap));
+	// Only a half sphere can be clipped exactly, other caps produce a non convex region
+	if (cap.d!=0.)
+		return SphericalRegion::getIntersection(cap);
+	QVarLengthArray<Vec3d, 16> res;
+	res.append(contour.constData(), contour.size());
+	clipConvexContour(res, &cap.n, 1);
+	return createClippedRegion(res);
+}
+
 // This algo is wrong
 void SphericalConvexPolygon::updateBoundingCap()
 {
@@ -267,6 +267,9 @@ private:
 class SphericalCap : public SphericalRegion
 {
 public:
+	// Avoid name hiding when overloading the virtual methods.
+	using SphericalRegion::getIntersection;
+
 	//! Construct a SphericalCap with a 90 deg aperture and an undefined direction.
 	SphericalCap() : d(0) {;}
 
@@ -318,6 +321,11 @@ public:
 	}
 	virtual bool intersects(const AllSkySphericalRegion&) const {return d<=1.;}
 
+	//! Return the intersection with a convex polygon, computed without tesselation when the result is convex or one of the regions.
+	virtual SphericalRegionP getIntersection(const SphericalConvexPolygon& r) const;
+	//! Return the intersection with a cap, computed without tesselation when one cap contains the other.
+	virtual SphericalRegionP getIntersection(const SphericalCap& r) const;
+
 	//! Serialize the region into a QVariant map matching the JSON format.
 	//! The format is ["CAP", [ra, dec], radius], with ra dec in degree in ICRS frame
 	//! and radius in degree (between 0 and 180 deg)
@@ -354,6 +362,10 @@ public:
 	//! Return whether the cap intersect with a convex contour defined by nbVertice.
 	bool intersectsConvexContour(const Vec3d* vertice, int nbVertice) const;
 
+	//! Return whether the great circle arc from a to b (shorter than 180 deg) intersects the cap.
+	//! The end points are assumed to be outside of the cap.
+	bool intersectsArc(const Vec3d& a, const Vec3d& b) const;
+
 	//! Return whether the cap contains the passed triangle.
 	bool containsTriangle(const Vec3d* vertice) const;
 
@@ -615,6 +627,7 @@ public:
 	// Avoid name hiding when overloading the virtual methods.
 	using SphericalRegion::intersects;
 	using SphericalRegion::contains;
+	using SphericalRegion::getIntersection;
 
 	//! Default constructor.
 	SphericalConvexPolygon() {;}
@@ -657,10 +670,14 @@ public:
 	virtual bool intersects(const SphericalPoint& r) const {return contains(r.n);}
 	virtual bool intersects(const AllSkySphericalRegion&) const {return true;}
 
+	//! Return the intersection with a convex polygon, computed by clipping this polygon with the sides of the other.
+	virtual SphericalRegionP getIntersection(const SphericalConvexPolygon& r) const;
+	//! Return the intersection with a cap, computed by clipping when the cap is a half sphere,
+	//! and without any computation when one region contains the other.
+	virtual SphericalRegionP getIntersection(const SphericalCap& r) const;
+
 	////////////////////////// TODO
 //	virtual SphericalRegionP getIntersection(const SphericalPolygon& r) const;
-//	virtual SphericalRegionP getIntersection(const SphericalConvexPolygon& r) const;
-//	virtual SphericalRegionP getIntersection(const SphericalCap& r) const;
 //	virtual SphericalRegionP getIntersection(const SphericalPoint& r) const;
 //	virtual SphericalRegionP getIntersection(const AllSkySphericalRegion& r) const;
 //	virtual SphericalRegionP getUnion(const SphericalPolygon& r) const;
@@ -25,11 +25,32 @@
 
 #include "StelToneReproducer.hpp"
 
+float StelToneReproducer::log2Table[StelToneReproducer::LOG_TABLE_SIZE+1];
+float StelToneReproducer::exp2Table[StelToneReproducer::LOG_TABLE_SIZE+1];
+
+void StelToneReproducer::initLogTables()
+{
+	static bool initialized = false;
+	if (initialized)
+		return;
+	for (int i=0;i<=LOG_TABLE_SIZE;++i)
+	{
+		log2Table[i] = std::log(0.5+0.5*i/LOG_TABLE_SIZE)/std::log(2.);
+		exp2Table[i] = std::pow(2., (double)i/LOG_TABLE_SIZE);
+	}
+	initialized = true;
+}
+
 /*********************************************************************
  Constructor: Set some default values to prevent bugs in case of bad use
 *********************************************************************/
 StelToneReproducer::StelToneReproducer() : Lda(50.f), Lwa(40000.f), oneOverMaxdL(1.f/100.f), lnOneOverMaxdL(std::log(1.f/100.f)), oneOverGamma(1.f/2.2222f)
 {
+	initLogTables();
+	alphaDa = alphaWa = alphaWaOverAlphaDa = 1.f;
+	term2 = term2TimesOneOverMaxdLpOneOverGamma = 1.f;
+	lnTerm2 = 0.f;
+
 	// Initialize  sensor
 	setInputScale();
 	
@@ -57,6 +78,19 @@ void StelToneReproducer::setInputScale(float scale)
 {
 	inputScale=scale;
 	lnInputScale = std::log(inputScale);
+	updateLogTerms();
+}
+
+/*********************************************************************
+ Update the coefficients of the conversions in the log domain
+*********************************************************************/
+void StelToneReproducer::updateLogTerms()
+{
+	const float lnPix0p0001 = -8.0656104861f;
+	lnAdaptScaledOffset = (lnInputScale+lnPix0p0001)*alphaWaOverAlphaDa+lnTerm2+lnOneOverMaxdL;
+	log2AdaptScaledFactor = lnAdaptScaledOffset*M_LOG2E;
+	log2AdaptFactor = log2AdaptScaledFactor-lnOneOverMaxdL*M_LOG2E;
+	log2DisplayFactor = (lnPix0p0001*alphaWaOverAlphaDa*oneOverGamma+std::log(term2TimesOneOverMaxdLpOneOverGamma))*M_LOG2E;
 }
 	
 /*********************************************************************
@@ -76,6 +110,7 @@ void StelToneReproducer::setDisplayAdaptationLuminance(float _Lda)
 	term2 = pow10((betaWa-betaDa)/alphaDa) / (M_PI*0.0001f);
 	lnTerm2 = std::log(term2);
 	term2TimesOneOverMaxdLpOneOverGamma = std::pow(term2*oneOverMaxdL, oneOverGamma);
+	updateLogTerms();
 }
 
 /*********************************************************************
@@ -95,6 +130,7 @@ void StelToneReproducer::setWorldAdaptationLuminance(float _Lwa)
 	term2 = pow10((betaWa-betaDa)/alphaDa) / (M_PI*0.0001f);
 	lnTerm2 = std::log(term2);
 	term2TimesOneOverMaxdLpOneOverGamma = std::pow(term2*oneOverMaxdL, oneOverGamma);
+	updateLogTerms();
 }
 
 
@@ -102,7 +138,7 @@ void StelToneReproducer::setWorldAdaptationLuminance(float _Lwa)
  Convert from xyY color system to RGB according to the adaptation
  The Y component is in cd/m^2
 *********************************************************************/
-void StelToneReproducer::xyYToRGB(float* color) const
+void StelToneReproducer::convertXyYToRGB(float* color, bool exact) const
 {
 	// 1. Hue conversion
 	// if log10Y>0.6, photopic vision only (with the cones, colors are seen)
@@ -112,7 +148,10 @@ void StelToneReproducer::xyYToRGB(float* color) const
 	{
 		// special case for s = 0 (x=0.25, y=0.25)
 		color[2] *= 0.5121445;
-		color[2] = std::pow((float)(color[2]*M_PI*0.0001f), alphaWaOverAlphaDa*oneOverGamma)* term2TimesOneOverMaxdLpOneOverGamma;
+		if (exact || !(color[2]>0.f))
+			color[2] = std::pow((float)(color[2]*M_PI*0.0001f), alphaWaOverAlphaDa*oneOverGamma)* term2TimesOneOverMaxdLpOneOverGamma;
+		else
+			color[2] = exp2FromTable(alphaWaOverAlphaDa*oneOverGamma*log2FromTable(color[2])+log2DisplayFactor);
 		color[0] = 0.787077*color[2];
 		color[1] = 0.9898434*color[2];
 		color[2] *= 1.9256125;
@@ -122,7 +161,8 @@ void StelToneReproducer::xyYToRGB(float* color) const
 	if (color[2]<3.9810717055349722)
 	{
 		// Compute s, ratio between scotopic and photopic vision
-		const float op = (std::log10(color[2]) + 2.f)/2.6f;
+		const float log10Y = exact ? std::log10(color[2]) : log2FromTable(color[2])*0.30102999566f;
+		const float op = (log10Y + 2.f)/2.6f;
 		const float s = op * op *(3.f - 2.f * op);
 		// Do the blue shift for scotopic vision simulation (night vision) [3]
 		// The "night blue" is x,y(0.25, 0.25)
@@ -135,7 +175,10 @@ void StelToneReproducer::xyYToRGB(float* color) const
 
 	// 2. Adapt the luminance value and scale it to fit in the RGB range [2]
 	// color[2] = std::pow(adaptLuminanceScaled(color[2]), oneOverGamma);
-	color[2] = std::pow((float)(color[2]*M_PI*0.0001f), alphaWaOverAlphaDa*oneOverGamma)* term2TimesOneOverMaxdLpOneOverGamma;
+	if (exact || !(color[2]>0.f))
+		color[2] = std::pow((float)(color[2]*M_PI*0.0001f), alphaWaOverAlphaDa*oneOverGamma)* term2TimesOneOverMaxdLpOneOverGamma;
+	else
+		color[2] = exp2FromTable(alphaWaOverAlphaDa*oneOverGamma*log2FromTable(color[2])+log2DisplayFactor);
 	
 	// Convert from xyY to XZY
 	const float X = color[0] * color[2] / color[1];
@@ -147,3 +190,23 @@ void StelToneReproducer::xyYToRGB(float* color) const
 	color[1] =-0.969258f *X + 1.87599f *Y + 0.0415557f*Z;
 	color[2] = 0.0134455f*X - 0.118373f*Y + 1.01527f  *Z;
 }
+
+void StelToneReproducer::xyYToRGB(float* xyY, int count, int stride) const
+{
+	for (int i=0;i<count;++i)
+		convertXyYToRGB(xyY+i*stride, false);
+}
+
+void StelToneReproducer::adaptLuminanceScaled(const float* worldLuminance, float* displayLuminance, int count) const
+{
+	for (int i=0;i<count;++i)
+		displayLuminance[i] = adaptLuminanceScaled(worldLuminance[i]);
+}
+
+void StelToneReproducer::adaptLuminanceScaledLn(const float* lnWorldLuminance, float* displayLuminance, int count, float pFact) const
+{
+	const float factor = alphaWaOverAlphaDa*pFact*(float)M_LOG2E;
+	const float offset = lnAdaptScaledOffset*pFact*(float)M_LOG2E;
+	for (int i=0;i<count;++i)
+		displayLuminance[i] = exp2FromTable(lnWorldLuminance[i]*factor+offset);
+}
@@ -19,6 +19,9 @@
 #ifndef _STELTONEREPRODUCER_HPP_
 #define _STELTONEREPRODUCER_HPP_
 
+#include <cmath>
+#include <QtGlobal>
+
 //! Converts tones in function of the eye adaptation to luminance.
 //! The aim is to get on the screen something which is perceptualy accurate,
 //! ie. to compress high dynamic range luminance to CRT display range.
@@ -46,6 +49,11 @@
 //!
 //! [4] "A Visibility Matching Tone Reproduction Operator for High Dynamic
 //! Range Scenes", G.W. Larson, H. Rushmeier, C. Piatko
+//!
+//! All the conversions are power laws of the luminance. They are computed in the log2 domain, using
+//! lookup tables of log2 and exp2 with a linear interpolation instead of std::pow and std::exp. The tables
+//! don't depend on the parameters, only the coefficients of the laws are precomputed when they change.
+//! The maximum relative error compared to the exact formulas is about 1e-5.
 class StelToneReproducer
 {
 public:
@@ -81,7 +89,10 @@ public:
 	//! This value is used to scale the RGB range
 	//! @param maxdL the maximum lumiance in cd/m^2. Initial default value is 120 cd/m^2
 	void setMaxDisplayLuminance(float maxdL)
-	{oneOverMaxdL = 1.f/maxdL; lnOneOverMaxdL=std::log(oneOverMaxdL); term2TimesOneOverMaxdLpOneOverGamma = std::pow(term2*oneOverMaxdL, oneOverGamma);}
+	{oneOverMaxdL = 1.f/maxdL; lnOneOverMaxdL=std::log(oneOverMaxdL); term2TimesOneOverMaxdLpOneOverGamma = std::pow(term2*oneOverMaxdL, oneOverGamma); updateLogTerms();}
+
+	//! Get the maximum luminance of the display in cd/m^2
+	float getMaxDisplayLuminance() const {return 1.f/oneOverMaxdL;}
 
 	//! Get the display gamma
 	//! @return the display gamma. Default value is 2.2222 for a CRT
@@ -90,12 +101,20 @@ public:
 	//! Set the display gamma
 	//! @param gamma the gamma. Initial default value is 2.2222
 	void setDisplayGamma(float gamma)
-	{oneOverGamma = 1.f/gamma; term2TimesOneOverMaxdLpOneOverGamma = std::pow(term2*oneOverMaxdL, oneOverGamma);}
+	{oneOverGamma = 1.f/gamma; term2TimesOneOverMaxdLpOneOverGamma = std::pow(term2*oneOverMaxdL, oneOverGamma); updateLogTerms();}
 
 	//! Return adapted luminance from world to display
 	//! @param worldLuminance the world luminance to convert in cd/m^2
 	//! @return the converted display luminance in cd/m^2
 	float adaptLuminance(float worldLuminance) const
+	{
+		if (!(worldLuminance>0.f))
+			return adaptLuminanceExact(worldLuminance);
+		return exp2FromTable(alphaWaOverAlphaDa*log2FromTable(worldLuminance)+log2AdaptFactor);
+	}
+
+	//! Same as adaptLuminance(), but computed with std::pow instead of the lookup tables.
+	float adaptLuminanceExact(float worldLuminance) const
 	{
 		return std::pow((float)(inputScale*worldLuminance*M_PI*0.0001f),alphaWaOverAlphaDa) * term2;
 	}
@@ -113,8 +132,13 @@ public:
 	//! @return the converted display luminance with 1 corresponding to full display white. The value can be more than 1 when saturation..
 	float adaptLuminanceScaled(float worldLuminance) const
 	{
-		return adaptLuminance(worldLuminance)*oneOverMaxdL;
+		if (!(worldLuminance>0.f))
+			return adaptLuminanceExact(worldLuminance)*oneOverMaxdL;
+		return exp2FromTable(alphaWaOverAlphaDa*log2FromTable(worldLuminance)+log2AdaptScaledFactor);
 	}
+
+	//! Apply adaptLuminanceScaled() to an array of count luminances.
+	void adaptLuminanceScaled(const float* worldLuminance, float* displayLuminance, int count) const;
 	
 	//! Return adapted luminance from display to world with 1 corresponding to full display white
 	//! @param displayLuminance the display luminance with 1 corresponding to full display white. The value can be more than 1 when saturation..
@@ -129,16 +153,34 @@ public:
 	//! @param pFact the power at whihc the result should be set. The default is 0.5 and therefore return the square root of the adapted luminance
 	//! @return the converted display set at the pFact power. Luminance with 1 corresponding to full display white. The value can be more than 1 when saturation..
 	float adaptLuminanceScaledLn(float lnWorldLuminance, float pFact=0.5f) const
+	{
+		return exp2FromTable((lnWorldLuminance*alphaWaOverAlphaDa+lnAdaptScaledOffset)*pFact*(float)M_LOG2E);
+	}
+
+	//! Same as adaptLuminanceScaledLn(), but computed with std::exp instead of the lookup tables.
+	float adaptLuminanceScaledLnExact(float lnWorldLuminance, float pFact=0.5f) const
 	{
 		const float lnPix0p0001 = -8.0656104861f;
 		return std::exp(((lnInputScale+lnWorldLuminance+lnPix0p0001)*alphaWaOverAlphaDa+lnTerm2+lnOneOverMaxdL)*pFact);
 	}
-	
+
+	//! Apply adaptLuminanceScaledLn() to an array of count ln(luminances).
+	void adaptLuminanceScaledLn(const float* lnWorldLuminance, float* displayLuminance, int count, float pFact=0.5f) const;
+
 	//! Convert from xyY color system to RGB.
 	//! The first two components x and y indicate the "color", the Y is luminance in cd/m^2.
 	//! @param xyY an array of 3 floats which are replaced by the converted RGB values
-	void xyYToRGB(float* xyY) const;
-	
+	void xyYToRGB(float* xyY) const {convertXyYToRGB(xyY, false);}
+
+	//! Convert an array of count xyY colors to RGB.
+	//! @param xyY the first color, which is replaced by the converted RGB values.
+	//! @param stride the number of floats between the start of two consecutive colors.
+	void xyYToRGB(float* xyY, int count, int stride=3) const;
+
+	//! Same as xyYToRGB(), but computed with std::pow and std::log10 instead of the lookup tables.
+	void xyYToRGBExact(float* xyY) const {convertXyYToRGB(xyY, true);}
+
+
 	void getShadersParams(float& a, float& b, float & c) const
 	{
 		a=alphaWaOverAlphaDa;
@@ -146,6 +188,42 @@ public:
 		c=term2TimesOneOverMaxdLpOneOverGamma;
 	}
 private:
+	//! Number of intervals of the log2 and exp2 lookup tables
+	static const int LOG_TABLE_SIZE = 512;
+	//! log2(m) for m in [0.5, 1] by steps of 0.5/LOG_TABLE_SIZE
+	static float log2Table[LOG_TABLE_SIZE+1];
+	//! 2^f for f in [0, 1] by steps of 1/LOG_TABLE_SIZE
+	static float exp2Table[LOG_TABLE_SIZE+1];
+	//! Fill the lookup tables the first time a StelToneReproducer is created
+	static void initLogTables();
+
+	//! Return log2(x) for x>0 from the binary exponent of x and the table of the log2 of its mantissa.
+	static float log2FromTable(float x)
+	{
+		int e;
+		const float m = std::frexp(x, &e);
+		const float u = (m-0.5f)*(2*LOG_TABLE_SIZE);
+		const int i = qMin((int)u, LOG_TABLE_SIZE-1);
+		return e + log2Table[i] + (u-i)*(log2Table[i+1]-log2Table[i]);
+	}
+
+	//! Return 2^y from the table of 2^f for the fractional part of y, scaled by the integer part.
+	static float exp2FromTable(float y)
+	{
+		// Below the smallest normal float, and for NaN
+		if (!(y>-126.f))
+			return 0.f;
+		const float fl = std::floor(y);
+		const float u = (y-fl)*LOG_TABLE_SIZE;
+		const int i = qMin((int)u, LOG_TABLE_SIZE-1);
+		return std::ldexp(exp2Table[i] + (u-i)*(exp2Table[i+1]-exp2Table[i]), (int)qMin(fl, 128.f));
+	}
+
+	//! Update the coefficients of the conversions in the log domain after a change of parameters.
+	void updateLogTerms();
+	//! Convert from xyY color system to RGB, using the lookup tables or the exact formulas.
+	void convertXyYToRGB(float* color, bool exact) const;
+
 	// The global luminance scaling
 	float inputScale;
 	float lnInputScale;		// std::log(inputScale)
@@ -166,6 +244,12 @@ private:
 	float lnTerm2;	// log(term2)
 	
 	float term2TimesOneOverMaxdLpOneOverGamma;
+
+	// Coefficients of the conversions in the log domain
+	float log2AdaptFactor;		// log2(adaptLuminance(1))
+	float log2AdaptScaledFactor;	// log2(adaptLuminanceScaled(1))
+	float lnAdaptScaledOffset;	// ln(adaptLuminanceScaledLn(0, 1))
+	float log2DisplayFactor;	// log2 of the adapted luminance with gamma for a luminance of 1
 };
 
 #endif // _STELTONEREPRODUCER_HPP_
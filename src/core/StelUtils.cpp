@@ -32,6 +32,9 @@
 #include <QDebug>
 #include <QLocale>
 #include <QRegExp>
+#include <QCache>
+#include <QMutex>
+#include <QVector>
 
 namespace StelUtils
 {
@@ -430,9 +433,9 @@ QDateTime jdToQDateTime(const double& jd)
 {
 	int year, month, day;
 	getDateFromJulianDay(jd, &year, &month, &day);
-	QDateTime result = QDateTime::fromString(QString("%1.%2.%3").arg(year, 4, 10, QLatin1Char('0')).arg(month).arg(day), "yyyy.M.d");
-	result.setTime(jdFractionToQTime(jd));
-	return result;
+	// Like the former parsing of a "yyyy.M.d" string, years before 1 give an invalid date
+	const QDate date = year>0 ? QDate(year, month, day) : QDate();
+	return QDateTime(date, jdFractionToQTime(jd));
 }
 
 
@@ -509,23 +512,111 @@ void getTimeFromJulianDay(double julianDay, int *hour, int *minute, int *second)
 	*second = s % 60;
 }
 
+void getDatesFromJulianDays(const double* julianDays, int count, int* years, int* months, int* days)
+{
+	static const long JD_GREG_CAL = 2299161;
+	long lastJulian = 0;
+	for (int i=0;i<count;++i)
+	{
+		const long julian = (long)floor(julianDays[i] + 0.5);
+		if (i>0 && julian==lastJulian)
+		{
+			years[i] = years[i-1];
+			months[i] = months[i-1];
+			days[i] = days[i-1];
+		}
+		else if (i>0 && julian==lastJulian+1 && days[i-1]<28 && julian!=JD_GREG_CAL)
+		{
+			// The next day is in the same month
+			years[i] = years[i-1];
+			months[i] = months[i-1];
+			days[i] = days[i-1]+1;
+		}
+		else
+		{
+			getDateFromJulianDay(julianDays[i], years+i, months+i, days+i);
+		}
+		lastJulian = julian;
+	}
+}
+
+void getTimesFromJulianDays(const double* julianDays, int count, int* hours, int* minutes, int* seconds)
+{
+	for (int i=0;i<count;++i)
+	{
+		const double frac = julianDays[i] - floor(julianDays[i]);
+		const int s = (int)floor((frac * 24.0 * 60.0 * 60.0) + 0.0001);
+		hours[i] = ((s / (60 * 60))+12)%24;
+		minutes[i] = (s/(60))%60;
+		seconds[i] = s % 60;
+	}
+}
+
+// Write the decimal digits of a positive value padded with zeros to width, and return the position after the last digit
+static QChar* writePaddedNumber(QChar* out, int value, int width)
+{
+	char digits[12];
+	int nb = 0;
+	do
+	{
+		digits[nb++] = '0' + value%10;
+		value /= 10;
+	} while (value>0);
+	for (int i=nb;i<width;++i)
+		*out++ = QLatin1Char('0');
+	while (nb>0)
+		*out++ = QLatin1Char(digits[--nb]);
+	return out;
+}
+
+// Format a date in ISO8601 directly in a character buffer, which is much cheaper than a chain of QString::arg()
+static QString formatISO8601(int year, int month, int day, int hour, int minute, int second)
+{
+	QChar buf[32];
+	QChar* out = buf;
+	if (year < 0)
+	{
+		*out++ = QLatin1Char('-');
+		year = -year;
+	}
+	out = writePaddedNumber(out, year, 4);
+	*out++ = QLatin1Char('-');
+	out = writePaddedNumber(out, month, 2);
+	*out++ = QLatin1Char('-');
+	out = writePaddedNumber(out, day, 2);
+	*out++ = QLatin1Char('T');
+	out = writePaddedNumber(out, hour, 2);
+	*out++ = QLatin1Char(':');
+	out = writePaddedNumber(out, minute, 2);
+	*out++ = QLatin1Char(':');
+	out = writePaddedNumber(out, second, 2);
+	return QString(buf, out-buf);
+}
+
 QString julianDayToISO8601String(double jd)
 {
 	int year, month, day, hour, minute, second;
 	getDateFromJulianDay(jd, &year, &month, &day);
 	getTimeFromJulianDay(jd, &hour, &minute, &second);
+	return formatISO8601(year, month, day, hour, minute, second);
+}
 
-	QString res = QString("%1-%2-%3T%4:%5:%6")
-				 .arg((year >= 0 ? year : -1* year),4,10,QLatin1Char('0'))
-				 .arg(month,2,10,QLatin1Char('0'))
-				 .arg(day,2,10,QLatin1Char('0'))
-				 .arg(hour,2,10,QLatin1Char('0'))
-				 .arg(minute,2,10,QLatin1Char('0'))
-				 .arg(second,2,10,QLatin1Char('0'));
-	if (year < 0)
-	{
-		res.prepend("-");
-	}
+QStringList julianDaysToISO8601Strings(const double* julianDays, int count)
+{
+	QVector<int> fields(6*count);
+	int* years = fields.data();
+	int* months = years+count;
+	int* days = months+count;
+	int* hours = days+count;
+	int* minutes = hours+count;
+	int* seconds = minutes+count;
+	getDatesFromJulianDays(julianDays, count, years, months, days);
+	getTimesFromJulianDays(julianDays, count, hours, minutes, seconds);
+
+	QStringList res;
+	res.reserve(count);
+	for (int i=0;i<count;++i)
+		res << formatISO8601(years[i], months[i], days[i], hours[i], minutes[i], seconds[i]);
 	return res;
 }
 
@@ -683,11 +774,12 @@ QTime jdFractionToQTime(double jd)
 	double decHours = std::fmod(jd+0.5, 1.0);
 	int hours = (int)(decHours/0.041666666666666666666);
 	int mins = (int)((decHours-(hours*0.041666666666666666666))/0.00069444444444444444444);
-	return QTime::fromString(QString("%1.%2").arg(hours).arg(mins), "h.m");
+	return QTime(hours, mins);
 }
 
 // Use Qt's own sense of time and offset instead of platform specific code.
-float getGMTShiftFromQT(double JD)
+// Return the offset from GMT in seconds.
+static int computeGMTShiftFromQT(double JD)
 {
 	int year, month, day, hour, minute, second;
 	getDateFromJulianDay(JD, &year, &month, &day);
@@ -710,9 +802,63 @@ float getGMTShiftFromQT(double JD)
 	//times to UTC if their zones have different daylight saving time rules.
 	local.setTimeSpec(Qt::UTC);
 
-	int shiftInSeconds = universal.secsTo(local);
-	float shiftInHours = shiftInSeconds / 3600.0f;
-	return shiftInHours;
+	return universal.secsTo(local);
+}
+
+// Precision of the dates of the UTC offset changes in days
+static const double GMT_SHIFT_PRECISION = 1./(24.*60.*60.);
+// Maximum number of days kept in the cache, the least recently used ones are removed first
+static const int GMT_SHIFT_MAX_DAYS = 4096;
+
+//! @struct GMTShiftDay
+//! The GMT shifts during one day starting at 0h UTC.
+//! The UTC offset of a time zone is assumed to change at most once a day.
+struct GMTShiftDay
+{
+	//! GMT shift in seconds at the start of the day
+	int startShift;
+	//! GMT shift in seconds at the end of the day
+	int endShift;
+	//! Julian Day at which the GMT shift changes from startShift to endShift, the end of the day if they are equal
+	double change;
+};
+
+float getGMTShiftFromQT(double JD)
+{
+	static QCache<int, GMTShiftDay> days(GMT_SHIFT_MAX_DAYS);
+	static QMutex mutex;
+	QMutexLocker locker(&mutex);
+
+	// The days start at 0h UTC, i.e. at the half Julian Days
+	const int dayNumber = (int)std::floor(JD+0.5);
+	GMTShiftDay* day = days.object(dayNumber);
+	if (day==NULL)
+	{
+		const double start = dayNumber-0.5;
+		const double end = start+1.;
+		day = new GMTShiftDay;
+		// The shifts at the boundaries are shared with the neighbour days when they are known
+		const GMTShiftDay* previous = days.object(dayNumber-1);
+		day->startShift = previous ? previous->endShift : computeGMTShiftFromQT(start);
+		const GMTShiftDay* next = days.object(dayNumber+1);
+		day->endShift = next ? next->startShift : computeGMTShiftFromQT(end);
+		day->change = end;
+		if (day->startShift!=day->endShift)
+		{
+			// Bisect the time of the change down to the second
+			double inside = start;
+			while (day->change-inside>GMT_SHIFT_PRECISION)
+			{
+				const double middle = 0.5*(inside+day->change);
+				if (computeGMTShiftFromQT(middle)==day->startShift)
+					inside = middle;
+				else
+					day->change = middle;
+			}
+		}
+		days.insert(dayNumber, day);
+	}
+	return (JD<day->change ? day->startShift : day->endShift) / 3600.0f;
 }
 
 // UTC !
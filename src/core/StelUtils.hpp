@@ -25,6 +25,7 @@
 #include <QVariantMap>
 #include <QDateTime>
 #include <QString>
+#include <QStringList>
 
 // astonomical unit (km)
 #define AU 149597870.691
@@ -187,6 +188,18 @@ namespace StelUtils
 	//! Make from julianDay an hour, minute, second.
 	void getTimeFromJulianDay(double julianDay, int *hour, int *minute, int *second);
 
+	//! Make from an array of Julian Days the year, month, day of each of them.
+	//! Gives the same results as getDateFromJulianDay(), but the date of a Julian Day falling
+	//! on the same day or on the day after the previous one is derived from the previous date,
+	//! so that converting sorted tables with many rows per day or one row per day is cheap.
+	//! @param julianDays the array of count Julian Days.
+	//! @param years, months, days arrays of count elements receiving the dates.
+	void getDatesFromJulianDays(const double* julianDays, int count, int* years, int* months, int* days);
+
+	//! Make from an array of Julian Days the hour, minute, second of each of them.
+	//! Gives the same results as getTimeFromJulianDay().
+	void getTimesFromJulianDays(const double* julianDays, int count, int* hours, int* minutes, int* seconds);
+
 	//! Parse an ISO8601 date string.
 	//! Also handles negative and distant years.
 	bool getDateTimeFromISO8601String(const QString& iso8601Date, int* y, int* m, int* d, int* h, int* min, float* s);
@@ -195,6 +208,10 @@ namespace StelUtils
 	//! Also handles negative and distant years.
 	QString julianDayToISO8601String(double jd);
 
+	//! Format an array of Julian Days in (UTC) ISO8601 date strings.
+	//! Gives the same results as julianDayToISO8601String(), for the cost of one string allocation per date.
+	QStringList julianDaysToISO8601Strings(const double* julianDays, int count);
+
 	//! Return the Julian Date matching the ISO8601 date string.
 	//! Also handles negative and distant years.
 	double getJulianDayFromISO8601String(const QString& iso8601Date, bool* ok);
@@ -220,6 +237,10 @@ namespace StelUtils
 	QTime jdFractionToQTime(double jd);
 
 	//! Return number of hours offset from GMT, using Qt functions.
+	//! The offsets are cached for each UTC day, with the offsets at the start and the end of the day and the time
+	//! of the change between them, which is bisected down to the second. A day missing from the cache costs one or
+	//! two calls to Qt, unless the offset changes during it. This assumes that the UTC offset of the system time zone
+	//! changes at most once a day, and that the system time zone doesn't change while running.
 	float getGMTShiftFromQT(double jd);
 
 	//! Convert a QT QDateTime class to julian day.
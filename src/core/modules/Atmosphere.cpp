@@ -40,10 +40,11 @@ inline bool myisnan(double value)
 	return value != value;
 }
 
-Atmosphere::Atmosphere(void) :viewport(0,0,0,0), posGrid(NULL), colorGrid(NULL), indices(NULL),
+Atmosphere::Atmosphere(void) :viewport(0,0,0,0), skyResolutionY(0), skyResolutionX(0), posGrid(NULL), colorGrid(NULL), indices(NULL),
 					   averageLuminance(0.f), eclipseFactor(1.f), lightPollutionLuminance(0)
 {
 	setFadeDuration(1.5f);
+	fullQualityResolutionY = StelApp::getInstance().getSettings()->value("landscape/atmosphereybin", 44).toInt();
 	useShader = StelApp::getInstance().getUseGLShaders();
 	if (useShader)
 	{
@@ -138,9 +139,11 @@ void Atmosphere::computeColor(double JD, Vec3d _sunPos, Vec3d moonPos, float moo
 							   StelCore* core, float latitude, float altitude, float temperature, float relativeHumidity)
 {
 	const StelProjectorP prj = core->getProjection(StelCore::FrameAltAz, StelCore::RefractionOff);
-	if (viewport != prj->getViewport())
+	// Use a coarser grid when the rendering quality is lowered
+	const int wantedResolutionY = qMax(8, (int)(fullQualityResolutionY*(0.4f+0.6f*core->getRenderingQuality())+0.5f));
+	if (viewport != prj->getViewport() || wantedResolutionY != skyResolutionY)
 	{
-		// The viewport changed: update the number of point of the grid
+		// The viewport or the quality changed: update the number of point of the grid
 		viewport = prj->getViewport();
 		if (posGrid)
 			delete[] posGrid;
@@ -148,7 +151,7 @@ void Atmosphere::computeColor(double JD, Vec3d _sunPos, Vec3d moonPos, float moo
 			delete[] colorGrid;
 		if (indices)
 			delete[] indices;
-		skyResolutionY = StelApp::getInstance().getSettings()->value("landscape/atmosphereybin", 44).toInt();
+		skyResolutionY = wantedResolutionY;
 		skyResolutionX = (int)floor(0.5+skyResolutionY*(0.5*sqrt(3.0))*prj->getViewportWidth()/prj->getViewportHeight());
 		posGrid = new Vec2f[(1+skyResolutionX)*(1+skyResolutionY)];
 		colorGrid = new Vec4f[(1+skyResolutionX)*(1+skyResolutionY)];
@@ -388,12 +391,10 @@ void Atmosphere::draw(StelCore* core)
 	{
 		// No shader is available on this graphics card, compute colors with the CPU
 		// Adapt luminance at this point to avoid a mismatch with the adaptation value
-		for (int i=0;i<(1+skyResolutionX)*(1+skyResolutionY);++i)
-		{
-			Vec4f& c = colorGrid[i];
-			eye->xyYToRGB(c);
-			c*=atm_intensity;
-		}
+		const int nbVertices = (1+skyResolutionX)*(1+skyResolutionY);
+		eye->xyYToRGB((float*)colorGrid, nbVertices, 4);
+		for (int i=0;i<nbVertices;++i)
+			colorGrid[i]*=atm_intensity;
 		sPainter.setShadeModel(StelPainter::ShadeModelSmooth);
 		sPainter.enableClientStates(true, false, true, false);
 		sPainter.setColorPointer(4, GL_FLOAT, colorGrid);
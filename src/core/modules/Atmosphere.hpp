@@ -84,6 +84,8 @@ private:
 	Skylight sky;
 	Skybright skyb;
 	int skyResolutionY,skyResolutionX;
+	//! The number of grid rows at full rendering quality
+	int fullQualityResolutionY;
 
 	Vec2f* posGrid;
 	Vec4f* colorGrid;
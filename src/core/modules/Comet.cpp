@@ -57,9 +57,7 @@ Comet::Comet(const QString& englishName,
 								  false) //No atmosphere
 {
 	texMapName = atexMapName;
-	lastOrbitJD =0;
 	deltaJD = StelCore::JD_SECOND;
-	orbitCached = 0;
 	closeOrbit = acloseOrbit;
 
 	eclipticPos=Vec3d(0.,0.,0.);
@@ -95,6 +93,7 @@ void Comet::setAbsoluteMagnitudeAndSlope(double magnitude, double slope)
 
 	absoluteMagnitude = magnitude;
 	slopeParameter = slope;
+	photometryStamp = 0;
 }
 
 QString Comet::getInfoString(const StelCore *core, const InfoStringGroup &flags) const
@@ -163,34 +162,18 @@ QString Comet::getInfoString(const StelCore *core, const InfoStringGroup &flags)
 	return str;
 }
 
-float Comet::getVMagnitude(const StelCore* core, bool withExtinction) const
+float Comet::computeMagnitudeWithoutExtinction(const StelCore* core, const Photometry& ph) const
 {
 	//If the two parameter system is not used,
 	//use the default radius/albedo mechanism
 	if (slopeParameter < 0)
 	{
-		return Planet::getVMagnitude(core, withExtinction);
+		return Planet::computeMagnitudeWithoutExtinction(core, ph);
 	}
 
-	float extinctionMag=0.0; // track magnitude loss
-	if (withExtinction && core->getSkyDrawer()->getFlagHasAtmosphere())
-	{
-	    Vec3d altAz=getAltAzPosApparent(core);
-	    altAz.normalize();
-	    core->getSkyDrawer()->getExtinction().forward(&altAz[2], &extinctionMag);
-	}
-
-	//Calculate distances
-	const Vec3d& observerHeliocentricPosition = core->getObserverHeliocentricEclipticPos();
-	const Vec3d& cometHeliocentricPosition = getHeliocentricEclipticPos();
-	const double cometSunDistance = std::sqrt(cometHeliocentricPosition.lengthSquared());
-	const double observerCometDistance = std::sqrt((observerHeliocentricPosition - cometHeliocentricPosition).lengthSquared());
-
 	//Calculate apparent magnitude
 	//Sources: http://www.clearskyinstitute.com/xephem/help/xephem.html#mozTocId564354
 	//(XEphem manual, section 7.1.2.3 "Magnitude models"), also
 	//http://www.ayton.id.au/gary/Science/Astronomy/Ast_comets.htm#Comet%20facts:
-	double apparentMagnitude = absoluteMagnitude + 5 * std::log10(observerCometDistance) + 2.5 * slopeParameter * std::log10(cometSunDistance);
-
-	return apparentMagnitude + extinctionMag;
+	return absoluteMagnitude + 5 * std::log10(ph.observerDistance) + 2.5 * slopeParameter * std::log10(ph.sunDistance);
 }
@@ -64,8 +64,6 @@ public:
 	//The Comet class inherits the "Planet" type because the SolarSystem class
 	//was not designed to handle different types of objects.
 	//virtual QString getType() const {return "Comet";}
-	//! \todo Find better sources for the g,k system
-	virtual float getVMagnitude(const StelCore* core, bool withExtinction=false) const;
 
 	//! \brief sets absolute magnitude and slope parameter.
 	//! These are the parameters in the IAU's two-parameter magnitude system
@@ -74,6 +72,11 @@ public:
 	//! as the same parameters in MinorPlanet.
 	void setAbsoluteMagnitudeAndSlope(double magnitude, double slope);
 
+protected:
+	//! Compute the magnitude with the g,k system, or with the albedo if it is not used.
+	//! \todo Find better sources for the g,k system
+	virtual float computeMagnitudeWithoutExtinction(const StelCore* core, const Photometry& ph) const;
+
 private:
 	double absoluteMagnitude;
 	double slopeParameter;
@@ -0,0 +1,100 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "CompiledCacheFile.hpp"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QDataStream>
+#include <QCryptographicHash>
+#include <QSysInfo>
+#include <QDebug>
+
+CompiledCacheFile::SourceSignature CompiledCacheFile::computeSignature(const QString& path)
+{
+	SourceSignature s;
+	s.path = path;
+	s.size = 0;
+	s.lastModified = 0;
+	if (path.isEmpty())
+		return s;
+	QFileInfo info(path);
+	s.size = info.size();
+	s.lastModified = info.lastModified().toTime_t();
+	QFile file(path);
+	if (file.open(QIODevice::ReadOnly))
+		s.md5 = QCryptographicHash::hash(file.readAll(), QCryptographicHash::Md5);
+	return s;
+}
+
+void CompiledCacheFile::writeHeader(QDataStream& out, quint32 magic, quint32 version, const QVector<SourceSignature>& sources)
+{
+	out << magic << version << (quint8)QSysInfo::ByteOrder;
+	out << (qint32)sources.size();
+	foreach (const SourceSignature& s, sources)
+		out << s.path << s.size << s.lastModified << s.md5;
+}
+
+bool CompiledCacheFile::readHeader(QDataStream& in, quint32 magic, quint32 version, const QStringList& sourceFiles,
+								   const char* name, QVector<SourceSignature>& sources, bool& refreshed)
+{
+	refreshed = false;
+	quint32 fileMagic, fileVersion;
+	quint8 byteOrder;
+	in >> fileMagic >> fileVersion >> byteOrder;
+	if (in.status()!=QDataStream::Ok || fileMagic!=magic || fileVersion!=version || byteOrder!=(quint8)QSysInfo::ByteOrder)
+	{
+		qDebug() << name << "cache file has an other format, it will be rebuilt";
+		return false;
+	}
+
+	// Check that the sources didn't change
+	qint32 nbSources;
+	in >> nbSources;
+	if (in.status()!=QDataStream::Ok || nbSources!=sourceFiles.size())
+		return false;
+	QVector<SourceSignature> signatures;
+	for (int i=0;i<nbSources;++i)
+	{
+		SourceSignature s;
+		in >> s.path >> s.size >> s.lastModified >> s.md5;
+		if (in.status()!=QDataStream::Ok || s.path!=sourceFiles.at(i))
+			return false;
+		if (!s.path.isEmpty())
+		{
+			QFileInfo info(s.path);
+			if (info.size()!=s.size || (qint64)info.lastModified().toTime_t()!=s.lastModified)
+			{
+				// The file may have been touched or copied without any change
+				const SourceSignature current = computeSignature(s.path);
+				if (current.md5!=s.md5)
+				{
+					qDebug() << name << "source file" << s.path << "changed, the cache will be rebuilt";
+					return false;
+				}
+				s = current;
+				refreshed = true;
+			}
+		}
+		signatures << s;
+	}
+	sources = signatures;
+	return true;
+}
@@ -0,0 +1,69 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _COMPILEDCACHEFILE_HPP_
+#define _COMPILEDCACHEFILE_HPP_
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QByteArray>
+
+class QDataStream;
+
+//! @class CompiledCacheFile
+//! Header of the binary cache files in which the catalogs compiled from text data files are stored.
+//! The header identifies the format of the file, and records the signature of each source file
+//! so that the cache can be rebuilt when one of them changes.
+class CompiledCacheFile
+{
+public:
+	//! @struct SourceSignature
+	//! What is needed to check whether a source file changed since the cache was compiled.
+	struct SourceSignature
+	{
+		QString path;
+		qint64 size;
+		qint64 lastModified;
+		QByteArray md5;
+	};
+
+	//! Compute the signature of a source file. An empty path gives an empty signature.
+	static SourceSignature computeSignature(const QString& path);
+
+	//! Write the header of a cache file.
+	//! @param magic identify the kind of cache file.
+	//! @param version the format version, which must be increased at each format change.
+	//! @param sources the signatures of the source files of the compiled data.
+	static void writeHeader(QDataStream& out, quint32 magic, quint32 version, const QVector<SourceSignature>& sources);
+
+	//! Read and check the header of a cache file.
+	//! The md5 of a source file is only recomputed when its size or modification time changed.
+	//! @param magic, version the expected values.
+	//! @param sourceFiles the expected source files, in the order they were given when compiling.
+	//! @param name the name of the cached data used in the debug messages, e.g. "Nebula".
+	//! @param sources filled with the up to date signatures of the source files.
+	//! @param refreshed set to true if the signature of a source which was touched without being changed
+	//! was recomputed, in which case the cache file should be saved again to avoid recomputing it at each load.
+	//! @return false if the file has an other format or if one of the sources changed.
+	static bool readHeader(QDataStream& in, quint32 magic, quint32 version, const QStringList& sourceFiles,
+						   const char* name, QVector<SourceSignature>& sources, bool& refreshed);
+};
+
+#endif // _COMPILEDCACHEFILE_HPP_
@@ -0,0 +1,354 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "CompiledNebulaCatalog.hpp"
+#include "StelFileMgr.hpp"
+#include "StelUtils.hpp"
+#include "StelGeodesicGrid.hpp"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QDataStream>
+#include <QTextStream>
+#include <QRegExp>
+#include <QHash>
+#include <QDebug>
+
+// Identify the cache files, and their format version which must be increased at each format change
+static const quint32 CACHE_FILE_MAGIC = 0x4E474343;
+static const quint32 CACHE_FILE_VERSION = 2;
+
+// Write an array of primitive values in native byte order so that it can be read in one block
+template<class T> static void writeArray(QDataStream& out, const QVector<T>& array)
+{
+	out << (qint32)array.size();
+	out.writeRawData((const char*)array.constData(), array.size()*sizeof(T));
+}
+
+template<class T> static bool readArray(QDataStream& in, QVector<T>& array)
+{
+	qint32 size;
+	in >> size;
+	// Check the size before allocating, a corrupted file could ask for much more than it contains
+	if (in.status()!=QDataStream::Ok || size<0 || (qint64)size>in.device()->bytesAvailable()/(qint64)sizeof(T))
+		return false;
+	array.resize(size);
+	const int bytes = size*sizeof(T);
+	return in.readRawData((char*)array.data(), bytes)==bytes;
+}
+
+// Return whether the offsets start at 0, never decrease and end at the given size, so that every range they define is valid
+static bool checkOffsets(const QVector<int>& offsets, int size)
+{
+	if (offsets.isEmpty() || offsets.first()!=0 || offsets.last()!=size)
+		return false;
+	for (int i=1;i<offsets.size();++i)
+	{
+		if (offsets.at(i)<offsets.at(i-1))
+			return false;
+	}
+	return true;
+}
+
+QString CompiledNebulaCatalog::getCacheFilePath(const QString& setName)
+{
+	return StelFileMgr::getUserDir() + "/cache/nebulae/" + setName + ".dat";
+}
+
+bool CompiledNebulaCatalog::compile(const QString& catalogFile, const QString& namesFile)
+{
+	sources.clear();
+	sources << CompiledCacheFile::computeSignature(catalogFile) << CompiledCacheFile::computeSignature(namesFile);
+	if (!parseCatalog(catalogFile))
+		return false;
+	const QStringList names = namesFile.isEmpty() ? QStringList() : parseNames(namesFile);
+	sortByZone(names);
+	return true;
+}
+
+bool CompiledNebulaCatalog::parseCatalog(const QString& catalogFile)
+{
+	positions.clear();
+	magnitudes.clear();
+	angularSizes.clear();
+	types.clear();
+	ngcNumbers.clear();
+	icNumbers.clear();
+	messierNumbers.clear();
+
+	QFile in(catalogFile);
+	if (!in.open(QIODevice::ReadOnly))
+	{
+		qWarning() << "Can't open NGC data file" << catalogFile;
+		return false;
+	}
+	QDataStream ins(&in);
+	ins.setVersion(QDataStream::Qt_4_5);
+
+	bool isIc;
+	int nb;
+	float ra, dec, mag, angularSize;
+	unsigned int type;
+	Vec3f XYZ;
+	while (!ins.atEnd())
+	{
+		ins >> isIc >> nb >> ra >> dec >> mag >> angularSize >> type;
+		if (ins.status()!=QDataStream::Ok)
+		{
+			qWarning() << "ERROR while reading NGC data file" << catalogFile;
+			break;
+		}
+		StelUtils::spheToRect(ra, dec, XYZ);
+		positions.append(XYZ);
+		magnitudes.append(mag);
+		angularSizes.append(angularSize);
+		types.append((quint8)type);
+		ngcNumbers.append(isIc ? 0 : nb);
+		icNumbers.append(isIc ? nb : 0);
+		messierNumbers.append(0);
+	}
+	in.close();
+	qDebug() << "Compiled" << positions.size() << "NGC records";
+	return true;
+}
+
+QStringList CompiledNebulaCatalog::parseNames(const QString& namesFile)
+{
+	QStringList names;
+	for (int i=0;i<positions.size();++i)
+		names << QString();
+
+	QFile ngcNameFile(namesFile);
+	if (!ngcNameFile.open(QIODevice::ReadOnly | QIODevice::Text))
+	{
+		qWarning() << "NGC name data file" << namesFile << "not found.";
+		return names;
+	}
+
+	QHash<unsigned int, int> ngcIndex;
+	QHash<unsigned int, int> icIndex;
+	for (int i=positions.size()-1;i>=0;--i)
+	{
+		if (ngcNumbers.at(i)!=0)
+			ngcIndex.insert(ngcNumbers.at(i), i);
+		if (icNumbers.at(i)!=0)
+			icIndex.insert(icNumbers.at(i), i);
+	}
+
+	QString name, record;
+	int totalRecords=0;
+	int lineNumber=0;
+	int readOk=0;
+	QRegExp commentRx("^(\\s*#.*|\\s*)$");
+	QRegExp transRx("_[(]\"(.*)\"[)]");
+	while (!ngcNameFile.atEnd())
+	{
+		record = QString::fromUtf8(ngcNameFile.readLine());
+		lineNumber++;
+		if (commentRx.exactMatch(record))
+			continue;
+
+		totalRecords++;
+		const unsigned int nb = record.mid(38,4).toInt();
+		const QHash<unsigned int, int>& index = record[37]=='I' ? icIndex : ngcIndex;
+		const int e = index.value(nb, -1);
+
+		// get name, trimmed of whitespace
+		name = record.left(36).trimmed();
+
+		if (e<0)
+		{
+			qWarning() << "no position data for " << name << "at line" << lineNumber << "of" << namesFile;
+			continue;
+		}
+
+		// If the name is not a messier number perhaps one is already
+		// defined for this object
+		if (name.left(2).toUpper() != "M ")
+		{
+			if (transRx.exactMatch(name))
+				names[e] = transRx.capturedTexts().at(1).trimmed();
+			else
+				names[e] = name;
+		}
+		else
+		{
+			// If it's a messiernumber, we will call it a messier if there is no better name
+			name = name.mid(2); // remove "M "
+
+			// read the Messier number
+			QTextStream istr(&name);
+			int num;
+			istr >> num;
+			if (istr.status()!=QTextStream::Ok)
+			{
+				qWarning() << "cannot read Messier number at line" << lineNumber << "of" << namesFile;
+				continue;
+			}
+			messierNumbers[e] = num;
+			names[e] = QString("M%1").arg(num);
+		}
+		readOk++;
+	}
+	ngcNameFile.close();
+	qDebug() << "Compiled" << readOk << "/" << totalRecords << "NGC name records successfully";
+	return names;
+}
+
+void CompiledNebulaCatalog::sortByZone(const QStringList& names)
+{
+	const StelGeodesicGrid grid(ZONE_LEVEL);
+	const int nbZones = StelGeodesicGrid::nrOfZones(ZONE_LEVEL);
+	const int nb = positions.size();
+
+	// Counting sort of the entries by zone, keeping the catalogue order inside a zone
+	QVector<int> zones(nb);
+	zoneOffsets.fill(0, nbZones+1);
+	for (int i=0;i<nb;++i)
+	{
+		zones[i] = grid.getZoneNumberForPoint(positions.at(i), ZONE_LEVEL);
+		++zoneOffsets[zones.at(i)+1];
+	}
+	for (int z=0;z<nbZones;++z)
+		zoneOffsets[z+1] += zoneOffsets.at(z);
+	QVector<int> newIndices(nb);
+	QVector<int> next(zoneOffsets);
+	for (int i=0;i<nb;++i)
+		newIndices[i] = next[zones.at(i)]++;
+
+	QVector<Vec3f> newPositions(nb);
+	QVector<float> newMagnitudes(nb);
+	QVector<float> newAngularSizes(nb);
+	QVector<quint8> newTypes(nb);
+	QVector<quint32> newNgcNumbers(nb);
+	QVector<quint32> newIcNumbers(nb);
+	QVector<quint32> newMessierNumbers(nb);
+	QVector<QByteArray> newNames(nb);
+	for (int i=0;i<nb;++i)
+	{
+		const int j = newIndices.at(i);
+		newPositions[j] = positions.at(i);
+		newMagnitudes[j] = magnitudes.at(i);
+		newAngularSizes[j] = angularSizes.at(i);
+		newTypes[j] = types.at(i);
+		newNgcNumbers[j] = ngcNumbers.at(i);
+		newIcNumbers[j] = icNumbers.at(i);
+		newMessierNumbers[j] = messierNumbers.at(i);
+		if (i<names.size())
+			newNames[j] = names.at(i).toUtf8();
+	}
+	positions = newPositions;
+	magnitudes = newMagnitudes;
+	angularSizes = newAngularSizes;
+	types = newTypes;
+	ngcNumbers = newNgcNumbers;
+	icNumbers = newIcNumbers;
+	messierNumbers = newMessierNumbers;
+
+	namePool.clear();
+	nameOffsets.resize(nb+1);
+	for (int i=0;i<nb;++i)
+	{
+		nameOffsets[i] = namePool.size();
+		namePool += newNames.at(i);
+	}
+	nameOffsets[nb] = namePool.size();
+}
+
+bool CompiledNebulaCatalog::load(const QString& cacheFile, const QStringList& sourceFiles)
+{
+	QFile file(cacheFile);
+	if (!file.open(QIODevice::ReadOnly))
+		return false;
+
+	// Read directly from the mapped file when possible, so that the bulk arrays are only copied once
+	const qint64 fileSize = file.size();
+	uchar* mapped = file.map(0, fileSize);
+	const QByteArray buf = mapped ? QByteArray::fromRawData((const char*)mapped, fileSize) : file.readAll();
+	QDataStream in(buf);
+	in.setVersion(QDataStream::Qt_4_6);
+
+	QVector<SourceSignature> signatures;
+	bool refreshed;
+	if (!CompiledCacheFile::readHeader(in, CACHE_FILE_MAGIC, CACHE_FILE_VERSION, sourceFiles, "Nebula", signatures, refreshed))
+		return false;
+	qint32 zoneLevel;
+	in >> zoneLevel;
+	if (in.status()!=QDataStream::Ok || zoneLevel!=ZONE_LEVEL)
+		return false;
+
+	CompiledNebulaCatalog c;
+	if (!readArray(in, c.positions) || !readArray(in, c.magnitudes) || !readArray(in, c.angularSizes) ||
+		!readArray(in, c.types) || !readArray(in, c.ngcNumbers) || !readArray(in, c.icNumbers) ||
+		!readArray(in, c.messierNumbers) || !readArray(in, c.nameOffsets) || !readArray(in, c.zoneOffsets))
+		return false;
+	in >> c.namePool;
+	const int nb = c.positions.size();
+	if (in.status()!=QDataStream::Ok || c.magnitudes.size()!=nb || c.angularSizes.size()!=nb || c.types.size()!=nb ||
+		c.ngcNumbers.size()!=nb || c.icNumbers.size()!=nb || c.messierNumbers.size()!=nb || c.nameOffsets.size()!=nb+1 ||
+		c.zoneOffsets.size()!=StelGeodesicGrid::nrOfZones(ZONE_LEVEL)+1 ||
+		!checkOffsets(c.nameOffsets, c.namePool.size()) || !checkOffsets(c.zoneOffsets, nb))
+		return false;
+
+	*this = c;
+	sources = signatures;
+	if (refreshed)
+	{
+		// Release the mapping before overwriting the file with the refreshed signatures
+		if (mapped)
+			file.unmap(mapped);
+		file.close();
+		save(cacheFile);
+	}
+	return true;
+}
+
+bool CompiledNebulaCatalog::save(const QString& cacheFile) const
+{
+	StelFileMgr::mkDir(QFileInfo(cacheFile).absolutePath());
+	QFile file(cacheFile);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+	{
+		qWarning() << "Can't write nebula cache file" << cacheFile;
+		return false;
+	}
+
+	QDataStream out(&file);
+	out.setVersion(QDataStream::Qt_4_6);
+	CompiledCacheFile::writeHeader(out, CACHE_FILE_MAGIC, CACHE_FILE_VERSION, sources);
+	out << (qint32)ZONE_LEVEL;
+	writeArray(out, positions);
+	writeArray(out, magnitudes);
+	writeArray(out, angularSizes);
+	writeArray(out, types);
+	writeArray(out, ngcNumbers);
+	writeArray(out, icNumbers);
+	writeArray(out, messierNumbers);
+	writeArray(out, nameOffsets);
+	writeArray(out, zoneOffsets);
+	out << namePool;
+	file.close();
+	if (out.status()!=QDataStream::Ok)
+	{
+		qWarning() << "Error while writing nebula cache file" << cacheFile;
+		QFile::remove(cacheFile);
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,109 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _COMPILEDNEBULACATALOG_HPP_
+#define _COMPILEDNEBULACATALOG_HPP_
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QByteArray>
+
+#include "VecMath.hpp"
+#include "CompiledCacheFile.hpp"
+
+//! @class CompiledNebulaCatalog
+//! The NGC/IC catalogue of a nebula set with the nebula names, in a form ready to be drawn by the NebulaMgr.
+//! Each field of the entries is stored in its own array, and the names are stored in one UTF-8 string pool.
+//! The entries are sorted by zone of the geodesic grid at level ZONE_LEVEL, so that the entries of a zone
+//! are contiguous and the visible ones can be found from a geodesic grid search result.
+//! The data is compiled once from ngc2000.dat and ngc2000names.dat, then saved in a binary cache file in
+//! the user directory. The next times, the cache file is memory mapped and each array is read in one bulk copy.
+//! The cache is rebuilt when its format version changes, or when one of the source files changed.
+class CompiledNebulaCatalog
+{
+public:
+	//! Level of the geodesic grid used to sort the entries.
+	static const int ZONE_LEVEL = 3;
+
+	//! Compile the catalogue from the data files of a nebula set.
+	//! @param catalogFile the binary ngc2000.dat file containing the positions and types.
+	//! @param namesFile the ngc2000names.dat file containing the names and Messier numbers, or an empty string.
+	//! @return false if the catalogue file can't be read.
+	bool compile(const QString& catalogFile, const QString& namesFile);
+
+	//! Load the compiled data from a cache file.
+	//! @param cacheFile the path of the cache file.
+	//! @param sourceFiles the data files from which the cache must have been compiled.
+	//! @return false if the cache file doesn't exist, has an other format version, or if one of the source files changed.
+	bool load(const QString& cacheFile, const QStringList& sourceFiles);
+
+	//! Save the compiled data in a cache file, with the signature of the source files used by the last call to compile().
+	bool save(const QString& cacheFile) const;
+
+	//! Get the path of the cache file for a nebula set in the user directory.
+	static QString getCacheFilePath(const QString& setName);
+
+	//! Get the number of entries.
+	int size() const {return positions.size();}
+
+	//! Return whether an entry has an english name.
+	bool hasName(int i) const {return nameOffsets.at(i+1)>nameOffsets.at(i);}
+
+	//! Get the english name of an entry, or an empty string if it has no name.
+	QString getEnglishName(int i) const
+	{
+		return QString::fromUtf8(namePool.constData()+nameOffsets.at(i), nameOffsets.at(i+1)-nameOffsets.at(i));
+	}
+
+	//! The J2000 equatorial positions
+	QVector<Vec3f> positions;
+	//! The visual magnitudes, 99 if unknown
+	QVector<float> magnitudes;
+	//! The angular sizes in degree
+	QVector<float> angularSizes;
+	//! The Nebula::NebulaType of each entry
+	QVector<quint8> types;
+	//! The NGC, IC and Messier numbers, or 0 if the entry is not part of the catalogue
+	QVector<quint32> ngcNumbers;
+	QVector<quint32> icNumbers;
+	QVector<quint32> messierNumbers;
+	//! The UTF-8 english names of all the entries one after the other
+	QByteArray namePool;
+	//! Offset of the name of each entry in namePool, with one more element at the end
+	//! so that the name of entry i is in [offsets[i], offsets[i+1])
+	QVector<int> nameOffsets;
+	//! Index of the first entry of each zone, with one more element at the end
+	//! so that the entries of zone z are in [offsets[z], offsets[z+1])
+	QVector<int> zoneOffsets;
+
+private:
+	typedef CompiledCacheFile::SourceSignature SourceSignature;
+
+	bool parseCatalog(const QString& catalogFile);
+	//! Parse the names file and return the english name of each entry.
+	QStringList parseNames(const QString& namesFile);
+	//! Sort all the arrays by zone, and fill the name pool and the zone offsets.
+	void sortByZone(const QStringList& names);
+
+	//! Signatures of the source files of the compiled data
+	QVector<SourceSignature> sources;
+};
+
+#endif // _COMPILEDNEBULACATALOG_HPP_
@@ -0,0 +1,311 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "CompiledSkyCulture.hpp"
+#include "StelFileMgr.hpp"
+#include "StelUtils.hpp"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QDataStream>
+#include <QTextStream>
+#include <QRegExp>
+#include <QHash>
+#include <QDebug>
+
+// Identify the cache files, and their format version which must be increased at each format change
+static const quint32 CACHE_FILE_MAGIC = 0x53534346;
+static const quint32 CACHE_FILE_VERSION = 1;
+
+QString CompiledSkyCulture::getCacheFilePath(const QString& skyCultureDir)
+{
+	return StelFileMgr::getUserDir() + "/cache/skycultures/" + skyCultureDir + ".dat";
+}
+
+bool CompiledSkyCulture::compile(const QString& linesFile, const QString& namesFile, const QString& boundariesFile)
+{
+	records.clear();
+	boundaryPoints.clear();
+	boundarySegmentOffsets.clear();
+	sources.clear();
+	sources << CompiledCacheFile::computeSignature(linesFile) << CompiledCacheFile::computeSignature(namesFile)
+			<< CompiledCacheFile::computeSignature(boundariesFile);
+
+	if (!QFile::exists(linesFile))
+	{
+		qWarning() << "Can't open constellation data file" << linesFile;
+		return false;
+	}
+	parseLines(linesFile);
+	if (!namesFile.isEmpty())
+		parseNames(namesFile);
+	if (!boundariesFile.isEmpty())
+		parseBoundaries(boundariesFile);
+	return true;
+}
+
+void CompiledSkyCulture::parseLines(const QString& linesFile)
+{
+	QFile in(linesFile);
+	if (!in.open(QIODevice::ReadOnly | QIODevice::Text))
+	{
+		qWarning() << "Can't open constellation data file" << linesFile;
+		return;
+	}
+
+	// Each non-comment line has the following format:
+	// ShortName nbSegments hp1 hp2 hp3 hp4...
+	// where each pair of Hipparcos numbers defines a segment of the constellation lines
+	QRegExp commentRx("^(\\s*#.*|\\s*)$");
+	int totalRecords = 0;
+	int currentLineNumber = 0;
+	while (!in.atEnd())
+	{
+		QString record = QString::fromUtf8(in.readLine());
+		currentLineNumber++;
+		if (commentRx.exactMatch(record))
+			continue;
+		totalRecords++;
+
+		QTextStream istr(&record, QIODevice::ReadOnly);
+		Record r;
+		QString abb;
+		unsigned int numberOfSegments = 0;
+		istr >> abb >> numberOfSegments;
+		bool ok = istr.status()==QTextStream::Ok;
+		r.abbreviation = abb.toUpper();
+		r.hipNumbers.reserve(numberOfSegments*2);
+		for (unsigned int i=0;ok && i<numberOfSegments*2;++i)
+		{
+			unsigned int HP = 0;
+			istr >> HP;
+			if (HP==0)
+				ok = false;
+			else
+				r.hipNumbers.append(HP);
+		}
+		if (!ok)
+		{
+			qWarning() << "ERROR reading constellation rec at line " << currentLineNumber << "of" << linesFile;
+			continue;
+		}
+		records.append(r);
+	}
+	qDebug() << "Compiled" << records.size() << "/" << totalRecords << "constellation records from" << linesFile;
+}
+
+void CompiledSkyCulture::parseNames(const QString& namesFile)
+{
+	QFile commonNameFile(namesFile);
+	if (!commonNameFile.open(QIODevice::ReadOnly | QIODevice::Text))
+	{
+		qDebug() << "Cannot open file" << namesFile;
+		return;
+	}
+
+	QHash<QString, int> recordIndices;
+	for (int i=0;i<records.size();++i)
+		recordIndices.insert(records.at(i).abbreviation, i);
+
+	// lines to ignore which start with a # or are empty
+	QRegExp commentRx("^(\\s*#.*|\\s*)$");
+	// lines which look like records - we use the RE to extract the fields
+	// which will be available in recRx.capturedTexts()
+	QRegExp recRx("^\\s*(\\w+)\\s+\"(.*)\"\\s+_[(]\"(.*)\"[)]\\n");
+
+	int totalRecords = 0;
+	int readOk = 0;
+	int lineNumber = 0;
+	while (!commonNameFile.atEnd())
+	{
+		const QString record = QString::fromUtf8(commonNameFile.readLine());
+		lineNumber++;
+		if (commentRx.exactMatch(record))
+			continue;
+		totalRecords++;
+
+		if (!recRx.exactMatch(record))
+		{
+			qWarning() << "ERROR - cannot parse record at line" << lineNumber << "in constellation names file" << namesFile;
+			continue;
+		}
+		const QString shortName = recRx.capturedTexts().at(1);
+		QHash<QString, int>::const_iterator iter = recordIndices.constFind(shortName.toUpper());
+		if (iter==recordIndices.constEnd())
+		{
+			qWarning() << "WARNING - constellation abbreviation" << shortName << "not found when loading constellation names";
+			continue;
+		}
+		Record& r = records[iter.value()];
+		r.nativeName = recRx.capturedTexts().at(2);
+		r.englishName = recRx.capturedTexts().at(3);
+		readOk++;
+	}
+	qDebug() << "Compiled" << readOk << "/" << totalRecords << "constellation names";
+}
+
+void CompiledSkyCulture::parseBoundaries(const QString& boundariesFile)
+{
+	// Modified boundary file by Torsten Bronger with permission
+	// http://pp3.sourceforge.net
+	QFile dataFile(boundariesFile);
+	if (!dataFile.open(QIODevice::ReadOnly | QIODevice::Text))
+	{
+		qWarning() << "Boundary file " << boundariesFile << " not found";
+		return;
+	}
+
+	QHash<QString, int> recordIndices;
+	for (int i=0;i<records.size();++i)
+		recordIndices.insert(records.at(i).abbreviation, i);
+
+	// The file is a list of whitespace separated boundary segments, each one made of:
+	//  - the number of vertices of the segment
+	//  - the RA (hour) and DE (degree) of each vertex
+	//  - the number of constellations separated by the segment (always 2)
+	//  - the abbreviations of these constellations
+	QTextStream istr(&dataFile);
+	float DE, RA;
+	Vec3f XYZ;
+	unsigned int num, numc;
+	QString consname;
+	boundarySegmentOffsets.append(0);
+	while (!istr.atEnd())
+	{
+		num = 0;
+		istr >> num;
+		if (num == 0)
+			continue;  // empty line
+
+		for (unsigned int j=0;j<num;j++)
+		{
+			istr >> RA >> DE;
+			RA*=M_PI/12.;     // Convert from hours to rad
+			DE*=M_PI/180.;    // Convert from deg to rad
+			StelUtils::spheToRect(RA,DE,XYZ);
+			boundaryPoints.append(XYZ);
+		}
+		const int segment = boundarySegmentOffsets.size()-1;
+		boundarySegmentOffsets.append(boundaryPoints.size());
+
+		// The segment is drawn only once by the last of its constellations when all of them are displayed
+		int lastRecord = -1;
+		istr >> numc;
+		for (unsigned int j=0;j<numc;j++)
+		{
+			istr >> consname;
+			if (consname == "SER1" || consname == "SER2")
+				consname = "SER";
+
+			QHash<QString, int>::const_iterator iter = recordIndices.constFind(consname.toUpper());
+			if (iter==recordIndices.constEnd())
+			{
+				qWarning() << "ERROR while processing boundary file - cannot find constellation: " << consname;
+				continue;
+			}
+			lastRecord = iter.value();
+			records[lastRecord].isolatedBoundarySegments.append(segment);
+		}
+		if (lastRecord>=0)
+			records[lastRecord].sharedBoundarySegments.append(segment);
+	}
+	qDebug() << "Compiled" << boundarySegmentOffsets.size()-1 << "constellation boundary segments";
+}
+
+bool CompiledSkyCulture::load(const QString& cacheFile, const QStringList& sourceFiles)
+{
+	QFile file(cacheFile);
+	if (!file.open(QIODevice::ReadOnly))
+		return false;
+
+	// Read directly from the mapped file when possible, so that the bulk arrays are only copied once
+	const qint64 fileSize = file.size();
+	uchar* mapped = file.map(0, fileSize);
+	const QByteArray buf = mapped ? QByteArray::fromRawData((const char*)mapped, fileSize) : file.readAll();
+	QDataStream in(buf);
+	in.setVersion(QDataStream::Qt_4_6);
+
+	QVector<SourceSignature> signatures;
+	bool refreshed;
+	if (!CompiledCacheFile::readHeader(in, CACHE_FILE_MAGIC, CACHE_FILE_VERSION, sourceFiles, "Sky culture", signatures, refreshed))
+		return false;
+
+	qint32 nbRecords;
+	in >> nbRecords;
+	QVector<Record> newRecords(nbRecords>0 ? nbRecords : 0);
+	for (int i=0;i<newRecords.size();++i)
+	{
+		Record& r = newRecords[i];
+		in >> r.abbreviation >> r.hipNumbers >> r.nativeName >> r.englishName >> r.isolatedBoundarySegments >> r.sharedBoundarySegments;
+	}
+	QVector<int> newOffsets;
+	in >> newOffsets;
+	qint32 nbPoints;
+	in >> nbPoints;
+	if (in.status()!=QDataStream::Ok || nbPoints<0)
+		return false;
+	QVector<Vec3f> newPoints(nbPoints);
+	const int pointsBytes = nbPoints*sizeof(Vec3f);
+	if (in.readRawData((char*)newPoints.data(), pointsBytes)!=pointsBytes)
+		return false;
+
+	records = newRecords;
+	boundarySegmentOffsets = newOffsets;
+	boundaryPoints = newPoints;
+	sources = signatures;
+	if (refreshed)
+	{
+		// Release the mapping before overwriting the file with the refreshed signatures
+		if (mapped)
+			file.unmap(mapped);
+		file.close();
+		save(cacheFile);
+	}
+	return true;
+}
+
+bool CompiledSkyCulture::save(const QString& cacheFile) const
+{
+	StelFileMgr::mkDir(QFileInfo(cacheFile).absolutePath());
+	QFile file(cacheFile);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+	{
+		qWarning() << "Can't write sky culture cache file" << cacheFile;
+		return false;
+	}
+
+	QDataStream out(&file);
+	out.setVersion(QDataStream::Qt_4_6);
+	CompiledCacheFile::writeHeader(out, CACHE_FILE_MAGIC, CACHE_FILE_VERSION, sources);
+	out << (qint32)records.size();
+	foreach (const Record& r, records)
+		out << r.abbreviation << r.hipNumbers << r.nativeName << r.englishName << r.isolatedBoundarySegments << r.sharedBoundarySegments;
+	out << boundarySegmentOffsets;
+	// The points are stored in native byte order so that they can be copied in one block
+	out << (qint32)boundaryPoints.size();
+	out.writeRawData((const char*)boundaryPoints.constData(), boundaryPoints.size()*sizeof(Vec3f));
+	file.close();
+	if (out.status()!=QDataStream::Ok)
+	{
+		qWarning() << "Error while writing sky culture cache file" << cacheFile;
+		QFile::remove(cacheFile);
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,97 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _COMPILEDSKYCULTURE_HPP_
+#define _COMPILEDSKYCULTURE_HPP_
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "VecMath.hpp"
+#include "CompiledCacheFile.hpp"
+
+//! @class CompiledSkyCulture
+//! The constellation lines, names and boundaries of a sky culture, in a form ready to be used by the ConstellationMgr.
+//! The data is compiled once from the text files of the sky culture, then saved in a binary cache file in
+//! the user directory. The next times the sky culture is loaded, the cache file is memory mapped and read
+//! in a few bulk copies, without any text parsing nor per-segment allocation.
+//! The cache is rebuilt when its format version changes, or when one of the source files changed. A source
+//! file is considered unchanged if its size and modification time are the same, or else if its MD5 hash is the same.
+//! The constellation art is not part of the cache because it is mostly made of textures.
+class CompiledSkyCulture
+{
+public:
+	//! @struct Record
+	//! The compiled data of one constellation.
+	struct Record
+	{
+		//! Upper case abbreviation of the constellation
+		QString abbreviation;
+		//! Hipparcos numbers of the stars forming the lines, by pairs
+		QVector<int> hipNumbers;
+		//! Name in native language
+		QString nativeName;
+		//! Name in english
+		QString englishName;
+		//! Indices of all the boundary segments around the constellation
+		QVector<int> isolatedBoundarySegments;
+		//! Indices of the boundary segments drawn by this constellation when all constellations are displayed
+		QVector<int> sharedBoundarySegments;
+	};
+
+	//! Compile the sky culture data from its text files.
+	//! @param linesFile the constellationship.fab file, defining the constellations and their lines.
+	//! @param namesFile the constellation names file, or an empty string.
+	//! @param boundariesFile the constellation boundaries file, or an empty string if the culture has no boundaries.
+	//! @return false if the lines file can't be read.
+	bool compile(const QString& linesFile, const QString& namesFile, const QString& boundariesFile);
+
+	//! Load the compiled data from a cache file.
+	//! @param cacheFile the path of the cache file.
+	//! @param sourceFiles the text files from which the cache must have been compiled.
+	//! @return false if the cache file doesn't exist, has an other format version, or if one of the source files changed.
+	bool load(const QString& cacheFile, const QStringList& sourceFiles);
+
+	//! Save the compiled data in a cache file, with the signature of the source files used by the last call to compile().
+	bool save(const QString& cacheFile) const;
+
+	//! Get the path of the cache file for a sky culture in the user directory.
+	static QString getCacheFilePath(const QString& skyCultureDir);
+
+	//! The constellations in the order of the lines file
+	QVector<Record> records;
+	//! The points of all the boundary segments, in J2000 frame
+	QVector<Vec3f> boundaryPoints;
+	//! Index of the first point of each boundary segment in boundaryPoints, with one more
+	//! element at the end so that the points of segment i are in [offsets[i], offsets[i+1])
+	QVector<int> boundarySegmentOffsets;
+
+private:
+	typedef CompiledCacheFile::SourceSignature SourceSignature;
+
+	void parseLines(const QString& linesFile);
+	void parseNames(const QString& namesFile);
+	void parseBoundaries(const QString& boundariesFile);
+
+	//! Signatures of the source files of the compiled data
+	QVector<SourceSignature> sources;
+};
+
+#endif // _COMPILEDSKYCULTURE_HPP_
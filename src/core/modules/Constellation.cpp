@@ -20,7 +20,6 @@
 
 #include <algorithm>
 #include <QString>
-#include <QTextStream>
 #include <QDebug>
 #include <QFontMetrics>
 
@@ -48,40 +47,19 @@ Constellation::~Constellation()
 	asterism = NULL;
 }
 
-bool Constellation::read(const QString& record, StarMgr *starMgr)
+bool Constellation::init(const QString& abb, const QVector<int>& hipNumbers, StarMgr *starMgr)
 {
-	unsigned int HP;
-
-	abbreviation.clear();
-	numberOfSegments = 0;
-
-	QString buf(record);
-	QTextStream istr(&buf, QIODevice::ReadOnly);
-	QString abb;
-	istr >> abb >> numberOfSegments;
-	if (istr.status()!=QTextStream::Ok)
-		return false;
-
 	abbreviation = abb.toUpper();
+	numberOfSegments = hipNumbers.size()/2;
 
+	if (asterism) delete[] asterism;
 	asterism = new StelObjectP[numberOfSegments*2];
 	for (unsigned int i=0;i<numberOfSegments*2;++i)
 	{
-		HP = 0;
-		istr >> HP;
-		if(HP == 0)
-		{
-			// TODO: why is this delete commented?
-			// delete[] asterism;
-			return false;
-		}
-
-		asterism[i]=starMgr->searchHP(HP);
+		asterism[i]=starMgr->searchHP(hipNumbers.at(i));
 		if (!asterism[i])
 		{
-			qWarning() << "Error in Constellation " << abbreviation << " asterism : can't find star HP= " << HP;
-			// TODO: why is this delete commented?
-			// delete[] asterism;
+			qWarning() << "Error in Constellation " << abbreviation << " asterism : can't find star HP= " << hipNumbers.at(i);
 			return false;
 		}
 	}
@@ -96,23 +74,78 @@ bool Constellation::read(const QString& record, StarMgr *starMgr)
 	return true;
 }
 
-void Constellation::drawOptim(StelPainter& sPainter, const StelCore* core, const SphericalCap& viewportHalfspace) const
+// Scratch buffer used to collect the visible segments of a partially visible range
+static QVector<Vec3d> visibleSegments;
+
+void Constellation::drawTessellatedRange(StelPainter& sPainter, const QVector<Vec3d>& vertices, const TessellatedRange& range, const SphericalCap& viewportHalfspace)
 {
-	if (lineFader.getInterstate()<=0.0001f)
+	if (range.count==0 || !viewportHalfspace.intersects(range.cap))
 		return;
 
-	sPainter.setColor(lineColor[0], lineColor[1], lineColor[2], lineFader.getInterstate());
+	const StelProjectorP& prj = sPainter.getProjector();
+	const Vec3d* first = vertices.constData()+range.offset;
+	if (viewportHalfspace.contains(range.cap) && !prj->intersectViewportDiscontinuity(range.cap))
+	{
+		// The whole range is visible, draw it as it is
+		sPainter.setVertexPointer(3, GL_DOUBLE, first);
+		sPainter.enableClientStates(true);
+		sPainter.drawFromArray(StelPainter::Lines, range.count);
+		sPainter.enableClientStates(false);
+		return;
+	}
+
+	visibleSegments.resize(0);
+	for (int i=0;i<range.count;i+=2)
+	{
+		Vec3d p1 = first[i];
+		Vec3d p2 = first[i+1];
+		// Clip the segment to the viewport as soon as one end is outside, a segment can also cross it with both ends outside when zoomed in
+		if (!viewportHalfspace.clipGreatCircle(p1, p2))
+			continue;
+		// Don't draw the segments wrapping around the projection discontinuity
+		if (prj->intersectViewportDiscontinuity(p1, p2))
+			continue;
+		visibleSegments.append(p1);
+		visibleSegments.append(p2);
+	}
+	if (visibleSegments.isEmpty())
+		return;
+
+	sPainter.setVertexPointer(3, GL_DOUBLE, visibleSegments.constData());
+	sPainter.enableClientStates(true);
+	sPainter.drawFromArray(StelPainter::Lines, visibleSegments.size());
+	sPainter.enableClientStates(false);
+}
 
-	Vec3d star1;
-	Vec3d star2;
-	for (unsigned int i=0;i<numberOfSegments;++i)
+// Set the range to cover all vertices appended to the array since its offset, and compute its bounding cap.
+void Constellation::closeTessellatedRange(const QVector<Vec3d>& vertices, TessellatedRange& range)
+{
+	range.count = vertices.size()-range.offset;
+	if (range.count==0)
+		return;
+	Vec3d center(0.);
+	for (int i=range.offset;i<vertices.size();++i)
+		center+=vertices.at(i);
+	if (center.lengthSquared()<0.00000001)
 	{
-		star1=asterism[2*i]->getJ2000EquatorialPos(core);
-		star2=asterism[2*i+1]->getJ2000EquatorialPos(core);
-		star1.normalize();
-		star2.normalize();
-		sPainter.drawGreatCircleArc(star1, star2, &viewportHalfspace);
+		// Degenerated case, use the full sky
+		range.cap = SphericalCap(Vec3d(1,0,0), -1.);
+		return;
 	}
+	center.normalize();
+	double d = 1.;
+	for (int i=range.offset;i<vertices.size();++i)
+		d = qMin(d, center*vertices.at(i));
+	range.cap = SphericalCap(center, d);
+}
+
+void Constellation::drawOptim(StelPainter& sPainter, const QVector<Vec3d>& lineVertices, const SphericalCap& viewportHalfspace) const
+{
+	if (lineFader.getInterstate()<=0.0001f)
+		return;
+
+	sPainter.setColor(lineColor[0], lineColor[1], lineColor[2], lineFader.getInterstate());
+	drawTessellatedRange(sPainter, lineVertices, linesRange, viewportHalfspace);
 }
 
 void Constellation::drawName(StelPainter& sPainter) const
@@ -174,7 +207,7 @@ void Constellation::update(int deltaTime)
 	boundaryFader.update(deltaTime);
 }
 
-void Constellation::drawBoundaryOptim(StelPainter& sPainter) const
+void Constellation::drawBoundaryOptim(StelPainter& sPainter, const QVector<Vec3d>& boundaryVertices) const
 {
 	if (!boundaryFader.getInterstate())
 		return;
@@ -185,32 +218,8 @@ void Constellation::drawBoundaryOptim(StelPainter& sPainter) const
 
 	sPainter.setColor(boundaryColor[0], boundaryColor[1], boundaryColor[2], boundaryFader.getInterstate());
 
-	unsigned int i, j, size;
-	Vec3f pt1, pt2;
-	Vec3d ptd1, ptd2;
-	std::vector<Vec3f> *points;
-
-	if (singleSelected) size = isolatedBoundarySegments.size();
-	else size = sharedBoundarySegments.size();
-
-	const SphericalCap& viewportHalfspace = sPainter.getProjector()->getBoundingCap();
-
-	for (i=0;i<size;i++)
-	{
-		if (singleSelected) points = isolatedBoundarySegments[i];
-		else points = sharedBoundarySegments[i];
-
-		for (j=0;j<points->size()-1;j++)
-		{
-			pt1 = points->at(j);
-			pt2 = points->at(j+1);
-			if (pt1*pt2>0.9999999f)
-				continue;
-			ptd1.set(pt1[0], pt1[1], pt1[2]);
-			ptd2.set(pt2[0], pt2[1], pt2[2]);
-			sPainter.drawGreatCircleArc(ptd1, ptd2, &viewportHalfspace);
-		}
-	}
+	const TessellatedRange& range = singleSelected ? isolatedBoundaryRange : sharedBoundaryRange;
+	drawTessellatedRange(sPainter, boundaryVertices, range, sPainter.getProjector()->getBoundingCap());
 }
 
 StelObjectP Constellation::getBrightestStarInConstellation(void) const
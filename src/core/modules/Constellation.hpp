@@ -23,6 +23,7 @@
 
 #include <vector>
 #include <QString>
+#include <QVector>
 #include <QFont>
 
 #include "StelObject.hpp"
@@ -68,21 +69,21 @@ private:
 
 	virtual double getAngularSize(const StelCore*) const {Q_ASSERT(0); return 0;} // TODO
 
-	//! @param record string containing the following whitespace
-	//! separated fields: abbreviation - a three character abbreviation
-	//! for the constellation, a number of lines, and a list of Hipparcos
-	//! catalogue numbers which, when connected form the lines of the
-	//! constellation.
+	//! Set the abbreviation and the lines of the constellation.
+	//! @param abb the abbreviation of the constellation.
+	//! @param hipNumbers the Hipparcos catalogue numbers of the stars which,
+	//! connected by pairs, form the lines of the constellation.
 	//! @param starMgr a pointer to the StarManager object.
-	//! @return false if can't parse record, else true.
-	bool read(const QString& record, StarMgr *starMgr);
+	//! @return false if one of the stars can't be found, else true.
+	bool init(const QString& abb, const QVector<int>& hipNumbers, StarMgr *starMgr);
 
 	//! Draw the constellation name
 	void drawName(StelPainter& sPainter) const;
 	//! Draw the constellation art
 	void drawArt(StelPainter& sPainter) const;
 	//! Draw the constellation boundary
-	void drawBoundaryOptim(StelPainter& sPainter) const;
+	//! @param boundaryVertices the tessellated boundaries buffer of the ConstellationMgr.
+	void drawBoundaryOptim(StelPainter& sPainter, const QVector<Vec3d>& boundaryVertices) const;
 
 	//! Test if a star is part of a Constellation.
 	//! This member tests to see if a star is one of those which make up
@@ -104,9 +105,10 @@ private:
 	//! Get the short name for the Constellation (returns the abbreviation).
 	QString getShortName() const {return abbreviation;}
 	//! Draw the lines for the Constellation.
-	//! This method uses the coords of the stars (optimized for use thru
-	//! the class ConstellationMgr only).
-	void drawOptim(StelPainter& sPainter, const StelCore* core, const SphericalCap& viewportHalfspace) const;
+	//! This method uses the tessellated lines precomputed by the ConstellationMgr
+	//! (optimized for use thru the class ConstellationMgr only).
+	//! @param lineVertices the tessellated lines buffer of the ConstellationMgr.
+	void drawOptim(StelPainter& sPainter, const QVector<Vec3d>& lineVertices, const SphericalCap& viewportHalfspace) const;
 	//! Draw the art texture, optimized function to be called thru a constellation manager only.
 	void drawArtOptim(StelPainter& sPainter, const SphericalRegion& region) const;
 	//! Update fade levels according to time since various events.
@@ -158,8 +160,30 @@ private:
 
 	//! Define whether art, lines, names and boundary must be drawn
 	LinearFader artFader, lineFader, nameFader, boundaryFader;
-	std::vector<std::vector<Vec3f> *> isolatedBoundarySegments;
-	std::vector<std::vector<Vec3f> *> sharedBoundarySegments;
+
+	//! A range of GL_LINES vertices in one of the tessellated buffers shared by all
+	//! constellations in the ConstellationMgr, with a cap bounding all its vertices.
+	struct TessellatedRange
+	{
+		TessellatedRange() : offset(0), count(0) {;}
+		int offset;
+		int count;
+		SphericalCap cap;
+	};
+
+	//! Set the range to cover all the vertices appended to the buffer since its offset, and compute its bounding cap.
+	static void closeTessellatedRange(const QVector<Vec3d>& vertices, TessellatedRange& range);
+
+	//! Draw the part of a tessellated range which is inside the viewport.
+	//! Fully visible ranges are drawn in one call, partially visible ones are culled segment by segment,
+	//! and segments crossing a projection discontinuity are skipped.
+	static void drawTessellatedRange(StelPainter& sPainter, const QVector<Vec3d>& vertices, const TessellatedRange& range, const SphericalCap& viewportHalfspace);
+
+	//! Location of the tessellated lines in the ConstellationMgr lines buffer
+	TessellatedRange linesRange;
+	//! Location of the tessellated boundaries in the ConstellationMgr boundaries buffer
+	TessellatedRange isolatedBoundaryRange;
+	TessellatedRange sharedBoundaryRange;
 
 	//! Currently we only need one color for all constellations, this may change at some point
 	static Vec3f lineColor;
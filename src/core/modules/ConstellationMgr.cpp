@@ -44,9 +44,47 @@
 
 using namespace std;
 
+// Maximum angular length of a piece of tessellated great circle arc in radian
+static const double MAX_TESSELLATION_STEP = M_PI/180.;
+
+// Number of days after which the lines are tessellated again to follow the proper motion of stars
+static const double LINES_TESSELLATION_VALIDITY = 365.25*50.;
+
+// Append the great circle arc between p1 and p2 to the passed array as GL_LINES pairs.
+// The arc is cut in pieces small enough to look smooth under non linear projections.
+static void appendGreatCircleArc(QVector<Vec3d>& vertices, Vec3d p1, Vec3d p2)
+{
+	p1.normalize();
+	p2.normalize();
+	const double cosAngle = p1*p2;
+	if (cosAngle>0.9999999)
+		return;
+	const double angle = std::acos(qMax(-1., cosAngle));
+	const int nbPieces = qMax(1, (int)std::ceil(angle/MAX_TESSELLATION_STEP));
+	const double sinAngle = std::sin(angle);
+	Vec3d prev = p1;
+	for (int i=1;i<=nbPieces;++i)
+	{
+		Vec3d p;
+		if (i==nbPieces)
+			p = p2;
+		else
+		{
+			// Spherical linear interpolation
+			const double a = angle*i/nbPieces;
+			p = p1*(std::sin(angle-a)/sinAngle) + p2*(std::sin(a)/sinAngle);
+			p.normalize();
+		}
+		vertices.append(prev);
+		vertices.append(p);
+		prev = p;
+	}
+}
+
 // constructor which loads all data from appropriate files
 ConstellationMgr::ConstellationMgr(StarMgr *_hip_stars)
 	: hipStarMgr(_hip_stars),
+	  linesTessellationJD(0.),
 	  artDisplayed(0),
 	  boundariesDisplayed(0),
 	  linesDisplayed(0),
@@ -66,13 +104,6 @@ ConstellationMgr::~ConstellationMgr()
 	{
 		delete(*iter);
 	}
-
-	vector<vector<Vec3f> *>::iterator iter1;
-	for (iter1 = allBoundarySegments.begin(); iter1 != allBoundarySegments.end(); ++iter1)
-	{
-		delete (*iter1);
-	}
-	allBoundarySegments.clear();
 }
 
 void ConstellationMgr::init()
@@ -118,7 +149,7 @@ void ConstellationMgr::updateSkyCulture(const QString& skyCultureDir)
 		return;
 
 	// Find constellation art.  If this doesn't exist, warn, but continue using ""
-	// the loadLinesAndArt function knows how to handle this (just loads lines).
+	// the loadArt function knows how to handle this.
 	QString conArtFile;
 	try
 	{
@@ -129,31 +160,31 @@ void ConstellationMgr::updateSkyCulture(const QString& skyCultureDir)
 		qDebug() << "No constellationsart.fab file found for sky culture " << skyCultureDir;
 	}
 
+	QString linesFile, namesFile, boundariesFile;
 	try
 	{
-		// first of all, remove constellations from the list of selected objects in StelObjectMgr, since we are going to delete them
-		deselectConstellations();
-
-		loadLinesAndArt(StelFileMgr::findFile("skycultures/"+skyCultureDir+"/constellationship.fab"), conArtFile, skyCultureDir);
-
-		// load constellation names
-		loadNames(StelFileMgr::findFile("skycultures/" + skyCultureDir + "/constellation_names.eng.fab"));
-
-		// Translate constellation names for the new sky culture
-		updateI18n();
+		linesFile = StelFileMgr::findFile("skycultures/"+skyCultureDir+"/constellationship.fab");
 	}
 	catch (std::runtime_error& e)
 	{
 		qWarning() << "ERROR: while loading new constellation data for sky culture "
 			<< skyCultureDir << ", reason: " << e.what() << endl;
+		lastLoadedSkyCulture = skyCultureDir;
+		return;
 	}
-
-	// TODO: do we need to have an else { clearBoundaries(); } ?
-        if (skyCultureDir.startsWith("western"))
+	try
+	{
+		namesFile = StelFileMgr::findFile("skycultures/" + skyCultureDir + "/constellation_names.eng.fab");
+	}
+	catch (std::runtime_error& e)
+	{
+		qWarning() << "ERROR: no constellation names for sky culture " << skyCultureDir << ", reason: " << e.what();
+	}
+	if (skyCultureDir.startsWith("western"))
 	{
 		try
 		{
-			loadBoundaries(StelFileMgr::findFile("data/constellations_boundaries.dat"));
+			boundariesFile = StelFileMgr::findFile("data/constellations_boundaries.dat");
 		}
 		catch (std::runtime_error& e)
 		{
@@ -161,6 +192,27 @@ void ConstellationMgr::updateSkyCulture(const QString& skyCultureDir)
 		}
 	}
 
+	// Use the compiled data from the cache if the text files didn't change since it was built
+	CompiledSkyCulture data;
+	const QString cacheFile = CompiledSkyCulture::getCacheFilePath(skyCultureDir);
+	if (data.load(cacheFile, QStringList() << linesFile << namesFile << boundariesFile))
+	{
+		qDebug() << "Loaded compiled constellation data for culture" << skyCultureDir << "from" << cacheFile;
+	}
+	else if (data.compile(linesFile, namesFile, boundariesFile))
+	{
+		data.save(cacheFile);
+	}
+
+	// Remove constellations from the list of selected objects in StelObjectMgr, since we are going to delete them
+	deselectConstellations();
+
+	loadCompiledData(data, skyCultureDir);
+	loadArt(conArtFile, skyCultureDir);
+
+	// Translate constellation names for the new sky culture
+	updateI18n();
+
 	lastLoadedSkyCulture = skyCultureDir;
 }
 
@@ -297,81 +349,62 @@ float ConstellationMgr::getFontSize() const
 	return asterFont.pixelSize();
 }
 
-void ConstellationMgr::loadLinesAndArt(const QString &fileName, const QString &artfileName, const QString& cultureName)
+void ConstellationMgr::loadCompiledData(const CompiledSkyCulture& data, const QString& cultureName)
 {
-	QFile in(fileName);
-	if (!in.open(QIODevice::ReadOnly | QIODevice::Text))
-	{
-		qWarning() << "Can't open constellation data file" << fileName  << "for culture" << cultureName;
-		Q_ASSERT(0);
-	}
-
-	int totalRecords=0;
-	QString record;
-	QRegExp commentRx("^(\\s*#.*|\\s*)$");
-	while (!in.atEnd())
-	{
-		record = QString::fromUtf8(in.readLine());
-		if (!commentRx.exactMatch(record))
-			totalRecords++;
-	}
-	in.seek(0);
-
 	// delete existing data, if any
 	vector < Constellation * >::iterator iter;
 	for (iter = asterisms.begin(); iter != asterisms.end(); ++iter)
 		delete(*iter);
-
 	asterisms.clear();
-	Constellation *cons = NULL;
+	boundaryVertices.clear();
 
-	// read the file, adding a record per non-comment line
-	int currentLineNumber = 0;	// line in file
-	int readOk = 0;			// count of records processed OK
-	while (!in.atEnd())
+	int readOk = 0;
+	foreach (const CompiledSkyCulture::Record& record, data.records)
 	{
-		record = QString::fromUtf8(in.readLine());
-		currentLineNumber++;
-		if (commentRx.exactMatch(record))
-			continue;
-
-		cons = new Constellation;
-		if(cons->read(record, hipStarMgr))
+		Constellation* cons = new Constellation;
+		if (!cons->init(record.abbreviation, record.hipNumbers, hipStarMgr))
 		{
-			cons->artFader.setMaxValue(artIntensity);
-			cons->setFlagArt(artDisplayed);
-			cons->setFlagBoundaries(boundariesDisplayed);
-			cons->setFlagLines(linesDisplayed);
-			cons->setFlagLabels(namesDisplayed);
-			asterisms.push_back(cons);
-			++readOk;
-		}
-		else
-		{
-			qWarning() << "ERROR reading constellation rec at line " << currentLineNumber << "for culture" << cultureName;
+			qWarning() << "ERROR creating constellation" << record.abbreviation << "for culture" << cultureName;
 			delete cons;
+			continue;
 		}
+		cons->nativeName = record.nativeName;
+		cons->englishName = record.englishName;
+		cons->artFader.setMaxValue(artIntensity);
+		cons->setFlagArt(artDisplayed);
+		cons->setFlagBoundaries(boundariesDisplayed);
+		cons->setFlagLines(linesDisplayed);
+		cons->setFlagLabels(namesDisplayed);
+		tessellateBoundaries(cons, data, record);
+		asterisms.push_back(cons);
+		++readOk;
 	}
-	in.close();
-	qDebug() << "Loaded" << readOk << "/" << totalRecords << "constellation records successfully for culture" << cultureName;
+	qDebug() << "Loaded" << readOk << "/" << data.records.size() << "constellation records successfully for culture" << cultureName;
+
+	tessellateLines();
 
 	// Set current states
 	setFlagArt(artDisplayed);
 	setFlagLines(linesDisplayed);
 	setFlagLabels(namesDisplayed);
 	setFlagBoundaries(boundariesDisplayed);
+}
 
+void ConstellationMgr::loadArt(const QString &artfileName, const QString& cultureName)
+{
 	// It's possible to have no art - just constellations
 	if (artfileName.isNull() || artfileName.isEmpty())
 		return;
 	QFile fic(artfileName);
 	if (!fic.open(QIODevice::ReadOnly | QIODevice::Text))
 	{
-		qWarning() << "Can't open constellation art file" << fileName  << "for culture" << cultureName;
+		qWarning() << "Can't open constellation art file" << artfileName  << "for culture" << cultureName;
 		return;
 	}
 
-	totalRecords=0;
+	QString record;
+	QRegExp commentRx("^(\\s*#.*|\\s*)$");
+	int totalRecords=0;
 	while (!fic.atEnd())
 	{
 		record = QString::fromUtf8(fic.readLine());
@@ -393,8 +426,9 @@ void ConstellationMgr::loadLinesAndArt(const QString &fileName, const QString &a
 	unsigned int x1, y1, x2, y2, x3, y3, hp1, hp2, hp3;
 	QString tmpstr;
 
-	currentLineNumber = 0;	// line in file
-	readOk = 0;		// count of records processed OK
+	Constellation *cons = NULL;
+	int currentLineNumber = 0;	// line in file
+	int readOk = 0;		// count of records processed OK
 
 	while (!fic.atEnd())
 	{
@@ -515,7 +549,7 @@ void ConstellationMgr::draw(StelCore* core)
 	const StelProjectorP prj = core->getProjection(StelCore::FrameJ2000);
 	StelPainter sPainter(prj);
 	sPainter.setFont(asterFont);
-	drawLines(sPainter, core);
+	drawLines(sPainter);
 	drawNames(sPainter);
 	drawArt(sPainter);
 	drawBoundaries(sPainter);
@@ -540,7 +574,7 @@ void ConstellationMgr::drawArt(StelPainter& sPainter) const
 }
 
 // Draw constellations lines
-void ConstellationMgr::drawLines(StelPainter& sPainter, const StelCore* core) const
+void ConstellationMgr::drawLines(StelPainter& sPainter) const
 {
 	sPainter.enableTexture2d(false);
 	glEnable(GL_BLEND);
@@ -549,10 +583,55 @@ void ConstellationMgr::drawLines(StelPainter& sPainter, const StelCore* core) co
 	vector < Constellation * >::const_iterator iter;
 	for (iter = asterisms.begin(); iter != asterisms.end(); ++iter)
 	{
-		(*iter)->drawOptim(sPainter, core, viewportHalfspace);
+		(*iter)->drawOptim(sPainter, lineVertices, viewportHalfspace);
+	}
+}
+
+void ConstellationMgr::tessellateLines()
+{
+	StelCore* core = StelApp::getInstance().getCore();
+	lineVertices.clear();
+	vector < Constellation * >::const_iterator iter;
+	for (iter = asterisms.begin(); iter != asterisms.end(); ++iter)
+	{
+		Constellation* cons = *iter;
+		cons->linesRange.offset = lineVertices.size();
+		for (unsigned int i=0;i<cons->numberOfSegments;++i)
+		{
+			appendGreatCircleArc(lineVertices, cons->asterism[2*i]->getJ2000EquatorialPos(core),
+					     cons->asterism[2*i+1]->getJ2000EquatorialPos(core));
+		}
+		Constellation::closeTessellatedRange(lineVertices, cons->linesRange);
+	}
+	linesTessellationJD = core->getJDay();
+}
+
+// Append the tessellated boundary segments to the passed array
+static void appendBoundarySegments(QVector<Vec3d>& vertices, const CompiledSkyCulture& data, const QVector<int>& segments)
+{
+	foreach (int segment, segments)
+	{
+		const int end = data.boundarySegmentOffsets.at(segment+1);
+		for (int j=data.boundarySegmentOffsets.at(segment)+1;j<end;++j)
+		{
+			const Vec3f& p1 = data.boundaryPoints.at(j-1);
+			const Vec3f& p2 = data.boundaryPoints.at(j);
+			appendGreatCircleArc(vertices, Vec3d(p1[0], p1[1], p1[2]), Vec3d(p2[0], p2[1], p2[2]));
+		}
 	}
 }
 
+void ConstellationMgr::tessellateBoundaries(Constellation* cons, const CompiledSkyCulture& data, const CompiledSkyCulture::Record& record)
+{
+	cons->isolatedBoundaryRange.offset = boundaryVertices.size();
+	appendBoundarySegments(boundaryVertices, data, record.isolatedBoundarySegments);
+	Constellation::closeTessellatedRange(boundaryVertices, cons->isolatedBoundaryRange);
+
+	cons->sharedBoundaryRange.offset = boundaryVertices.size();
+	appendBoundarySegments(boundaryVertices, data, record.sharedBoundarySegments);
+	Constellation::closeTessellatedRange(boundaryVertices, cons->sharedBoundaryRange);
+}
+
 // Draw the names of all the constellations
 void ConstellationMgr::drawNames(StelPainter& sPainter) const
 {
@@ -602,78 +681,6 @@ QList<StelObjectP> ConstellationMgr::searchAround(const Vec3d&, double, const St
 	return QList<StelObjectP>();
 }
 
-void ConstellationMgr::loadNames(const QString& namesFile)
-{
-	// Constellation not loaded yet
-	if (asterisms.empty()) return;
-
-	// clear previous names
-	vector < Constellation * >::const_iterator iter;
-	for (iter = asterisms.begin(); iter != asterisms.end(); ++iter)
-	{
-		(*iter)->englishName.clear();
-	}
-
-	// Open file
-	QFile commonNameFile(namesFile);
-	if (!commonNameFile.open(QIODevice::ReadOnly | QIODevice::Text))
-	{
-		qDebug() << "Cannot open file" << namesFile;
-		return;
-	}
-
-	// Now parse the file
-	// lines to ignore which start with a # or are empty
-	QRegExp commentRx("^(\\s*#.*|\\s*)$");
-
-	// lines which look like records - we use the RE to extract the fields
-	// which will be available in recRx.capturedTexts()
-	QRegExp recRx("^\\s*(\\w+)\\s+\"(.*)\"\\s+_[(]\"(.*)\"[)]\\n");
-
-	// Some more variables to use in the parsing
-	Constellation *aster;
-	QString record, shortName;
-
-	// keep track of how many records we processed.
-	int totalRecords=0;
-	int readOk=0;
-	int lineNumber=0;
-	while (!commonNameFile.atEnd())
-	{
-		record = QString::fromUtf8(commonNameFile.readLine());
-		lineNumber++;
-
-		// Skip comments
-		if (commentRx.exactMatch(record))
-			continue;
-
-		totalRecords++;
-
-		if (!recRx.exactMatch(record))
-		{
-			qWarning() << "ERROR - cannot parse record at line" << lineNumber << "in constellation names file" << namesFile;
-		}
-		else
-		{
-			shortName = recRx.capturedTexts().at(1);
-			aster = findFromAbbreviation(shortName);
-			// If the constellation exists, set the English name
-			if (aster != NULL)
-			{
-				aster->nativeName = recRx.capturedTexts().at(2);
-				aster->englishName = recRx.capturedTexts().at(3);
-				readOk++;
-			}
-			else
-			{
-				qWarning() << "WARNING - constellation abbreviation" << shortName << "not found when loading constellation names";
-			}
-		}
-	}
-	commonNameFile.close();
-	qDebug() << "Loaded" << readOk << "/" << totalRecords << "constellation names";
-}
-
 void ConstellationMgr::updateI18n()
 {
 	StelTranslator trans = StelApp::getInstance().getLocaleMgr().getSkyTranslator();
@@ -693,6 +700,10 @@ void ConstellationMgr::update(double deltaTime)
 	{
 		(*iter)->update(delta);
 	}
+
+	// Follow the proper motion of the stars forming the lines on large time scales
+	if (!asterisms.empty() && std::fabs(StelApp::getInstance().getCore()->getJDay()-linesTessellationJD)>LINES_TESSELLATION_VALIDITY)
+		tessellateLines();
 }
 
 void ConstellationMgr::setArtIntensity(const double intensity)
@@ -1011,87 +1022,6 @@ void ConstellationMgr::unsetSelectedConst(Constellation * c)
 	}
 }
 
-bool ConstellationMgr::loadBoundaries(const QString& boundaryFile)
-{
-	Constellation *cons = NULL;
-	unsigned int i, j;
-
-	// delete existing boundaries if any exist
-	vector<vector<Vec3f> *>::iterator iter;
-	for (iter = allBoundarySegments.begin(); iter != allBoundarySegments.end(); ++iter)
-	{
-		delete (*iter);
-	}
-	allBoundarySegments.clear();
-
-	qDebug() << "Loading constellation boundary data ... ";
-
-	// Modified boundary file by Torsten Bronger with permission
-	// http://pp3.sourceforge.net
-	QFile dataFile(boundaryFile);
-	if (!dataFile.open(QIODevice::ReadOnly | QIODevice::Text))
-	{
-		qWarning() << "Boundary file " << boundaryFile << " not found";
-		return false;
-	}
-
-	QTextStream istr(&dataFile);
-	float DE, RA;
-	Vec3f XYZ;
-	unsigned num, numc;
-	vector<Vec3f> *points = NULL;
-	QString consname;
-	i = 0;
-	while (!istr.atEnd())
-	{
-		points = new vector<Vec3f>;
-
-		num = 0;
-		istr >> num;
-		if(num == 0) continue;  // empty line
-
-		for (j=0;j<num;j++)
-		{
-			istr >> RA >> DE;
-
-			RA*=M_PI/12.;     // Convert from hours to rad
-			DE*=M_PI/180.;    // Convert from deg to rad
-
-			// Calc the Cartesian coord with RA and DE
-			StelUtils::spheToRect(RA,DE,XYZ);
-			points->push_back(XYZ);
-		}
-
-		// this list is for the de-allocation
-		allBoundarySegments.push_back(points);
-
-		istr >> numc;
-		// there are 2 constellations per boundary
-
-		for (j=0;j<numc;j++)
-		{
-			istr >> consname;
-			// not used?
-			if (consname == "SER1" || consname == "SER2") consname = "SER";
-
-			cons = findFromAbbreviation(consname);
-			if (!cons)
-				qWarning() << "ERROR while processing boundary file - cannot find constellation: " << consname;
-			else
-				cons->isolatedBoundarySegments.push_back(points);
-		}
-
-		if (cons) cons->sharedBoundarySegments.push_back(points);
-		i++;
-
-	}
-	dataFile.close();
-	qDebug() << "Loaded" << i << "constellation boundary segments";
-	delete points;
-
-	return true;
-}
-
 void ConstellationMgr::drawBoundaries(StelPainter& sPainter) const
 {
 	sPainter.enableTexture2d(false);
@@ -1103,7 +1033,7 @@ void ConstellationMgr::drawBoundaries(StelPainter& sPainter) const
 	vector < Constellation * >::const_iterator iter;
 	for (iter = asterisms.begin(); iter != asterisms.end(); ++iter)
 	{
-		(*iter)->drawBoundaryOptim(sPainter);
+		(*iter)->drawBoundaryOptim(sPainter, boundaryVertices);
 	}
 #ifndef USE_OPENGL_ES2
 	glDisable(GL_LINE_STIPPLE);
@@ -25,10 +25,12 @@
 #include <QString>
 #include <QStringList>
 #include <QFont>
+#include <QVector>
 
 #include "StelObjectType.hpp"
 #include "StelObjectModule.hpp"
 #include "StelProjectorType.hpp"
+#include "CompiledSkyCulture.hpp"
 
 class StelToneReproducer;
 class StarMgr;
@@ -222,32 +224,27 @@ private slots:
 	void updateI18n();
 
 private:
-	//! Read constellation names from the given file.
-	//! @param namesFile Name of the file containing the constellation names in english
-	void loadNames(const QString& namesFile);
+	//! Create the constellations from the compiled lines, names and boundaries of a sky culture.
+	//! This function deletes any currently loaded constellation.
+	//! @param data the compiled sky culture data.
+	//! @param cultureName A string ID of the current skyculture
+	void loadCompiledData(const CompiledSkyCulture& data, const QString& cultureName);
 
-	//! Load constellation line shapes, art textures and boundaries shapes from data files.
-	//! @param fileName The name of the constellation data file
+	//! Load the constellation art textures.
 	//! @param artFileName The name of the constellation art data file
 	//! @param cultureName A string ID of the current skyculture
-	void loadLinesAndArt(const QString& fileName, const QString& artfileName, const QString& cultureName);
-
-	//! Load the constellation boundary file.
-	//! This function deletes any currently loaded constellation boundaries
-	//! and loads a new set from the file passed as the parameter.  The boundary
-	//! data file consists of whitespace separated values (space, tab or newline).
-	//! Each boundary may span multiple lines, and consists of the following ordered
-	//! data items:
-	//!  - The number of vertexes which make up in the boundary (integer).
-	//!  - For each vertex, two floating point numbers describing the ra and dec
-	//!    of the vertex.
-	//!  - The number of constellations which this boundary separates (always 2).
-	//!  - Two constellation abbreviations representing the constellations which
-	//!    the boundary separates.
-	//! @param conCatFile the path to the file which contains the constellation boundary data.
-	bool loadBoundaries(const QString& conCatFile);
-        //! Draw the constellation lines at the epoch given by the StelCore.
-	void drawLines(StelPainter& sPainter, const StelCore* core) const;
+	void loadArt(const QString& artfileName, const QString& cultureName);
+
+	//! Tessellate the lines of all constellations into the shared lines buffer.
+	//! The star positions are taken at the current date, so that the lines follow proper motions.
+	void tessellateLines();
+	//! Tessellate the boundaries of a constellation at the end of the shared boundaries buffer.
+	//! @param cons the constellation.
+	//! @param data the compiled sky culture data containing the boundary segments.
+	//! @param record the compiled record of the constellation.
+	void tessellateBoundaries(Constellation* cons, const CompiledSkyCulture& data, const CompiledSkyCulture::Record& record);
+	//! Draw the constellation lines.
+	void drawLines(StelPainter& sPainter) const;
 	//! Draw the constellation art.
 	void drawArt(StelPainter& sPainter) const;
 	//! Draw the constellation name labels.
@@ -282,7 +279,15 @@ private:
 	StarMgr* hipStarMgr;
 
 	bool isolateSelected;
-	std::vector<std::vector<Vec3f> *> allBoundarySegments;
+
+	//! Constellation lines tessellated in great circle arcs pieces, as GL_LINES in J2000 frame.
+	//! Each constellation refers to its own range of this buffer.
+	QVector<Vec3d> lineVertices;
+	//! Date at which the lines were last tessellated.
+	double linesTessellationJD;
+	//! Constellation boundaries tessellated in great circle arcs pieces, as GL_LINES in J2000 frame.
+	//! Each constellation refers to its own isolated and shared ranges of this buffer.
+	QVector<Vec3d> boundaryVertices;
 
 	QString lastLoadedSkyCulture;	// Store the last loaded sky culture directory name
 
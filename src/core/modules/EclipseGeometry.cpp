@@ -0,0 +1,251 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "EclipseGeometry.hpp"
+#include "StelUtils.hpp"
+#include "stellplanet.h"
+
+#include <QtGlobal>
+#include <cmath>
+
+//! Radii of the Sun, of the Earth and of the Moon in AU
+static const double SUN_RADIUS = 696000./AU;
+static const double EARTH_RADIUS = 6378.1/AU;
+static const double MOON_RADIUS = 1737.4/AU;
+//! Margin in AU around the penumbra inside which the shadow is drawn over the Moon
+static const double NEAR_ECLIPSE_MARGIN = 2000./AU;
+//! Number of sides of the shadow disks
+static const int SHADOW_MESH_SIDES = 100;
+//! Factor applied to the radius of the umbra disk, so that its edge is inside the penumbra strip
+static const double UMBRA_MESH_SCALE = 1.02;
+
+//! Mean synodic month in days, and date of the mean new moon of January 2000 (Meeus, Astronomical Algorithms, chapter 49)
+static const double SYNODIC_MONTH = 29.530588861;
+static const double FIRST_NEW_MOON_JD = 2451550.09766;
+//! Maximum difference in days between a true full moon and the mean one
+static const double MAX_FULL_MOON_OFFSET = 1.;
+//! There is no lunar eclipse when the sine of the argument of latitude of the Moon at the mean full moon is
+//! above 0.36 (Meeus, chapter 54), keep a margin
+static const double MAX_SIN_ARGUMENT_OF_LATITUDE = 0.4;
+//! Distance in AU from the Moon to the shadow axis found by the first coarse search above which there is no eclipse:
+//! 1.5 times the largest radius of the penumbra plus the radius of the Moon
+static const double MAX_COARSE_ECLIPSE_DISTANCE = 1.5*(9000.+1737.4)/AU;
+//! Precision in days of the computed dates
+static const double ECLIPSE_DATE_PRECISION = 1e-5;
+//! Distance in days between the two first dates of the secant method for the contacts, and maximum number of iterations
+static const double CONTACT_SECANT_STEP = 0.001;
+static const int MAX_CONTACT_ITERATIONS = 10;
+
+EclipseGeometry::EarthShadow EclipseGeometry::computeEarthShadow(const Vec3d& earthPos, const Vec3d& moonPos)
+{
+	EarthShadow s;
+	const double earthDistance = earthPos.length();
+	const double moonDistance = moonPos.length();
+
+	// The shadow at the distance of the Moon along the Sun-Earth axis
+	s.center = earthPos*((earthDistance+moonDistance)/earthDistance);
+	s.moonPos = earthPos+moonPos;
+	s.penumbraRadius = (earthDistance+moonDistance)*(SUN_RADIUS+EARTH_RADIUS)/earthDistance - SUN_RADIUS;
+	s.umbraRadius = EARTH_RADIUS - moonDistance*(SUN_RADIUS-EARTH_RADIUS)/earthDistance;
+	s.moonDistance = (s.center-s.moonPos).length();
+	s.nearEclipse = s.moonDistance<=s.penumbraRadius+NEAR_ECLIPSE_MARGIN;
+	return s;
+}
+
+EclipseGeometry::EarthShadow EclipseGeometry::computeEarthShadow(double JD)
+{
+	double earth[3];
+	double moon[3];
+	get_earth_helio_coordsv(JD, earth, NULL);
+	get_lunar_parent_coordsv(JD, moon, NULL);
+	return computeEarthShadow(Vec3d(earth[0], earth[1], earth[2]), Vec3d(moon[0], moon[1], moon[2]));
+}
+
+// The cosine and sine of the angles of the edge points of the shadow disks
+static QVector<Vec2d> computeShadowMeshCircle()
+{
+	QVector<Vec2d> circle(SHADOW_MESH_SIDES+1);
+	for (int i=0;i<=SHADOW_MESH_SIDES;++i)
+	{
+		const double a = 2.*M_PI*i/SHADOW_MESH_SIDES;
+		circle[i].set(std::cos(a), std::sin(a));
+	}
+	return circle;
+}
+
+void EclipseGeometry::computeShadowMesh(const EarthShadow& shadow, double moonScale, ShadowMesh& mesh)
+{
+	static const QVector<Vec2d> circle = computeShadowMeshCircle();
+
+	// The shadow follows the scaled Moon
+	const Vec3d center = shadow.moonPos + (shadow.center-shadow.moonPos)*moonScale;
+	const double umbraRadius = shadow.umbraRadius*moonScale*UMBRA_MESH_SCALE;
+	const double penumbraRadius = shadow.penumbraRadius*moonScale;
+
+	// Two orthogonal directions in the plane of the disks
+	Vec3d axis(center);
+	axis.normalize();
+	Vec3d u = center^Vec3d(0,0,1);
+	u.normalize();
+	const Vec3d v = axis^u;
+
+	mesh.umbraVertices.resize(SHADOW_MESH_SIDES+2);
+	mesh.penumbraVertices.resize(2*(SHADOW_MESH_SIDES+1));
+	mesh.umbraVertices[0] = center;
+	for (int i=0;i<=SHADOW_MESH_SIDES;++i)
+	{
+		const Vec3d dir = u*circle.at(i)[0] + v*circle.at(i)[1];
+		mesh.umbraVertices[i+1] = center + dir*umbraRadius;
+		mesh.penumbraVertices[2*i] = mesh.umbraVertices.at(i+1);
+		mesh.penumbraVertices[2*i+1] = center + dir*penumbraRadius;
+	}
+}
+
+// johannes: work-around for nasty ATI rendering bug: use y-texture coordinate of 0.5 instead of 0.0
+static QVector<Vec2f> computeUmbraTexCoords()
+{
+	QVector<Vec2f> texCoords(SHADOW_MESH_SIDES+2, Vec2f(0.6f, 0.5f));
+	texCoords[0].set(0.f, 0.5f);
+	return texCoords;
+}
+
+static QVector<Vec2f> computePenumbraTexCoords()
+{
+	QVector<Vec2f> texCoords;
+	texCoords.reserve(2*(SHADOW_MESH_SIDES+1));
+	for (int i=0;i<=SHADOW_MESH_SIDES;++i)
+		texCoords << Vec2f(0.6f, 0.5f) << Vec2f(1.f, 0.5f);
+	return texCoords;
+}
+
+const QVector<Vec2f>& EclipseGeometry::getUmbraTexCoords()
+{
+	static const QVector<Vec2f> texCoords = computeUmbraTexCoords();
+	return texCoords;
+}
+
+const QVector<Vec2f>& EclipseGeometry::getPenumbraTexCoords()
+{
+	static const QVector<Vec2f> texCoords = computePenumbraTexCoords();
+	return texCoords;
+}
+
+double EclipseGeometry::getContactDistance(double JD, bool umbra, double moonRadiusFactor)
+{
+	const EarthShadow s = computeEarthShadow(JD);
+	return s.moonDistance - (umbra ? s.umbraRadius : s.penumbraRadius) - moonRadiusFactor*MOON_RADIUS;
+}
+
+double EclipseGeometry::findContact(double estimateJD, bool umbra, double moonRadiusFactor)
+{
+	double JD0 = estimateJD-CONTACT_SECANT_STEP;
+	double JD1 = estimateJD;
+	double d0 = getContactDistance(JD0, umbra, moonRadiusFactor);
+	double d1 = getContactDistance(JD1, umbra, moonRadiusFactor);
+	for (int i=0;i<MAX_CONTACT_ITERATIONS && std::fabs(JD1-JD0)>ECLIPSE_DATE_PRECISION && d1!=d0;++i)
+	{
+		const double JD = JD1 - d1*(JD1-JD0)/(d1-d0);
+		JD0 = JD1;
+		d0 = d1;
+		JD1 = JD;
+		d1 = getContactDistance(JD1, umbra, moonRadiusFactor);
+	}
+	return JD1;
+}
+
+// Fit a parabola through the squared distances of the Moon to the shadow axis at JD-h, JD and JD+h, move JD to
+// its minimum and return its curvature. The squared distance is close to a parabola because the Moon crosses
+// the shadow in a nearly straight line at a nearly constant speed.
+// @param minDistance receives the distance at the minimum of the parabola.
+static double fitClosestApproach(double& JD, double h, double& minDistance)
+{
+	const double dm = EclipseGeometry::computeEarthShadow(JD-h).moonDistance;
+	const double d0 = EclipseGeometry::computeEarthShadow(JD).moonDistance;
+	const double dp = EclipseGeometry::computeEarthShadow(JD+h).moonDistance;
+	const double secondDifference = dm*dm - 2.*d0*d0 + dp*dp;
+	minDistance = d0;
+	if (secondDifference>0.)
+	{
+		const double offset = qBound(-2., 0.5*(dm*dm-dp*dp)/secondDifference, 2.);
+		JD += offset*h;
+		minDistance = std::sqrt(qMax(0., d0*d0 + offset*offset*secondDifference/2. - offset*(dm*dm-dp*dp)/2.));
+	}
+	return secondDifference/(2.*h*h);
+}
+
+QVector<EclipseGeometry::LunarEclipse> EclipseGeometry::findLunarEclipses(double startJD, double endJD)
+{
+	QVector<LunarEclipse> res;
+	for (double k=std::floor((startJD-FIRST_NEW_MOON_JD)/SYNODIC_MONTH)-1.5;;k+=1.)
+	{
+		const double meanJD = FIRST_NEW_MOON_JD + SYNODIC_MONTH*k;
+		if (meanJD>endJD+MAX_FULL_MOON_OFFSET)
+			break;
+		if (meanJD<startJD-MAX_FULL_MOON_OFFSET)
+			continue;
+
+		// Skip the full moons far from the nodes
+		const double T = k/1236.85;
+		const double F = (160.7108 + 390.67050284*k - 0.0016118*T*T)*M_PI/180.;
+		if (std::fabs(std::sin(F))>MAX_SIN_ARGUMENT_OF_LATITUDE)
+			continue;
+
+		// The maximum is where the Moon is the closest to the shadow axis. The first fit is coarse,
+		// but it is enough to skip the full moons passing far from the penumbra
+		LunarEclipse e;
+		e.maximumJD = meanJD;
+		double minDistance;
+		double curvature = fitClosestApproach(e.maximumJD, MAX_FULL_MOON_OFFSET/2., minDistance);
+		if (minDistance>MAX_COARSE_ECLIPSE_DISTANCE)
+			continue;
+		for (double h=MAX_FULL_MOON_OFFSET/20.;h>=ECLIPSE_DATE_PRECISION*100.;h/=10.)
+			curvature = fitClosestApproach(e.maximumJD, h, minDistance);
+		if (e.maximumJD<startJD || e.maximumJD>endJD || curvature<=0.)
+			continue;
+		const EarthShadow s = computeEarthShadow(e.maximumJD);
+		e.penumbralMagnitude = (s.penumbraRadius+MOON_RADIUS-s.moonDistance)/(2.*MOON_RADIUS);
+		if (e.penumbralMagnitude<=0.)
+			continue;
+		e.umbralMagnitude = (s.umbraRadius+MOON_RADIUS-s.moonDistance)/(2.*MOON_RADIUS);
+
+		// Each contact is first estimated from the parabola, then refined
+		const double d2 = s.moonDistance*s.moonDistance;
+		double r = s.penumbraRadius+MOON_RADIUS;
+		double halfDuration = std::sqrt((r*r-d2)/curvature);
+		e.penumbralStartJD = findContact(e.maximumJD-halfDuration, false, 1.);
+		e.penumbralEndJD = findContact(e.maximumJD+halfDuration, false, 1.);
+		e.partialStartJD = e.partialEndJD = e.totalStartJD = e.totalEndJD = 0.;
+		if (e.umbralMagnitude>0.)
+		{
+			r = s.umbraRadius+MOON_RADIUS;
+			halfDuration = std::sqrt((r*r-d2)/curvature);
+			e.partialStartJD = findContact(e.maximumJD-halfDuration, true, 1.);
+			e.partialEndJD = findContact(e.maximumJD+halfDuration, true, 1.);
+		}
+		if (e.umbralMagnitude>=1.)
+		{
+			r = s.umbraRadius-MOON_RADIUS;
+			halfDuration = std::sqrt((r*r-d2)/curvature);
+			e.totalStartJD = findContact(e.maximumJD-halfDuration, true, -1.);
+			e.totalEndJD = findContact(e.maximumJD+halfDuration, true, -1.);
+		}
+		res.append(e);
+	}
+	return res;
+}
@@ -0,0 +1,125 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _ECLIPSEGEOMETRY_HPP_
+#define _ECLIPSEGEOMETRY_HPP_
+
+#include <QVector>
+
+#include "VecMath.hpp"
+
+//! @class EclipseGeometry
+//! The geometry of the shadow of the Earth at the distance of the Moon, used to draw the lunar eclipses
+//! and to list them over long date ranges.
+//! The umbra and the penumbra are the cones tangent to the Sun and to the Earth, without the enlargement
+//! by the atmosphere of the Earth, so that the listed eclipses match the drawn shadow.
+class EclipseGeometry
+{
+public:
+	//! @struct EarthShadow
+	//! The cross section of the shadow of the Earth at the distance of the Moon, in heliocentric ecliptic coordinates.
+	struct EarthShadow
+	{
+		//! The point of the shadow axis at the distance of the Moon from the Earth, in AU
+		Vec3d center;
+		//! The heliocentric position of the Moon in AU
+		Vec3d moonPos;
+		//! The radii of the umbra and of the penumbra in AU
+		double umbraRadius;
+		double penumbraRadius;
+		//! The distance from the center of the Moon to center in AU
+		double moonDistance;
+		//! Whether the Moon is close enough to the penumbra for the shadow to be drawn over it
+		bool nearEclipse;
+	};
+
+	//! @struct ShadowMesh
+	//! The disks of the umbra and of the penumbra drawn over the Moon, in heliocentric ecliptic coordinates.
+	//! They match the texture coordinates returned by getUmbraTexCoords() and getPenumbraTexCoords().
+	struct ShadowMesh
+	{
+		//! A triangle fan: the center of the shadow, then the edge of the umbra
+		QVector<Vec3d> umbraVertices;
+		//! A triangle strip between the edges of the umbra and of the penumbra
+		QVector<Vec3d> penumbraVertices;
+	};
+
+	//! @struct LunarEclipse
+	//! The circumstances of a lunar eclipse. The dates are Julian days.
+	struct LunarEclipse
+	{
+		//! The date when the Moon is the closest to the shadow axis
+		double maximumJD;
+		//! The fraction of the diameter of the Moon inside the penumbra and the umbra at the maximum.
+		//! The eclipse is penumbral if umbralMagnitude<=0, and total if umbralMagnitude>=1.
+		double penumbralMagnitude;
+		double umbralMagnitude;
+		//! The first and last contacts with the penumbra
+		double penumbralStartJD;
+		double penumbralEndJD;
+		//! The first and last contacts with the umbra, or 0 for a penumbral eclipse
+		double partialStartJD;
+		double partialEndJD;
+		//! The second and third contacts with the umbra, or 0 if the eclipse is not total
+		double totalStartJD;
+		double totalEndJD;
+	};
+
+	//! Compute the shadow of the Earth at the distance of the Moon.
+	//! @param earthPos the heliocentric ecliptic position of the Earth in AU.
+	//! @param moonPos the geocentric ecliptic position of the Moon in AU.
+	static EarthShadow computeEarthShadow(const Vec3d& earthPos, const Vec3d& moonPos);
+
+	//! Compute the shadow of the Earth at a date with the VSOP87 and ELP82B theories.
+	static EarthShadow computeEarthShadow(double JD);
+
+	//! Compute the disks of the shadow drawn over the Moon.
+	//! @param shadow the shadow of the Earth.
+	//! @param moonScale the scale applied to the Moon sphere, which the shadow follows.
+	//! @param mesh receives the vertices.
+	static void computeShadowMesh(const EarthShadow& shadow, double moonScale, ShadowMesh& mesh);
+
+	//! Get the texture coordinates of ShadowMesh::umbraVertices in the shadow texture.
+	static const QVector<Vec2f>& getUmbraTexCoords();
+	//! Get the texture coordinates of ShadowMesh::penumbraVertices in the shadow texture.
+	static const QVector<Vec2f>& getPenumbraTexCoords();
+
+	//! Find the lunar eclipses whose maximum is between two dates, using the VSOP87 and ELP82B theories.
+	//! The full moons are predicted from the mean lunation, and the ones too far from the nodes of the
+	//! lunar orbit are skipped without computing any position.
+	//! The theories keep their last results in static variables, so this must not be called while the
+	//! SolarSystem computes the positions in its worker threads.
+	//! @param startJD the first date.
+	//! @param endJD the last date.
+	//! @return the eclipses sorted by date.
+	static QVector<LunarEclipse> findLunarEclipses(double startJD, double endJD);
+
+private:
+	//! Get the distance from the center of the Moon to the edge of the umbra or of the penumbra, minus a factor
+	//! of the radius of the Moon. It is positive when the contact is not reached yet.
+	static double getContactDistance(double JD, bool umbra, double moonRadiusFactor);
+
+	//! Find the date of a contact of the Moon with the umbra or the penumbra with the secant method.
+	//! @param estimateJD a first estimate of the date.
+	//! @param umbra whether the contact is with the umbra or with the penumbra.
+	//! @param moonRadiusFactor 1 for an external contact, -1 for an internal contact.
+	static double findContact(double estimateJD, bool umbra, double moonRadiusFactor);
+};
+
+#endif // _ECLIPSEGEOMETRY_HPP_
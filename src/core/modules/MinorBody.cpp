@@ -0,0 +1,106 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "MinorBody.hpp"
+#include "SolarSystem.hpp"
+#include "StelCore.hpp"
+#include "StelSkyDrawer.hpp"
+#include "RefractionExtinction.hpp"
+#include "StelTranslator.hpp"
+
+#include <QTextStream>
+
+MinorBody::MinorBody(const SolarSystem* ssystem, int index) : ssystem(ssystem), index(index), generation(ssystem->minorBodiesGeneration)
+{
+	englishName = ssystem->minorBodies.getEnglishName(index);
+}
+
+int MinorBody::getIndex() const
+{
+	if (generation!=ssystem->minorBodiesGeneration)
+	{
+		index = ssystem->minorBodyIndex.value(englishName, -1);
+		generation = ssystem->minorBodiesGeneration;
+	}
+	// The positions are computed again after the catalogue is loaded
+	return index<ssystem->minorBodyPositions.size() ? index : -1;
+}
+
+Vec3d MinorBody::getJ2000EquatorialPos(const StelCore* core) const
+{
+	const int i = getIndex();
+	if (i<0)
+		return Vec3d(1.,0.,0.);
+	return StelCore::matVsop87ToJ2000.multiplyWithoutTranslation(ssystem->minorBodyPositions.at(i)-core->getObserverHeliocentricEclipticPos());
+}
+
+float MinorBody::getVMagnitude(const StelCore* core, bool withExtinction) const
+{
+	const int i = getIndex();
+	if (i<0)
+		return 99.f;
+	float mag = ssystem->minorBodies.computeMagnitude(i, ssystem->minorBodyPositions.at(i), core->getObserverHeliocentricEclipticPos());
+	if (withExtinction && core->getSkyDrawer()->getFlagHasAtmosphere())
+	{
+		Vec3d altAz = getAltAzPosApparent(core);
+		altAz.normalize();
+		core->getSkyDrawer()->getExtinction().forward(&altAz, &mag);
+	}
+	return mag;
+}
+
+// Same layout as MinorPlanet::getInfoString(), with what is known without creating the MinorPlanet
+QString MinorBody::getInfoString(const StelCore* core, const InfoStringGroup& flags) const
+{
+	QString str;
+	QTextStream oss(&str);
+
+	const int i = getIndex();
+	if (flags&Name)
+	{
+		oss << "<h2>";
+		const quint32 number = i<0 ? 0 : ssystem->minorBodies.numbers.at(i);
+		if (number)
+			oss << QString("(%1) ").arg(number);
+		oss << getEnglishName() << "</h2>";
+	}
+
+	if (flags&Magnitude)
+	{
+		if (core->getSkyDrawer()->getFlagHasAtmosphere())
+			oss << q_("Magnitude: <b>%1</b> (extincted to: <b>%2</b>)").arg(QString::number(getVMagnitude(core, false), 'f', 2),
+											QString::number(getVMagnitude(core, true), 'f', 2)) << "<br>";
+		else
+			oss << q_("Magnitude: <b>%1</b>").arg(getVMagnitude(core, false), 0, 'f', 2) << "<br>";
+	}
+
+	if ((flags&AbsoluteMagnitude) && i>=0)
+		oss << q_("Absolute Magnitude: %1").arg(ssystem->minorBodies.absoluteMagnitudes.at(i), 0, 'f', 2) << "<br>";
+
+	oss << getPositionInfoString(core, flags);
+
+	if (flags&Distance)
+	{
+		// xgettext:no-c-format
+		oss << q_("Distance: %1AU").arg(getJ2000EquatorialPos(core).length(), 0, 'f', 8) << "<br>";
+	}
+
+	postProcessInfoString(str, flags);
+	return str;
+}
@@ -0,0 +1,62 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _MINORBODY_HPP_
+#define _MINORBODY_HPP_
+
+#include "StelObject.hpp"
+
+class SolarSystem;
+
+//! @class MinorBody
+//! A lightweight StelObject for an entry of the minor body catalogue of the SolarSystem, returned by its searches.
+//! It only refers to the entry, and reads its position from the positions computed in bulk by the SolarSystem,
+//! so that searching the catalogue does not create a Planet object for each body found.
+//! The SolarSystem replaces it by a full MinorPlanet when it is selected.
+//! When the catalogue is loaded again, the index is looked up again from the name of the entry.
+class MinorBody : public StelObject
+{
+public:
+	//! @param ssystem the SolarSystem which computes the position of the entry.
+	//! @param index the index of the entry in the minor body catalogue.
+	MinorBody(const SolarSystem* ssystem, int index);
+
+	//! Get the index of the entry in the minor body catalogue, or -1 if it is no longer in the catalogue.
+	int getIndex() const;
+
+	virtual QString getInfoString(const StelCore* core, const InfoStringGroup& flags) const;
+	virtual QString getType() const {return "MinorBody";}
+	virtual QString getEnglishName() const {return englishName;}
+	//! The names of the catalogue minor bodies are not translated.
+	virtual QString getNameI18n() const {return getEnglishName();}
+	virtual Vec3d getJ2000EquatorialPos(const StelCore* core) const;
+	virtual float getVMagnitude(const StelCore* core, bool withExtinction=false) const;
+	virtual float getSelectPriority(const StelCore* core) const {return getVMagnitude(core);}
+	//! The catalogue has no diameters, the bodies are drawn as point sources.
+	virtual double getAngularSize(const StelCore*) const {return 0.;}
+
+private:
+	const SolarSystem* ssystem;
+	QString englishName;
+	//! The index in the catalogue, valid for the catalogue generation it was looked up in
+	mutable int index;
+	mutable int generation;
+};
+
+#endif // _MINORBODY_HPP_
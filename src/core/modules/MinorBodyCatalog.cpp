@@ -0,0 +1,415 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "MinorBodyCatalog.hpp"
+#include "Orbit.hpp"
+#include "StelFileMgr.hpp"
+#include "StelUtils.hpp"
+
+#include <cmath>
+#include <QFile>
+#include <QFileInfo>
+#include <QDataStream>
+#include <QDebug>
+
+// Identify the cache files, and their format version which must be increased at each format change
+static const quint32 CACHE_FILE_MAGIC = 0x4D504342;
+static const quint32 CACHE_FILE_VERSION = 1;
+
+// Slope parameter used when the record doesn't give one
+static const float DEFAULT_SLOPE_PARAMETER = 0.15f;
+
+// Write an array of primitive values in native byte order so that it can be read in one block
+template<class T> static void writeArray(QDataStream& out, const QVector<T>& array)
+{
+	out << (qint32)array.size();
+	out.writeRawData((const char*)array.constData(), array.size()*sizeof(T));
+}
+
+template<class T> static bool readArray(QDataStream& in, QVector<T>& array)
+{
+	qint32 size;
+	in >> size;
+	// Check the size before allocating, a corrupted file could ask for much more than it contains
+	if (in.status()!=QDataStream::Ok || size<0 || (qint64)size>in.device()->bytesAvailable()/(qint64)sizeof(T))
+		return false;
+	array.resize(size);
+	const int bytes = size*sizeof(T);
+	return in.readRawData((char*)array.data(), bytes)==bytes;
+}
+
+// Return whether the offsets start at 0, never decrease and end at the given size, so that every range they define is valid
+static bool checkOffsets(const QVector<int>& offsets, int size)
+{
+	if (offsets.isEmpty() || offsets.first()!=0 || offsets.last()!=size)
+		return false;
+	for (int i=1;i<offsets.size();++i)
+	{
+		if (offsets.at(i)<offsets.at(i-1))
+			return false;
+	}
+	return true;
+}
+
+// Keep the elements of an array whose index is not marked as removed
+template<class T> static void removeElements(QVector<T>& array, const QVector<bool>& removed)
+{
+	int j=0;
+	for (int i=0;i<array.size();++i)
+	{
+		if (!removed.at(i))
+			array[j++] = array.at(i);
+	}
+	array.resize(j);
+}
+
+QString MinorBodyCatalog::getCacheFilePath(const QString& sourceFile)
+{
+	return StelFileMgr::getUserDir() + "/cache/minorbodies/" + QFileInfo(sourceFile).completeBaseName() + ".dat";
+}
+
+// Decode a digit of the MPC packed dates: 0-9, then A=10 to V=31
+static int unpackDigit(char c)
+{
+	if (c>='0' && c<='9')
+		return c-'0';
+	if (c>='A' && c<='V')
+		return c-'A'+10;
+	return -1;
+}
+
+// Decode a MPC packed date like K107N (2010 July 23) into a JD at 0h TT
+static bool unpackEpoch(const QByteArray& packed, double& jd)
+{
+	if (packed.size()!=5)
+		return false;
+	const int century = unpackDigit(packed.at(0));
+	const int year = unpackDigit(packed.at(1))*10+unpackDigit(packed.at(2));
+	const int month = unpackDigit(packed.at(3));
+	const int day = unpackDigit(packed.at(4));
+	if (century<10 || year<0 || month<1 || month>12 || day<1)
+		return false;
+	return StelUtils::getJDFromDate(&jd, century*100+year, month, day, 0, 0, 0);
+}
+
+// Read a fixed width numeric field of a MPCORB record
+static double readField(const QByteArray& record, int start, int width, bool& ok)
+{
+	return record.mid(start, width).trimmed().toDouble(&ok);
+}
+
+bool MinorBodyCatalog::compile(const QString& mpcorbFile)
+{
+	sources.clear();
+	sources << CompiledCacheFile::computeSignature(mpcorbFile);
+	epochs.clear();
+	meanAnomaliesAtEpoch.clear();
+	meanMotions.clear();
+	semiMajorAxes.clear();
+	eccentricities.clear();
+	inclinations.clear();
+	ascendingNodes.clear();
+	argsOfPerihelion.clear();
+	absoluteMagnitudes.clear();
+	slopeParameters.clear();
+	numbers.clear();
+	namePool.clear();
+	nameOffsets.clear();
+
+	QFile in(mpcorbFile);
+	if (!in.open(QIODevice::ReadOnly))
+	{
+		qWarning() << "Can't open minor body data file" << mpcorbFile;
+		return false;
+	}
+
+	// The records have fixed width fields, see http://www.minorplanetcenter.net/iau/info/MPOrbitFormat.html
+	int totalRecords=0;
+	QByteArray record;
+	while (!in.atEnd())
+	{
+		record = in.readLine();
+		if (record.size()<103)
+			continue;
+		++totalRecords;
+
+		bool ok[8];
+		double jd;
+		const double M = readField(record, 26, 9, ok[0]);
+		const double argOfPerihelion = readField(record, 37, 9, ok[1]);
+		const double node = readField(record, 48, 9, ok[2]);
+		const double inclination = readField(record, 59, 9, ok[3]);
+		const double e = readField(record, 70, 9, ok[4]);
+		const double n = readField(record, 80, 11, ok[5]);
+		const double a = readField(record, 92, 11, ok[6]);
+		ok[7] = unpackEpoch(record.mid(20, 5), jd);
+		if (!(ok[0] && ok[1] && ok[2] && ok[3] && ok[4] && ok[5] && ok[6] && ok[7]) || e<0. || e>=1. || a<=0.)
+			continue;
+
+		bool hOk, gOk;
+		const double H = readField(record, 8, 5, hOk);
+		const double G = readField(record, 14, 5, gOk);
+
+		// The readable designation is like "(1) Ceres", "(3708) 1974 FV1" or "2010 AB123"
+		QByteArray name = record.size()>166 ? record.mid(166, 28).trimmed() : QByteArray();
+		quint32 number = 0;
+		if (name.startsWith('('))
+		{
+			const int end = name.indexOf(')');
+			if (end>0)
+			{
+				number = name.mid(1, end-1).toUInt();
+				name = name.mid(end+1).trimmed();
+			}
+		}
+		if (name.isEmpty())
+			name = record.left(7).trimmed();
+
+		epochs.append(jd);
+		meanAnomaliesAtEpoch.append(M*M_PI/180.);
+		meanMotions.append(n*M_PI/180.);
+		semiMajorAxes.append(a);
+		eccentricities.append(e);
+		inclinations.append(inclination*M_PI/180.);
+		ascendingNodes.append(node*M_PI/180.);
+		argsOfPerihelion.append(argOfPerihelion*M_PI/180.);
+		absoluteMagnitudes.append(hOk ? H : 99.f);
+		slopeParameters.append(gOk && G>=0. && G<=1. ? G : DEFAULT_SLOPE_PARAMETER);
+		numbers.append(number);
+		nameOffsets.append(namePool.size());
+		namePool += name;
+	}
+	nameOffsets.append(namePool.size());
+	in.close();
+	computeRotations();
+	qDebug() << "Compiled" << size() << "/" << totalRecords << "minor body records successfully";
+	return true;
+}
+
+void MinorBodyCatalog::computeRotations()
+{
+	const int nb = size();
+	planeToVsop87.resize(6*nb);
+	for (int i=0;i<nb;++i)
+	{
+		// Same rotation as an EllipticalOrbit around the Sun, whose frame is already VSOP87
+		const double co = std::cos(argsOfPerihelion.at(i));
+		const double so = std::sin(argsOfPerihelion.at(i));
+		const double cOm = std::cos(ascendingNodes.at(i));
+		const double sOm = std::sin(ascendingNodes.at(i));
+		const double ci = std::cos(inclinations.at(i));
+		const double si = std::sin(inclinations.at(i));
+		double* r = planeToVsop87.data()+6*i;
+		r[0] = co*cOm-so*sOm*ci;
+		r[1] = -so*cOm-co*sOm*ci;
+		r[2] = co*sOm+so*cOm*ci;
+		r[3] = -so*sOm+co*cOm*ci;
+		r[4] = so*si;
+		r[5] = co*si;
+	}
+}
+
+int MinorBodyCatalog::removeEnglishNames(const QSet<QString>& names)
+{
+	const int nb = size();
+	QVector<bool> removed(nb, false);
+	int nbRemoved = 0;
+	for (int i=0;i<nb;++i)
+	{
+		if (names.contains(getEnglishName(i)))
+		{
+			removed[i] = true;
+			++nbRemoved;
+		}
+	}
+	if (nbRemoved==0)
+		return 0;
+
+	QByteArray newNamePool;
+	QVector<int> newNameOffsets;
+	for (int i=0;i<nb;++i)
+	{
+		if (removed.at(i))
+			continue;
+		newNameOffsets.append(newNamePool.size());
+		newNamePool.append(namePool.constData()+nameOffsets.at(i), nameOffsets.at(i+1)-nameOffsets.at(i));
+	}
+	newNameOffsets.append(newNamePool.size());
+	namePool = newNamePool;
+	nameOffsets = newNameOffsets;
+
+	removeElements(epochs, removed);
+	removeElements(meanAnomaliesAtEpoch, removed);
+	removeElements(meanMotions, removed);
+	removeElements(semiMajorAxes, removed);
+	removeElements(eccentricities, removed);
+	removeElements(inclinations, removed);
+	removeElements(ascendingNodes, removed);
+	removeElements(argsOfPerihelion, removed);
+	removeElements(absoluteMagnitudes, removed);
+	removeElements(slopeParameters, removed);
+	removeElements(numbers, removed);
+	computeRotations();
+	return nbRemoved;
+}
+
+void MinorBodyCatalog::computePositionsAtDates(const QVector<double>& dates, QVector<Vec3d>& positions) const
+{
+	const int nb = size();
+	QVector<double> meanAnomalies(nb);
+	for (int i=0;i<nb;++i)
+		meanAnomalies[i] = meanAnomaliesAtEpoch.at(i)+meanMotions.at(i)*(dates.at(i)-epochs.at(i));
+	QVector<double> anomalies(nb);
+	solveKeplerElliptic(eccentricities.constData(), meanAnomalies.constData(), anomalies.data(), nb);
+
+	positions.resize(nb);
+	for (int i=0;i<nb;++i)
+	{
+		const double e = eccentricities.at(i);
+		const double a = semiMajorAxes.at(i);
+		const double x = a*(std::cos(anomalies.at(i))-e);
+		const double y = a*std::sqrt(1.-e*e)*std::sin(anomalies.at(i));
+		const double* r = planeToVsop87.constData()+6*i;
+		positions[i].set(r[0]*x+r[1]*y, r[2]*x+r[3]*y, r[4]*x+r[5]*y);
+	}
+}
+
+void MinorBodyCatalog::computePositions(double JD, QVector<Vec3d>& positions, const Vec3d* lightTimeObserverPos) const
+{
+	QVector<double> dates(size(), JD);
+	computePositionsAtDates(dates, positions);
+	if (lightTimeObserverPos==NULL)
+		return;
+	for (int i=0;i<dates.size();++i)
+		dates[i] = JD-(positions.at(i)-*lightTimeObserverPos).length()*(AU/(SPEED_OF_LIGHT*86400));
+	computePositionsAtDates(dates, positions);
+}
+
+void MinorBodyCatalog::computeMagnitudes(const QVector<Vec3d>& positions, const Vec3d& observerPos, QVector<float>& magnitudes) const
+{
+	const int nb = size();
+	magnitudes.resize(nb);
+	for (int i=0;i<nb;++i)
+		magnitudes[i] = computeMagnitude(i, positions.at(i), observerPos);
+}
+
+float MinorBodyCatalog::computeMagnitude(int i, const Vec3d& position, const Vec3d& observerPos) const
+{
+	// Same formulae as MinorPlanet::computeMagnitudeWithoutExtinction(), with tan(phase/2) computed from cos(phase)
+	const double observerRq = observerPos.lengthSquared();
+	const double planetRq = position.lengthSquared();
+	const double observerPlanetRq = (observerPos-position).lengthSquared();
+	const double cosChi = qBound(-1., (observerPlanetRq+planetRq-observerRq)/(2.*std::sqrt(observerPlanetRq*planetRq)), 1.);
+	const double tanHalfPhase = std::sqrt((1.-cosChi)/(1.+cosChi));
+	const double phi1 = std::exp(-3.33*std::pow(tanHalfPhase, 0.63));
+	const double phi2 = std::exp(-1.87*std::pow(tanHalfPhase, 1.22));
+	const double slope = slopeParameters.at(i);
+	const double reducedMagnitude = absoluteMagnitudes.at(i)-2.5*std::log10((1.-slope)*phi1+slope*phi2);
+	return reducedMagnitude+5.*std::log10(std::sqrt(planetRq*observerPlanetRq));
+}
+
+EllipticalOrbit* MinorBodyCatalog::createOrbit(int i) const
+{
+	const double e = eccentricities.at(i);
+	return new EllipticalOrbit(semiMajorAxes.at(i)*(1.-e), e, inclinations.at(i), ascendingNodes.at(i), argsOfPerihelion.at(i),
+				   meanAnomaliesAtEpoch.at(i), 2.*M_PI/meanMotions.at(i), epochs.at(i), 0., 0., 0.);
+}
+
+bool MinorBodyCatalog::load(const QString& cacheFile, const QStringList& sourceFiles)
+{
+	QFile file(cacheFile);
+	if (!file.open(QIODevice::ReadOnly))
+		return false;
+
+	// Read directly from the mapped file when possible, so that the bulk arrays are only copied once
+	const qint64 fileSize = file.size();
+	uchar* mapped = file.map(0, fileSize);
+	const QByteArray buf = mapped ? QByteArray::fromRawData((const char*)mapped, fileSize) : file.readAll();
+	QDataStream in(buf);
+	in.setVersion(QDataStream::Qt_4_6);
+
+	QVector<SourceSignature> signatures;
+	bool refreshed;
+	if (!CompiledCacheFile::readHeader(in, CACHE_FILE_MAGIC, CACHE_FILE_VERSION, sourceFiles, "Minor body", signatures, refreshed))
+		return false;
+
+	MinorBodyCatalog c;
+	if (!readArray(in, c.epochs) || !readArray(in, c.meanAnomaliesAtEpoch) || !readArray(in, c.meanMotions) ||
+		!readArray(in, c.semiMajorAxes) || !readArray(in, c.eccentricities) || !readArray(in, c.inclinations) ||
+		!readArray(in, c.ascendingNodes) || !readArray(in, c.argsOfPerihelion) || !readArray(in, c.absoluteMagnitudes) ||
+		!readArray(in, c.slopeParameters) || !readArray(in, c.numbers) || !readArray(in, c.nameOffsets))
+		return false;
+	in >> c.namePool;
+	const int nb = c.epochs.size();
+	if (in.status()!=QDataStream::Ok || c.meanAnomaliesAtEpoch.size()!=nb || c.meanMotions.size()!=nb ||
+		c.semiMajorAxes.size()!=nb || c.eccentricities.size()!=nb || c.inclinations.size()!=nb ||
+		c.ascendingNodes.size()!=nb || c.argsOfPerihelion.size()!=nb || c.absoluteMagnitudes.size()!=nb ||
+		c.slopeParameters.size()!=nb || c.numbers.size()!=nb || c.nameOffsets.size()!=nb+1 ||
+		!checkOffsets(c.nameOffsets, c.namePool.size()))
+		return false;
+
+	*this = c;
+	sources = signatures;
+	if (refreshed)
+	{
+		// Release the mapping before overwriting the file with the refreshed signatures
+		if (mapped)
+			file.unmap(mapped);
+		file.close();
+		save(cacheFile);
+	}
+	computeRotations();
+	return true;
+}
+
+bool MinorBodyCatalog::save(const QString& cacheFile) const
+{
+	StelFileMgr::mkDir(QFileInfo(cacheFile).absolutePath());
+	QFile file(cacheFile);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+	{
+		qWarning() << "Can't write minor body cache file" << cacheFile;
+		return false;
+	}
+
+	QDataStream out(&file);
+	out.setVersion(QDataStream::Qt_4_6);
+	CompiledCacheFile::writeHeader(out, CACHE_FILE_MAGIC, CACHE_FILE_VERSION, sources);
+	writeArray(out, epochs);
+	writeArray(out, meanAnomaliesAtEpoch);
+	writeArray(out, meanMotions);
+	writeArray(out, semiMajorAxes);
+	writeArray(out, eccentricities);
+	writeArray(out, inclinations);
+	writeArray(out, ascendingNodes);
+	writeArray(out, argsOfPerihelion);
+	writeArray(out, absoluteMagnitudes);
+	writeArray(out, slopeParameters);
+	writeArray(out, numbers);
+	writeArray(out, nameOffsets);
+	out << namePool;
+	file.close();
+	if (out.status()!=QDataStream::Ok)
+	{
+		qWarning() << "Error while writing minor body cache file" << cacheFile;
+		QFile::remove(cacheFile);
+		return false;
+	}
+	return true;
+}
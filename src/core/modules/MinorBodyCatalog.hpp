@@ -0,0 +1,138 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _MINORBODYCATALOG_HPP_
+#define _MINORBODYCATALOG_HPP_
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QByteArray>
+#include <QSet>
+
+#include "VecMath.hpp"
+#include "CompiledCacheFile.hpp"
+
+class EllipticalOrbit;
+
+//! @class MinorBodyCatalog
+//! The orbital elements and H-G magnitude parameters of a large set of minor planets, in a form ready to be
+//! evaluated in bulk by the SolarSystem, without creating a Planet object for each body.
+//! Each field of the entries is stored in its own array, and the names are stored in one UTF-8 string pool.
+//! The data is compiled once from a text file in the MPCORB.DAT format of the Minor Planet Center, then saved
+//! in a binary cache file in the user directory. The next times, the cache file is memory mapped and each
+//! array is read in one bulk copy. The cache is rebuilt when its format version changes, or when the source file changed.
+//! Only the elliptical orbits around the Sun are supported.
+class MinorBodyCatalog
+{
+public:
+	//! Compile the catalogue from a text file in the MPCORB.DAT format.
+	//! The lines which are not valid orbit records, like the header of the file, are skipped.
+	//! @return false if the file can't be read.
+	bool compile(const QString& mpcorbFile);
+
+	//! Load the compiled data from a cache file.
+	//! @param cacheFile the path of the cache file.
+	//! @param sourceFiles the data files from which the cache must have been compiled.
+	//! @return false if the cache file doesn't exist, has an other format version, or if one of the source files changed.
+	bool load(const QString& cacheFile, const QStringList& sourceFiles);
+
+	//! Save the compiled data in a cache file, with the signature of the source files used by the last call to compile().
+	bool save(const QString& cacheFile) const;
+
+	//! Get the path of the cache file for a minor body file in the user directory.
+	static QString getCacheFilePath(const QString& sourceFile);
+
+	//! Get the number of entries.
+	int size() const {return epochs.size();}
+
+	//! Get the english name of an entry, which is its provisional designation if it has no name.
+	QString getEnglishName(int i) const
+	{
+		return QString::fromUtf8(namePool.constData()+nameOffsets.at(i), nameOffsets.at(i+1)-nameOffsets.at(i));
+	}
+
+	//! Remove the entries having one of the given english names, for example because they are already
+	//! defined in the Solar System configuration file.
+	//! @return the number of removed entries.
+	int removeEnglishNames(const QSet<QString>& names);
+
+	//! Compute the heliocentric positions of all the entries in VSOP87 coordinates, solving Kepler's equation in batch.
+	//! @param JD the date.
+	//! @param positions the array receiving the positions, resized to size().
+	//! @param lightTimeObserverPos if not NULL, the heliocentric position of the observer, and each position is
+	//! computed at the date corrected for its light travel time.
+	void computePositions(double JD, QVector<Vec3d>& positions, const Vec3d* lightTimeObserverPos=NULL) const;
+
+	//! Compute the visual magnitudes of all the entries without extinction, using the H-G system like MinorPlanet.
+	//! @param positions the heliocentric positions computed by computePositions().
+	//! @param observerPos the heliocentric position of the observer.
+	//! @param magnitudes the array receiving the magnitudes, resized to size().
+	void computeMagnitudes(const QVector<Vec3d>& positions, const Vec3d& observerPos, QVector<float>& magnitudes) const;
+
+	//! Compute the visual magnitude of one entry without extinction, like computeMagnitudes().
+	float computeMagnitude(int i, const Vec3d& position, const Vec3d& observerPos) const;
+
+	//! Create the orbit of an entry, giving the same positions as computePositions().
+	//! The caller takes the ownership of the orbit.
+	EllipticalOrbit* createOrbit(int i) const;
+
+	//! The epochs of the elements in JD
+	QVector<double> epochs;
+	//! The mean anomalies at the epochs in radian
+	QVector<double> meanAnomaliesAtEpoch;
+	//! The mean motions in radian per day
+	QVector<double> meanMotions;
+	//! The semi-major axes in AU
+	QVector<double> semiMajorAxes;
+	QVector<double> eccentricities;
+	//! The inclinations, longitudes of the ascending node and arguments of the perihelion in radian,
+	//! relative to the J2000 ecliptic
+	QVector<double> inclinations;
+	QVector<double> ascendingNodes;
+	QVector<double> argsOfPerihelion;
+	//! The absolute magnitudes H and slope parameters G
+	QVector<float> absoluteMagnitudes;
+	QVector<float> slopeParameters;
+	//! The minor planet numbers, or 0 if the body is not numbered
+	QVector<quint32> numbers;
+	//! The UTF-8 english names of all the entries one after the other
+	QByteArray namePool;
+	//! Offset of the name of each entry in namePool, with one more element at the end
+	//! so that the name of entry i is in [offsets[i], offsets[i+1])
+	QVector<int> nameOffsets;
+
+private:
+	typedef CompiledCacheFile::SourceSignature SourceSignature;
+
+	//! Compute planeToVsop87 from the orbital elements.
+	void computeRotations();
+
+	//! Compute the positions of all the entries, each one at its own date.
+	void computePositionsAtDates(const QVector<double>& dates, QVector<Vec3d>& positions) const;
+
+	//! For each entry, the two first columns of the rotation from the orbit plane to VSOP87,
+	//! computed after loading and not saved in the cache
+	QVector<double> planeToVsop87;
+
+	//! Signatures of the source files of the compiled data
+	QVector<SourceSignature> sources;
+};
+
+#endif // _MINORBODYCATALOG_HPP_
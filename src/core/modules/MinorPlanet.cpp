@@ -58,9 +58,7 @@ MinorPlanet::MinorPlanet(const QString& englishName,
 								  false) //No atmosphere
 {
 	texMapName = atexMapName;
-	lastOrbitJD =0;
 	deltaJD = StelCore::JD_SECOND;
-	orbitCached = 0;
 	closeOrbit = acloseOrbit;
 
 	eclipticPos=Vec3d(0.,0.,0.);
@@ -153,6 +151,7 @@ void MinorPlanet::setAbsoluteMagnitudeAndSlope(double magnitude, double slope)
 
 	absoluteMagnitude = magnitude;
 	slopeParameter = slope;
+	photometryStamp = 0;
 }
 
 void MinorPlanet::setProvisionalDesignation(QString designation)
@@ -248,44 +247,22 @@ QString MinorPlanet::getInfoString(const StelCore *core, const InfoStringGroup &
 	return str;
 }
 
-float MinorPlanet::getVMagnitude(const StelCore* core, bool withExtinction) const
+float MinorPlanet::computeMagnitudeWithoutExtinction(const StelCore* core, const Photometry& ph) const
 {
-	float extinctionMag=0.0; // track magnitude loss
-	if (withExtinction)
-	{
-	    Vec3d altAz=getAltAzPosApparent(core);
-	    altAz.normalize();
-	    core->getSkyDrawer()->getExtinction().forward(&altAz[2], &extinctionMag);
-	}
-
 	//If the H-G system is not used, use the default radius/albedo mechanism
 	if (slopeParameter < 0)
 	{
-		return Planet::getVMagnitude(core, withExtinction);
+		return Planet::computeMagnitudeWithoutExtinction(core, ph);
 	}
 
-	//Calculate phase angle
-	//(Code copied from Planet::getVMagnitude())
-	//(LOL, this is actually vector subtraction + the cosine theorem :))
-	const Vec3d& observerHelioPos = core->getObserverHeliocentricEclipticPos();
-	const double observerRq = observerHelioPos.lengthSquared();
-	const Vec3d& planetHelioPos = getHeliocentricEclipticPos();
-	const double planetRq = planetHelioPos.lengthSquared();
-	const double observerPlanetRq = (observerHelioPos - planetHelioPos).lengthSquared();
-	const double cos_chi = (observerPlanetRq + planetRq - observerRq)/(2.0*sqrt(observerPlanetRq*planetRq));
-	double phaseAngle = std::acos(cos_chi);
-
 	//Calculate reduced magnitude (magnitude without the influence of distance)
 	//Source of the formulae: http://www.britastro.org/asteroids/dymock4.pdf
-	const double phi1 = std::exp(-3.33 * std::pow(std::tan(phaseAngle/2), 0.63));
-	const double phi2 = std::exp(-1.87 * std::pow(std::tan(phaseAngle/2), 1.22));
+	const double phi1 = std::exp(-3.33 * std::pow(std::tan(ph.phaseAngle/2), 0.63));
+	const double phi2 = std::exp(-1.87 * std::pow(std::tan(ph.phaseAngle/2), 1.22));
 	double reducedMagnitude = absoluteMagnitude - 2.5 * std::log10( (1 - slopeParameter) * phi1 + slopeParameter * phi2 );
 
 	//Calculate apparent magnitude
-	//TODO: See if you can "collapse" some calculations
-	double apparentMagnitude = reducedMagnitude + 5 * std::log10(std::sqrt(planetRq * observerPlanetRq));
-
-	return apparentMagnitude+extinctionMag;
+	return reducedMagnitude + 5 * std::log10(ph.sunDistance * ph.observerDistance);
 }
 
 void MinorPlanet::translateName(StelTranslator &translator)
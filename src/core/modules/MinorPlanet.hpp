@@ -70,7 +70,6 @@ public:
 	//was not designed to handle different types of objects.
 	// \todo Decide if this is going to be "MinorPlanet" or "Asteroid"
 	//virtual QString getType() const {return "MinorPlanet";}
-	virtual float getVMagnitude(const StelCore* core, bool withExtinction=false) const;
 	//! sets the nameI18 property with the appropriate translation.
 	//! Function overriden to handle the problem with name conflicts.
 	virtual void translateName(StelTranslator& trans);
@@ -102,6 +101,10 @@ public:
 	static QString renderProvisionalDesignationinHtml(QString plainText);
 
 
+protected:
+	//! Compute the magnitude with the H-G system, or with the albedo if it is not used.
+	virtual float computeMagnitudeWithoutExtinction(const StelCore* core, const Photometry& ph) const;
+
 private:
 	int minorPlanetNumber;
 	double absoluteMagnitude;
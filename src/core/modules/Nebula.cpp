@@ -151,72 +151,33 @@ double Nebula::getCloseViewFov(const StelCore*) const
 	return angularSize>0 ? angularSize * 4 : 1;
 }
 
-void Nebula::drawHints(StelPainter& sPainter, float maxMagHints)
+void Nebula::drawHints(StelPainter& sPainter, const Vec3d& XY, NebulaType type)
 {
-	if (mag>maxMagHints)
-		return;
 	glEnable(GL_BLEND);
 	glBlendFunc(GL_ONE, GL_ONE);
 	float lum = 1.f;//qMin(1,4.f/getOnScreenSize(core))*0.8;
 	sPainter.setColor(circleColor[0]*lum*hintsBrightness, circleColor[1]*lum*hintsBrightness, circleColor[2]*lum*hintsBrightness, 1);
-	if (nType == 1)
+	if (type == 1)
 		Nebula::texOpenCluster->bind();
 
-	if (nType == 2)
+	if (type == 2)
 		Nebula::texGlobularCluster->bind();
 
-	if (nType == 4)
+	if (type == 4)
 		Nebula::texPlanetNebula->bind();
 
-	if (nType != 1 && nType != 2 && nType != 4)
+	if (type != 1 && type != 2 && type != 4)
 		Nebula::texCircle->bind();
 
 	sPainter.drawSprite2dMode(XY[0], XY[1], 6);
 }
 
-void Nebula::drawLabel(StelPainter& sPainter, float maxMagLabel)
+void Nebula::drawLabel(StelPainter& sPainter, const Vec3d& XY, float angularSize, const QString& label)
 {
-	if (mag>maxMagLabel)
-		return;
 	sPainter.setColor(labelColor[0], labelColor[1], labelColor[2], hintsBrightness);
-	float size = getAngularSize(NULL)*M_PI/180.*sPainter.getProjector()->getPixelPerRadAtCenter();
+	float size = angularSize*0.5*M_PI/180.*sPainter.getProjector()->getPixelPerRadAtCenter();
 	float shift = 4.f + size/1.8f;
-	QString str;
-	if (nameI18!="")
-		str = getNameI18n();
-	else
-	{
-		if (M_nb > 0)
-			str = QString("M %1").arg(M_nb);
-		else if (NGC_nb > 0)
-			str = QString("NGC %1").arg(NGC_nb);
-		else if (IC_nb > 0)
-			str = QString("IC %1").arg(IC_nb);
-	}
-
-	sPainter.drawText(XY[0]+shift, XY[1]+shift, str, 0, 0, 0, false);
-}
-
-
-void Nebula::readNGC(QDataStream& in)
-{
-	bool isIc;
-	int nb;
-	float ra, dec;
-	unsigned int type;
-	in >> isIc >> nb >> ra >> dec >> mag >> angularSize >> type;
-	if (isIc)
-	{
-		IC_nb = nb;
-	}
-	else
-	{
-		NGC_nb = nb;
-	}
-	StelUtils::spheToRect(ra,dec,XYZ);
-	Q_ASSERT(fabs(XYZ.lengthSquared()-1.)<0.000000001);
-	nType = (Nebula::NebulaType)type;
-	pointRegion = SphericalRegionP(new SphericalPoint(getJ2000EquatorialPos(NULL)));
+	sPainter.drawText(XY[0]+shift, XY[1]+shift, label, 0, 0, 0, false);
 }
 
 #if 0
@@ -70,8 +70,6 @@ public:
 	QString getTypeString() const;
 
 private:
-	friend struct DrawNebulaFuncObject;
-	
 	//! @enum NebulaType Nebula types
 	enum NebulaType
 	{
@@ -90,10 +88,14 @@ private:
 	void translateName(StelTranslator& trans) {nameI18 = trans.qtranslate(englishName);}
 
 	bool readNGC(char *record);
-	void readNGC(QDataStream& in);
-			
-	void drawLabel(StelPainter& sPainter, float maxMagLabel);
-	void drawHints(StelPainter& sPainter, float maxMagHints);
+
+	//! Draw the label of a nebula.
+	//! @param XY the projected position of the nebula.
+	//! @param angularSize the angular size of the nebula in degree.
+	static void drawLabel(StelPainter& sPainter, const Vec3d& XY, float angularSize, const QString& label);
+	//! Draw the hint of a nebula, whose symbol depends on its type.
+	//! @param XY the projected position of the nebula.
+	static void drawHints(StelPainter& sPainter, const Vec3d& XY, NebulaType type);
 
 	unsigned int M_nb;              // Messier Catalog number
 	unsigned int NGC_nb;            // New General Catalog number
@@ -103,7 +105,6 @@ private:
 	float mag;                      // Apparent magnitude
 	float angularSize;              // Angular size in degree
 	Vec3d XYZ;                      // Cartesian equatorial position
-	Vec3d XY;                       // Store temporary 2D position
 	NebulaType nType;
 
 	SphericalRegionP pointRegion;
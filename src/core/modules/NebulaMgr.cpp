@@ -45,6 +45,8 @@
 #include "StelSkyImageTile.hpp"
 #include "StelPainter.hpp"
 #include "RefractionExtinction.hpp"
+#include "StelGeodesicGrid.hpp"
+#include "StelSphereGeometry.hpp"
 
 void NebulaMgr::setLabelsColor(const Vec3f& c) {Nebula::labelColor = c;}
 const Vec3f &NebulaMgr::getLabelsColor(void) const {return Nebula::labelColor;}
@@ -54,7 +56,7 @@ void NebulaMgr::setCircleScale(float scale) {Nebula::circleScale = scale;}
 float NebulaMgr::getCircleScale(void) const {return Nebula::circleScale;}
 
 
-NebulaMgr::NebulaMgr(void) : nebGrid(200), displayNoTexture(false)
+NebulaMgr::NebulaMgr(void) : displayNoTexture(false)
 {
 	setObjectName("NebulaMgr");
 }
@@ -78,7 +80,7 @@ double NebulaMgr::getCallOrder(StelModuleActionName actionName) const
 }
 
 // read from stream
-void NebulaMgr::init()
+bool NebulaMgr::preload()
 {
 	// TODO: mechanism to specify which sets get loaded at start time.
 	// candidate methods:
@@ -88,6 +90,17 @@ void NebulaMgr::init()
 	// 4. info.ini file in each set containing a "load at startup" item
 	// For now (0.9.0), just load the default set
 	loadNebulaSet("default");
+	return catalog.size()>0;
+}
+
+void NebulaMgr::init()
+{
+	// The data is normally loaded by a preload started in a worker thread, it must not be loaded twice
+	StelModuleMgr::PreloadStatus preloadStatus = StelApp::getInstance().getModuleMgr().waitForPreload(this);
+	if (preloadStatus==StelModuleMgr::PreloadNotStarted)
+		preloadStatus = preload() ? StelModuleMgr::PreloadSucceeded : StelModuleMgr::PreloadFailed;
+	if (preloadStatus==StelModuleMgr::PreloadFailed)
+		qWarning() << "ERROR: the NGC/IC catalogue could not be loaded, the nebulae will not be displayed";
 
 	QSettings* conf = StelApp::getInstance().getSettings();
 	Q_ASSERT(conf);
@@ -114,30 +127,28 @@ void NebulaMgr::init()
 	GETSTELMODULE(StelObjectMgr)->registerStelObjectMgr(this);
 }
 
-struct DrawNebulaFuncObject
+void NebulaMgr::drawZone(StelPainter& sPainter, int zone, const SphericalRegion* viewport, float maxMagHints, float maxMagLabels,
+			 bool checkMaxMagHints, float angularSizeLimit) const
 {
-	DrawNebulaFuncObject(float amaxMagHints, float amaxMagLabels, StelPainter* p, StelCore* aCore, bool acheckMaxMagHints) : maxMagHints(amaxMagHints), maxMagLabels(amaxMagLabels), sPainter(p), core(aCore), checkMaxMagHints(acheckMaxMagHints)
+	const StelProjectorP prj = sPainter.getProjector();
+	Vec3d XY;
+	for (int i=catalog.zoneOffsets.at(zone);i<catalog.zoneOffsets.at(zone+1);++i)
 	{
-		angularSizeLimit = 5.f/sPainter->getProjector()->getPixelPerRadAtCenter()*180.f/M_PI;
-	}
-	void operator()(StelRegionObjectP obj)
-	{
-		Nebula* n = obj.staticCast<Nebula>().data();
-		if (n->angularSize>angularSizeLimit || (checkMaxMagHints && n->mag <= maxMagHints))
-		{
-			float refmag_add=0; // value to adjust hints visibility threshold.
-			sPainter->getProjector()->project(n->XYZ,n->XY);
-			n->drawLabel(*sPainter, maxMagLabels-refmag_add);
-			n->drawHints(*sPainter, maxMagHints -refmag_add);
-		}
+		const float mag = catalog.magnitudes.at(i);
+		const float angularSize = catalog.angularSizes.at(i);
+		if (angularSize<=angularSizeLimit && !(checkMaxMagHints && mag<=maxMagHints))
+			continue;
+		const Vec3f& pos = catalog.positions.at(i);
+		const Vec3d XYZ(pos[0], pos[1], pos[2]);
+		if (viewport && !viewport->contains(XYZ))
+			continue;
+		prj->project(XYZ, XY);
+		if (mag<=maxMagLabels)
+			Nebula::drawLabel(sPainter, XY, angularSize, getLabel(i));
+		if (mag<=maxMagHints)
+			Nebula::drawHints(sPainter, XY, (Nebula::NebulaType)catalog.types.at(i));
 	}
-	float maxMagHints;
-	float maxMagLabels;
-	StelPainter* sPainter;
-	StelCore* core;
-	float angularSizeLimit;
-	bool checkMaxMagHints;
-};
+}
 
 // Draw all the Nebulae
 void NebulaMgr::draw(StelCore* core)
@@ -159,10 +170,20 @@ void NebulaMgr::draw(StelCore* core)
 
 	// Print all the nebulae of all the selected zones
 	float maxMagHints = skyDrawer->getLimitMagnitude()*1.2f-2.f+(hintsAmount*1.2f)-2.f;
-	float maxMagLabels = skyDrawer->getLimitMagnitude()-2.f+(labelsAmount*1.2f)-2.f;
+	// Show fewer labels when the rendering quality is lowered
+	float maxMagLabels = skyDrawer->getLimitMagnitude()-2.f+(labelsAmount*1.2f)-2.f-(1.f-core->getRenderingQuality())*2.f;
 	sPainter.setFont(nebulaFont);
-	DrawNebulaFuncObject func(maxMagHints, maxMagLabels, &sPainter, core, hintsFader.getInterstate()>0.0001);
-	nebGrid.processIntersectingRegions(p, func);
+	const float angularSizeLimit = 5.f/prj->getPixelPerRadAtCenter()*180.f/M_PI;
+	const bool checkMaxMagHints = hintsFader.getInterstate()>0.0001;
+
+	// The nebulae of the zones fully inside the viewport don't need to be tested
+	const int level = CompiledNebulaCatalog::ZONE_LEVEL;
+	const GeodesicSearchResult* searchResult = core->getGeodesicGrid(level)->search(p->getBoundingSphericalCaps(), level);
+	int zone;
+	for (GeodesicSearchInsideIterator it(*searchResult, level);(zone = it.next()) >= 0;)
+		drawZone(sPainter, zone, NULL, maxMagHints, maxMagLabels, checkMaxMagHints, angularSizeLimit);
+	for (GeodesicSearchBorderIterator it(*searchResult, level);(zone = it.next()) >= 0;)
+		drawZone(sPainter, zone, p.data(), maxMagHints, maxMagLabels, checkMaxMagHints, angularSizeLimit);
 
 	if (GETSTELMODULE(StelObjectMgr)->getFlagSelectedObjectPointer())
 		drawPointer(core, sPainter);
@@ -213,10 +234,10 @@ NebulaP NebulaMgr::search(const QString& name)
 {
 	QString uname = name.toUpper();
 
-	foreach (const NebulaP& n, nebArray)
+	for (int i=0;i<catalog.size();++i)
 	{
-		QString testName = n->getEnglishName().toUpper();
-		if (testName==uname) return n;
+		if (catalog.hasName(i) && catalog.getEnglishName(i).toUpper()==uname)
+			return getNebula(i);
 	}
 
 	// If no match found, try search by catalog reference
@@ -235,35 +256,102 @@ NebulaP NebulaMgr::search(const QString& name)
 
 void NebulaMgr::loadNebulaSet(const QString& setName)
 {
+	QString catalogFile, namesFile;
 	try
 	{
-		loadNGC(StelFileMgr::findFile("nebulae/" + setName + "/ngc2000.dat"));
-		loadNGCNames(StelFileMgr::findFile("nebulae/" + setName + "/ngc2000names.dat"));
+		catalogFile = StelFileMgr::findFile("nebulae/" + setName + "/ngc2000.dat");
 	}
 	catch (std::runtime_error& e)
 	{
 		qWarning() << "ERROR while loading nebula data set " << setName << ": " << e.what();
+		return;
+	}
+	try
+	{
+		namesFile = StelFileMgr::findFile("nebulae/" + setName + "/ngc2000names.dat");
+	}
+	catch (std::runtime_error& e)
+	{
+		qWarning() << "ERROR while loading nebula names of set " << setName << ": " << e.what();
+	}
+
+	const QString cacheFile = CompiledNebulaCatalog::getCacheFilePath(setName);
+	if (catalog.load(cacheFile, QStringList() << catalogFile << namesFile))
+	{
+		qDebug() << "Loaded" << catalog.size() << "NGC records from" << cacheFile;
+	}
+	else
+	{
+		if (!catalog.compile(catalogFile, namesFile))
+			return;
+		catalog.save(cacheFile);
+	}
+
+	namesI18n = QVector<QString>(catalog.size());
+	nebulae = QVector<NebulaP>(catalog.size());
+	ngcIndex.clear();
+	for (int i=0;i<catalog.size();++i)
+	{
+		if (catalog.ngcNumbers.at(i)!=0)
+			ngcIndex.insert(catalog.ngcNumbers.at(i), i);
 	}
 }
 
+NebulaP NebulaMgr::getNebula(int index) const
+{
+	NebulaP& n = nebulae[index];
+	if (n.isNull())
+	{
+		n = NebulaP(new Nebula);
+		const Vec3f& pos = catalog.positions.at(index);
+		n->XYZ.set(pos[0], pos[1], pos[2]);
+		n->XYZ.normalize();
+		n->mag = catalog.magnitudes.at(index);
+		n->angularSize = catalog.angularSizes.at(index);
+		n->nType = (Nebula::NebulaType)catalog.types.at(index);
+		n->NGC_nb = catalog.ngcNumbers.at(index);
+		n->IC_nb = catalog.icNumbers.at(index);
+		n->M_nb = catalog.messierNumbers.at(index);
+		n->englishName = catalog.getEnglishName(index);
+		n->nameI18 = namesI18n.at(index);
+		n->pointRegion = SphericalRegionP(new SphericalPoint(n->XYZ));
+	}
+	return n;
+}
+
+QString NebulaMgr::getLabel(int index) const
+{
+	if (!namesI18n.at(index).isEmpty())
+		return namesI18n.at(index);
+	if (catalog.messierNumbers.at(index) > 0)
+		return QString("M %1").arg(catalog.messierNumbers.at(index));
+	if (catalog.ngcNumbers.at(index) > 0)
+		return QString("NGC %1").arg(catalog.ngcNumbers.at(index));
+	if (catalog.icNumbers.at(index) > 0)
+		return QString("IC %1").arg(catalog.icNumbers.at(index));
+	return QString();
+}
+
 // Look for a nebulae by XYZ coords
 NebulaP NebulaMgr::search(const Vec3d& apos)
 {
 	Vec3d pos = apos;
 	pos.normalize();
-	NebulaP plusProche;
+	int plusProche = -1;
 	float anglePlusProche=0.;
-	foreach (const NebulaP& n, nebArray)
+	for (int i=0;i<catalog.size();++i)
 	{
-		if (n->XYZ*pos>anglePlusProche)
+		const Vec3f& p = catalog.positions.at(i);
+		const float a = p[0]*pos[0]+p[1]*pos[1]+p[2]*pos[2];
+		if (a>anglePlusProche)
 		{
-			anglePlusProche=n->XYZ*pos;
-			plusProche=n;
+			anglePlusProche=a;
+			plusProche=i;
 		}
 	}
 	if (anglePlusProche>0.999)
 	{
-		return plusProche;
+		return getNebula(plusProche);
 	}
 	else return NebulaP();
 }
@@ -278,14 +366,12 @@ QList<StelObjectP> NebulaMgr::searchAround(const Vec3d& av, double limitFov, con
 	Vec3d v(av);
 	v.normalize();
 	double cosLimFov = cos(limitFov * M_PI/180.);
-	Vec3d equPos;
-	foreach (const NebulaP& n, nebArray)
+	for (int i=0;i<catalog.size();++i)
 	{
-		equPos = n->XYZ;
-		equPos.normalize();
-		if (equPos*v>=cosLimFov)
+		const Vec3f& p = catalog.positions.at(i);
+		if (p[0]*v[0]+p[1]*v[1]+p[2]*v[2]>=cosLimFov)
 		{
-			result.push_back(qSharedPointerCast<StelObject>(n));
+			result.push_back(qSharedPointerCast<StelObject>(getNebula(i)));
 		}
 	}
 	return result;
@@ -293,195 +379,33 @@ QList<StelObjectP> NebulaMgr::searchAround(const Vec3d& av, double limitFov, con
 
 NebulaP NebulaMgr::searchM(unsigned int M)
 {
-	foreach (const NebulaP& n, nebArray)
-		if (n->M_nb == M)
-			return n;
-	return NebulaP();
+	const int i = catalog.messierNumbers.indexOf(M);
+	return i<0 ? NebulaP() : getNebula(i);
 }
 
 NebulaP NebulaMgr::searchNGC(unsigned int NGC)
 {
 	if (ngcIndex.contains(NGC))
-		return ngcIndex[NGC];
+		return getNebula(ngcIndex[NGC]);
 	return NebulaP();
 }
 
 NebulaP NebulaMgr::searchIC(unsigned int IC)
 {
-	foreach (const NebulaP& n, nebArray)
-		if (n->IC_nb == IC) return n;
-	return NebulaP();
+	const int i = catalog.icNumbers.indexOf(IC);
+	return i<0 ? NebulaP() : getNebula(i);
 }
 
-#if 0
-// read from stream
-bool NebulaMgr::loadNGCOld(const QString& catNGC)
-{
-	QFile in(catNGC);
-	if (!in.open(QIODevice::ReadOnly | QIODevice::Text))
-		return false;
-
-	int totalRecords=0;
-	QString record;
-	while (!in.atEnd())
-	{
-		in.readLine();
-		++totalRecords;
-	}
-
-	// rewind the file to the start
-	in.seek(0);
-
-	int currentLineNumber = 0;	// what input line we are on
-	int currentRecordNumber = 0;	// what record number we are on
-	int readOk = 0;			// how many records weree rad without problems
-	while (!in.atEnd())
-	{
-		record = QString::fromUtf8(in.readLine());
-		++currentLineNumber;
-
-		// skip comments
-		if (record.startsWith("//") || record.startsWith("#"))
-			continue;
-		++currentRecordNumber;
-
-		// Create a new Nebula record
-		NebulaP e = NebulaP(new Nebula);
-		if (!e->readNGC((char*)record.toLocal8Bit().data())) // reading error
-		{
-			e.clear();
-		}
-		else
-		{
-			nebArray.append(e);
-			nebGrid.insert(qSharedPointerCast<StelRegionObject>(e));
-			if (e->NGC_nb!=0)
-				ngcIndex.insert(e->NGC_nb, e);
-			++readOk;
-		}
-	}
-	in.close();
-	qDebug() << "Loaded" << readOk << "/" << totalRecords << "NGC records";
-	return true;
-}
-#endif
-
-bool NebulaMgr::loadNGC(const QString& catNGC)
-{
-	QFile in(catNGC);
-	if (!in.open(QIODevice::ReadOnly))
-		return false;
-	QDataStream ins(&in);
-	ins.setVersion(QDataStream::Qt_4_5);
-
-	int totalRecords=0;
-	while (!ins.atEnd())
-	{
-		// Create a new Nebula record
-		NebulaP e = NebulaP(new Nebula);
-		e->readNGC(ins);
-
-		nebArray.append(e);
-		nebGrid.insert(qSharedPointerCast<StelRegionObject>(e));
-		if (e->NGC_nb!=0)
-			ngcIndex.insert(e->NGC_nb, e);
-		++totalRecords;
-	}
-	in.close();
-	qDebug() << "Loaded" << totalRecords << "NGC records";
-	return true;
-}
-
-bool NebulaMgr::loadNGCNames(const QString& catNGCNames)
-{
-	qDebug() << "Loading NGC name data ...";
-	QFile ngcNameFile(catNGCNames);
-	if (!ngcNameFile.open(QIODevice::ReadOnly | QIODevice::Text))
-	{
-		qWarning() << "NGC name data file" << catNGCNames << "not found.";
-		return false;
-	}
-
-	// Read the names of the NGC objects
-	QString name, record;
-	int totalRecords=0;
-	int lineNumber=0;
-	int readOk=0;
-	int nb;
-	NebulaP e;
-	QRegExp commentRx("^(\\s*#.*|\\s*)$");
-	QRegExp transRx("_[(]\"(.*)\"[)]");
-	while (!ngcNameFile.atEnd())
-	{
-		record = QString::fromUtf8(ngcNameFile.readLine());
-		lineNumber++;
-		if (commentRx.exactMatch(record))
-			continue;
-
-		totalRecords++;
-		nb = record.mid(38,4).toInt();
-		if (record[37] == 'I')
-		{
-			e = searchIC(nb);
-		}
-		else
-		{
-			e = searchNGC(nb);
-		}
-
-		// get name, trimmed of whitespace
-		name = record.left(36).trimmed();
-
-		if (e)
-		{
-			// If the name is not a messier number perhaps one is already
-			// defined for this object
-			if (name.left(2).toUpper() != "M ")
-			{
-				if (transRx.exactMatch(name)) {
-					e->englishName = transRx.capturedTexts().at(1).trimmed();
-				}
-				 else 
-				{
-					e->englishName = name;
-				}
-			}
-			else
-			{
-				// If it's a messiernumber, we will call it a messier if there is no better name
-				name = name.mid(2); // remove "M "
-
-				// read the Messier number
-				QTextStream istr(&name);
-				int num;
-				istr >> num;
-				if (istr.status()!=QTextStream::Ok)
-				{
-					qWarning() << "cannot read Messier number at line" << lineNumber << "of" << catNGCNames;
-					continue;
-				}
-
-				e->M_nb=(unsigned int)(num);
-				e->englishName = QString("M%1").arg(num);
-			}
-
-			readOk++;
-		}
-		else
-			qWarning() << "no position data for " << name << "at line" << lineNumber << "of" << catNGCNames;
-	}
-	ngcNameFile.close();
-	qDebug() << "Loaded" << readOk << "/" << totalRecords << "NGC name records successfully";
-
-	return true;
-}
-
-
 void NebulaMgr::updateI18n()
 {
 	StelTranslator trans = StelApp::getInstance().getLocaleMgr().getSkyTranslator();
-	foreach (NebulaP n, nebArray)
-			n->translateName(trans);
+	for (int i=0;i<catalog.size();++i)
+	{
+		if (catalog.hasName(i))
+			namesI18n[i] = trans.qtranslate(catalog.getEnglishName(i));
+		if (nebulae.at(i))
+			nebulae.at(i)->nameI18 = namesI18n.at(i);
+	}
 }
 
 
@@ -493,28 +417,29 @@ StelObjectP NebulaMgr::searchByNameI18n(const QString& nameI18n) const
 	// Search by NGC numbers (possible formats are "NGC31" or "NGC 31")
 	if (objw.mid(0, 3) == "NGC")
 	{
-		foreach (const NebulaP& n, nebArray)
+		for (int i=0;i<catalog.size();++i)
 		{
-			if (QString("NGC%1").arg(n->NGC_nb) == objw || QString("NGC %1").arg(n->NGC_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
+			const unsigned int nb = catalog.ngcNumbers.at(i);
+			if (QString("NGC%1").arg(nb) == objw || QString("NGC %1").arg(nb) == objw)
+				return qSharedPointerCast<StelObject>(getNebula(i));
 		}
 	}
 
 	// Search by common names
-	foreach (const NebulaP& n, nebArray)
+	for (int i=0;i<catalog.size();++i)
 	{
-		QString objwcap = n->nameI18.toUpper();
-		if (objwcap==objw)
-			return qSharedPointerCast<StelObject>(n);
+		if (!namesI18n.at(i).isEmpty() && namesI18n.at(i).toUpper()==objw)
+			return qSharedPointerCast<StelObject>(getNebula(i));
 	}
 
 	// Search by Messier numbers (possible formats are "M31" or "M 31")
 	if (objw.mid(0, 1) == "M")
 	{
-		foreach (const NebulaP& n, nebArray)
+		for (int i=0;i<catalog.size();++i)
 		{
-			if (QString("M%1").arg(n->M_nb) == objw || QString("M %1").arg(n->M_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
+			const unsigned int nb = catalog.messierNumbers.at(i);
+			if (QString("M%1").arg(nb) == objw || QString("M %1").arg(nb) == objw)
+				return qSharedPointerCast<StelObject>(getNebula(i));
 		}
 	}
 
@@ -531,28 +456,29 @@ StelObjectP NebulaMgr::searchByName(const QString& name) const
 	// Search by NGC numbers (possible formats are "NGC31" or "NGC 31")
 	if (objw.mid(0, 3) == "NGC")
 	{
-		foreach (const NebulaP& n, nebArray)
+		for (int i=0;i<catalog.size();++i)
 		{
-			if (QString("NGC%1").arg(n->NGC_nb) == objw || QString("NGC %1").arg(n->NGC_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
+			const unsigned int nb = catalog.ngcNumbers.at(i);
+			if (QString("NGC%1").arg(nb) == objw || QString("NGC %1").arg(nb) == objw)
+				return qSharedPointerCast<StelObject>(getNebula(i));
 		}
 	}
 
 	// Search by common names
-	foreach (const NebulaP& n, nebArray)
+	for (int i=0;i<catalog.size();++i)
 	{
-		QString objwcap = n->englishName.toUpper();
-		if (objwcap==objw)
-			return qSharedPointerCast<StelObject>(n);
+		if (catalog.hasName(i) && catalog.getEnglishName(i).toUpper()==objw)
+			return qSharedPointerCast<StelObject>(getNebula(i));
 	}
 
 	// Search by Messier numbers (possible formats are "M31" or "M 31")
 	if (objw.mid(0, 1) == "M")
 	{
-		foreach (const NebulaP& n, nebArray)
+		for (int i=0;i<catalog.size();++i)
 		{
-			if (QString("M%1").arg(n->M_nb) == objw || QString("M %1").arg(n->M_nb) == objw)
-				return qSharedPointerCast<StelObject>(n);
+			const unsigned int nb = catalog.messierNumbers.at(i);
+			if (QString("M%1").arg(nb) == objw || QString("M %1").arg(nb) == objw)
+				return qSharedPointerCast<StelObject>(getNebula(i));
 		}
 	}
 
@@ -571,17 +497,17 @@ QStringList NebulaMgr::listMatchingObjectsI18n(const QString& objPrefix, int max
 	// Search by messier objects number (possible formats are "M31" or "M 31")
 	if (objw.size()>=1 && objw[0]=='M')
 	{
-		foreach (const NebulaP& n, nebArray)
+		foreach (unsigned int nb, catalog.messierNumbers)
 		{
-			if (n->M_nb==0) continue;
-			QString constw = QString("M%1").arg(n->M_nb);
+			if (nb==0) continue;
+			QString constw = QString("M%1").arg(nb);
 			QString constws = constw.mid(0, objw.size());
 			if (constws==objw)
 			{
 				result << constw;
 				continue;	// Prevent adding both forms for name
 			}
-			constw = QString("M %1").arg(n->M_nb);
+			constw = QString("M %1").arg(nb);
 			constws = constw.mid(0, objw.size());
 			if (constws==objw)
 				result << constw;
@@ -589,28 +515,28 @@ QStringList NebulaMgr::listMatchingObjectsI18n(const QString& objPrefix, int max
 	}
 
 	// Search by NGC numbers (possible formats are "NGC31" or "NGC 31")
-	foreach (const NebulaP& n, nebArray)
+	foreach (unsigned int nb, catalog.ngcNumbers)
 	{
-		if (n->NGC_nb==0) continue;
-		QString constw = QString("NGC%1").arg(n->NGC_nb);
+		if (nb==0) continue;
+		QString constw = QString("NGC%1").arg(nb);
 		QString constws = constw.mid(0, objw.size());
 		if (constws==objw)
 		{
 			result << constw;
 			continue;
 		}
-		constw = QString("NGC %1").arg(n->NGC_nb);
+		constw = QString("NGC %1").arg(nb);
 		constws = constw.mid(0, objw.size());
 		if (constws==objw)
 			result << constw;
 	}
 
 	// Search by common names
-	foreach (const NebulaP& n, nebArray)
+	foreach (const QString& nameI18, namesI18n)
 	{
-		QString constw = n->nameI18.mid(0, objw.size()).toUpper();
-		if (constw==objw)
-			result << n->nameI18;
+		QString constw = nameI18.mid(0, objw.size()).toUpper();
+		if (!nameI18.isEmpty() && constw==objw)
+			result << nameI18;
 	}
 
 	result.sort();
@@ -618,4 +544,3 @@ QStringList NebulaMgr::listMatchingObjectsI18n(const QString& objPrefix, int max
 
 	return result;
 }
-
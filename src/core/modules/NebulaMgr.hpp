@@ -26,21 +26,24 @@
 #include <QFont>
 #include "StelObjectType.hpp"
 #include "StelFader.hpp"
-#include "StelSphericalIndex.hpp"
 #include "StelObjectModule.hpp"
 #include "StelTextureTypes.hpp"
+#include "CompiledNebulaCatalog.hpp"
 
 class Nebula;
 class StelTranslator;
 class StelToneReproducer;
 class QSettings;
 class StelPainter;
+class SphericalRegion;
 
 typedef QSharedPointer<Nebula> NebulaP;
 
 //! @class NebulaMgr
 //! Manage a collection of nebulae. This class is used
 //! to display the NGC catalog with information, and textures for some of them.
+//! The catalogue is drawn directly from its compiled arrays, the Nebula objects are only
+//! created when they are needed for the selection, the searches and the info display.
 class NebulaMgr : public StelObjectModule
 {
 	Q_OBJECT
@@ -51,7 +54,13 @@ public:
 
 	///////////////////////////////////////////////////////////////////////////
 	// Methods defined in the StelModule class
+	//! Load the NGC/IC catalogue and the nebula names of the default nebula set.
+	//! This is called from a worker thread before init().
+	//! @return false if the NGC/IC catalogue could not be loaded.
+	virtual bool preload();
+
 	//! Initialize the NebulaMgr object.
+	//!  - Load the default nebula set if no preload() was started.
 	//!  - Load the font into the Nebula class, which is used to draw Nebula labels.
 	//!  - Load the texture used to draw nebula locations into the Nebula class (for
 	//!     those with no individual texture).
@@ -163,32 +172,41 @@ private:
 	//! Search the Nebulae by position
 	NebulaP search(const Vec3d& pos);
 
-	//! Load a set of nebula images.
+	//! Load a nebula set.
 	//! Each sub-directory of the INSTALLDIR/nebulae directory contains a set of
-	//! nebula textures.  The sub-directory is the setName.  Each set has its
-	//! own nebula_textures.fab file and corresponding image files.
-	//! This function loads a set of textures.
+	//! nebulae. The sub-directory is the setName. Each set has its own ngc2000.dat
+	//! and ngc2000names.dat files, which are compiled in a cache file the first time.
 	//! @param setName a string which corresponds to the directory where the set resides
 	void loadNebulaSet(const QString& setName);
 
 	//! Draw a nice animated pointer around the object
 	void drawPointer(const StelCore* core, StelPainter& sPainter);
 
+	//! Draw the labels and hints of the nebulae of a geodesic grid zone.
+	//! @param viewport if not NULL, only the nebulae inside this region are drawn.
+	void drawZone(StelPainter& sPainter, int zone, const SphericalRegion* viewport, float maxMagHints, float maxMagLabels,
+		      bool checkMaxMagHints, float angularSizeLimit) const;
+
+	//! Get the Nebula object of a catalogue entry, creating it the first time.
+	NebulaP getNebula(int index) const;
+	//! Get the label drawn for a catalogue entry.
+	QString getLabel(int index) const;
+
 	NebulaP searchM(unsigned int M);
 	NebulaP searchNGC(unsigned int NGC);
 	NebulaP searchIC(unsigned int IC);
-	bool loadNGC(const QString& fileName);
-	bool loadNGCOld(const QString& catNGC);
-	bool loadNGCNames(const QString& fileName);
 
-	QVector<NebulaP> nebArray;		// The nebulas list
-	QHash<unsigned int, NebulaP> ngcIndex;
+	//! The compiled NGC/IC catalogue
+	CompiledNebulaCatalog catalog;
+	//! The translated names of the catalogue entries
+	QVector<QString> namesI18n;
+	//! The Nebula objects already created, by catalogue index
+	mutable QVector<NebulaP> nebulae;
+	//! The catalogue index of each NGC number
+	QHash<unsigned int, int> ngcIndex;
 	LinearFader hintsFader;
 	LinearFader flagShow;
 
-	//! The internal grid for fast positional lookup
-	StelSphericalIndex nebGrid;
-
 	//! The amount of hints (between 0 and 10)
 	float hintsAmount;
 	//! The amount of labels (between 0 and 10)
@@ -13,29 +13,133 @@
 #include <algorithm>
 #include <cmath>
 #include <cstring>
+#include <vector>
 
-#include "Solve.hpp"
 #include "Orbit.hpp"
 
 using namespace std;
 
-#define EPSILON 1e-10
-
 #if defined(_MSC_VER)
 // cuberoot is missing in VC++ !?
 #define cbrt(x) pow((x),1./3.)
 #endif
 
+// Stop the Kepler iterations when the correction is below this value (radians, or relative for large anomalies)
+static const double KEPLER_TOLERANCE = 1e-14;
+// The Laguerre-Conway iteration converges in less than 8 iterations in practice
+static const int KEPLER_MAX_ITERATIONS = 20;
+// Number of orbits solved together by the batch solvers
+static const int KEPLER_LANES = 4;
+// Comet orbits with |e-1| below this value are computed with the universal variable
+static const double NEAR_PARABOLIC_ECCENTRICITY = 1e-2;
+// Number of terms of the series of the Stumpff functions for |x|<=1
+static const int STUMPFF_TERMS = 10;
+
+// One Laguerre-Conway step for the elliptic Kepler equation, see Conway 1986, Celestial Mechanics 39, 199
+static inline double keplerEllipticStep(double e, double m, double E)
+{
+  const double s = e*sin(E);
+  const double f = E-s-m;
+  const double f1 = 1.0-e*cos(E);
+  return -5.0*f/(f1+sqrt(fabs(16.0*f1*f1-20.0*f*s)));
+}
+
+static inline double keplerHyperbolicStep(double e, double m, double H)
+{
+  const double s = e*sinh(H);
+  const double f = s-H-m;
+  const double f1 = e*cosh(H)-1.0;
+  return -5.0*f/(f1+sqrt(fabs(16.0*f1*f1-20.0*f*s)));
+}
+
+double solveKeplerElliptic(double e, double M)
+{
+  // Solve for the mean anomaly reduced to [-pi,pi], where the starting value of Danby is good
+  const double turns = floor(M/(2.0*M_PI)+0.5);
+  const double m = M-turns*2.0*M_PI;
+  double E = m+(m<0.0 ? -0.85 : 0.85)*e;
+  for (int i=0;i<KEPLER_MAX_ITERATIONS;++i) {
+    const double dE = keplerEllipticStep(e,m,E);
+    E += dE;
+    if (fabs(dE) < KEPLER_TOLERANCE) break;
+  }
+  return E+turns*2.0*M_PI;
+}
+
+double solveKeplerHyperbolic(double e, double M)
+{
+  double H = (M<0.0 ? -1.0 : 1.0)*log(2.0*fabs(M)/e+1.8);
+  for (int i=0;i<KEPLER_MAX_ITERATIONS;++i) {
+    const double dH = keplerHyperbolicStep(e,M,H);
+    H += dH;
+    if (fabs(dH) < KEPLER_TOLERANCE*max(1.0,fabs(H))) break;
+  }
+  return H;
+}
+
+double solveKeplerParabolic(double A)
+{
+  // Closed form solution of the cubic D + D^3/3 = 2A/3
+  const double h = sqrt(A*A+1.0);
+  double c = cbrt(fabs(A)+h);
+  c = c*c;
+  return 2*A/(1+c+1/c);
+}
+
+void solveKeplerElliptic(const double* e, const double* M, double* E, int n)
+{
+  int i = 0;
+  for (;i+KEPLER_LANES<=n;i+=KEPLER_LANES) {
+    double turns[KEPLER_LANES], m[KEPLER_LANES], x[KEPLER_LANES];
+    for (int l=0;l<KEPLER_LANES;++l) {
+      turns[l] = floor(M[i+l]/(2.0*M_PI)+0.5);
+      m[l] = M[i+l]-turns[l]*2.0*M_PI;
+      x[l] = m[l]+(m[l]<0.0 ? -0.85 : 0.85)*e[i+l];
+    }
+    // All the lanes iterate until the slowest one converged
+    for (int k=0;k<KEPLER_MAX_ITERATIONS;++k) {
+      double maxStep = 0.0;
+      for (int l=0;l<KEPLER_LANES;++l) {
+        const double dx = keplerEllipticStep(e[i+l],m[l],x[l]);
+        x[l] += dx;
+        maxStep = max(maxStep,fabs(dx));
+      }
+      if (maxStep < KEPLER_TOLERANCE) break;
+    }
+    for (int l=0;l<KEPLER_LANES;++l)
+      E[i+l] = x[l]+turns[l]*2.0*M_PI;
+  }
+  for (;i<n;++i)
+    E[i] = solveKeplerElliptic(e[i],M[i]);
+}
+
+void solveKeplerHyperbolic(const double* e, const double* M, double* H, int n)
+{
+  int i = 0;
+  for (;i+KEPLER_LANES<=n;i+=KEPLER_LANES) {
+    double x[KEPLER_LANES];
+    for (int l=0;l<KEPLER_LANES;++l)
+      x[l] = (M[i+l]<0.0 ? -1.0 : 1.0)*log(2.0*fabs(M[i+l])/e[i+l]+1.8);
+    for (int k=0;k<KEPLER_MAX_ITERATIONS;++k) {
+      bool converged = true;
+      for (int l=0;l<KEPLER_LANES;++l) {
+        const double dx = keplerHyperbolicStep(e[i+l],M[i+l],x[l]);
+        x[l] += dx;
+        converged = converged && fabs(dx) < KEPLER_TOLERANCE*max(1.0,fabs(x[l]));
+      }
+      if (converged) break;
+    }
+    for (int l=0;l<KEPLER_LANES;++l)
+      H[i+l] = x[l];
+  }
+  for (;i<n;++i)
+    H[i] = solveKeplerHyperbolic(e[i],M[i]);
+}
+
 static
 void InitHyp(double q,double n,double e,double dt,double &a1,double &a2) {
   const double a = q/(e-1.0);
-  const double M = n * dt;
-  double H = M;
-  for (;;) { // Newton
-    const double Hp = H;
-    H = H-(e*sinh(H)-H-M)/(e*cosh(H)-1);
-    if (fabs(H - Hp) < EPSILON) break;
-  }
+  const double H = solveKeplerHyperbolic(e,n*dt);
   const double h1 = q*sqrt((e+1.0)/(e-1.0));
   a1 = a*(e-cosh(H));
   a2 = h1*sinh(H);
@@ -43,29 +147,71 @@ void InitHyp(double q,double n,double e,double dt,double &a1,double &a2) {
 
 static
 void InitPar(double q,double n,double dt,double &a1,double &a2) {
-  const double A = n*dt;
-  const double h = sqrt(A*A+1.0);
-  double c = cbrt(fabs(A)+h);
-  c = c*c;
-  const double tan_nu_h = 2*A/(1+c+1/c);
+  const double tan_nu_h = solveKeplerParabolic(n*dt);
   a1 = q*(1-tan_nu_h*tan_nu_h);
   a2 = 2.0*q*tan_nu_h;
 }
 
 static
-void InitEll(double q,double n,double e,double dt,double &a1,double &a2) {
+void InitEll(double q,double e,double E,double &a1,double &a2) {
   const double a = q/(1.0-e);
-  double M = fmod(n*dt,2*M_PI);
-  if (M < 0.0) M += 2.0*M_PI;
-  double H = M;
-  for (;;) { // Newton
-    const double Hp = H;
-    H = H-(M-H+e*sin(H))/(e*cos(H)-1);
-    if (fabs(H-Hp) < EPSILON) break;
-  }
   const double h1 = q*sqrt((1.0+e)/(1.0-e));
-  a1 = a*(cos(H)-e);
-  a2 = h1*sin(H);
+  a1 = a*(cos(E)-e);
+  a2 = h1*sin(E);
+}
+
+// Stumpff functions c0(x) to c3(x)
+static
+void Stumpff(double x,double &c0,double &c1,double &c2,double &c3) {
+  if (x > 1.0) {
+    const double s = sqrt(x);
+    c0 = cos(s);
+    c1 = sin(s)/s;
+  } else if (x < -1.0) {
+    const double s = sqrt(-x);
+    c0 = cosh(s);
+    c1 = sinh(s)/s;
+  } else {
+    // The closed forms of c2 and c3 cancel for small x, use their series
+    double t2 = 0.5;
+    double t3 = 1.0/6.0;
+    c2 = t2;
+    c3 = t3;
+    for (int j=1;j<STUMPFF_TERMS;++j) {
+      t2 *= -x/((2*j+1)*(2*j+2));
+      t3 *= -x/((2*j+2)*(2*j+3));
+      c2 += t2;
+      c3 += t3;
+    }
+    c0 = 1.0-x*c2;
+    c1 = 1.0-x*c3;
+    return;
+  }
+  c2 = (1.0-c0)/x;
+  c3 = (1.0-c1)/x;
+}
+
+// Near parabolic orbit: solve the universal Kepler equation q*s*c1(beta*s^2) + mu*s^3*c3(beta*s^2) = dt
+// for the universal anomaly s, with beta = mu*(1-e)/q, see Danby, Fundamentals of Celestial Mechanics, 6.9.
+// mu is the gravitational parameter in AU^3/day^2.
+static
+void InitNearPar(double q,double e,double mu,double dt,double &a1,double &a2) {
+  const double beta = mu*(1.0-e)/q;
+  // Start from the solution of the parabolic orbit with the same pericenter distance
+  double s = solveKeplerParabolic(1.5*sqrt(mu/(2.0*q*q*q))*dt)*sqrt(2.0*q/mu);
+  double c0,c1,c2,c3;
+  for (int i=0;i<KEPLER_MAX_ITERATIONS;++i) {
+    Stumpff(beta*s*s,c0,c1,c2,c3);
+    const double f = q*s*c1+mu*s*s*s*c3-dt;
+    const double f1 = q*c0+mu*s*s*c2;
+    const double f2 = mu*e*s*c1;
+    const double ds = -5.0*f/(f1+sqrt(fabs(16.0*f1*f1-20.0*f*f2)));
+    s += ds;
+    if (fabs(ds) <= KEPLER_TOLERANCE*fabs(s)) break;
+  }
+  Stumpff(beta*s*s,c0,c1,c2,c3);
+  a1 = q-mu*s*s*c2;
+  a2 = sqrt(mu*(1.0+e)/q)*(dt-mu*s*s*s*c3);
 }
 
 void Init3D(double i,double Omega,double o,double a1,double a2,
@@ -87,6 +233,25 @@ void Init3D(double i,double Omega,double o,double a1,double a2,
   x3 = d31*a1+d32*a2;
 }
 
+// Combine the two first columns of the rotation from the orbit plane to the parent frame
+// with the rotation to VSOP87, so that v = planeToVsop87 * (a1,a2)
+static
+void InitPlaneToVsop87(const double rotateToVsop87[9],
+                       const double col0[3],const double col1[3],
+                       double planeToVsop87[6]) {
+  for (int r=0;r<3;r++) {
+    planeToVsop87[2*r]   = rotateToVsop87[3*r]*col0[0] + rotateToVsop87[3*r+1]*col0[1] + rotateToVsop87[3*r+2]*col0[2];
+    planeToVsop87[2*r+1] = rotateToVsop87[3*r]*col1[0] + rotateToVsop87[3*r+1]*col1[1] + rotateToVsop87[3*r+2]*col1[2];
+  }
+}
+
+static inline
+void PlaneToVsop87(const double planeToVsop87[6],double a1,double a2,double *v) {
+  v[0] = planeToVsop87[0]*a1 + planeToVsop87[1]*a2;
+  v[1] = planeToVsop87[2]*a1 + planeToVsop87[3]*a2;
+  v[2] = planeToVsop87[4]*a1 + planeToVsop87[5]*a2;
+}
+
 
 CometOrbit::CometOrbit(double pericenterDistance,
                        double eccentricity,
@@ -125,21 +290,75 @@ CometOrbit::CometOrbit(double pericenterDistance,
   rotateToVsop87[6] =                 s_obl*sj;
   rotateToVsop87[7] =                 s_obl*cj;
   rotateToVsop87[8] =                 c_obl;
+  double col0[3],col1[3];
+  Init3D(i,Om,o,1.0,0.0,col0[0],col0[1],col0[2]);
+  Init3D(i,Om,o,0.0,1.0,col1[0],col1[1],col1[2]);
+  InitPlaneToVsop87(rotateToVsop87,col0,col1,planeToVsop87);
+  // Gravitational parameter consistent with the mean motion, see the mean motion of parabolic orbits in SolarSystem
+  if (e == 1.0) mu = (8.0/9.0)*n*n*q*q*q;
+  else {
+    const double a = q/fabs(1.0-e);
+    mu = n*n*a*a*a;
+  }
 }
 
 void CometOrbit::positionAtTimevInVSOP87Coordinates(double JD,double *v) const {
   JD -= t0;
   double a1,a2;
-  if (e < 1.0) InitEll(q,n,e,JD,a1,a2);
-  else if (e > 1.0) InitHyp(q,n,e,JD,a1,a2);
-  else InitPar(q,n,JD,a1,a2);
-  double p0,p1,p2;
-  Init3D(i,Om,o,a1,a2,p0,p1,p2);
-  v[0] = rotateToVsop87[0]*p0 + rotateToVsop87[1]*p1 + rotateToVsop87[2]*p2;
-  v[1] = rotateToVsop87[3]*p0 + rotateToVsop87[4]*p1 + rotateToVsop87[5]*p2;
-  v[2] = rotateToVsop87[6]*p0 + rotateToVsop87[7]*p1 + rotateToVsop87[8]*p2;
+  if (e == 1.0) InitPar(q,n,JD,a1,a2);
+  else if (fabs(e-1.0) < NEAR_PARABOLIC_ECCENTRICITY) InitNearPar(q,e,mu,JD,a1,a2);
+  else if (e < 1.0) InitEll(q,e,solveKeplerElliptic(e,n*JD),a1,a2);
+  else InitHyp(q,n,e,JD,a1,a2);
+  PlaneToVsop87(planeToVsop87,a1,a2,v);
 }
 
+void CometOrbit::positionsAtTimeInVSOP87Coordinates(const CometOrbit* const* orbits,int count,
+                                                    double JD,Vec3d* positions) {
+  // The elliptic and hyperbolic orbits are solved in batch, the near parabolic ones one by one
+  vector<int> elliptic,hyperbolic;
+  vector<double> eccentricities,meanAnomalies;
+  for (int k=0;k<count;k++) {
+    const CometOrbit* orb = orbits[k];
+    if (fabs(orb->e-1.0) < NEAR_PARABOLIC_ECCENTRICITY)
+      orb->positionAtTimevInVSOP87Coordinates(JD,positions[k]);
+    else if (orb->e < 1.0) elliptic.push_back(k);
+    else hyperbolic.push_back(k);
+  }
+
+  vector<double> anomalies;
+  for (int pass=0;pass<2;pass++) {
+    const vector<int>& indices = (pass==0) ? elliptic : hyperbolic;
+    if (indices.empty()) continue;
+    const int nb = indices.size();
+    eccentricities.resize(nb);
+    meanAnomalies.resize(nb);
+    anomalies.resize(nb);
+    for (int k=0;k<nb;k++) {
+      const CometOrbit* orb = orbits[indices[k]];
+      eccentricities[k] = orb->e;
+      meanAnomalies[k] = orb->n*(JD-orb->t0);
+    }
+    if (pass==0) solveKeplerElliptic(&eccentricities[0],&meanAnomalies[0],&anomalies[0],nb);
+    else solveKeplerHyperbolic(&eccentricities[0],&meanAnomalies[0],&anomalies[0],nb);
+    for (int k=0;k<nb;k++) {
+      const CometOrbit* orb = orbits[indices[k]];
+      double a1,a2;
+      if (pass==0) InitEll(orb->q,orb->e,anomalies[k],a1,a2);
+      else {
+        const double H = anomalies[k];
+        a1 = orb->q/(orb->e-1.0)*(orb->e-cosh(H));
+        a2 = orb->q*sqrt((orb->e+1.0)/(orb->e-1.0))*sinh(H);
+      }
+      PlaneToVsop87(orb->planeToVsop87,a1,a2,positions[indices[k]]);
+    }
+  }
+}
+
+void CometOrbit::positionAtEInVSOP87Coordinates(double E, double *v) const {
+  double a1,a2;
+  InitEll(q,e,E,a1,a2);
+  PlaneToVsop87(planeToVsop87,a1,a2,v);
+}
 
 
 EllipticalOrbit::EllipticalOrbit(double pericenterDistance,
@@ -180,92 +399,15 @@ EllipticalOrbit::EllipticalOrbit(double pericenterDistance,
   rotateToVsop87[6] =                 s_obl*sj;
   rotateToVsop87[7] =                 s_obl*cj;
   rotateToVsop87[8] =                 c_obl;
-}
-
-// Standard iteration for solving Kepler's Equation
-struct SolveKeplerFunc1 : public unary_function<double, double>
-{
-    double ecc;
-    double M;
-
-    SolveKeplerFunc1(double _ecc, double _M) : ecc(_ecc), M(_M) {};
-
-    double operator()(double x) const
-    {
-        return M + ecc * sin(x);
-    }
-};
-
-
-// Faster converging iteration for Kepler's Equation; more efficient
-// than above for orbits with eccentricities greater than 0.3.  This
-// is from Jean Meeus's _Astronomical Algorithms_ (2nd ed), p. 199
-struct SolveKeplerFunc2 : public unary_function<double, double>
-{
-    double ecc;
-    double M;
-
-    SolveKeplerFunc2(double _ecc, double _M) : ecc(_ecc), M(_M) {};
 
-    double operator()(double x) const
-    {
-        return x + (M + ecc * sin(x) - x) / (1 - ecc * cos(x));
-    }
-};
-
-double sign(double x)
-{
-    if (x < 0.)
-        return -1.;
-    else if (x > 0.)
-        return 1.;
-    else
-        return 0.;
+  const Mat4d R = Mat4d::zrotation(ascendingNode) *
+                  Mat4d::xrotation(inclination) *
+                  Mat4d::zrotation(argOfPeriapsis);
+  const double col0[3] = {R.r[0], R.r[1], R.r[2]};
+  const double col1[3] = {R.r[4], R.r[5], R.r[6]};
+  InitPlaneToVsop87(rotateToVsop87,col0,col1,planeToVsop87);
 }
 
-struct SolveKeplerLaguerreConway : public unary_function<double, double>
-{
-    double ecc;
-    double M;
-
-    SolveKeplerLaguerreConway(double _ecc, double _M) : ecc(_ecc), M(_M) {};
-
-    double operator()(double x) const
-    {
-        double s = ecc * sin(x);
-        double c = ecc * cos(x);
-        double f = x - s - M;
-        double f1 = 1 - c;
-        double f2 = s;
-        x += -5 * f / (f1 + sign(f1) * sqrt(abs(16 * f1 * f1 - 20 * f * f2)));
-
-        return x;
-    }
-};
-
-struct SolveKeplerLaguerreConwayHyp : public unary_function<double, double>
-{
-    double ecc;
-    double M;
-
-    SolveKeplerLaguerreConwayHyp(double _ecc, double _M) : ecc(_ecc), M(_M) {};
-
-    double operator()(double x) const
-    {
-        double s = ecc * sinh(x);
-        double c = ecc * cosh(x);
-        double f = s - x - M;
-        double f1 = c - 1;
-        double f2 = s;
-        x += -5 * f / (f1 + sign(f1) * sqrt(abs(16 * f1 * f1 - 20 * f * f2)));
-
-        return x;
-    }
-};
-
-typedef pair<double, double> Solution;
-
-
 double EllipticalOrbit::eccentricAnomaly(double M) const
 {
     if (eccentricity == 0.0)
@@ -273,75 +415,55 @@ double EllipticalOrbit::eccentricAnomaly(double M) const
         // Circular orbit
         return M;
     }
-    else if (eccentricity < 0.2)
-    {
-        // Low eccentricity, so use the standard iteration technique
-        Solution sol = solveIteration_fixed(SolveKeplerFunc1(eccentricity, M), M, 5);
-        return sol.first;
-    }
-    else if (eccentricity < 0.9)
-    {
-        // Higher eccentricity elliptical orbit; use a more complex but
-        // much faster converging iteration.
-        Solution sol = solveIteration_fixed(SolveKeplerFunc2(eccentricity, M), M, 6);
-        // Debugging
-        // qDebug("ecc: %f, error: %f mas\n",
-        //        eccentricity, radToDeg(sol.second) * 3600000);
-        return sol.first;
-    }
     else if (eccentricity < 1.0)
     {
-        // Extremely stable Laguerre-Conway method for solving Kepler's
-        // equation.  Only use this for high-eccentricity orbits, as it
-        // requires more calcuation.
-        double E = M + 0.85 * eccentricity * sign(sin(M));
-        Solution sol = solveIteration_fixed(SolveKeplerLaguerreConway(eccentricity, M), E, 8);
-        return sol.first;
+        return solveKeplerElliptic(eccentricity, M);
     }
     else if (eccentricity == 1.0)
     {
-        // Nearly parabolic orbit; very common for comets
-        // TODO: handle this
-        return M;
+        // Parabolic orbit: return tan(nu/2) instead of an eccentric anomaly
+        return solveKeplerParabolic(M);
     }
     else
     {
-        // Laguerre-Conway method for hyperbolic (ecc > 1) orbits.
-        double E = log(2 * M / eccentricity + 1.85);
-        Solution sol = solveIteration_fixed(SolveKeplerLaguerreConwayHyp(eccentricity, M), E, 30);
-        return sol.first;
+        return solveKeplerHyperbolic(eccentricity, M);
     }
 }
 
 
-Vec3d EllipticalOrbit::positionAtE(double E) const
+void EllipticalOrbit::positionInPlane(double E, double& x, double& y) const
 {
-    double x, z;
-
     if (eccentricity < 1.0)
     {
         double a = pericenterDistance / (1.0 - eccentricity);
         x = a * (cos(E) - eccentricity);
-        z = a * sqrt(1 - eccentricity * eccentricity) * -sin(E);
+        y = a * sqrt(1 - eccentricity * eccentricity) * sin(E);
     }
     else if (eccentricity > 1.0)
     {
         double a = pericenterDistance / (1.0 - eccentricity);
         x = -a * (eccentricity - cosh(E));
-        z = -a * sqrt(eccentricity * eccentricity - 1) * -sinh(E);
+        y = -a * sqrt(eccentricity * eccentricity - 1) * sinh(E);
     }
     else
     {
-        // TODO: Handle parabolic orbits
-        x = 0.0;
-        z = 0.0;
+        // Parabolic orbit, E is tan(nu/2)
+        x = pericenterDistance * (1.0 - E * E);
+        y = 2.0 * pericenterDistance * E;
     }
+}
+
+
+Vec3d EllipticalOrbit::positionAtE(double E) const
+{
+    double x, y;
+    positionInPlane(E, x, y);
 
     Mat4d R = (Mat4d::zrotation(ascendingNode) *
                Mat4d::xrotation(inclination) *
                Mat4d::zrotation(argOfPeriapsis));
 
-    return R * Vec3d(x, -z, 0);
+    return R * Vec3d(x, y, 0);
 }
 
 
@@ -374,10 +496,49 @@ Vec3d EllipticalOrbit::positionAtTime(double t) const
 
 void EllipticalOrbit::positionAtTimevInVSOP87Coordinates(double JD, double* v) const
 {
-  Vec3d pos = positionAtTime(JD);
-  v[0] = rotateToVsop87[0]*pos[0] + rotateToVsop87[1]*pos[1] + rotateToVsop87[2]*pos[2];
-  v[1] = rotateToVsop87[3]*pos[0] + rotateToVsop87[4]*pos[1] + rotateToVsop87[5]*pos[2];
-  v[2] = rotateToVsop87[6]*pos[0] + rotateToVsop87[7]*pos[1] + rotateToVsop87[8]*pos[2];
+  double x, y;
+  positionInPlane(eccentricAnomaly(meanAnomalyAtEpoch + (JD - epoch) * 2.0 * M_PI / period), x, y);
+  PlaneToVsop87(planeToVsop87, x, y, v);
+}
+
+void EllipticalOrbit::positionsAtTimeInVSOP87Coordinates(const EllipticalOrbit* const* orbits, int count,
+                                                         double JD, Vec3d* positions)
+{
+  // The elliptic orbits are solved in batch, the others one by one
+  vector<int> elliptic;
+  vector<double> eccentricities, meanAnomalies;
+  for (int k = 0; k < count; k++)
+  {
+    const EllipticalOrbit* orb = orbits[k];
+    if (orb->eccentricity > 0.0 && orb->eccentricity < 1.0)
+    {
+      elliptic.push_back(k);
+      eccentricities.push_back(orb->eccentricity);
+      meanAnomalies.push_back(orb->meanAnomalyAtEpoch + (JD - orb->epoch) * 2.0 * M_PI / orb->period);
+    }
+    else
+      orb->positionAtTimevInVSOP87Coordinates(JD, positions[k]);
+  }
+  if (elliptic.empty())
+    return;
+
+  const int nb = elliptic.size();
+  vector<double> anomalies(nb);
+  solveKeplerElliptic(&eccentricities[0], &meanAnomalies[0], &anomalies[0], nb);
+  for (int k = 0; k < nb; k++)
+  {
+    const EllipticalOrbit* orb = orbits[elliptic[k]];
+    double x, y;
+    orb->positionInPlane(anomalies[k], x, y);
+    PlaneToVsop87(orb->planeToVsop87, x, y, positions[elliptic[k]]);
+  }
+}
+
+void EllipticalOrbit::positionAtEInVSOP87Coordinates(double E, double* v) const
+{
+  double x, y;
+  positionInPlane(E, x, y);
+  PlaneToVsop87(planeToVsop87, x, y, v);
 }
 
 double EllipticalOrbit::getPeriod() const
@@ -16,6 +16,18 @@
 
 class OrbitSampleProc;
 
+// Solve Kepler's equation E - e*sin(E) = M of an elliptic orbit (0 <= e < 1).
+// The Laguerre-Conway iteration starts from the value of Danby and stops when the correction is below 1e-14.
+double solveKeplerElliptic(double e, double M);
+// Solve Kepler's equation e*sinh(H) - H = M of a hyperbolic orbit (e > 1)
+double solveKeplerHyperbolic(double e, double M);
+// Solve Barker's equation D + D^3/3 = 2A/3 of a parabolic orbit, and return D = tan(nu/2)
+double solveKeplerParabolic(double A);
+// Solve Kepler's equation for n orbits at once. The orbits are solved by groups of 4 lanes running the same
+// instructions, which iterate until the slowest lane converged, so that the compiler can vectorise them.
+void solveKeplerElliptic(const double* e, const double* M, double* E, int n);
+void solveKeplerHyperbolic(const double* e, const double* M, double* H, int n);
+
 //! @internal
 //! Orbit computations used for comet and asteroids
 class Orbit
@@ -23,6 +35,11 @@ class Orbit
 public:
     Orbit(void) {}
 	virtual ~Orbit(void) {}
+	// Return whether the orbit is a closed ellipse, so that its whole shape can be
+	// sampled with positionAtEInVSOP87Coordinates() instead of as a function of time
+	virtual bool isClosed() const {return false;}
+	// Compute the position for an eccentric anomaly on a closed orbit, in VSOP87 coordinates
+	virtual void positionAtEInVSOP87Coordinates(double, double*) const {;}
 private:
   Orbit(const Orbit&);
   const Orbit &operator=(const Orbit&);
@@ -52,6 +69,13 @@ public:
 	// parentRotObliquity and parentRotAscendingnode must be supplied.
     void positionAtTimevInVSOP87Coordinates(double JD, double* v) const;
 
+    virtual bool isClosed() const {return eccentricity < 1.0;}
+    virtual void positionAtEInVSOP87Coordinates(double E, double* v) const;
+
+    // Compute the positions of count orbits at the same date, solving Kepler's equation in batch
+    static void positionsAtTimeInVSOP87Coordinates(const EllipticalOrbit* const* orbits, int count,
+                                                   double JD, Vec3d* positions);
+
 	// Original one
     Vec3d positionAtTime(double) const;
     double getPeriod() const;
@@ -59,8 +83,10 @@ public:
     virtual void sample(double, double, int, OrbitSampleProc&) const;
 
 private:
+    // Return the eccentric anomaly, or tan(nu/2) for a parabolic orbit
     double eccentricAnomaly(double) const;
     Vec3d positionAtE(double) const;
+    void positionInPlane(double E, double& x, double& y) const;
 
     double pericenterDistance;
     double eccentricity;
@@ -71,6 +97,8 @@ private:
     double period;
     double epoch;
     double rotateToVsop87[9];
+    // Rotation from the orbit plane to VSOP87
+    double planeToVsop87[6];
 };
 
 
@@ -89,6 +117,14 @@ public:
 
     // Compute the orbit for a specified Julian date and return a "stellarium compliant" function
   void positionAtTimevInVSOP87Coordinates(double JD, double* v) const;
+
+  virtual bool isClosed() const {return e < 1.0;}
+  virtual void positionAtEInVSOP87Coordinates(double E, double* v) const;
+
+  // Compute the positions of count orbits at the same date, solving Kepler's equation in batch.
+  // The near parabolic orbits are computed with the universal variable.
+  static void positionsAtTimeInVSOP87Coordinates(const CometOrbit* const* orbits, int count,
+                                                 double JD, Vec3d* positions);
 private:
   const double q;
   const double e;
@@ -98,9 +134,19 @@ private:
   const double t0;
   const double n;
   double rotateToVsop87[9];
+  // Rotation from the orbit plane to VSOP87
+  double planeToVsop87[6];
+  // Gravitational parameter consistent with n, for the near parabolic orbits
+  double mu;
 };
 
 
+// The position functions of the elliptical and comet orbits given to the Planet objects,
+// userDataPtr being the EllipticalOrbit or the CometOrbit
+void ellipticalOrbitPosFunc(double jd, double xyz[3], void* userDataPtr);
+void cometOrbitPosFunc(double jd, double xyz[3], void* userDataPtr);
+
+
 class OrbitSampleProc
 {
  public:
@@ -22,7 +22,6 @@
 #include <QTextStream>
 #include <QString>
 #include <QDebug>
-#include <QVarLengthArray>
 
 #include "StelApp.hpp"
 #include "StelCore.hpp"
@@ -40,11 +39,21 @@
 #include "StelPainter.hpp"
 #include "StelTranslator.hpp"
 #include "StelUtils.hpp"
+#include "Orbit.hpp"
+
+// Maximum distance in pixel between an orbit line and the orbit
+static const double ORBIT_MAX_PIXEL_ERROR = 1.;
+// Maximum number of times an orbit segment is split in two halves
+static const int ORBIT_MAX_DEPTH = 6;
+// Relative change of the zoom, of the view direction in fields of view, and of the observer position in orbit sizes
+// after which an orbit line is sampled again
+static const double ORBIT_RESAMPLING_TOLERANCE = 0.1;
 
 Vec3f Planet::labelColor = Vec3f(0.4,0.4,0.8);
 Vec3f Planet::orbitColor = Vec3f(1,0.6,1);
 StelTextureSP Planet::hintCircleTex;
 StelTextureSP Planet::texEarthShadow;
+unsigned int Planet::photometryEpoch = 1;
 
 Planet::Planet(const QString& englishName,
 			   int flagLighting,
@@ -69,14 +78,28 @@ Planet::Planet(const QString& englishName,
 	  userDataPtr(auserDataPtr),
 	  osculatingFunc(osculatingFunc),
 	  parent(NULL),
+	  satellitesRadius(0.),
+	  satellitesCulled(false),
+	  satellitesStale(false),
 	  hidden(hidden),
-	  atmosphere(hasAtmosphere)
+	  atmosphere(hasAtmosphere),
+	  photometryStamp(0)
 {
 	texMapName = atexMapName;
-	lastOrbitJD =0;
 	deltaJD = StelCore::JD_SECOND;
-	orbitCached = 0;
 	closeOrbit = acloseOrbit;
+	orbitShapeJD = 0.;
+	orbitVerticesStale = true;
+	orbitVerticesPixelPerRad = 0.f;
+
+	// The orbits of the Keplerian bodies are sampled in eccentric anomaly when they are closed
+	closedOrbit = NULL;
+	if (coordFunc==&ellipticalOrbitPosFunc)
+		closedOrbit = static_cast<EllipticalOrbit*>(userDataPtr);
+	else if (coordFunc==&cometOrbitPosFunc)
+		closedOrbit = static_cast<CometOrbit*>(userDataPtr);
+	if (closedOrbit && !closedOrbit->isClosed())
+		closedOrbit = NULL;
 
 	eclipticPos=Vec3d(0.,0.,0.);
 	rotLocalToParent = Mat4d::identity();
@@ -257,124 +280,7 @@ void Planet::computePositionWithoutOrbits(const double date)
 
 void Planet::computePosition(const double date)
 {
-
-	if (orbitFader.getInterstate()>0.000001 && deltaOrbitJD > 0 && (fabs(lastOrbitJD-date)>deltaOrbitJD || !orbitCached))
-	{
-
-		// calculate orbit first (for line drawing)
-		double date_increment = re.siderealPeriod/ORBIT_SEGMENTS;
-		double calc_date;
-		// int delta_points = (int)(0.5 + (date - lastOrbitJD)/date_increment);
-		int delta_points;
-
-		if( date > lastOrbitJD )
-		{
-			delta_points = (int)(0.5 + (date - lastOrbitJD)/date_increment);
-		}
-		else
-		{
-			delta_points = (int)(-0.5 + (date - lastOrbitJD)/date_increment);
-		}
-		double new_date = lastOrbitJD + delta_points*date_increment;
-
-		// qDebug( "Updating orbit coordinates for %s (delta %f) (%d points)\n", name.c_str(), deltaOrbitJD, delta_points);
-
-		if( delta_points > 0 && delta_points < ORBIT_SEGMENTS && orbitCached)
-		{
-
-			for( int d=0; d<ORBIT_SEGMENTS; d++ )
-			{
-				if(d + delta_points >= ORBIT_SEGMENTS )
-				{
-					// calculate new points
-					calc_date = new_date + (d-ORBIT_SEGMENTS/2)*date_increment;
-
-					// date increments between points will not be completely constant though
-					computeTransMatrix(calc_date);
-					if (osculatingFunc)
-					{
-						(*osculatingFunc)(date,calc_date,eclipticPos);
-					}
-					else
-					{
-						coordFunc(calc_date, eclipticPos, userDataPtr);
-					}
-					orbit[d] = getHeliocentricEclipticPos();
-				}
-				else
-				{
-					orbit[d] = orbit[d+delta_points];
-				}
-			}
-
-			lastOrbitJD = new_date;
-		}
-		else if( delta_points < 0 && abs(delta_points) < ORBIT_SEGMENTS  && orbitCached)
-		{
-
-			for( int d=ORBIT_SEGMENTS-1; d>=0; d-- )
-			{
-				if(d + delta_points < 0 )
-				{
-					// calculate new points
-					calc_date = new_date + (d-ORBIT_SEGMENTS/2)*date_increment;
-
-					computeTransMatrix(calc_date);
-					if (osculatingFunc) {
-						(*osculatingFunc)(date,calc_date,eclipticPos);
-					}
-					else
-					{
-						coordFunc(calc_date, eclipticPos, userDataPtr);
-					}
-					orbit[d] = getHeliocentricEclipticPos();
-				}
-				else
-				{
-					orbit[d] = orbit[d+delta_points];
-				}
-			}
-
-			lastOrbitJD = new_date;
-
-		}
-		else if( delta_points || !orbitCached)
-		{
-
-			// update all points (less efficient)
-			for( int d=0; d<ORBIT_SEGMENTS; d++ )
-			{
-				calc_date = date + (d-ORBIT_SEGMENTS/2)*date_increment;
-				computeTransMatrix(calc_date);
-				if (osculatingFunc)
-				{
-					(*osculatingFunc)(date,calc_date,eclipticPos);
-				}
-				else
-				{
-					coordFunc(calc_date, eclipticPos, userDataPtr);
-				}
-				orbit[d] = getHeliocentricEclipticPos();
-			}
-
-			lastOrbitJD = date;
-			if (!osculatingFunc) orbitCached = 1;
-		}
-
-
-		// calculate actual Planet position
-		coordFunc(date, eclipticPos, userDataPtr);
-
-		lastJD = date;
-
-	}
-	else if (fabs(lastJD-date)>deltaJD)
-	{
-		// calculate actual Planet position
-		coordFunc(date, eclipticPos, userDataPtr);
-		lastJD = date;
-	}
-
+	computePositionWithoutOrbits(date);
 }
 
 // Compute the transformation matrix from the local Planet coordinate to the parent Planet coordinate
@@ -484,64 +390,101 @@ double Planet::getPhase(const Vec3d& obsPos) const
 
 // Computation of the visual magnitude (V band) of the planet.
 float Planet::getVMagnitude(const StelCore* core, bool withExtinction) const
+{
+	const float mag = getPhotometry(core).magnitude;
+	if (withExtinction)
+		return mag + getExtinctionMagnitude(core);
+	return mag;
+}
+
+float Planet::getExtinctionMagnitude(const StelCore* core) const
 {
 	float extinctionMag=0.0; // track magnitude loss
-	if (withExtinction && core->getSkyDrawer()->getFlagHasAtmosphere())
+	if (core->getSkyDrawer()->getFlagHasAtmosphere())
 	{
 	    Vec3d altAz=getAltAzPosApparent(core);
 	    altAz.normalize();
 	    core->getSkyDrawer()->getExtinction().forward(&altAz[2], &extinctionMag);
 	}
+	return extinctionMag;
+}
 
-
-	if (parent == 0)
-	{
-		// sun, compute the apparent magnitude for the absolute mag (4.83) and observer's distance
-		const double distParsec = std::sqrt(core->getObserverHeliocentricEclipticPos().lengthSquared())*AU/PARSEC;
-		return 4.83 + 5.*(std::log10(distParsec)-1.) + extinctionMag;
-	}
-
-	// Compute the angular phase
+const Planet::Photometry& Planet::getPhotometry(const StelCore* core) const
+{
 	const Vec3d& observerHelioPos = core->getObserverHeliocentricEclipticPos();
-	const double observerRq = observerHelioPos.lengthSquared();
+	if (photometryStamp==photometryEpoch && photometryObserverPos==observerHelioPos)
+		return photometry;
+
+	Photometry& ph = photometry;
 	const Vec3d& planetHelioPos = getHeliocentricEclipticPos();
-	const double planetRq = planetHelioPos.lengthSquared();
-	const double observerPlanetRq = (observerHelioPos - planetHelioPos).lengthSquared();
-	const double cos_chi = (observerPlanetRq + planetRq - observerRq)/(2.0*sqrt(observerPlanetRq*planetRq));
-	double phase = std::acos(cos_chi);
+	ph.observerDistance = (observerHelioPos - planetHelioPos).length();
+	ph.sunDistance = planetHelioPos.length();
+	ph.phaseAngle = 0.;
+	ph.illuminatedFraction = 1.;
+	ph.shadowFactor = 1.;
 
-	double shadowFactor = 1.;
-	// Check if the satellite is inside the inner shadow of the parent planet:
-	if (parent->parent != 0)
+	if (parent != 0)
 	{
-		const Vec3d& parentHeliopos = parent->getHeliocentricEclipticPos();
-		const double parent_Rq = parentHeliopos.lengthSquared();
-		const double pos_times_parent_pos = planetHelioPos * parentHeliopos;
-		if (pos_times_parent_pos > parent_Rq)
+		// Compute the angular phase
+		const double observerRq = observerHelioPos.lengthSquared();
+		const double planetRq = planetHelioPos.lengthSquared();
+		const double observerPlanetRq = (observerHelioPos - planetHelioPos).lengthSquared();
+		const double cos_chi = (observerPlanetRq + planetRq - observerRq)/(2.0*sqrt(observerPlanetRq*planetRq));
+		ph.phaseAngle = std::acos(cos_chi);
+		ph.illuminatedFraction = 0.5*(1.+cos_chi);
+
+		// Check if the satellite is inside the inner shadow of the parent planet:
+		if (parent->parent != 0)
 		{
-			// The satellite is farther away from the sun than the parent planet.
-			const double sun_radius = parent->parent->radius;
-			const double sun_minus_parent_radius = sun_radius - parent->radius;
-			const double quot = pos_times_parent_pos/parent_Rq;
-
-			// Compute d = distance from satellite center to border of inner shadow.
-			// d>0 means inside the shadow cone.
-			double d = sun_radius - sun_minus_parent_radius*quot - std::sqrt((1.-sun_minus_parent_radius/sqrt(parent_Rq)) * (planetRq-pos_times_parent_pos*quot));
-			if (d>=radius)
+			const Vec3d& parentHeliopos = parent->getHeliocentricEclipticPos();
+			const double parent_Rq = parentHeliopos.lengthSquared();
+			const double pos_times_parent_pos = planetHelioPos * parentHeliopos;
+			if (pos_times_parent_pos > parent_Rq)
 			{
-				// The satellite is totally inside the inner shadow.
-				shadowFactor = 1e-9;
-			}
-			else if (d>-radius)
-			{
-				// The satellite is partly inside the inner shadow,
-				// compute a fantasy value for the magnitude:
-				d /= radius;
-				shadowFactor = (0.5 - (std::asin(d)+d*std::sqrt(1.0-d*d))/M_PI);
+				// The satellite is farther away from the sun than the parent planet.
+				const double sun_radius = parent->parent->radius;
+				const double sun_minus_parent_radius = sun_radius - parent->radius;
+				const double quot = pos_times_parent_pos/parent_Rq;
+
+				// Compute d = distance from satellite center to border of inner shadow.
+				// d>0 means inside the shadow cone.
+				double d = sun_radius - sun_minus_parent_radius*quot - std::sqrt((1.-sun_minus_parent_radius/sqrt(parent_Rq)) * (planetRq-pos_times_parent_pos*quot));
+				if (d>=radius)
+				{
+					// The satellite is totally inside the inner shadow.
+					ph.shadowFactor = 1e-9;
+				}
+				else if (d>-radius)
+				{
+					// The satellite is partly inside the inner shadow,
+					// compute a fantasy value for the magnitude:
+					d /= radius;
+					ph.shadowFactor = (0.5 - (std::asin(d)+d*std::sqrt(1.0-d*d))/M_PI);
+				}
 			}
 		}
 	}
 
+	ph.magnitude = computeMagnitudeWithoutExtinction(core, ph);
+	photometryStamp = photometryEpoch;
+	photometryObserverPos = observerHelioPos;
+	return ph;
+}
+
+float Planet::computeMagnitudeWithoutExtinction(const StelCore* core, const Photometry& ph) const
+{
+	if (parent == 0)
+	{
+		// sun, compute the apparent magnitude for the absolute mag (4.83) and observer's distance
+		const double distParsec = ph.observerDistance*AU/PARSEC;
+		return 4.83 + 5.*(std::log10(distParsec)-1.);
+	}
+
+	const double phase = ph.phaseAngle;
+	const double cos_chi = 2.*ph.illuminatedFraction-1.;
+	const double observerPlanetRq = ph.observerDistance*ph.observerDistance;
+	const double planetRq = ph.sunDistance*ph.sunDistance;
+
 	// Use empirical formulae for main planets when seen from earth
 	if (core->getCurrentLocation().planetName=="Earth")
 	{
@@ -554,26 +497,26 @@ float Planet::getVMagnitude(const StelCore* core, bool withExtinction) const
 		if (englishName=="Mercury")
 		{
 			if ( phaseDeg > 150. ) f1 = 1.5;
-			return -0.36 + d + 3.8*f1 - 2.73*f1*f1 + 2*f1*f1*f1 + extinctionMag;
+			return -0.36 + d + 3.8*f1 - 2.73*f1*f1 + 2*f1*f1*f1;
 		}
 		if (englishName=="Venus")
-			return -4.29 + d + 0.09*f1 + 2.39*f1*f1 - 0.65*f1*f1*f1 + extinctionMag;
+			return -4.29 + d + 0.09*f1 + 2.39*f1*f1 - 0.65*f1*f1*f1;
 		if (englishName=="Mars")
-			return -1.52 + d + 0.016*phaseDeg + extinctionMag;
+			return -1.52 + d + 0.016*phaseDeg;
 		if (englishName=="Jupiter")
-			return -9.25 + d + 0.005*phaseDeg + extinctionMag;
+			return -9.25 + d + 0.005*phaseDeg;
 		if (englishName=="Saturn")
 		{
 			// TODO re-add rings computation
 			// double rings = -2.6*sinx + 1.25*sinx*sinx;
-			return -8.88 + d + 0.044*phaseDeg + extinctionMag;// + rings;
+			return -8.88 + d + 0.044*phaseDeg;// + rings;
 		}
 		if (englishName=="Uranus")
-			return -7.19 + d + 0.0028*phaseDeg + extinctionMag;
+			return -7.19 + d + 0.0028*phaseDeg;
 		if (englishName=="Neptune")
-			return -6.87 + d + extinctionMag;
+			return -6.87 + d;
 		if (englishName=="Pluto")
-			return -1.01 + d + 0.041*phaseDeg + extinctionMag;
+			return -1.01 + d + 0.041*phaseDeg;
 		*/
 		// GZ: I prefer the values given by Meeus, Astronomical Algorithms (1992).
 		// There are two solutions:
@@ -585,14 +528,14 @@ float Planet::getVMagnitude(const StelCore* core, bool withExtinction) const
 		if (englishName=="Mercury")
 		    {
 			double ph50=phaseDeg-50.0;
-			return 1.16 + d + 0.02838*ph50 + 0.0001023*ph50*ph50 + extinctionMag;
+			return 1.16 + d + 0.02838*ph50 + 0.0001023*ph50*ph50;
 		    }
 		if (englishName=="Venus")
-			return -4.0 + d + 0.01322*phaseDeg + 0.0000004247*phaseDeg*phaseDeg*phaseDeg + extinctionMag;
+			return -4.0 + d + 0.01322*phaseDeg + 0.0000004247*phaseDeg*phaseDeg*phaseDeg;
 		if (englishName=="Mars")
-			return -1.3 + d + 0.01486*phaseDeg + extinctionMag;
+			return -1.3 + d + 0.01486*phaseDeg;
 		if (englishName=="Jupiter")
-			return -8.93 + d + extinctionMag;
+			return -8.93 + d;
 		if (englishName=="Saturn")
 		{
 			// TODO re-add rings computation
@@ -607,24 +550,24 @@ float Planet::getVMagnitude(const StelCore* core, bool withExtinction) const
 			double beta=atan2(saturnEarth[2], sqrt(saturnEarth[0]*saturnEarth[0]+saturnEarth[1]*saturnEarth[1]));
 			const double sinB=sin(i)*cos(beta)*sin(lambda-Omega)-cos(i)*sin(beta);
 			double rings = -2.6*fabs(sinB) + 1.25*sinB*sinB; // sinx=sinB, saturnicentric latitude of earth. longish, see Meeus.
-			return -8.68 + d + 0.044*phaseDeg + rings + extinctionMag;
+			return -8.68 + d + 0.044*phaseDeg + rings;
 		}
 		if (englishName=="Uranus")
-			return -6.85 + d + extinctionMag;
+			return -6.85 + d;
 		if (englishName=="Neptune")
-			return -7.05 + d + extinctionMag;
+			return -7.05 + d;
 		if (englishName=="Pluto")
-			return -1.0 + d + extinctionMag;
+			return -1.0 + d;
 		/*
 		// (2)
 		if (englishName=="Mercury")
-			return 0.42 + d + .038*phaseDeg - 0.000273*phaseDeg*phaseDeg + 0.000002*phaseDeg*phaseDeg*phaseDeg + extinctionMag;
+			return 0.42 + d + .038*phaseDeg - 0.000273*phaseDeg*phaseDeg + 0.000002*phaseDeg*phaseDeg*phaseDeg;
 		if (englishName=="Venus")
-			return -4.40 + d + 0.0009*phaseDeg + 0.000239*phaseDeg*phaseDeg - 0.00000065*phaseDeg*phaseDeg*phaseDeg + extinctionMag;
+			return -4.40 + d + 0.0009*phaseDeg + 0.000239*phaseDeg*phaseDeg - 0.00000065*phaseDeg*phaseDeg*phaseDeg;
 		if (englishName=="Mars")
-			return -1.52 + d + 0.016*phaseDeg + extinctionMag;
+			return -1.52 + d + 0.016*phaseDeg;
 		if (englishName=="Jupiter")
-			return -9.40 + d + 0.005*phaseDeg + extinctionMag;
+			return -9.40 + d + 0.005*phaseDeg;
 		if (englishName=="Saturn")
 		{
 			// TODO re-add rings computation
@@ -639,22 +582,22 @@ float Planet::getVMagnitude(const StelCore* core, bool withExtinction) const
 			double beta=atan2(saturnEarth[2], sqrt(saturnEarth[0]*saturnEarth[0]+saturnEarth[1]*saturnEarth[1]));
 			const double sinB=sin(i)*cos(beta)*sin(lambda-Omega)-cos(i)*sin(beta);
 			double rings = -2.6*fabs(sinB) + 1.25*sinB*sinB; // sinx=sinB, saturnicentric latitude of earth. longish, see Meeus.
-			return -8.88 + d + 0.044*phaseDeg + rings + extinctionMag;
+			return -8.88 + d + 0.044*phaseDeg + rings;
 		}
 		if (englishName=="Uranus")
-			return -7.19f + d + extinctionMag;
+			return -7.19f + d;
 		if (englishName=="Neptune")
-			return -6.87f + d + extinctionMag;
+			return -6.87f + d;
 		if (englishName=="Pluto")
-			return -1.00f + d + extinctionMag;
+			return -1.00f + d;
 	*/
 	// TODO: decide which set of formulae is best?
 	}
 
 	// This formula seems to give wrong results
 	const double p = (1.0 - phase/M_PI) * cos_chi + std::sqrt(1.0 - cos_chi*cos_chi) / M_PI;
-	double F = 2.0 * albedo * radius * radius * p / (3.0*observerPlanetRq*planetRq) * shadowFactor;
-	return -26.73 - 2.5 * std::log10(F) + extinctionMag;
+	double F = 2.0 * albedo * radius * radius * p / (3.0*observerPlanetRq*planetRq) * ph.shadowFactor;
+	return -26.73 - 2.5 * std::log10(F);
 }
 
 double Planet::getAngularSize(const StelCore* core) const
@@ -671,6 +614,15 @@ double Planet::getSpheroidAngularSize(const StelCore* core) const
 	return std::atan2(radius*sphereScale,getJ2000EquatorialPos(core).length()) * 180./M_PI;
 }
 
+// Return whether a position on screen is in the viewport enlarged by a margin in pixels
+static bool isInViewport(const StelProjectorP& prj, const Vec3d& win, float margin)
+{
+	const float left = prj->getViewportPosX();
+	const float bottom = prj->getViewportPosY();
+	return win[1]>bottom-margin && win[1]<bottom+prj->getViewportHeight()+margin
+	    && win[0]>left-margin && win[0]<left+prj->getViewportWidth()+margin;
+}
+
 // Draw the Planet and all the related infos : name, circle etc..
 void Planet::draw(StelCore* core, float maxMagLabels, const QFont& planetNameFont)
 {
@@ -702,11 +654,7 @@ void Planet::draw(StelCore* core, float maxMagLabels, const QFont& planetNameFon
 	// Compute the 2D position and check if in the screen
 	const StelProjectorP prj = core->getProjection(transfo);
 	float screenSz = getAngularSize(core)*M_PI/180.*prj->getPixelPerRadAtCenter();
-	float viewport_left = prj->getViewportPosX();
-	float viewport_bottom = prj->getViewportPosY();
-	if (prj->project(Vec3d(0), screenPos)
-	    && screenPos[1]>viewport_bottom - screenSz && screenPos[1] < viewport_bottom + prj->getViewportHeight()+screenSz
-	    && screenPos[0]>viewport_left - screenSz && screenPos[0] < viewport_left + prj->getViewportWidth() + screenSz)
+	if (prj->project(Vec3d(0), screenPos) && isInViewport(prj, screenPos, screenSz))
 	{
 		// Draw the name, and the circle if it's not too close from the body it's turning around
 		// this prevents name overlaping (ie for jupiter satellites)
@@ -714,9 +662,6 @@ void Planet::draw(StelCore* core, float maxMagLabels, const QFont& planetNameFon
 		if (ang_dist==0.f)
 			ang_dist = 1.f; // if ang_dist == 0, the Planet is sun..
 
-		// by putting here, only draw orbit if Planet is visible for clarity
-		drawOrbit(core);  // TODO - fade in here also...
-
 		if (flagLabels && ang_dist>0.25 && maxMagLabels>getVMagnitude(core))
 		{
 			labelsFader=true;
@@ -851,6 +796,8 @@ void Planet::drawSphere(StelPainter* painter, float screenSz)
 	int nb_facet = (int)(screenSz * 40/50);	// 40 facets for 1024 pixels diameter on screen
 	if (nb_facet<10) nb_facet = 10;
 	if (nb_facet>40) nb_facet = 40;
+	// Use down to half the facets when the rendering quality is lowered
+	nb_facet = qMax(10, (int)(nb_facet*(0.5f+0.5f*StelApp::getInstance().getCore()->getRenderingQuality())));
 	painter->setShadeModel(StelPainter::ShadeModelSmooth);
 	// Rotate and add an extra quarter rotation so that the planet texture map
 	// fits to the observers position. No idea why this is necessary,
@@ -863,37 +810,11 @@ void Planet::drawSphere(StelPainter* painter, float screenSz)
 
 // draws earth shadow overlapping the moon using stencil buffer
 // umbra and penumbra are sized separately for accuracy
+// The shadow disks are computed by the SolarSystem once per time step
 void Planet::drawEarthShadow(StelCore* core, StelPainter* sPainter)
 {
 	SolarSystem* ssm = GETSTELMODULE(SolarSystem);
-	Vec3d e = ssm->getEarth()->getEclipticPos();
-	Vec3d m = ssm->getMoon()->getEclipticPos();  // relative to earth
-	Vec3d mh = ssm->getMoon()->getHeliocentricEclipticPos();  // relative to sun
-	float mscale = ssm->getMoon()->getSphereScale();
-
-	// shadow location at earth + moon distance along earth vector from sun
-	Vec3d en = e;
-	en.normalize();
-	Vec3d shadow = en * (e.length() + m.length());
-
-	// find shadow radii in AU
-	double r_penumbra = shadow.length()*702378.1/AU/e.length() - 696000./AU;
-	double r_umbra = 6378.1/AU - m.length()*(689621.9/AU/e.length());
-
-	// find vector orthogonal to sun-earth vector using cross product with
-	// a non-parallel vector
-	Vec3d rpt = shadow^Vec3d(0,0,1);
-	rpt.normalize();
-	Vec3d upt = rpt*r_umbra*mscale*1.02;  // point on umbra edge
-	rpt *= r_penumbra*mscale;  // point on penumbra edge
-
-	// modify shadow location for scaled moon
-	Vec3d mdist = shadow - mh;
-	if (mdist.length() > r_penumbra + 2000./AU)
-		return;   // not visible so don't bother drawing
-
-	shadow = mh + mdist*mscale;
-	r_penumbra *= mscale;
+	const EclipseGeometry::ShadowMesh& mesh = ssm->getEarthShadowMesh();
 
 	StelProjectorP saveProj = sPainter->getProjector();
 	sPainter->setProjector(core->getProjection(StelCore::FrameHeliocentricEcliptic));
@@ -912,44 +833,11 @@ void Planet::drawEarthShadow(StelCore* core, StelPainter* sPainter)
 	// shadow radial texture
 	texEarthShadow->bind();
 
-	Vec3d r;
-
-	// Draw umbra first
-	QVector<Vec2f> texCoordArray;
-	QVector<Vec3d> vertexArray;
-	texCoordArray.reserve(210);
-	vertexArray.reserve(210);
-	texCoordArray << Vec2f(0.f, 0.5f);
-	// johannes: work-around for nasty ATI rendering bug: use y-texture coordinate of 0.5 instead of 0.0
-	vertexArray << shadow;
-
-	const Mat4d& rotMat = Mat4d::rotation(shadow, 2.*M_PI/100.);
-	r = upt;
-	for (int i=1; i<=101; ++i)
-	{
-		// position in texture of umbra edge
-		texCoordArray << Vec2f(0.6f, 0.5f);
-		r.transfo4d(rotMat);
-		vertexArray << shadow + r;
-	}
-	sPainter->setArrays(vertexArray.constData(), texCoordArray.constData());
-	sPainter->drawFromArray(StelPainter::TriangleFan, 102);
-
-	// now penumbra
-	vertexArray.resize(0);
-	texCoordArray.resize(0);
-	Vec3d u;
-	r = rpt;
-	u = upt;
-	for (int i=0; i<=200; i+=2)
-	{
-		r.transfo4d(rotMat);
-		u.transfo4d(rotMat);
-		texCoordArray << Vec2f(0.6f, 0.5f) << Vec2f(1.f, 0.5f); // position in texture of umbra edge
-		vertexArray <<  shadow + u << shadow + r;
-	}
-	sPainter->setArrays(vertexArray.constData(), texCoordArray.constData());
-	sPainter->drawFromArray(StelPainter::TriangleStrip, 202);
+	// Draw umbra first, then penumbra
+	sPainter->setArrays(mesh.umbraVertices.constData(), EclipseGeometry::getUmbraTexCoords().constData());
+	sPainter->drawFromArray(StelPainter::TriangleFan, mesh.umbraVertices.size());
+	sPainter->setArrays(mesh.penumbraVertices.constData(), EclipseGeometry::getPenumbraTexCoords().constData());
+	sPainter->drawFromArray(StelPainter::TriangleStrip, mesh.penumbraVertices.size());
 	glDisable(GL_STENCIL_TEST);
 	glClearStencil(0x0);
 	glClear(GL_STENCIL_BUFFER_BIT);	// Clean again to let a clean buffer for later Qt display
@@ -1023,54 +911,161 @@ void Ring::draw(StelPainter* sPainter,StelProjector::ModelViewTranformP transfo,
 }
 
 
-// draw orbital path of Planet
-void Planet::drawOrbit(const StelCore* core)
+double Planet::getOrbitParam(qint64 index) const
 {
-	if (!orbitFader.getInterstate())
-		return;
-	if (!re.siderealPeriod)
-		return;
+	if (closedOrbit)
+		return 2.*M_PI*index/ORBIT_SEGMENTS;
+	return index*deltaOrbitJD;
+}
 
-	const StelProjectorP prj = core->getProjection(StelCore::FrameHeliocentricEcliptic);
+Vec3d Planet::computeOrbitPoint(double param) const
+{
+	Vec3d pos;
+	if (closedOrbit)
+		closedOrbit->positionAtEInVSOP87Coordinates(param, pos);
+	else if (osculatingFunc)
+		(*osculatingFunc)(orbitShapeJD, param, pos);
+	else
+		coordFunc(param, pos, userDataPtr);
+	return pos;
+}
 
-	StelPainter sPainter(prj);
+void Planet::updateOrbitSegments(double date, qint64& first, qint64& last)
+{
+	if (closedOrbit)
+	{
+		// The shape of a Keplerian orbit never changes
+		first = 0;
+		last = ORBIT_SEGMENTS-1;
+		if (orbitSegments.isEmpty())
+		{
+			for (qint64 i=first;i<=last;++i)
+				orbitSegments[i].start = computeOrbitPoint(getOrbitParam(i));
+			orbitVerticesStale = true;
+		}
+		return;
+	}
 
-	// Normal transparency mode
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-	glEnable(GL_BLEND);
+	// The osculating elements change with the date, recompute the shape when the date moved by more than one segment
+	if (osculatingFunc && (orbitSegments.isEmpty() || fabs(date-orbitShapeJD)>deltaOrbitJD))
+	{
+		orbitSegments.clear();
+		orbitShapeJD = date;
+	}
 
-	sPainter.setColor(orbitColor[0], orbitColor[1], orbitColor[2], orbitFader.getInterstate());
-	Vec3d onscreen;
-	// special case - use current Planet position as center vertex so that draws
-	// on it's orbit all the time (since segmented rather than smooth curve)
-	Vec3d savePos = orbit[ORBIT_SEGMENTS/2];
-	orbit[ORBIT_SEGMENTS/2]=getHeliocentricEclipticPos();
-	orbit[ORBIT_SEGMENTS]=orbit[0];
-	int nbIter = closeOrbit ? ORBIT_SEGMENTS : ORBIT_SEGMENTS-1;
-	QVarLengthArray<float, 1024> vertexArray;
-
-	sPainter.enableClientStates(true, false, false);
-	for (int n=0; n<=nbIter; ++n)
+	// Window of one period around the date, aligned on the grid so that the segments can be reused at the next dates
+	first = (qint64)std::floor(date/deltaOrbitJD) - ORBIT_SEGMENTS/2;
+	last = first+ORBIT_SEGMENTS-1;
+	QMap<qint64, OrbitSegment>::Iterator iter = orbitSegments.begin();
+	while (iter!=orbitSegments.end())
 	{
-		if (prj->project(orbit[n],onscreen) && (vertexArray.size()==0 || !prj->intersectViewportDiscontinuity(orbit[n-1], orbit[n])))
+		if (iter.key()<first || iter.key()>last+1)
 		{
-			vertexArray.append(onscreen[0]);
-			vertexArray.append(onscreen[1]);
+			iter = orbitSegments.erase(iter);
+			orbitVerticesStale = true;
 		}
-		else if (!vertexArray.isEmpty())
+		else
+			++iter;
+	}
+	// The segment after the last one is only used for the end position of the last one
+	for (qint64 i=first;i<=last+1;++i)
+	{
+		if (!orbitSegments.contains(i))
 		{
-			sPainter.setVertexPointer(2, GL_FLOAT, vertexArray.constData());
-			sPainter.drawFromArray(StelPainter::LineStrip, vertexArray.size()/2, 0, false);
-			vertexArray.clear();
+			orbitSegments[i].start = computeOrbitPoint(getOrbitParam(i));
+			orbitVerticesStale = true;
 		}
 	}
-	orbit[ORBIT_SEGMENTS/2]=savePos;
-	if (!vertexArray.isEmpty())
+}
+
+void Planet::appendOrbitPiece(const StelProjectorP& prj, OrbitSegment& segment, int node, double p0, double p1,
+			      const Vec3d& start, const Vec3d& end, const Vec3d& offset, int depth, QVector<Vec3d>& points)
+{
+	const Vec3d middle = segment.nodes.at(node).middle;
+	Vec3d winStart, winEnd, winMiddle;
+	bool split = false;
+	if (depth<ORBIT_MAX_DEPTH && prj->project(start+offset, winStart) && prj->project(end+offset, winEnd) && prj->project(middle+offset, winMiddle))
+	{
+		// Distance on screen between the middle of the piece and the middle of its chord
+		const double dx = winMiddle[0]-0.5*(winStart[0]+winEnd[0]);
+		const double dy = winMiddle[1]-0.5*(winStart[1]+winEnd[1]);
+		split = dx*dx+dy*dy > ORBIT_MAX_PIXEL_ERROR*ORBIT_MAX_PIXEL_ERROR;
+	}
+	if (!split)
+	{
+		points.append(middle);
+		points.append(end);
+		return;
+	}
+
+	const double pm = 0.5*(p0+p1);
+	if (segment.nodes.at(node).firstChild<0)
 	{
-		sPainter.setVertexPointer(2, GL_FLOAT, vertexArray.constData());
-		sPainter.drawFromArray(StelPainter::LineStrip, vertexArray.size()/2, 0, false);
+		segment.nodes[node].firstChild = segment.nodes.size();
+		segment.nodes.append(OrbitNode(computeOrbitPoint(0.5*(p0+pm))));
+		segment.nodes.append(OrbitNode(computeOrbitPoint(0.5*(pm+p1))));
 	}
-	sPainter.enableClientStates(false);
+	const int child = segment.nodes.at(node).firstChild;
+	appendOrbitPiece(prj, segment, child, p0, pm, start, middle, offset, depth+1, points);
+	appendOrbitPiece(prj, segment, child+1, pm, p1, middle, end, offset, depth+1, points);
+}
+
+bool Planet::isOrbitDrawn(const StelCore* core) const
+{
+	if (hidden || !orbitFader.getInterstate() || !re.siderealPeriod)
+		return false;
+	// Same conditions as in draw(): only draw the orbit if the Planet is visible, for clarity
+	if (getEnglishName()==core->getCurrentLocation().planetName)
+		return false;
+	const StelProjectorP prj = core->getProjection(StelCore::FrameJ2000);
+	const float screenSz = getAngularSize(core)*M_PI/180.*prj->getPixelPerRadAtCenter();
+	Vec3d win;
+	return prj->project(getJ2000EquatorialPos(core), win) && isInViewport(prj, win, screenSz);
+}
+
+const QVector<Vec3d>& Planet::getOrbitVertices(const StelProjectorP& prj, const Vec3d& observerPos)
+{
+	qint64 first, last;
+	updateOrbitSegments(lastJD, first, last);
+
+	// The orbit positions are relative to the parent, so that the orbit follows the parent's current position.
+	// The sampling depends on the projection, but keep the line while the view and the observer moved only a little.
+	const Vec3d offset = getHeliocentricEclipticPos()-eclipticPos;
+	const Vec3d relativeObserverPos = observerPos-offset;
+	const float pixelPerRad = prj->getPixelPerRadAtCenter();
+	const Vec3d viewDir = prj->getBoundingCap().n;
+	const double orbitSize = orbitSegments.value(first).start.length();
+	if (!orbitVerticesStale
+	    && std::fabs(pixelPerRad/orbitVerticesPixelPerRad-1.f)<ORBIT_RESAMPLING_TOLERANCE
+	    && viewDir.angle(orbitVerticesViewDir)<ORBIT_RESAMPLING_TOLERANCE*prj->getFov()*M_PI/180.
+	    && (relativeObserverPos-orbitVerticesObserverPos).length()<ORBIT_RESAMPLING_TOLERANCE*(orbitVerticesObserverPos.length()+orbitSize))
+		return orbitVertices;
+
+	if (closedOrbit && !closeOrbit)
+		--last;
+	orbitVertices.clear();
+	orbitVertices.append(orbitSegments.value(first).start);
+	for (qint64 i=first;i<=last;++i)
+	{
+		OrbitSegment& segment = orbitSegments[i];
+		const Vec3d end = orbitSegments.value(closedOrbit ? (i+1)%ORBIT_SEGMENTS : i+1).start;
+		const double p0 = getOrbitParam(i);
+		const double p1 = getOrbitParam(i+1);
+		if (segment.nodes.isEmpty())
+			segment.nodes.append(OrbitNode(computeOrbitPoint(0.5*(p0+p1))));
+		appendOrbitPiece(prj, segment, 0, p0, p1, segment.start, end, offset, 0, orbitVertices);
+	}
+	if (!closedOrbit && closeOrbit)
+	{
+		const Vec3d start = orbitVertices.first();
+		orbitVertices.append(start);
+	}
+
+	orbitVerticesStale = false;
+	orbitVerticesPixelPerRad = pixelPerRad;
+	orbitVerticesViewDir = viewDir;
+	orbitVerticesObserverPos = relativeObserverPos;
+	return orbitVertices;
 }
 
 void Planet::update(int deltaTime)
@@ -21,6 +21,8 @@
 #define _PLANET_HPP_
 
 #include <QString>
+#include <QMap>
+#include <QVector>
 
 #include "StelObject.hpp"
 #include "StelProjector.hpp"
@@ -42,6 +44,7 @@ typedef void (OsculatingFunctType)(double jd0,double jd,double xyz[3]);
 class StelFont;
 class StelPainter;
 class StelTranslator;
+class Orbit;
 
 struct TrailPoint
 {
@@ -154,6 +157,7 @@ public:
 	const RotationElements &getRotationElements(void) const {return re;}
 
 	// Compute the position in the parent Planet coordinate system
+	// The orbit is not computed here, but lazily by getOrbitVertices()
 	void computePositionWithoutOrbits(const double date);
 	void computePosition(const double date);
 
@@ -162,6 +166,23 @@ public:
 
 	// Get the phase angle for an observer at pos obsPos in the heliocentric coordinate (in AU)
 	double getPhase(const Vec3d& obsPos) const;
+
+	//! @struct Photometry
+	//! The quantities the visual magnitude is computed from, which only change when the positions are recomputed.
+	struct Photometry
+	{
+		double observerDistance;         //!< distance from the observer in AU
+		double sunDistance;              //!< distance from the Sun in AU
+		double phaseAngle;               //!< angle between the Sun and the observer seen from the body in radian
+		double illuminatedFraction;      //!< illuminated fraction of the disk seen by the observer
+		double shadowFactor;             //!< 1 outside of the shadow of the parent, down to 1e-9 inside its umbra
+		float magnitude;                 //!< visual magnitude without extinction
+	};
+	//! Get the photometry for the current observer. It is computed on the first call after each
+	//! SolarSystem::computePositions(), or when the observer moved.
+	const Photometry& getPhotometry(const StelCore* core) const;
+	//! Invalidate the photometry of all the bodies, called when the positions are recomputed.
+	static void invalidatePhotometry() {if (++photometryEpoch==0) ++photometryEpoch;}
 	// Get the angular size of the spheroid of the planet (i.e. without the rings)
 	double getSpheroidAngularSize(const StelCore* core) const;
 
@@ -208,17 +229,57 @@ public:
 	void setFlagOrbits(bool b){orbitFader = b;}
 	bool getFlagOrbits(void) const {return orbitFader;}
 	LinearFader orbitFader;
-	// draw orbital path of Planet
-	void drawOrbit(const StelCore*);
-	Vec3d orbit[ORBIT_SEGMENTS+1];   // store heliocentric coordinates for drawing the orbit
-	double lastOrbitJD;
+	// Return whether the orbit line is drawn: when orbits are shown and the body is in the viewport
+	bool isOrbitDrawn(const StelCore* core) const;
+	// Return the orbit line as a line strip in the parent ecliptic frame, drawn by the SolarSystem with all the other
+	// orbits. It is rebuilt only when the orbit segments changed, or when the zoom, the view direction or the position
+	// of the observer changed by more than ORBIT_RESAMPLING_TOLERANCE
+	const QVector<Vec3d>& getOrbitVertices(const StelProjectorP& prj, const Vec3d& observerPos);
 	double deltaJD;
-	double deltaOrbitJD;
-	bool orbitCached;                // whether orbit calculations are cached for drawing orbit yet
+	double deltaOrbitJD;             // time step between the first samples of an orbit sampled in time
 	bool closeOrbit;                 // whether to connect the beginning of the orbit line to
 					 // the end: good for elliptical orbits, bad for parabolic
 					 // and hyperbolic orbits
 
+	// A piece of an orbit segment, split in two halves when its sagitta on screen is too large
+	struct OrbitNode
+	{
+		OrbitNode(const Vec3d& m) : middle(m), firstChild(-1) {;}
+		Vec3d middle;            // position in the middle of the piece
+		int firstChild;          // index of the first half in OrbitSegment::nodes, the second half follows it,
+					 // or -1 if the piece was never split
+	};
+	// One of the ORBIT_SEGMENTS parts of the orbit line, with the positions computed so far along it
+	struct OrbitSegment
+	{
+		Vec3d start;             // position at the start of the segment
+		QVector<OrbitNode> nodes;// the first node is the whole segment
+	};
+	// The orbit segments in the parent ecliptic frame, by index of their start on the sampling grid.
+	// A closed Keplerian orbit is sampled once in eccentric anomaly, the other orbits in a moving window
+	// of one period around the current date. The positions are computed lazily when the orbit is drawn,
+	// and are kept while their shape is unchanged so that going back and forth in time reuses them.
+	QMap<qint64, OrbitSegment> orbitSegments;
+	double orbitShapeJD;             // date of the osculating elements used for the orbit segments
+	// Update the orbit segments for the date, and return the first and last index of the drawn segments
+	void updateOrbitSegments(double date, qint64& first, qint64& last);
+	// Compute the orbit position for a sampling parameter: an eccentric anomaly or a date
+	Vec3d computeOrbitPoint(double param) const;
+	// Return the sampling parameter for a grid index
+	double getOrbitParam(qint64 index) const;
+	// Append to points the positions of a piece of orbit segment in the parent frame, without its start,
+	// splitting the piece until its sagitta on screen is below ORBIT_MAX_PIXEL_ERROR
+	void appendOrbitPiece(const StelProjectorP& prj, OrbitSegment& segment, int node, double p0, double p1,
+			      const Vec3d& start, const Vec3d& end, const Vec3d& offset, int depth, QVector<Vec3d>& points);
+	// The closed Keplerian orbit of the body, or NULL if its orbit is sampled in time
+	const Orbit* closedOrbit;
+	// The orbit line returned by getOrbitVertices()
+	QVector<Vec3d> orbitVertices;
+	bool orbitVerticesStale;         // whether the orbit segments changed since orbitVertices was built
+	float orbitVerticesPixelPerRad;  // zoom, view direction and observer position relative to the parent
+	Vec3d orbitVerticesViewDir;      // for which orbitVertices was sampled
+	Vec3d orbitVerticesObserverPos;
+
 	static Vec3f orbitColor;
 	static void setOrbitColor(const Vec3f& oc) {orbitColor = oc;}
 	static const Vec3f& getOrbitColor() {return orbitColor;}
@@ -241,6 +302,13 @@ protected:
 	// Draw the circle and name of the Planet
 	void drawHints(const StelCore* core, const QFont& planetNameFont);
 
+	// Compute the visual magnitude without extinction from the geometric part of the photometry.
+	// Overridden by the bodies using an other magnitude system.
+	virtual float computeMagnitudeWithoutExtinction(const StelCore* core, const Photometry& ph) const;
+
+	// Return the magnitude loss by the atmospheric extinction at the apparent position
+	float getExtinctionMagnitude(const StelCore* core) const;
+
 	QString englishName;             // english planet name
 	QString nameI18;                 // International translated name
 	QString texMapName;              // Texture file path
@@ -269,12 +337,20 @@ protected:
 	OsculatingFunctType *const osculatingFunc;
 	QSharedPointer<Planet> parent;           // Planet parent i.e. sun for earth
 	QList<QSharedPointer<Planet> > satellites;      // satellites of the Planet
+	double satellitesRadius;         // Radius in AU of a sphere centered on the Planet enclosing its satellites
+	bool satellitesCulled;           // Whether the positions of the satellites are skipped, because nothing depends on them
+	bool satellitesStale;            // Whether the positions of the satellites were skipped at the last time step
 	LinearFader hintFader;
 	LinearFader labelsFader;         // Store the current state of the label for this planet
 	bool flagLabels;                 // Define whether labels should be displayed
 	bool hidden;                     // useful for fake planets used as observation positions - not drawn or labeled
 	bool atmosphere;                 // Does the planet have an atmosphere?
 
+	mutable Photometry photometry;   // Photometry cached by getPhotometry()
+	mutable unsigned int photometryStamp; // Value of photometryEpoch when photometry was computed, 0 if never
+	mutable Vec3d photometryObserverPos; // Heliocentric observer position for which photometry was computed
+	static unsigned int photometryEpoch;
+
 	static Vec3f labelColor;
 	static StelTextureSP hintCircleTex;
 };
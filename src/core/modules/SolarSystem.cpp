@@ -33,10 +33,12 @@
 #include "StelSkyCultureMgr.hpp"
 #include "StelFileMgr.hpp"
 #include "StelModuleMgr.hpp"
+#include "StelMovementMgr.hpp"
 #include "StelIniParser.hpp"
 #include "Planet.hpp"
 #include "MinorPlanet.hpp"
 #include "Comet.hpp"
+#include "MinorBody.hpp"
 
 #include "StelSkyDrawer.hpp"
 #include "StelUtils.hpp"
@@ -54,11 +56,25 @@
 #include <QStringList>
 #include <QMap>
 #include <QMultiMap>
+#include <QHash>
 #include <QMapIterator>
 #include <QDebug>
-
-SolarSystem::SolarSystem() : moonScale(1.),	flagOrbits(false), flagLightTravelTime(false), allTrails(NULL)
+#include <QRunnable>
+#include <QThreadPool>
+#include <QSemaphore>
+#include <QSet>
+
+//! Maximum number of bodies without shared state computed by one position task
+static const int MAX_INDEPENDENT_BODIES_PER_TASK = 64;
+//! Factor applied to the largest distance of a satellite seen so far, to enclose its whole orbit in the bounding sphere
+static const double SATELLITE_SYSTEM_MARGIN = 1.25;
+//! Diameter in pixel under which the satellites of a system are not drawn
+static const double SATELLITE_SYSTEM_MIN_PIXELS = 1.;
+
+SolarSystem::SolarSystem() : moonScale(1.),	flagOrbits(false), flagLightTravelTime(false), flagParallelPositions(false), positionsDate(0.), minorBodiesGeneration(0), earthShadowMeshScale(0.f), allTrails(NULL)
 {
+	positionThreadPool = new QThreadPool(this);
+	earthShadow.nearEclipse = false;
 	planetNameFont.setPixelSize(StelApp::getInstance().getSettings()->value("gui/base_font_size", 13).toInt());
 	setObjectName("SolarSystem");
 }
@@ -77,6 +93,8 @@ SolarSystem::~SolarSystem()
 		delete orb;
 		orb = NULL;
 	}
+	minorBodyPlanets.clear();
+	qDeleteAll(minorBodyOrbits);
 	sun.clear();
 	moon.clear();
 	earth.clear();
@@ -110,6 +128,7 @@ void SolarSystem::init()
 	Q_ASSERT(conf);
 
 	loadPlanets();	// Load planets data
+	loadMinorBodies();
 
 	// Compute position and matrix of sun and all the satellites (ie planets)
 	// for the first initialization Q_ASSERT that center is sun center (only impacts on light speed correction)
@@ -124,6 +143,7 @@ void SolarSystem::init()
 	setLabelsAmount(conf->value("astro/labels_amount", 3.).toFloat());
 	setFlagOrbits(conf->value("astro/flag_planets_orbits").toBool());
 	setFlagLightTravelTime(conf->value("astro/flag_light_travel_time", false).toBool());
+	setFlagParallelPositions(conf->value("astro/flag_parallel_positions", false).toBool());
 
 	recreateTrails();
 
@@ -251,6 +271,7 @@ void SolarSystem::loadPlanets()
 			}
 		}
 	}
+	buildPositionTasks();
 }
 
 bool SolarSystem::loadPlanets(const QString& filePath)
@@ -864,18 +885,246 @@ bool SolarSystem::loadPlanets(const QString& filePath)
 	return true;
 }
 
+// The ephemeris theories keep the last computed elements in static variables, and the interpolated results
+// depend on the previous calls. The bodies using the same theory are therefore computed in the same task
+// and in the same order as in the serial loop, so that the results don't depend on the number of threads.
+enum EphemerisGroup
+{
+	EphemerisIndependent,	// no shared state: Sun, Pluto, elliptical and comet orbits
+	EphemerisVsop87Elp82b,	// the major planets, the Earth and the Moon
+	EphemerisMarsSat,
+	EphemerisL1,
+	EphemerisTass17,
+	EphemerisGust86,
+	EphemerisUnknown	// a function which is not known to be reentrant
+};
+
+static EphemerisGroup getEphemerisGroup(posFuncType f)
+{
+	if (f==&ellipticalOrbitPosFunc || f==&cometOrbitPosFunc || f==&get_sun_helio_coordsv || f==&get_pluto_helio_coordsv)
+		return EphemerisIndependent;
+	if (f==&get_mercury_helio_coordsv || f==&get_venus_helio_coordsv || f==&get_earth_helio_coordsv
+	    || f==&get_mars_helio_coordsv || f==&get_jupiter_helio_coordsv || f==&get_saturn_helio_coordsv
+	    || f==&get_uranus_helio_coordsv || f==posFuncType(get_neptune_helio_coordsv) || f==&get_lunar_parent_coordsv)
+		return EphemerisVsop87Elp82b;
+	if (f==posFuncType(get_phobos_parent_coordsv) || f==&get_deimos_parent_coordsv)
+		return EphemerisMarsSat;
+	if (f==&get_io_parent_coordsv || f==&get_europa_parent_coordsv || f==&get_ganymede_parent_coordsv || f==&get_callisto_parent_coordsv)
+		return EphemerisL1;
+	if (f==&get_mimas_parent_coordsv || f==&get_enceladus_parent_coordsv || f==&get_tethys_parent_coordsv
+	    || f==&get_dione_parent_coordsv || f==&get_rhea_parent_coordsv || f==&get_titan_parent_coordsv
+	    || f==&get_hyperion_parent_coordsv || f==&get_iapetus_parent_coordsv)
+		return EphemerisTass17;
+	if (f==&get_miranda_parent_coordsv || f==&get_ariel_parent_coordsv || f==&get_umbriel_parent_coordsv
+	    || f==&get_titania_parent_coordsv || f==&get_oberon_parent_coordsv)
+		return EphemerisGust86;
+	return EphemerisUnknown;
+}
+
+bool SolarSystem::lowerPositionTaskLevel(const PositionTask& t1, const PositionTask& t2)
+{
+	return t1.level < t2.level;
+}
+
+void SolarSystem::buildPositionTasks()
+{
+	positionTasks.clear();
+
+	// Assign each body to a task, the bodies without shared state are grouped by parent task in chunks
+	QVector<PositionTask> tasks;
+	QHash<const Planet*, int> taskOfBody;
+	QHash<int, int> taskOfGroup;
+	QHash<int, int> independentTaskOfParentTask;
+	foreach (const PlanetP& p, systemPlanets)
+	{
+		const EphemerisGroup group = getEphemerisGroup(p->coordFunc);
+		int parentTask = -1;
+		if (p->parent)
+		{
+			if (!taskOfBody.contains(p->parent.data()))
+			{
+				qWarning() << "WARNING: the parent of" << p->getEnglishName() << "is not loaded before it, compute the Solar System positions in one thread.";
+				return;
+			}
+			parentTask = taskOfBody.value(p->parent.data());
+		}
+
+		int t;
+		if (group==EphemerisIndependent)
+		{
+			t = independentTaskOfParentTask.value(parentTask, -1);
+			if (t<0 || tasks.at(t).bodies.size()>=MAX_INDEPENDENT_BODIES_PER_TASK)
+			{
+				t = tasks.size();
+				tasks.append(PositionTask());
+				independentTaskOfParentTask.insert(parentTask, t);
+			}
+		}
+		else
+		{
+			t = taskOfGroup.value(group, -1);
+			if (t<0)
+			{
+				t = tasks.size();
+				tasks.append(PositionTask());
+				taskOfGroup.insert(group, t);
+			}
+		}
+		tasks[t].bodies.append(p.data());
+		taskOfBody.insert(p.data(), t);
+	}
+
+	// Compute the level of each task as the length of its longest chain of parent tasks. A task of an
+	// ephemeris group can contain bodies of several levels of the hierarchy, so iterate until it is stable.
+	for (int t=0;t<tasks.size();++t)
+		tasks[t].level = 0;
+	bool changed = true;
+	for (int i=0;changed && i<=tasks.size();++i)
+	{
+		changed = false;
+		for (int t=0;t<tasks.size();++t)
+		{
+			foreach (const Planet* p, tasks.at(t).bodies)
+			{
+				if (!p->parent)
+					continue;
+				const int parentTask = taskOfBody.value(p->parent.data());
+				if (parentTask!=t && tasks.at(parentTask).level>=tasks.at(t).level)
+				{
+					tasks[t].level = tasks.at(parentTask).level+1;
+					changed = true;
+				}
+			}
+		}
+	}
+	if (changed)
+	{
+		qWarning() << "WARNING: cyclic dependencies between the Solar System ephemeris theories, compute the positions in one thread.";
+		return;
+	}
+
+	if (tasks.size()>1)
+	{
+		qStableSort(tasks.begin(), tasks.end(), lowerPositionTaskLevel);
+		positionTasks = tasks;
+	}
+}
+
+//! Run a pass over the bodies of one position task in a worker thread, and release the semaphore when done
+class SolarSystemPositionRunnable : public QRunnable
+{
+public:
+	SolarSystemPositionRunnable(const SolarSystem::PositionTask& atask, SolarSystem::PositionPass apass, double adate, const Vec3d& aobserverPos, QSemaphore* adone)
+		: task(atask), pass(apass), date(adate), observerPos(aobserverPos), done(adone) {;}
+	virtual void run()
+	{
+		SolarSystem::computeTaskPositions(task, pass, date, observerPos);
+		done->release();
+	}
+private:
+	const SolarSystem::PositionTask& task;
+	SolarSystem::PositionPass pass;
+	double date;
+	Vec3d observerPos;
+	QSemaphore* done;
+};
+
+void SolarSystem::computeTaskPositions(const PositionTask& task, PositionPass pass, double date, const Vec3d& observerPos)
+{
+	foreach (Planet* p, task.bodies)
+	{
+		if (isCulledSatellite(p))
+			continue;
+		switch (pass)
+		{
+			case PassPositionWithoutOrbits:
+				p->computePositionWithoutOrbits(date);
+				break;
+			case PassPosition:
+				p->computePosition(date);
+				break;
+			case PassLightTimePosition:
+			{
+				const double light_speed_correction = (p->getHeliocentricEclipticPos()-observerPos).length() * (AU / (SPEED_OF_LIGHT * 86400));
+				p->computePosition(date-light_speed_correction);
+				break;
+			}
+			case PassTransMatrix:
+				p->computeTransMatrix(date);
+				break;
+			case PassLightTimeTransMatrix:
+			{
+				const double light_speed_correction = (p->getHeliocentricEclipticPos()-observerPos).length() * (AU / (SPEED_OF_LIGHT * 86400));
+				p->computeTransMatrix(date-light_speed_correction);
+				break;
+			}
+		}
+	}
+}
+
+void SolarSystem::runPositionTasks(PositionPass pass, double date, const Vec3d& observerPos, bool levelled)
+{
+	// QThreadPool::waitForDone() would also stop the worker threads, so wait for the tasks with a semaphore
+	// and keep the threads for the next passes
+	QSemaphore done;
+	int first = 0;
+	while (first<positionTasks.size())
+	{
+		int last = positionTasks.size();
+		if (levelled)
+		{
+			last = first+1;
+			while (last<positionTasks.size() && positionTasks.at(last).level==positionTasks.at(first).level)
+				++last;
+		}
+		// The calling thread computes the last task of the level while the workers compute the others
+		for (int t=first;t<last-1;++t)
+			positionThreadPool->start(new SolarSystemPositionRunnable(positionTasks.at(t), pass, date, observerPos, &done));
+		computeTaskPositions(positionTasks.at(last-1), pass, date, observerPos);
+		done.acquire(last-1-first);
+		first = last;
+	}
+}
+
 // Compute the position for every elements of the solar system.
-// The order is not important since the position is computed relatively to the mother body
+// With the light travel time, a body is computed after its parent because its light travel time uses the parent position.
+// When the positions are computed in parallel, the bodies are split in tasks by buildPositionTasks().
 void SolarSystem::computePositions(double date, const Vec3d& observerPos)
 {
-	if (flagLightTravelTime)
+	// The magnitudes cached by the bodies are computed again on their next use
+	Planet::invalidatePhotometry();
+
+	// The satellites of the systems culled by the last draw() are skipped, unless something else depends on them
+	positionsDate = date;
+	positionsObserverPos = observerPos;
+	foreach (const PlanetP& p, systemPlanets)
+	{
+		if (p->satellitesCulled && isSatelliteSystemNeeded(p.data()))
+			p->satellitesCulled = false;
+		p->satellitesStale = p->satellitesCulled;
+	}
+
+	if (flagParallelPositions && !positionTasks.isEmpty())
+	{
+		if (flagLightTravelTime)
+		{
+			runPositionTasks(PassPositionWithoutOrbits, date, observerPos, false);
+			runPositionTasks(PassLightTimePosition, date, observerPos, true);
+		}
+		else
+			runPositionTasks(PassPosition, date, observerPos, false);
+	}
+	else if (flagLightTravelTime)
 	{
 		foreach (PlanetP p, systemPlanets)
 		{
-			p->computePositionWithoutOrbits(date);
+			if (!isCulledSatellite(p.data()))
+				p->computePositionWithoutOrbits(date);
 		}
 		foreach (PlanetP p, systemPlanets)
 		{
+			if (isCulledSatellite(p.data()))
+				continue;
 			const double light_speed_correction = (p->getHeliocentricEclipticPos()-observerPos).length() * (AU / (SPEED_OF_LIGHT * 86400));
 			p->computePosition(date-light_speed_correction);
 		}
@@ -884,20 +1133,153 @@ void SolarSystem::computePositions(double date, const Vec3d& observerPos)
 	{
 		foreach (PlanetP p, systemPlanets)
 		{
-			p->computePosition(date);
+			if (!isCulledSatellite(p.data()))
+				p->computePosition(date);
 		}
 	}
 	computeTransMatrices(date, observerPos);
+	computeMinorBodyPositions(date, observerPos);
+
+	if (earth && moon)
+	{
+		earthShadow = EclipseGeometry::computeEarthShadow(earth->getHeliocentricEclipticPos(), moon->getEclipticPos());
+		earthShadowMeshScale = 0.f;
+	}
+
+	foreach (const PlanetP& p, systemPlanets)
+	{
+		if (!p->satellites.isEmpty() && !p->satellitesCulled)
+			updateSatellitesRadius(p.data());
+	}
+}
+
+// Compute the position and the transform matrix of a body which has no satellite, in the same way as computePositions()
+static void computeBodyPosition(Planet* p, double date, const Vec3d& observerPos, bool lightTravelTime)
+{
+	double lightTime = 0.;
+	if (lightTravelTime)
+	{
+		p->computePositionWithoutOrbits(date);
+		lightTime = (p->getHeliocentricEclipticPos()-observerPos).length() * (AU / (SPEED_OF_LIGHT * 86400));
+	}
+	p->computePosition(date-lightTime);
+	p->computeTransMatrix(date-lightTime);
+}
+
+void SolarSystem::computeMinorBodyPositions(double date, const Vec3d& observerPos)
+{
+	if (minorBodies.size()==0)
+		return;
+	minorBodies.computePositions(date, minorBodyPositions, flagLightTravelTime ? &observerPos : NULL);
+	foreach (const PlanetP& p, minorBodyPlanets)
+		computeBodyPosition(p.data(), date, observerPos, flagLightTravelTime);
+}
+
+void SolarSystem::loadMinorBodies()
+{
+	// The indices of the MinorBody objects still referenced must be looked up again
+	++minorBodiesGeneration;
+	minorBodies = MinorBodyCatalog();
+	minorBodyPositions.clear();
+	minorBodyMagnitudes.clear();
+	minorBodyIndex.clear();
+	QString sourceFile;
+	try
+	{
+		sourceFile = StelFileMgr::findFile(StelApp::getInstance().getSettings()->value("astro/minor_bodies_file", "data/mpcorb.dat").toString());
+	}
+	catch (std::runtime_error&)
+	{
+		// The minor bodies catalogue is optional
+		return;
+	}
+
+	const QString cacheFile = MinorBodyCatalog::getCacheFilePath(sourceFile);
+	if (minorBodies.load(cacheFile, QStringList() << sourceFile))
+	{
+		qDebug() << "Loaded" << minorBodies.size() << "minor body records from" << cacheFile;
+	}
+	else
+	{
+		if (!minorBodies.compile(sourceFile))
+			return;
+		minorBodies.save(cacheFile);
+	}
+
+	QSet<QString> names;
+	foreach (const PlanetP& p, systemPlanets)
+		names.insert(p->getEnglishName());
+	minorBodies.removeEnglishNames(names);
+	for (int i=0;i<minorBodies.size();++i)
+		minorBodyIndex.insert(minorBodies.getEnglishName(i), i);
+}
+
+StelObjectP SolarSystem::getMinorBody(int index) const
+{
+	const PlanetP p = minorBodyPlanets.value(index);
+	if (p)
+		return qSharedPointerCast<StelObject>(p);
+	return StelObjectP(new MinorBody(this, index));
+}
+
+PlanetP SolarSystem::getMinorBodyPlanet(int index)
+{
+	PlanetP& p = minorBodyPlanets[index];
+	if (p.isNull())
+	{
+		// The orbits are kept after the Planet is released, the Planet objects may still be referenced for a while
+		Orbit*& orbit = minorBodyOrbits[index];
+		if (!orbit)
+			orbit = minorBodies.createOrbit(index);
+		EllipticalOrbit* orb = static_cast<EllipticalOrbit*>(orbit);
+		QSharedPointer<MinorPlanet> mp(new MinorPlanet(minorBodies.getEnglishName(index), false, 0., 0., Vec3f(1.f, 1.f, 1.f), 0.15f,
+							       "nomap.png", &ellipticalOrbitPosFunc, orb, NULL, true, false));
+		if (minorBodies.numbers.at(index)!=0)
+			mp->setMinorPlanetNumber(minorBodies.numbers.at(index));
+		mp->setAbsoluteMagnitudeAndSlope(minorBodies.absoluteMagnitudes.at(index), minorBodies.slopeParameters.at(index));
+		mp->setRotationElements(1.f, 0.f, J2000, 0.f, 0.f, 0.f, orb->getPeriod());
+		mp->translateName(StelApp::getInstance().getLocaleMgr().getAppStelTranslator());
+		p = mp;
+		p->parent = sun;
+
+		const StelCore* core = StelApp::getInstance().getCore();
+		computeBodyPosition(p.data(), core->getJDay(), core->getObserverHeliocentricEclipticPos(), flagLightTravelTime);
+	}
+	return p;
+}
+
+void SolarSystem::releaseMinorBodyPlanets(const QList<StelObjectP>& selection)
+{
+	QHash<int, PlanetP>::Iterator iter = minorBodyPlanets.begin();
+	while (iter!=minorBodyPlanets.end())
+	{
+		if (selection.contains(qSharedPointerCast<StelObject>(iter.value())))
+		{
+			++iter;
+			continue;
+		}
+		if (selected==iter.value())
+			selected.clear();
+		iter = minorBodyPlanets.erase(iter);
+	}
 }
 
 // Compute the transformation matrix for every elements of the solar system.
-// The elements have to be ordered hierarchically, eg. it's important to compute earth before moon.
+// The matrix of a body only depends on the body itself and on the positions, so they can all be computed at once.
 void SolarSystem::computeTransMatrices(double date, const Vec3d& observerPos)
 {
+	if (flagParallelPositions && !positionTasks.isEmpty())
+	{
+		runPositionTasks(flagLightTravelTime ? PassLightTimeTransMatrix : PassTransMatrix, date, observerPos, false);
+		return;
+	}
+
 	if (flagLightTravelTime)
 	{
 		foreach (PlanetP p, systemPlanets)
 		{
+			if (isCulledSatellite(p.data()))
+				continue;
 			const double light_speed_correction = (p->getHeliocentricEclipticPos()-observerPos).length() * (AU / (SPEED_OF_LIGHT * 86400));
 			p->computeTransMatrix(date-light_speed_correction);
 		}
@@ -906,11 +1288,94 @@ void SolarSystem::computeTransMatrices(double date, const Vec3d& observerPos)
 	{
 		foreach (PlanetP p, systemPlanets)
 		{
-			p->computeTransMatrix(date);
+			if (!isCulledSatellite(p.data()))
+				p->computeTransMatrix(date);
+		}
+	}
+}
+
+bool SolarSystem::isSatelliteSystemNeeded(const Planet* p) const
+{
+	// The Moon is used for the brightness of the atmosphere and of the landscape even when it is not drawn
+	if (p==earth.data())
+		return true;
+	if (selected && (selected.data()==p || selected->parent.data()==p))
+		return true;
+	const QString& observerPlanet = StelApp::getInstance().getCore()->getCurrentLocation().planetName;
+	if (p->englishName==observerPlanet)
+		return true;
+	foreach (const PlanetP& s, p->satellites)
+	{
+		if (s->englishName==observerPlanet)
+			return true;
+	}
+	return false;
+}
+
+void SolarSystem::cullSatelliteSystems(StelCore* core)
+{
+	const StelProjectorP prj = core->getProjection(StelCore::FrameJ2000);
+	const SphericalCap& viewportCap = prj->getBoundingCap();
+	const double pixPerRad = prj->getPixelPerRadAtCenter();
+	foreach (const PlanetP& p, systemPlanets)
+	{
+		if (p->satellites.isEmpty() || !p->parent)
+			continue;
+		bool culled = !flagShow;
+		if (!culled)
+		{
+			// The observer can be inside the bounding sphere
+			const Vec3d pos = p->getJ2000EquatorialPos(core);
+			const double dist = pos.length();
+			if (dist>p->satellitesRadius)
+			{
+				const double angularRadius = std::asin(p->satellitesRadius/dist);
+				culled = 2.*angularRadius*pixPerRad<SATELLITE_SYSTEM_MIN_PIXELS
+					 || !viewportCap.intersects(SphericalCap(pos/dist, std::cos(angularRadius)));
+			}
 		}
+		p->satellitesCulled = culled && !isSatelliteSystemNeeded(p.data());
+		if (!p->satellitesCulled)
+			computeStaleSatellites(p.data());
 	}
 }
 
+void SolarSystem::computeStaleSatellites(Planet* p) const
+{
+	if (!p->satellitesStale)
+		return;
+	p->satellitesStale = false;
+	foreach (const PlanetP& s, p->satellites)
+	{
+		computeBodyPosition(s.data(), positionsDate, positionsObserverPos, flagLightTravelTime);
+		s->photometryStamp = 0;
+	}
+	updateSatellitesRadius(p);
+}
+
+void SolarSystem::updateSatellitesRadius(Planet* p)
+{
+	foreach (const PlanetP& s, p->satellites)
+	{
+		double r = s->getEclipticPos().length()*SATELLITE_SYSTEM_MARGIN;
+		// The farthest point of a Keplerian orbit is known
+		if (s->coordFunc==&ellipticalOrbitPosFunc)
+			r = qMax(r, static_cast<EllipticalOrbit*>(s->userDataPtr)->getBoundingRadius());
+		r += s->radius*s->sphereScale + s->satellitesRadius;
+		if (r>p->satellitesRadius)
+			p->satellitesRadius = r;
+	}
+}
+
+bool SolarSystem::satelliteSystemIntersects(const Planet* p, const Vec3d& v, double limitFov, const StelCore* core)
+{
+	const Vec3d pos = p->getEquinoxEquatorialPos(core);
+	const double dist = pos.length();
+	if (dist<=p->satellitesRadius)
+		return true;
+	return std::acos(qBound(-1., pos*v/dist, 1.)) <= limitFov+std::asin(p->satellitesRadius/dist);
+}
+
 // And sort them from the furthest to the closest to the observer
 struct biggerDistance : public std::binary_function<PlanetP, PlanetP, bool>
 {
@@ -924,6 +1389,8 @@ struct biggerDistance : public std::binary_function<PlanetP, PlanetP, bool>
 // We are supposed to be in heliocentric coordinate
 void SolarSystem::draw(StelCore* core)
 {
+	// Decide which satellites are drawn, and computed at the next time steps
+	cullSatelliteSystems(core);
 	if (!flagShow)
 		return;
 
@@ -934,6 +1401,10 @@ void SolarSystem::draw(StelCore* core)
 	{
 		p->computeDistance(obsHelioPos);
 	}
+	foreach (const PlanetP& p, minorBodyPlanets)
+	{
+		p->computeDistance(obsHelioPos);
+	}
 
 	// And sort them from the furthest to the closest
 	sort(systemPlanets.begin(),systemPlanets.end(),biggerDistance());
@@ -949,9 +1420,15 @@ void SolarSystem::draw(StelCore* core)
 	// Make some voodoo to determine when labels should be displayed
 	float maxMagLabel = (core->getSkyDrawer()->getLimitMagnitude()<5.f ? core->getSkyDrawer()->getLimitMagnitude() :
 			5.f+(core->getSkyDrawer()->getLimitMagnitude()-5.f)*1.2f) +(labelsAmount-3.f)*1.2f;
-
-	// Draw the elements
-	foreach (const PlanetP& p, systemPlanets)
+	// Show fewer labels when the rendering quality is lowered
+	maxMagLabel -= (1.f-core->getRenderingQuality())*2.f;
+
+	// Draw the orbits, the catalogue minor bodies and the unresolved bodies in batch, then the other elements one by one
+	drawOrbits(core);
+	drawMinorBodies(core);
+	QList<PlanetP> resolvedBodies;
+	drawUnresolvedBodies(core, maxMagLabel, resolvedBodies);
+	foreach (const PlanetP& p, resolvedBodies)
 	{
 		p->draw(core, maxMagLabel, planetNameFont);
 	}
@@ -960,6 +1437,181 @@ void SolarSystem::draw(StelCore* core)
 		drawPointer(core);
 }
 
+// Draw the orbit lines of all the bodies in one pass. The cached lines of the bodies are projected one after the other
+// in arrays of line pieces, one for each colour and opacity, instead of one painter and line strip per body.
+void SolarSystem::drawOrbits(StelCore* core)
+{
+	const StelProjectorP prj = core->getProjection(StelCore::FrameHeliocentricEcliptic);
+	const Vec3d observerPos = core->getObserverHeliocentricEclipticPos();
+
+	QVector<Vec4f> batchColors;
+	QVector<QVector<float> > batchVertices;
+	QList<PlanetP> bodies(systemPlanets);
+	bodies += minorBodyPlanets.values();
+	foreach (const PlanetP& p, bodies)
+	{
+		if (isCulledSatellite(p.data()) || !p->isOrbitDrawn(core))
+			continue;
+
+		const Vec4f color(Planet::orbitColor[0], Planet::orbitColor[1], Planet::orbitColor[2], p->orbitFader.getInterstate());
+		int batch = batchColors.indexOf(color);
+		if (batch<0)
+		{
+			batch = batchColors.size();
+			batchColors << color;
+			batchVertices.resize(batch+1);
+		}
+		QVector<float>& vertices = batchVertices[batch];
+
+		// The pieces which can't be projected or cross a discontinuity of the projection are skipped
+		const QVector<Vec3d>& orbit = p->getOrbitVertices(prj, observerPos);
+		const Vec3d offset = p->getHeliocentricEclipticPos()-p->eclipticPos;
+		Vec3d previous, previousWin, win;
+		bool previousProjected = false;
+		for (int i=0;i<orbit.size();++i)
+		{
+			const Vec3d pos = orbit.at(i)+offset;
+			const bool projected = prj->project(pos, win);
+			if (projected && previousProjected && !prj->intersectViewportDiscontinuity(previous, pos))
+				vertices << previousWin[0] << previousWin[1] << win[0] << win[1];
+			previous = pos;
+			previousWin = win;
+			previousProjected = projected;
+		}
+	}
+	if (batchColors.isEmpty())
+		return;
+
+	StelPainter sPainter(prj);
+
+	// Normal transparency mode
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	glEnable(GL_BLEND);
+
+	sPainter.enableClientStates(true, false, false);
+	for (int b=0;b<batchColors.size();++b)
+	{
+		const QVector<float>& vertices = batchVertices.at(b);
+		if (vertices.isEmpty())
+			continue;
+		const Vec4f& c = batchColors.at(b);
+		sPainter.setColor(c[0], c[1], c[2], c[3]);
+		sPainter.setVertexPointer(2, GL_FLOAT, vertices.constData());
+		sPainter.drawFromArray(StelPainter::Lines, vertices.size()/2, 0, false);
+	}
+	sPainter.enableClientStates(false);
+}
+
+// Draw the bodies smaller than a pixel which have no label nor hint to draw in one pass of point sources.
+// Planet::draw() would only draw their halo, but with a painter, an extinction transform and a flush of the point sources each.
+void SolarSystem::drawUnresolvedBodies(StelCore* core, float maxMagLabel, QList<PlanetP>& resolvedBodies)
+{
+	const StelProjectorP prj = core->getProjection(StelCore::FrameJ2000);
+	const float pixPerRad = prj->getPixelPerRadAtCenter();
+	const float fov = core->getMovementMgr()->getCurrentFov();
+	const QString& observerPlanet = core->getCurrentLocation().planetName;
+
+	QVector<Vec3d> positions;
+	QVector<float> magnitudes;
+	QVector<float> pixRadii;
+	QVector<Vec3f> colors;
+	QList<PlanetP> bodies(systemPlanets);
+	bodies += minorBodyPlanets.values();
+	foreach (const PlanetP& p, bodies)
+	{
+		if (p->hidden || isCulledSatellite(p.data()))
+			continue;
+		if (p->rings || p->getEnglishName()==observerPlanet || p->hintFader.getInterstate()>0.f
+		    || p->labelsFader.getInterstate()>0.f
+		    || p->getAngularSize(core)*M_PI/180.*pixPerRad>1.)
+		{
+			resolvedBodies << p;
+			continue;
+		}
+
+		// Same label condition as in Planet::draw()
+		const float mag = p->getVMagnitude(core);
+		float angDist = 300.f*atan(p->getEclipticPos().length()/p->getEquinoxEquatorialPos(core).length())/fov;
+		if (angDist==0.f)
+			angDist = 1.f;
+		if (mag<-15.f || (p->flagLabels && angDist>0.25 && maxMagLabel>mag))
+		{
+			resolvedBodies << p;
+			continue;
+		}
+		p->labelsFader = false;
+
+		// Same halo as in Planet::draw3dModel()
+		const float surfArcMin2 = p->getSpheroidAngularSize(core)*60;
+		positions << p->getJ2000EquatorialPos(core);
+		magnitudes << mag;
+		pixRadii << std::sqrt(surfArcMin2*surfArcMin2*M_PI/(60.*60.)*M_PI/180.*M_PI/180.*(pixPerRad*pixPerRad))/M_PI;
+		colors << p->color;
+	}
+	const int nb = positions.size();
+	if (nb==0)
+		return;
+
+	StelSkyDrawer* skyDrawer = core->getSkyDrawer();
+	if (skyDrawer->getFlagHasAtmosphere())
+	{
+		QVector<Vec3d> altAz(positions);
+		core->j2000ToAltAz(altAz.data(), nb, StelCore::RefractionOn);
+		for (int i=0;i<nb;++i)
+			altAz[i].normalize();
+		skyDrawer->getExtinction().forward(altAz.constData(), magnitudes.data(), nb);
+	}
+
+	// The halos of the 3D models don't twinkle
+	const bool flagTwinkle = skyDrawer->getFlagTwinkle();
+	skyDrawer->setFlagTwinkle(false);
+	StelPainter sPainter(prj);
+	skyDrawer->preDrawPointSource(&sPainter);
+	float rcMag[2];
+	for (int i=0;i<nb;++i)
+	{
+		if (skyDrawer->computeSky3dModelRCMag(pixRadii.at(i), magnitudes.at(i), rcMag))
+			skyDrawer->drawPointSource(&sPainter, Vec3f(positions.at(i)[0], positions.at(i)[1], positions.at(i)[2]), rcMag, colors.at(i), true);
+	}
+	skyDrawer->postDrawPointSource(&sPainter);
+	skyDrawer->setFlagTwinkle(flagTwinkle);
+}
+
+// Draw the catalogue minor bodies like the stars. The bodies which have a Planet object are drawn by Planet::draw()
+void SolarSystem::drawMinorBodies(StelCore* core)
+{
+	if (minorBodyPositions.isEmpty())
+		return;
+	const Vec3d& obsHelioPos = core->getObserverHeliocentricEclipticPos();
+	minorBodies.computeMagnitudes(minorBodyPositions, obsHelioPos, minorBodyMagnitudes);
+
+	StelSkyDrawer* skyDrawer = core->getSkyDrawer();
+	const Extinction& extinction = skyDrawer->getExtinction();
+	const bool withExtinction = skyDrawer->getFlagHasAtmosphere() && extinction.getExtinctionCoefficient()>=0.01f;
+	const float limitMagnitude = skyDrawer->getLimitMagnitude();
+	const Vec3f color(1.f, 1.f, 1.f);
+	StelPainter sPainter(core->getProjection(StelCore::FrameJ2000));
+	skyDrawer->preDrawPointSource(&sPainter);
+	float rcMag[2];
+	for (int i=0;i<minorBodyPositions.size();++i)
+	{
+		// The extinction can only make a body fainter
+		float mag = minorBodyMagnitudes.at(i);
+		if (mag>limitMagnitude || (!minorBodyPlanets.isEmpty() && minorBodyPlanets.contains(i)))
+			continue;
+		const Vec3d pos = StelCore::matVsop87ToJ2000.multiplyWithoutTranslation(minorBodyPositions.at(i)-obsHelioPos);
+		if (withExtinction)
+		{
+			Vec3d altAz = core->j2000ToAltAz(pos, StelCore::RefractionOn);
+			altAz.normalize();
+			extinction.forward(&altAz, &mag);
+		}
+		if (skyDrawer->computeRCMag(mag, rcMag))
+			skyDrawer->drawPointSource(&sPainter, Vec3f(pos[0], pos[1], pos[2]), rcMag, color, true);
+	}
+	skyDrawer->postDrawPointSource(&sPainter);
+}
+
 void SolarSystem::setStelStyle(const QString& section)
 {
 	// Load colors from config file
@@ -978,7 +1630,11 @@ PlanetP SolarSystem::searchByEnglishName(QString planetEnglishName) const
 	foreach (const PlanetP& p, systemPlanets)
 	{
 		if (p->getEnglishName() == planetEnglishName)
+		{
+			if (isCulledSatellite(p.data()))
+				computeStaleSatellites(p->parent.data());
 			return p;
+		}
 	}
 	return PlanetP();
 }
@@ -988,8 +1644,16 @@ StelObjectP SolarSystem::searchByNameI18n(const QString& planetNameI18) const
 	foreach (const PlanetP& p, systemPlanets)
 	{
 		if (p->getNameI18n() == planetNameI18)
+		{
+			if (isCulledSatellite(p.data()))
+				computeStaleSatellites(p->parent.data());
 			return qSharedPointerCast<StelObject>(p);
+		}
 	}
+	// The names of the catalogue minor bodies are not translated
+	const int index = minorBodyIndex.value(planetNameI18, -1);
+	if (index>=0)
+		return getMinorBody(index);
 	return StelObjectP();
 }
 
@@ -999,8 +1663,15 @@ StelObjectP SolarSystem::searchByName(const QString& name) const
 	foreach (const PlanetP& p, systemPlanets)
 	{
 		if (p->getEnglishName() == name)
+		{
+			if (isCulledSatellite(p.data()))
+				computeStaleSatellites(p->parent.data());
 			return qSharedPointerCast<StelObject>(p);
+		}
 	}
+	const int index = minorBodyIndex.value(name, -1);
+	if (index>=0)
+		return getMinorBody(index);
 	return StelObjectP();
 }
 
@@ -1014,6 +1685,13 @@ StelObjectP SolarSystem::search(Vec3d pos, const StelCore* core) const
 
 	foreach (const PlanetP& p, systemPlanets)
 	{
+		// The satellites of a culled system are only computed and tested if the system is close enough
+		if (isCulledSatellite(p.data()))
+		{
+			if (!satelliteSystemIntersects(p->parent.data(), pos, std::acos(0.999), core))
+				continue;
+			computeStaleSatellites(p->parent.data());
+		}
 		equPos = p->getEquinoxEquatorialPos(core);
 		equPos.normalize();
 		double cos_ang_dist = equPos*pos;
@@ -1045,6 +1723,13 @@ QList<StelObjectP> SolarSystem::searchAround(const Vec3d& vv, double limitFov, c
 
 	foreach (const PlanetP& p, systemPlanets)
 	{
+		// The satellites of a culled system are only computed and tested if the system is inside the circle
+		if (isCulledSatellite(p.data()))
+		{
+			if (!satelliteSystemIntersects(p->parent.data(), v, limitFov*M_PI/180., core))
+				continue;
+			computeStaleSatellites(p->parent.data());
+		}
 		equPos = p->getEquinoxEquatorialPos(core);
 		equPos.normalize();
 		if (equPos*v>=cosLimFov)
@@ -1052,6 +1737,24 @@ QList<StelObjectP> SolarSystem::searchAround(const Vec3d& vv, double limitFov, c
 			result.append(qSharedPointerCast<StelObject>(p));
 		}
 	}
+
+	// Only the catalogue minor bodies bright enough to be drawn can be found
+	if (minorBodyMagnitudes.size()==minorBodyPositions.size())
+	{
+		const Vec3d& obsHelioPos = core->getObserverHeliocentricEclipticPos();
+		const float limitMagnitude = core->getSkyDrawer()->getLimitMagnitude();
+		Vec3d j2000v(vv);
+		j2000v.normalize();
+		for (int i=0;i<minorBodyPositions.size();++i)
+		{
+			if (minorBodyMagnitudes.at(i)>limitMagnitude)
+				continue;
+			Vec3d pos = StelCore::matVsop87ToJ2000.multiplyWithoutTranslation(minorBodyPositions.at(i)-obsHelioPos);
+			pos.normalize();
+			if (pos*j2000v>=cosLimFov)
+				result.append(getMinorBody(i));
+		}
+	}
 	return result;
 }
 
@@ -1061,6 +1764,8 @@ void SolarSystem::updateI18n()
 	StelTranslator& trans = StelApp::getInstance().getLocaleMgr().getAppStelTranslator();
 	foreach (PlanetP p, systemPlanets)
 		p->translateName(trans);
+	foreach (PlanetP p, minorBodyPlanets)
+		p->translateName(trans);
 }
 
 QString SolarSystem::getPlanetHashString(void)
@@ -1173,31 +1878,22 @@ void SolarSystem::update(double deltaTime)
 	{
 		p->update((int)(deltaTime*1000));
 	}
+	foreach (PlanetP p, minorBodyPlanets)
+	{
+		p->update((int)(deltaTime*1000));
+	}
 }
 
 
-// is a lunar eclipse close at hand?
-bool SolarSystem::nearLunarEclipse()
+const EclipseGeometry::ShadowMesh& SolarSystem::getEarthShadowMesh() const
 {
-	// TODO: could replace with simpler test
-
-	Vec3d e = getEarth()->getEclipticPos();
-	Vec3d m = getMoon()->getEclipticPos();  // relative to earth
-	Vec3d mh = getMoon()->getHeliocentricEclipticPos();  // relative to sun
-
-	// shadow location at earth + moon distance along earth vector from sun
-	Vec3d en = e;
-	en.normalize();
-	Vec3d shadow = en * (e.length() + m.length());
-
-	// find shadow radii in AU
-	double r_penumbra = shadow.length()*702378.1/AU/e.length() - 696000/AU;
-
-	// modify shadow location for scaled moon
-	Vec3d mdist = shadow - mh;
-	if(mdist.length() > r_penumbra + 2000/AU) return 0;   // not visible so don't bother drawing
-
-	return 1;
+	const float scale = moon->getSphereScale();
+	if (scale!=earthShadowMeshScale)
+	{
+		EclipseGeometry::computeShadowMesh(earthShadow, scale, earthShadowMesh);
+		earthShadowMeshScale = scale;
+	}
+	return earthShadowMesh;
 }
 
 //! Find and return the list of at most maxNbItem objects auto-completing the passed object I18n name
@@ -1217,12 +1913,46 @@ QStringList SolarSystem::listMatchingObjectsI18n(const QString& objPrefix, int m
 				return result;
 		}
 	}
+	for (int i=0;i<minorBodies.size();++i)
+	{
+		const QString name = minorBodies.getEnglishName(i);
+		if (name.startsWith(objPrefix, Qt::CaseInsensitive))
+		{
+			result << name;
+			if (result.size()==maxNbItem)
+				return result;
+		}
+	}
 	return result;
 }
 
 void SolarSystem::selectedObjectChange(StelModule::StelModuleSelectAction)
 {
-	const QList<StelObjectP> newSelected = GETSTELMODULE(StelObjectMgr)->getSelectedObject("Planet");
+	StelObjectMgr* objectMgr = GETSTELMODULE(StelObjectMgr);
+
+	// A catalogue minor body gets a Planet object only while it is selected: replace the MinorBody objects
+	// of the selection by their Planet objects, this slot is then called again with the new selection
+	if (!objectMgr->getSelectedObject("MinorBody").isEmpty())
+	{
+		QList<StelObjectP> selection = objectMgr->getSelectedObject();
+		for (int i=0;i<selection.size();++i)
+		{
+			const MinorBody* mb = dynamic_cast<const MinorBody*>(selection.at(i).data());
+			if (!mb)
+				continue;
+			// The body may have been removed from the catalogue since the MinorBody was returned
+			const int index = mb->getIndex();
+			if (index<0)
+				selection.removeAt(i--);
+			else
+				selection[i] = qSharedPointerCast<StelObject>(getMinorBodyPlanet(index));
+		}
+		objectMgr->setSelectedObject(selection, StelModule::ReplaceSelection);
+		return;
+	}
+	releaseMinorBodyPlanets(objectMgr->getSelectedObject());
+
+	const QList<StelObjectP> newSelected = objectMgr->getSelectedObject("Planet");
 	if (!newSelected.empty())
 		setSelected(qSharedPointerCast<Planet>(newSelected[0]));
 }
@@ -1292,6 +2022,17 @@ void SolarSystem::reloadPlanets()
 	bool flagLabels = getFlagLabels();
 	bool flagOrbits = getFlagOrbits();
 
+	// The orbits of the catalogue minor bodies are deleted below, release their Planet objects from the selection
+	StelObjectMgr* objectMgr = GETSTELMODULE(StelObjectMgr);
+	foreach (const StelObjectP& obj, objectMgr->getSelectedObject())
+	{
+		if (obj->getType()=="MinorBody" || minorBodyPlanets.values().contains(obj.dynamicCast<Planet>()))
+		{
+			objectMgr->unSelect();
+			break;
+		}
+	}
+
 	//Unload all Solar System objects
 	selected.clear();//Release the selected one
 	foreach (Orbit* orb, orbits)
@@ -1300,6 +2041,9 @@ void SolarSystem::reloadPlanets()
 		orb = NULL;
 	}
 	orbits.clear();
+	minorBodyPlanets.clear();
+	qDeleteAll(minorBodyOrbits);
+	minorBodyOrbits.clear();
 
 	sun.clear();
 	moon.clear();
@@ -1314,11 +2058,13 @@ void SolarSystem::reloadPlanets()
 		p->satellites.clear();
 		p.clear();
 	}
+	positionTasks.clear();
 	systemPlanets.clear();
 	//Memory leak? What's the proper way of cleaning shared pointers?
 
-	//Re-load the ssystem.ini file
+	//Re-load the ssystem.ini file, and the minor bodies catalogue filtered by its names
 	loadPlanets();
+	loadMinorBodies();
 	computePositions(StelUtils::getJDFromSystem());
 	setSelected("");
 	recreateTrails();
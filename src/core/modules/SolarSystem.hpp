@@ -26,9 +26,13 @@
 #endif
 
 #include <QFont>
+#include <QVector>
+#include <QHash>
 #include "StelObjectModule.hpp"
 #include "StelTextureTypes.hpp"
 #include "Planet.hpp"
+#include "MinorBodyCatalog.hpp"
+#include "EclipseGeometry.hpp"
 
 class Orbit;
 class StelTranslator;
@@ -36,12 +40,16 @@ class StelObject;
 class StelCore;
 class StelProjector;
 class QSettings;
+class QThreadPool;
 
 typedef QSharedPointer<Planet> PlanetP;
 
 //! @class SolarSystem
 //! This StelObjectModule derivative is used to model SolarSystem bodies.
 //! This includes the Major Planets, Minor Planets and Comets.
+//! The large sets of minor planets of the catalogue file are kept in a MinorBodyCatalog, evaluated in bulk and
+//! drawn as point sources. The searches return lightweight MinorBody objects for them, and a Planet object is only
+//! created for such a body while it is selected.
 class SolarSystem : public StelObjectModule
 {
 	Q_OBJECT
@@ -145,6 +153,13 @@ public slots:
 	//! calculation is used or not.
 	bool getFlagLightTravelTime(void) const {return flagLightTravelTime;}
 
+	//! Set flag which determines if the positions of the bodies are computed in parallel on a pool of worker threads.
+	//! The results are the same as when the positions are computed in one thread.
+	//! It is off by default: for the few tens of bodies of the default Solar System, no measure has shown a gain yet.
+	void setFlagParallelPositions(bool b) {flagParallelPositions=b;}
+	//! Get the current value of the flag which determines if the positions of the bodies are computed in parallel.
+	bool getFlagParallelPositions(void) const {return flagParallelPositions;}
+
 	//! Set planet names font size.
 	void setFontSize(float newFontSize);
 
@@ -194,7 +209,13 @@ public:
 	PlanetP getMoon() const {return moon;}
 
 	//! Determine if a lunar eclipse is close at hand?
-	bool nearLunarEclipse();
+	bool nearLunarEclipse() const {return earthShadow.nearEclipse;}
+
+	//! Get the shadow of the Earth at the distance of the Moon, computed once per time step by computePositions().
+	const EclipseGeometry::EarthShadow& getEarthShadow() const {return earthShadow;}
+
+	//! Get the disks of the shadow of the Earth drawn over the Moon, computed once per time step and Moon scale.
+	const EclipseGeometry::ShadowMesh& getEarthShadowMesh() const;
 
 	//! Get the list of all the planet english names
 	QStringList getAllPlanetEnglishNames() const;
@@ -215,6 +236,7 @@ public:
 	QString getPlanetHashString();
 
 	//! Compute the position and transform matrix for every element of the solar system.
+	//! The satellites of the systems culled by the last draw() are skipped, unless something else depends on them.
 	//! @param observerPos Position of the observer in heliocentric ecliptic frame (Required for light travel time computation).
 	//! @param date the date in JDay
 	//! \deprecated ??? In the "deprecated" section, but used in SolarSystem::init()
@@ -222,6 +244,7 @@ public:
 
 	//! Get the list of all the bodies of the solar system.
 	//! \deprecated Used in LandscapeMgr::update(), but commented out.
+	//! The satellites of the culled systems keep the positions of an earlier time step.
 	const QList<PlanetP>& getAllPlanets() const {return systemPlanets;}
 
 private slots:
@@ -244,6 +267,40 @@ private:
 	//! observerPos is needed for light travel time computation.
 	void computeTransMatrices(double date, const Vec3d& observerPos = Vec3d(0.));
 
+	//! What is computed for each body by a pass over the position tasks.
+	enum PositionPass
+	{
+		PassPositionWithoutOrbits,	//!< Planet::computePositionWithoutOrbits at the date
+		PassPosition,			//!< Planet::computePosition at the date
+		PassLightTimePosition,		//!< Planet::computePosition at the date corrected for the light travel time
+		PassTransMatrix,		//!< Planet::computeTransMatrix at the date
+		PassLightTimeTransMatrix	//!< Planet::computeTransMatrix at the date corrected for the light travel time
+	};
+
+	//! @struct PositionTask
+	//! Bodies whose positions are computed one after the other, in the order of systemPlanets, by the same thread.
+	//! The bodies of a task either have no shared state, or all use the static caches of the same ephemeris theory.
+	struct PositionTask
+	{
+		QVector<Planet*> bodies;
+		//! The tasks of a level only depend on the bodies of the tasks of the previous levels
+		int level;
+	};
+
+	//! Split systemPlanets into position tasks, and sort them by dependency level.
+	//! A body depends on its parent, because its light travel time uses the parent position.
+	void buildPositionTasks();
+	static bool lowerPositionTaskLevel(const PositionTask& t1, const PositionTask& t2);
+
+	//! Run a pass over all the position tasks on the worker threads.
+	//! @param levelled if true, wait for the tasks of a level before starting the tasks of the next level.
+	void runPositionTasks(PositionPass pass, double date, const Vec3d& observerPos, bool levelled);
+
+	//! Run a pass over the bodies of a position task.
+	static void computeTaskPositions(const PositionTask& task, PositionPass pass, double date, const Vec3d& observerPos);
+	friend class SolarSystemPositionRunnable;
+	friend class MinorBody;
+
 	//! Draw a nice animated pointer around the object.
 	void drawPointer(const StelCore* core);
 
@@ -258,6 +315,55 @@ private:
 
 	void recreateTrails();
 
+	//! Load the minor bodies catalogue file given by astro/minor_bodies_file, if it exists.
+	//! The bodies already defined in the Solar System configuration file are removed from the catalogue.
+	void loadMinorBodies();
+
+	//! Compute the positions of the catalogue minor bodies, and of the Planet objects created for them.
+	void computeMinorBodyPositions(double date, const Vec3d& observerPos);
+
+	//! Draw the catalogue minor bodies as point sources, except the ones drawn as Planet objects.
+	void drawMinorBodies(StelCore* core);
+
+	//! Draw the orbit lines of all the bodies in one pass, with one draw call for each colour and opacity.
+	void drawOrbits(StelCore* core);
+
+	//! Draw the bodies which are smaller than a pixel and have no label nor hint to draw as point sources, in one pass.
+	//! @param resolvedBodies receives the other bodies, which must be drawn with Planet::draw(), from the furthest to the closest.
+	void drawUnresolvedBodies(StelCore* core, float maxMagLabel, QList<PlanetP>& resolvedBodies);
+
+	//! Get the object returned by the searches for a catalogue minor body: its Planet object if it has one,
+	//! else a lightweight MinorBody.
+	StelObjectP getMinorBody(int index) const;
+
+	//! Get the Planet object of a catalogue minor body, creating it if needed.
+	PlanetP getMinorBodyPlanet(int index);
+
+	//! Release the Planet objects of the catalogue minor bodies which are not selected any more.
+	void releaseMinorBodyPlanets(const QList<StelObjectP>& selection);
+
+	//! Return whether the position of a body is skipped because its satellite system is culled.
+	static bool isCulledSatellite(const Planet* p) {return p->parent && p->parent->satellitesCulled;}
+
+	//! Return whether the positions of the satellites of a planet are needed even if they are not drawn:
+	//! for the Moon, for the observer planet and its satellites, and for the selected planet and its satellites.
+	bool isSatelliteSystemNeeded(const Planet* p) const;
+
+	//! Cull the satellite systems whose bounding sphere is outside of the viewport or smaller than a pixel,
+	//! so that their satellites are neither drawn nor computed at the next time steps.
+	//! The positions of the satellites of the systems which are not culled any more are computed.
+	void cullSatelliteSystems(StelCore* core);
+
+	//! Compute the positions of the satellites of a planet if they were skipped at the last time step.
+	void computeStaleSatellites(Planet* p) const;
+
+	//! Grow the bounding sphere of the satellite system of a planet to enclose the current positions.
+	static void updateSatellitesRadius(Planet* p);
+
+	//! Return whether the bounding sphere of the satellite system of a planet intersects the circle of
+	//! angular radius limitFov in radian around the normalized equinox equatorial direction v.
+	static bool satelliteSystemIntersects(const Planet* p, const Vec3d& v, double limitFov, const StelCore* core);
+
 	PlanetP sun;
 	PlanetP moon;
 	PlanetP earth;
@@ -284,9 +390,40 @@ private:
 	//! List of all the bodies of the solar system.
 	QList<PlanetP> systemPlanets;
 
+	//! The date and observer position of the last computePositions(), to compute the skipped satellites later
+	double positionsDate;
+	Vec3d positionsObserverPos;
+
 	// Master settings
 	bool flagOrbits;
 	bool flagLightTravelTime;
+	bool flagParallelPositions;
+
+	//! The position tasks sorted by level, empty if the positions can't be computed in parallel
+	QVector<PositionTask> positionTasks;
+	//! The worker threads computing the position tasks
+	QThreadPool* positionThreadPool;
+
+	//! The minor bodies of the catalogue file
+	MinorBodyCatalog minorBodies;
+	//! The heliocentric positions of the catalogue minor bodies computed by the last computePositions()
+	QVector<Vec3d> minorBodyPositions;
+	//! The magnitudes without extinction of the catalogue minor bodies computed by the last draw()
+	QVector<float> minorBodyMagnitudes;
+	//! Index of the catalogue minor bodies by english name
+	QHash<QString, int> minorBodyIndex;
+	//! Incremented each time the catalogue is loaded, so that the MinorBody objects know when their index is stale
+	int minorBodiesGeneration;
+	//! The Planet objects of the selected catalogue minor bodies, by index in the catalogue
+	QHash<int, PlanetP> minorBodyPlanets;
+	//! The orbits created for the Planet objects of the catalogue minor bodies, kept until the catalogue is reloaded
+	QHash<int, Orbit*> minorBodyOrbits;
+
+	//! The shadow of the Earth computed by the last computePositions()
+	EclipseGeometry::EarthShadow earthShadow;
+	//! The shadow disks drawn over the Moon, and the Moon scale they were computed for, or 0 if they must be computed again
+	mutable EclipseGeometry::ShadowMesh earthShadowMesh;
+	mutable float earthShadowMeshScale;
 
 	//! The selection pointer texture.
 	StelTextureSP texPointer;
@@ -191,11 +191,8 @@ void StarMgr::copyDefaultConfigFile()
 	}
 }
 
-void StarMgr::init()
+bool StarMgr::preload()
 {
-	QSettings* conf = StelApp::getInstance().getSettings();
-	Q_ASSERT(conf);
-
 	try
 	{
 		starConfigFileFullPath = StelFileMgr::findFile("stars/default/starsConfig.json", StelFileMgr::Flags(StelFileMgr::Writable|StelFileMgr::File));
@@ -224,6 +221,21 @@ void StarMgr::init()
 	}
 
 	loadData(starSettings);
+	return !zoneArrays.isEmpty();
+}
+
+void StarMgr::init()
+{
+	QSettings* conf = StelApp::getInstance().getSettings();
+	Q_ASSERT(conf);
+
+	// The data is normally loaded by a preload started in a worker thread, it must not be loaded twice
+	StelModuleMgr::PreloadStatus preloadStatus = StelApp::getInstance().getModuleMgr().waitForPreload(this);
+	if (preloadStatus==StelModuleMgr::PreloadNotStarted)
+		preloadStatus = preload() ? StelModuleMgr::PreloadSucceeded : StelModuleMgr::PreloadFailed;
+	if (preloadStatus==StelModuleMgr::PreloadFailed)
+		qWarning() << "ERROR: no star catalogue could be loaded, the stars will not be displayed";
+
 	starFont.setPixelSize(StelApp::getInstance().getSettings()->value("gui/base_font_size", 13).toInt());
 
 	setFlagStars(conf->value("astro/flag_stars", true).toBool());
@@ -233,7 +245,8 @@ void StarMgr::init()
 	objectMgr->registerStelObjectMgr(this);
 	texPointer = StelApp::getInstance().getTextureManager().createTexture("textures/pointeur2.png");   // Load pointer texture
 
-	StelApp::getInstance().getCore()->getGeodesicGrid(maxGeodesicGridLevel)->visitTriangles(maxGeodesicGridLevel,initTriangleFunc,this);
+	if (maxGeodesicGridLevel>=0)
+		StelApp::getInstance().getCore()->getGeodesicGrid(maxGeodesicGridLevel)->visitTriangles(maxGeodesicGridLevel,initTriangleFunc,this);
 	for (ZoneArrayMap::const_iterator it(zoneArrays.begin()); it!=zoneArrays.end();it++)
 	{
 		it.value()->scaleAxis();
@@ -677,7 +690,8 @@ void StarMgr::draw(StelCore* core)
 		if (labelsFader.getInterstate()>0.f)
 		{
 			// Adapt magnitude limit of the stars labels according to FOV and labelsAmount
-			float maxMag = (skyDrawer->getLimitMagnitude()-6.5)*0.7+(labelsAmount*1.2f)-2.f;
+			// Show fewer labels when the rendering quality is lowered
+			float maxMag = (skyDrawer->getLimitMagnitude()-6.5)*0.7+(labelsAmount*1.2f)-2.f-(1.f-core->getRenderingQuality())*2.f;
 			int x = (int)((maxMag-mag_min)/k);
 			if (x > 0)
 				maxMagStarName = x;
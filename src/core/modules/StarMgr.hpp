@@ -71,8 +71,13 @@ public:
 
 	///////////////////////////////////////////////////////////////////////////
 	// Methods defined in the StelModule class
+	//! Load the star catalogues and the HIP spectral types and components data into memory.
+	//! This is called from a worker thread before init().
+	//! @return false if no star catalogue could be loaded.
+	virtual bool preload();
+
 	//! Initialize the StarMgr.
-	//! - Loads the star catalogue data into memory
+	//! - Loads the star catalogue data into memory if no preload() was started
 	//! - Sets up the star color table
 	//! - Loads the star texture
 	//! - Loads the star font (for labels on named stars)
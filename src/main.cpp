@@ -24,6 +24,7 @@
 #include "StelFileMgr.hpp"
 #include "CLIProcessor.hpp"
 #include "StelIniParser.hpp"
+#include "StelBenchmark.hpp"
 
 #include <QDebug>
 #include <QApplication>
@@ -337,10 +338,22 @@ int main(int argc, char **argv)
 		QMessageBox::warning(0, "Stellarium", q_("This system does not support OpenGL."));
 	}
 
-	StelMainWindow mainWin;
-	mainWin.init(confSettings);
-	app.exec();
-	mainWin.deinit();
+	int exitCode = 0;
+	if (qApp->property("onetime_benchmark").isValid())
+	{
+		// Headless run: no window is created, the frame times are printed on the standard output
+		StelBenchmark benchmark(confSettings, qApp->property("onetime_benchmark").toString(),
+			qApp->property("onetime_benchmark_frames").toInt(), qApp->property("onetime_benchmark_size").toSize(),
+			qApp->property("onetime_benchmark_computations").toBool());
+		exitCode = benchmark.run();
+	}
+	else
+	{
+		StelMainWindow mainWin;
+		mainWin.init(confSettings);
+		app.exec();
+		mainWin.deinit();
+	}
 
 	delete confSettings;
 	StelLogger::deinit();
@@ -350,6 +363,6 @@ int main(int argc, char **argv)
 		timeEndPeriod(timerGrain);
 	#endif //Q_OS_WIN
 
-	return 0;
+	return exitCode;
 }
 
@@ -0,0 +1,104 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "StelTestApp.hpp"
+#include "StelApp.hpp"
+#include "StelCore.hpp"
+#include "StelFileMgr.hpp"
+#include "StelIniParser.hpp"
+#include "StelPainter.hpp"
+#include "StelTranslator.hpp"
+
+#include <clocale>
+#include <stdexcept>
+#include <QSettings>
+#include <QFile>
+#include <QDebug>
+#include <QPainter>
+#include <QGLPixelBuffer>
+#include <QGLFramebufferObject>
+#include <QtOpenGL>
+
+// Size of the off-screen buffer in pixel
+static const int BUFFER_WIDTH = 640;
+static const int BUFFER_HEIGHT = 480;
+
+StelTestApp::StelTestApp() : conf(NULL), pixelBuffer(NULL), fbo(NULL), qPainter(NULL), app(NULL)
+{
+}
+
+StelTestApp::~StelTestApp()
+{
+	if (app)
+	{
+		StelPainter::setQPainter(NULL);
+		delete app;
+		StelApp::deinitStatic();
+	}
+	delete qPainter;
+	delete fbo;
+	delete pixelBuffer;
+	delete conf;
+}
+
+bool StelTestApp::init()
+{
+	Q_ASSERT(!app);
+	// The configuration and data files must always be parsed in the C locale
+	setlocale(LC_NUMERIC, "C");
+	StelFileMgr::init();
+	QString defaultConfigFilePath;
+	try
+	{
+		defaultConfigFilePath = StelFileMgr::findFile("data/default_config.ini");
+		StelTranslator::init(StelFileMgr::findFile("data/iso639-1.utf8"));
+	}
+	catch (std::runtime_error& e)
+	{
+		qWarning() << "WARNING: can't find the installation data:" << e.what();
+		return false;
+	}
+	if (!configFile.open())
+		return false;
+	QFile defaultConfigFile(defaultConfigFilePath);
+	if (!defaultConfigFile.open(QIODevice::ReadOnly))
+		return false;
+	configFile.write(defaultConfigFile.readAll());
+	configFile.flush();
+	conf = new QSettings(configFile.fileName(), StelIniFormat);
+
+	if (!QGLPixelBuffer::hasOpenGLPbuffers())
+		return false;
+	pixelBuffer = new QGLPixelBuffer(QSize(BUFFER_WIDTH, BUFFER_HEIGHT), QGLFormat(QGL::StencilBuffer | QGL::DepthBuffer));
+	if (!pixelBuffer->isValid() || !pixelBuffer->makeCurrent())
+		return false;
+	if (QGLFramebufferObject::hasOpenGLFramebufferObjects())
+		fbo = new QGLFramebufferObject(QSize(BUFFER_WIDTH, BUFFER_HEIGHT), QGLFramebufferObject::CombinedDepthStencil);
+
+	StelPainter::initSystemGLInfo(const_cast<QGLContext*>(QGLContext::currentContext()));
+	qPainter = fbo ? new QPainter(fbo) : new QPainter(pixelBuffer);
+	StelPainter::setQPainter(qPainter);
+
+	StelApp::initStatic();
+	app = new StelApp();
+	app->glWindowHasBeenResized(0, 0, BUFFER_WIDTH, BUFFER_HEIGHT);
+	app->init(conf);
+	app->getCore()->setZeroTimeSpeed();
+	return true;
+}
@@ -0,0 +1,54 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#ifndef _STELTESTAPP_HPP_
+#define _STELTESTAPP_HPP_
+
+#include <QTemporaryFile>
+
+class QSettings;
+class QPainter;
+class QGLPixelBuffer;
+class QGLFramebufferObject;
+class StelApp;
+
+//! @class StelTestApp
+//! Initialize a complete StelApp in an off-screen GL buffer for the tests which need the modules or the settings.
+//! The default configuration of the installation is used, from a temporary copy so that it is never modified.
+class StelTestApp
+{
+public:
+	StelTestApp();
+	~StelTestApp();
+
+	//! Create the off-screen GL context and initialize the StelApp.
+	//! @return false if no off-screen GL context could be created or if the installation data were not found,
+	//! in which case the tests using the StelApp should be skipped.
+	bool init();
+
+private:
+	QTemporaryFile configFile;
+	QSettings* conf;
+	QGLPixelBuffer* pixelBuffer;
+	QGLFramebufferObject* fbo;
+	QPainter* qPainter;
+	StelApp* app;
+};
+
+#endif // _STELTESTAPP_HPP_
@@ -0,0 +1,89 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "testDates.hpp"
+#include "StelUtils.hpp"
+
+#include <cmath>
+#include <QStringList>
+#include <QVector>
+
+QTEST_MAIN(TestDates)
+
+// Number of random Julian days
+static const int NB_DATES = 100000;
+// Range of the random Julian days: years -4000 to 4000
+static const double MIN_DATE_JD = 260424.5;
+static const double MAX_DATE_JD = 3182030.5;
+
+// Return random Julian days, followed by a sorted table with one row per hour like the ones of the ephemeris exports
+static QVector<double> testJulianDays()
+{
+	qsrand(1);
+	QVector<double> jds(2*NB_DATES);
+	const double tableStart = MIN_DATE_JD+(MAX_DATE_JD-MIN_DATE_JD)*qrand()/RAND_MAX;
+	for (int i=0;i<NB_DATES;++i)
+	{
+		jds[i] = std::floor(MIN_DATE_JD+(MAX_DATE_JD-MIN_DATE_JD)*qrand()/RAND_MAX)+(double)qrand()/RAND_MAX;
+		jds[NB_DATES+i] = tableStart+i/24.;
+	}
+	return jds;
+}
+
+// Check that a Julian day converted to a date and back matches the original, which is truncated to the second
+static bool isRoundTripJD(double roundTripJD, double jd)
+{
+	return roundTripJD<=jd+1e-6 && roundTripJD>=jd-1./86400.-1e-6;
+}
+
+void TestDates::testBatchConversions()
+{
+	const QVector<double> jds = testJulianDays();
+	const int nb = jds.size();
+	QVector<int> years(nb), months(nb), days(nb);
+	QVector<int> hours(nb), minutes(nb), seconds(nb);
+	StelUtils::getDatesFromJulianDays(jds.constData(), nb, years.data(), months.data(), days.data());
+	StelUtils::getTimesFromJulianDays(jds.constData(), nb, hours.data(), minutes.data(), seconds.data());
+	for (int i=0;i<nb;++i)
+	{
+		int y, m, d, h, min, sec;
+		StelUtils::getDateFromJulianDay(jds.at(i), &y, &m, &d);
+		StelUtils::getTimeFromJulianDay(jds.at(i), &h, &min, &sec);
+		const QString jdString = QString::number(jds.at(i), 'f', 6);
+		QVERIFY2(y==years.at(i) && m==months.at(i) && d==days.at(i) && h==hours.at(i) && min==minutes.at(i) && sec==seconds.at(i),
+			 qPrintable("batch date conversion mismatch for JD "+jdString));
+		double roundTripJD = 0.;
+		StelUtils::getJDFromDate(&roundTripJD, y, m, d, h, min, sec);
+		QVERIFY2(isRoundTripJD(roundTripJD, jds.at(i)), qPrintable("date round trip mismatch for JD "+jdString));
+	}
+}
+
+void TestDates::testISO8601Conversions()
+{
+	const QVector<double> jds = testJulianDays();
+	const QStringList batchStrings = StelUtils::julianDaysToISO8601Strings(jds.constData(), jds.size());
+	QCOMPARE(batchStrings.size(), jds.size());
+	for (int i=0;i<jds.size();++i)
+	{
+		QCOMPARE(batchStrings.at(i), StelUtils::julianDayToISO8601String(jds.at(i)));
+		bool ok = false;
+		const double parsedJD = StelUtils::getJulianDayFromISO8601String(batchStrings.at(i), &ok);
+		QVERIFY2(ok && isRoundTripJD(parsedJD, jds.at(i)), qPrintable("ISO8601 round trip mismatch for "+batchStrings.at(i)));
+	}
+}
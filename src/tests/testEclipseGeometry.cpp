@@ -0,0 +1,58 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "testEclipseGeometry.hpp"
+#include "EclipseGeometry.hpp"
+
+#include <cmath>
+
+QTEST_MAIN(TestEclipseGeometry)
+
+// The 21st century
+static const double CENTURY_START_JD = 2451910.5;
+static const double CENTURY_END_JD = 2488435.5;
+// Greatest eclipse of the total lunar eclipse of 2011 June 15 (NASA Five Millennium Canon), and tolerance in days
+static const double TOTAL_ECLIPSE_2011_JD = 2455728.3421;
+static const double MAX_ECLIPSE_DATE_ERROR = 0.005;
+
+void TestEclipseGeometry::testContactsOrder()
+{
+	// The contacts must be in order around the maximum
+	const QVector<EclipseGeometry::LunarEclipse> eclipses = EclipseGeometry::findLunarEclipses(CENTURY_START_JD, CENTURY_END_JD);
+	QVERIFY(!eclipses.isEmpty());
+	foreach (const EclipseGeometry::LunarEclipse& e, eclipses)
+	{
+		const QString date = QString::number(e.maximumJD, 'f', 4);
+		QVERIFY2(e.penumbralStartJD<e.maximumJD && e.maximumJD<e.penumbralEndJD, qPrintable("penumbral contacts of "+date));
+		if (e.umbralMagnitude>0.)
+			QVERIFY2(e.penumbralStartJD<e.partialStartJD && e.partialStartJD<e.maximumJD
+				 && e.maximumJD<e.partialEndJD && e.partialEndJD<e.penumbralEndJD, qPrintable("partial contacts of "+date));
+		if (e.umbralMagnitude>=1.)
+			QVERIFY2(e.partialStartJD<e.totalStartJD && e.totalStartJD<e.maximumJD
+				 && e.maximumJD<e.totalEndJD && e.totalEndJD<e.partialEndJD, qPrintable("total contacts of "+date));
+	}
+}
+
+void TestEclipseGeometry::testTotalEclipse2011()
+{
+	const QVector<EclipseGeometry::LunarEclipse> eclipses = EclipseGeometry::findLunarEclipses(TOTAL_ECLIPSE_2011_JD-10., TOTAL_ECLIPSE_2011_JD+10.);
+	QCOMPARE(eclipses.size(), 1);
+	QVERIFY(std::fabs(eclipses.first().maximumJD-TOTAL_ECLIPSE_2011_JD)<MAX_ECLIPSE_DATE_ERROR);
+	QVERIFY(eclipses.first().umbralMagnitude>=1.);
+}
@@ -0,0 +1,106 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "testMinorBodyCatalog.hpp"
+#include "MinorBodyCatalog.hpp"
+#include "Orbit.hpp"
+#include "StelUtils.hpp"
+
+#include <cmath>
+#include <QFile>
+#include <QTextStream>
+#include <QVector>
+
+QTEST_MAIN(TestMinorBodyCatalog)
+
+// Number of synthetic minor planets
+static const int NB_MINOR_BODIES = 10000;
+// Number of dates at which the bulk positions are compared
+static const int NB_MINOR_BODY_DATES = 20;
+// Maximum allowed relative difference between the bulk positions and the orbit positions
+static const double MAX_POSITION_ERROR = 1e-10;
+
+void TestMinorBodyCatalog::initTestCase()
+{
+	// Main belt asteroids with the epoch 2013 April 18
+	qsrand(1);
+	QVERIFY(sourceFile.open());
+	QTextStream out(&sourceFile);
+	out << "MINOR PLANET CENTER ORBIT DATABASE (MPCORB)\n\n";
+	out << QString("-").repeated(160) << "\n";
+	for (int i=0;i<NB_MINOR_BODIES;++i)
+	{
+		const double a = 2.+1.5*qrand()/RAND_MAX;
+		const QString record = QString().sprintf("%-7d %5.2f %5.2f K134I %9.5f  %9.5f  %9.5f  %9.5f  %9.7f %11.8f %11.7f",
+			i+1, 10.+10.*qrand()/RAND_MAX, 0.15, 360.*qrand()/RAND_MAX, 360.*qrand()/RAND_MAX, 360.*qrand()/RAND_MAX,
+			30.*qrand()/RAND_MAX, 0.3*qrand()/RAND_MAX, 0.9856076686/(a*std::sqrt(a)), a);
+		out << record.leftJustified(166, ' ') << QString("(%1) Test%1").arg(i+1) << "\n";
+	}
+	out.flush();
+	sourceFile.close();
+}
+
+void TestMinorBodyCatalog::testCacheRoundTrip()
+{
+	MinorBodyCatalog catalog;
+	QVERIFY(catalog.compile(sourceFile.fileName()));
+	QCOMPARE(catalog.size(), NB_MINOR_BODIES);
+
+	const QString cacheFile = sourceFile.fileName()+".cache";
+	QVERIFY(catalog.save(cacheFile));
+	MinorBodyCatalog loadedCatalog;
+	const bool loaded = loadedCatalog.load(cacheFile, QStringList() << sourceFile.fileName());
+	QFile::remove(cacheFile);
+	QVERIFY(loaded);
+	QCOMPARE(loadedCatalog.size(), NB_MINOR_BODIES);
+
+	QVector<Vec3d> positions;
+	QVector<Vec3d> loadedPositions;
+	catalog.computePositions(2456400.5, positions);
+	loadedCatalog.computePositions(2456400.5, loadedPositions);
+	QVERIFY(positions==loadedPositions);
+}
+
+void TestMinorBodyCatalog::testBulkPositions()
+{
+	// The bulk positions corrected for the light travel time must match the ones of the orbit objects
+	MinorBodyCatalog catalog;
+	QVERIFY(catalog.compile(sourceFile.fileName()));
+	QVector<EllipticalOrbit*> orbits(catalog.size());
+	for (int i=0;i<catalog.size();++i)
+		orbits[i] = catalog.createOrbit(i);
+	const Vec3d observerPos(-0.9, 0.4, 0.);
+	QVector<Vec3d> positions;
+	Vec3d orbitPos;
+	double maxDifference = 0.;
+	for (int d=0;d<NB_MINOR_BODY_DATES;++d)
+	{
+		const double jd = 2456400.5+100.*d;
+		catalog.computePositions(jd, positions, &observerPos);
+		for (int i=0;i<catalog.size();++i)
+		{
+			orbits.at(i)->positionAtTimevInVSOP87Coordinates(jd, orbitPos);
+			const double lightTime = (orbitPos-observerPos).length()*(AU/(SPEED_OF_LIGHT*86400));
+			orbits.at(i)->positionAtTimevInVSOP87Coordinates(jd-lightTime, orbitPos);
+			maxDifference = qMax(maxDifference, (positions.at(i)-orbitPos).length()/orbitPos.length());
+		}
+	}
+	qDeleteAll(orbits);
+	QVERIFY2(maxDifference<=MAX_POSITION_ERROR, qPrintable(QString("the bulk positions differ from the orbit positions by %1").arg(maxDifference)));
+}
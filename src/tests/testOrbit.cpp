@@ -0,0 +1,208 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "testOrbit.hpp"
+#include "Orbit.hpp"
+
+#include <cmath>
+#include <QVector>
+
+QTEST_MAIN(TestOrbit)
+
+// Number of random orbits or equations of each test
+static const int NB_KEPLER_ORBITS = 100000;
+// Number of dates at which the batch positions are compared
+static const int NB_KEPLER_DATES = 20;
+// Maximum allowed error of the Kepler solvers compared to the high precision reference, in radian or relative
+static const double MAX_KEPLER_ERROR = 1e-10;
+
+// Solve the elliptic Kepler equation by bisection in long double, as a reference for the solvers
+static long double referenceKeplerElliptic(long double e, long double M)
+{
+	long double lower = M-e;
+	long double upper = M+e;
+	for (int i=0;i<200;++i)
+	{
+		const long double mid = (lower+upper)/2;
+		if (mid-e*std::sin(mid)<M)
+			lower = mid;
+		else
+			upper = mid;
+	}
+	return (lower+upper)/2;
+}
+
+// Solve the hyperbolic Kepler equation by bisection in long double
+static long double referenceKeplerHyperbolic(long double e, long double M)
+{
+	// |H| <= asinh(|M|/(e-1)) <= log(2|M|/(e-1)+1)
+	const long double bound = std::log(2*std::fabs(M)/(e-1)+1)+1;
+	long double lower = -bound;
+	long double upper = bound;
+	for (int i=0;i<200;++i)
+	{
+		const long double mid = (lower+upper)/2;
+		if (e*std::sinh(mid)-mid<M)
+			lower = mid;
+		else
+			upper = mid;
+	}
+	return (lower+upper)/2;
+}
+
+// Compute the position in the orbit plane of a comet at dt days from the pericenter, in long double
+static Vec3d referenceCometPosition(long double q, long double e, long double n, long double dt)
+{
+	const long double M = n*dt;
+	if (e<1)
+	{
+		const long double E = referenceKeplerElliptic(e, M);
+		return Vec3d(q/(1-e)*(std::cos(E)-e), q*std::sqrt((1+e)/(1-e))*std::sin(E), 0.);
+	}
+	if (e>1)
+	{
+		const long double H = referenceKeplerHyperbolic(e, M);
+		return Vec3d(q/(e-1)*(e-std::cosh(H)), q*std::sqrt((e+1)/(e-1))*std::sinh(H), 0.);
+	}
+	// Barker's equation D + D^3/3 = 2M/3 by bisection
+	long double lower = -1e6;
+	long double upper = 1e6;
+	for (int i=0;i<200;++i)
+	{
+		const long double mid = (lower+upper)/2;
+		if (mid+mid*mid*mid/3<2*M/3)
+			lower = mid;
+		else
+			upper = mid;
+	}
+	const long double D = (lower+upper)/2;
+	return Vec3d(q*(1-D*D), 2*q*D, 0.);
+}
+
+// Create a comet orbit with random elements, in the orbit plane if planar is true
+static CometOrbit* randomCometOrbit(double minEccentricity, double maxEccentricity, bool planar, double& q, double& e, double& n)
+{
+	q = 0.1+5.*qrand()/RAND_MAX;
+	e = minEccentricity+(maxEccentricity-minEccentricity)*qrand()/RAND_MAX;
+	const double k = 0.01720209895;
+	n = (e==1.) ? k*(1.5/q)*std::sqrt(0.5/q) : k/std::pow(q/std::fabs(1.-e), 1.5);
+	const double i = planar ? 0. : M_PI*qrand()/RAND_MAX;
+	const double node = planar ? 0. : 2.*M_PI*qrand()/RAND_MAX;
+	const double perihelion = planar ? 0. : 2.*M_PI*qrand()/RAND_MAX;
+	return new CometOrbit(q, e, i, node, perihelion, 2455927.5, n, 0., 0., 0.);
+}
+
+void TestOrbit::testKeplerElliptic()
+{
+	qsrand(1);
+	QVector<double> eccentricities(NB_KEPLER_ORBITS);
+	QVector<double> meanAnomalies(NB_KEPLER_ORBITS);
+	QVector<double> anomalies(NB_KEPLER_ORBITS);
+	for (int i=0;i<NB_KEPLER_ORBITS;++i)
+	{
+		eccentricities[i] = 0.999*qrand()/RAND_MAX;
+		meanAnomalies[i] = -50.+100.*qrand()/RAND_MAX;
+	}
+	solveKeplerElliptic(eccentricities.constData(), meanAnomalies.constData(), anomalies.data(), NB_KEPLER_ORBITS);
+	for (int i=0;i<NB_KEPLER_ORBITS;++i)
+	{
+		const double reference = referenceKeplerElliptic(eccentricities.at(i), meanAnomalies.at(i));
+		QVERIFY(std::fabs(anomalies.at(i)-reference)<=MAX_KEPLER_ERROR);
+		QVERIFY(std::fabs(solveKeplerElliptic(eccentricities.at(i), meanAnomalies.at(i))-reference)<=MAX_KEPLER_ERROR);
+	}
+}
+
+void TestOrbit::testKeplerHyperbolic()
+{
+	qsrand(1);
+	QVector<double> eccentricities(NB_KEPLER_ORBITS);
+	QVector<double> meanAnomalies(NB_KEPLER_ORBITS);
+	QVector<double> anomalies(NB_KEPLER_ORBITS);
+	for (int i=0;i<NB_KEPLER_ORBITS;++i)
+	{
+		eccentricities[i] = 1.001+5.*qrand()/RAND_MAX;
+		meanAnomalies[i] = -1000.+2000.*qrand()/RAND_MAX;
+	}
+	solveKeplerHyperbolic(eccentricities.constData(), meanAnomalies.constData(), anomalies.data(), NB_KEPLER_ORBITS);
+	for (int i=0;i<NB_KEPLER_ORBITS;++i)
+	{
+		const double reference = referenceKeplerHyperbolic(eccentricities.at(i), meanAnomalies.at(i));
+		QVERIFY(std::fabs(anomalies.at(i)-reference)/qMax(1., std::fabs(reference))<=MAX_KEPLER_ERROR);
+	}
+}
+
+void TestOrbit::testNearParabolicComets()
+{
+	// Near parabolic and parabolic comets, in their orbit plane so that the positions can be compared directly
+	qsrand(1);
+	const double kind[3][2] = {{0.99, 1.}, {1., 1.}, {1., 1.01}};
+	for (int c=0;c<3*NB_KEPLER_ORBITS/10;++c)
+	{
+		double q, e, n;
+		CometOrbit* orb = randomCometOrbit(kind[c%3][0], kind[c%3][1], true, q, e, n);
+		const double dt = -20000.+40000.*qrand()/RAND_MAX;
+		Vec3d pos;
+		orb->positionAtTimevInVSOP87Coordinates(2455927.5+dt, pos);
+		delete orb;
+		const Vec3d reference = referenceCometPosition(q, e, n, dt);
+		QVERIFY2((pos-reference).length()/reference.length()<=MAX_KEPLER_ERROR, qPrintable(QString("comet q=%1 e=%2 dt=%3").arg(q).arg(e).arg(dt)));
+	}
+}
+
+void TestOrbit::testBatchPositions()
+{
+	// The batch positions of minor planet like orbits and of comet orbits must match the ones computed one by one
+	qsrand(1);
+	QVector<EllipticalOrbit*> ellipticalOrbits(NB_KEPLER_ORBITS);
+	QVector<CometOrbit*> cometOrbits(NB_KEPLER_ORBITS);
+	for (int i=0;i<NB_KEPLER_ORBITS;++i)
+	{
+		const double e = 0.4*qrand()/RAND_MAX;
+		const double a = 1.5+3.5*qrand()/RAND_MAX;
+		const double period = 365.25*a*std::sqrt(a);
+		ellipticalOrbits[i] = new EllipticalOrbit(a*(1.-e), e, 0.5*qrand()/RAND_MAX, 2.*M_PI*qrand()/RAND_MAX, 2.*M_PI*qrand()/RAND_MAX,
+							 2.*M_PI*qrand()/RAND_MAX, period, 2455927.5, 0., 0., 0.);
+		double cometQ, cometE, cometN;
+		cometOrbits[i] = randomCometOrbit(0.5, 1.2, false, cometQ, cometE, cometN);
+	}
+	QVector<Vec3d> positions(NB_KEPLER_ORBITS);
+	QVector<Vec3d> batchPositions(NB_KEPLER_ORBITS);
+	double maxEllipticalDifference = 0.;
+	double maxCometDifference = 0.;
+	for (int d=0;d<NB_KEPLER_DATES;++d)
+	{
+		const double jd = 2455927.5+1000.*d;
+		EllipticalOrbit::positionsAtTimeInVSOP87Coordinates(ellipticalOrbits.constData(), NB_KEPLER_ORBITS, jd, batchPositions.data());
+		for (int i=0;i<NB_KEPLER_ORBITS;++i)
+		{
+			ellipticalOrbits.at(i)->positionAtTimevInVSOP87Coordinates(jd, positions[i]);
+			maxEllipticalDifference = qMax(maxEllipticalDifference, (positions.at(i)-batchPositions.at(i)).length()/positions.at(i).length());
+		}
+		CometOrbit::positionsAtTimeInVSOP87Coordinates(cometOrbits.constData(), NB_KEPLER_ORBITS, jd, batchPositions.data());
+		for (int i=0;i<NB_KEPLER_ORBITS;++i)
+		{
+			cometOrbits.at(i)->positionAtTimevInVSOP87Coordinates(jd, positions[i]);
+			maxCometDifference = qMax(maxCometDifference, (positions.at(i)-batchPositions.at(i)).length()/positions.at(i).length());
+		}
+	}
+	qDeleteAll(ellipticalOrbits);
+	qDeleteAll(cometOrbits);
+	QVERIFY2(maxEllipticalDifference<=MAX_KEPLER_ERROR, qPrintable(QString("elliptical orbits differ by %1").arg(maxEllipticalDifference)));
+	QVERIFY2(maxCometDifference<=MAX_KEPLER_ERROR, qPrintable(QString("comet orbits differ by %1").arg(maxCometDifference)));
+}
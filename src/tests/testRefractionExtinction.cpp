@@ -0,0 +1,84 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "testRefractionExtinction.hpp"
+#include "RefractionExtinction.hpp"
+#include "StelUtils.hpp"
+
+#include <cmath>
+#include <QVector>
+
+QTEST_MAIN(TestRefractionExtinction)
+
+// Number of altitudes between -10 and 90 degrees
+static const int NB_REFRACTION_ALTITUDES = 100000;
+// Maximum allowed deviation of the tabulated refraction from the formulas in arcsec
+static const double MAX_REFRACTION_ERROR_ARCSEC = 0.1;
+
+// Return the altitude in degree of an alt-azimuthal vector
+static double vectorAltitude(const Vec3d& v)
+{
+	return 180./M_PI*std::asin(qBound(-1., v[2]/v.length(), 1.));
+}
+
+void TestRefractionExtinction::initTestCase()
+{
+	if (!app.init())
+		QSKIP("Can't initialize Stellarium in an off-screen GL buffer", SkipAll);
+}
+
+void TestRefractionExtinction::testRefractionTable_data()
+{
+	QTest::addColumn<float>("pressure");
+	QTest::addColumn<float>("temperature");
+	QTest::newRow("standard") << 1013.f << 15.f;
+	QTest::newRow("cold") << 1013.f << -30.f;
+	QTest::newRow("hot") << 1040.f << 40.f;
+	QTest::newRow("mountain") << 700.f << 0.f;
+}
+
+void TestRefractionExtinction::testRefractionTable()
+{
+	QFETCH(float, pressure);
+	QFETCH(float, temperature);
+	Refraction refraction;
+	refraction.setPressure(pressure);
+	refraction.setTemperature(temperature);
+
+	// The tabulated refraction must not deviate from the formulas. The altitudes are compared rather than their
+	// sines, whose differences shrink by cos(alt) and would hide the errors near the zenith.
+	double maxForwardError = 0.;
+	double maxBackwardError = 0.;
+	for (int i=0;i<NB_REFRACTION_ALTITUDES;++i)
+	{
+		const double alt = -10.+100.*i/(NB_REFRACTION_ALTITUDES-1);
+		Vec3d altAzPos;
+		StelUtils::spheToRect(0.3*i, alt*M_PI/180., altAzPos);
+		Vec3d v = altAzPos;
+		refraction.forward(v);
+		maxForwardError = qMax(maxForwardError, std::fabs(vectorAltitude(v)-refraction.forwardAltitude(alt)));
+		v = altAzPos;
+		refraction.backward(v);
+		maxBackwardError = qMax(maxBackwardError, std::fabs(vectorAltitude(v)-refraction.backwardAltitude(alt)));
+	}
+	maxForwardError *= 3600.;
+	maxBackwardError *= 3600.;
+	QVERIFY2(maxForwardError<=MAX_REFRACTION_ERROR_ARCSEC, qPrintable(QString("forward error of %1 arcsec").arg(maxForwardError)));
+	QVERIFY2(maxBackwardError<=MAX_REFRACTION_ERROR_ARCSEC, qPrintable(QString("backward error of %1 arcsec").arg(maxBackwardError)));
+}
@@ -0,0 +1,96 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "testSolarSystem.hpp"
+#include "StelApp.hpp"
+#include "StelCore.hpp"
+#include "StelModuleMgr.hpp"
+#include "SolarSystem.hpp"
+
+#include <QVector>
+
+QTEST_MAIN(TestSolarSystem)
+
+// Number of time steps, as during a time-lapse of SOLAR_SYSTEM_STEP_JD days per frame
+static const int NB_SOLAR_SYSTEM_STEPS = 200;
+static const double SOLAR_SYSTEM_START_JD = 2455927.5;
+static const double SOLAR_SYSTEM_STEP_JD = 0.5;
+// Number of frames of the position cache test, and number of times each position is queried during a frame
+static const int NB_POSITION_CACHE_FRAMES = 10;
+static const int NB_POSITION_QUERIES = 3;
+
+void TestSolarSystem::initTestCase()
+{
+	if (!app.init())
+		QSKIP("Can't initialize Stellarium in an off-screen GL buffer", SkipAll);
+}
+
+void TestSolarSystem::testParallelPositions_data()
+{
+	QTest::addColumn<bool>("lightTravelTime");
+	QTest::newRow("geometric") << false;
+	QTest::newRow("light travel time") << true;
+}
+
+void TestSolarSystem::testParallelPositions()
+{
+	QFETCH(bool, lightTravelTime);
+	SolarSystem* ssystem = GETSTELMODULE(SolarSystem);
+	const Vec3d observerPos = StelApp::getInstance().getCore()->getObserverHeliocentricEclipticPos();
+	const bool flagParallelPositions = ssystem->getFlagParallelPositions();
+	const bool flagLightTravelTime = ssystem->getFlagLightTravelTime();
+	const QList<PlanetP>& planets = ssystem->getAllPlanets();
+
+	// The parallel computation must give exactly the same results as the serial one
+	ssystem->setFlagLightTravelTime(lightTravelTime);
+	QVector<Vec3d> positions[2];
+	for (int parallel=0;parallel<2;++parallel)
+	{
+		ssystem->setFlagParallelPositions(parallel==1);
+		// Start far from the tested dates, so that the planets and the ephemeris caches are in the same state for both runs
+		ssystem->computePositions(SOLAR_SYSTEM_START_JD-100000., observerPos);
+		for (int i=0;i<NB_SOLAR_SYSTEM_STEPS;++i)
+		{
+			ssystem->computePositions(SOLAR_SYSTEM_START_JD+i*SOLAR_SYSTEM_STEP_JD, observerPos);
+			foreach (const PlanetP& p, planets)
+				positions[parallel].append(p->getHeliocentricEclipticPos());
+		}
+	}
+	ssystem->setFlagParallelPositions(flagParallelPositions);
+	ssystem->setFlagLightTravelTime(flagLightTravelTime);
+	QVERIFY(positions[0]==positions[1]);
+}
+
+void TestSolarSystem::testPositionCache()
+{
+	// The positions cached by the StelObject must be exactly the ones computed at each query
+	StelCore* core = StelApp::getInstance().getCore();
+	const QList<PlanetP>& planets = GETSTELMODULE(SolarSystem)->getAllPlanets();
+	for (int f=0;f<NB_POSITION_CACHE_FRAMES;++f)
+	{
+		core->setJDay(SOLAR_SYSTEM_START_JD+f*SOLAR_SYSTEM_STEP_JD);
+		core->update(0.);
+		foreach (const PlanetP& p, planets)
+		{
+			const Vec3d computed = core->j2000ToAltAz(p->getJ2000EquatorialPos(core), StelCore::RefractionOn);
+			for (int q=0;q<NB_POSITION_QUERIES;++q)
+				QVERIFY2(p->getAltAzPosApparent(core)==computed, qPrintable(p->getEnglishName()));
+		}
+	}
+}
@@ -0,0 +1,159 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "testStelSphericalGeometry.hpp"
+#include "StelSphereGeometry.hpp"
+#include "StelUtils.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <QVector>
+
+QTEST_MAIN(TestStelSphericalGeometry)
+
+// Number of random region pairs
+static const int NB_GEOMETRY_PAIRS = 1000;
+// The octahedron algorithm replaces a cap by a 40 sided polygon which differs from it by less than 0.1 deg.
+// Each closed-form result is compared with the octahedron results of the cap shrunk and grown by this margin in radian,
+// which bound the exact result, so that no disagreement is tolerated.
+static const double CAP_MARGIN = 0.01;
+
+// Return a random direction uniformly distributed on the sphere
+static Vec3d randomDirection()
+{
+	Vec3d dir;
+	const double ra = 2.*M_PI*qrand()/RAND_MAX;
+	const double dec = std::asin(2.*qrand()/RAND_MAX-1.);
+	StelUtils::spheToRect(ra, dec, dir);
+	return dir;
+}
+
+// Return a random convex quad with a half size between minSize and maxSize in degree
+static SphericalConvexPolygon randomConvexQuad(double minSize, double maxSize)
+{
+	const Vec3d center = randomDirection();
+	Vec3d u = center^Vec3d(0,0,1);
+	if (u.lengthSquared()<1e-10)
+		u = center^Vec3d(1,0,0);
+	u.normalize();
+	const Vec3d v = center^u;
+	const double size = std::tan((minSize+(maxSize-minSize)*qrand()/RAND_MAX)*M_PI/180.);
+	QVector<Vec3d> contour;
+	contour << center+(u+v)*size << center+(v-u)*size << center-(u+v)*size << center+(u-v)*size;
+	for (int i=0;i<contour.size();++i)
+		contour[i].normalize();
+	if (!SphericalConvexPolygon::checkValidContour(contour))
+		std::reverse(contour.begin(), contour.end());
+	return SphericalConvexPolygon(contour);
+}
+
+// Return a random cap with a radius between 1 and 170 deg, one cap in four being exactly a half sphere
+static SphericalCap randomCap(double& radius)
+{
+	radius = (qrand()%4==0) ? M_PI/2. : (1.+169.*qrand()/RAND_MAX)*M_PI/180.;
+	return SphericalCap(randomDirection(), radius==M_PI/2. ? 0. : std::cos(radius));
+}
+
+// Return the octahedron polygon of the cap grown by the given margin in radian.
+// The polygon of a half sphere is exact, so the margin is not applied to it.
+static OctahedronPolygon capOctahedron(const SphericalCap& cap, double radius, double margin)
+{
+	if (cap.d==0.)
+		return cap.getOctahedronPolygon();
+	return SphericalCap(cap.n, std::cos(radius+margin)).getOctahedronPolygon();
+}
+
+// Return 1 if the result is true for the lower bound region, 0 if it is false for the upper bound region, -1 if it is undecided
+static int boundedResult(bool lowResult, bool highResult)
+{
+	return lowResult ? 1 : (highResult ? -1 : 0);
+}
+
+// Return whether the area is within the areas of the bounding regions
+static bool areaInRange(double area, double lowArea, double highArea)
+{
+	return area>=lowArea-1e-6-1e-4*lowArea && area<=highArea+1e-6+1e-4*highArea;
+}
+
+void TestStelSphericalGeometry::testClosedFormOperations()
+{
+	// The closed-form intersection tests and intersections must give the same results as the generic OctahedronPolygon algorithms
+	qsrand(1);
+	int nbMismatches = 0;
+	for (int i=0;i<NB_GEOMETRY_PAIRS;++i)
+	{
+		const SphericalConvexPolygon poly = randomConvexQuad(0.1, 20.);
+		const SphericalConvexPolygon viewport = randomConvexQuad(1., 60.);
+		double radius;
+		const SphericalCap cap = randomCap(radius);
+
+		// Convex polygons are represented exactly by both algorithms
+		const OctahedronPolygon polyOct = poly.getOctahedronPolygon();
+		OctahedronPolygon intersection(polyOct);
+		intersection.inPlaceIntersection(viewport.getOctahedronPolygon());
+		const double octArea = intersection.getArea();
+		if (poly.intersects(viewport)!=polyOct.intersects(viewport.getOctahedronPolygon()) ||
+			std::fabs(poly.getIntersection(viewport)->getArea()-octArea)>1e-6+1e-4*octArea)
+			++nbMismatches;
+
+		// The cap results must lie between the ones of the shrunk and grown caps
+		const OctahedronPolygon capLow = capOctahedron(cap, radius, -CAP_MARGIN);
+		const OctahedronPolygon capHigh = capOctahedron(cap, radius, CAP_MARGIN);
+		const int intersects = boundedResult(capLow.intersects(polyOct), capHigh.intersects(polyOct));
+		const int contains = boundedResult(capLow.contains(polyOct), capHigh.contains(polyOct));
+		if ((intersects>=0 && cap.intersects(poly)!=(intersects==1)) || (contains>=0 && cap.contains(poly)!=(contains==1)))
+			++nbMismatches;
+		OctahedronPolygon lowIntersection(polyOct);
+		lowIntersection.inPlaceIntersection(capLow);
+		OctahedronPolygon highIntersection(polyOct);
+		highIntersection.inPlaceIntersection(capHigh);
+		if (!areaInRange(poly.getIntersection(cap)->getArea(), lowIntersection.getArea(), highIntersection.getArea()))
+			++nbMismatches;
+	}
+	QVERIFY2(nbMismatches==0, qPrintable(QString("%1 mismatches between the closed-form and octahedron spherical geometry").arg(nbMismatches)));
+}
+
+void TestStelSphericalGeometry::testCapIntersections()
+{
+	// The closed-form cap to cap operations must agree with the OctahedronPolygon algorithms applied to the bounding caps
+	qsrand(2);
+	int nbMismatches = 0;
+	for (int i=0;i<NB_GEOMETRY_PAIRS;++i)
+	{
+		double radius1, radius2;
+		const SphericalCap cap1 = randomCap(radius1);
+		const SphericalCap cap2 = randomCap(radius2);
+
+		const OctahedronPolygon low1 = capOctahedron(cap1, radius1, -CAP_MARGIN);
+		const OctahedronPolygon low2 = capOctahedron(cap2, radius2, -CAP_MARGIN);
+		const OctahedronPolygon high1 = capOctahedron(cap1, radius1, CAP_MARGIN);
+		const OctahedronPolygon high2 = capOctahedron(cap2, radius2, CAP_MARGIN);
+		const int intersects = boundedResult(low1.intersects(low2), high1.intersects(high2));
+		const int contains = boundedResult(low1.contains(high2), high1.contains(low2));
+		if ((intersects>=0 && cap1.intersects(cap2)!=(intersects==1)) || (contains>=0 && cap1.contains(cap2)!=(contains==1)))
+			++nbMismatches;
+		OctahedronPolygon lowIntersection(low1);
+		lowIntersection.inPlaceIntersection(low2);
+		OctahedronPolygon highIntersection(high1);
+		highIntersection.inPlaceIntersection(high2);
+		if (!areaInRange(cap1.getIntersection(cap2)->getArea(), lowIntersection.getArea(), highIntersection.getArea()))
+			++nbMismatches;
+	}
+	QVERIFY2(nbMismatches==0, qPrintable(QString("%1 mismatches between the closed-form and octahedron cap operations").arg(nbMismatches)));
+}
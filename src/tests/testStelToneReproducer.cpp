@@ -0,0 +1,77 @@
+/*
+ * Stellarium
+ * Copyright (C) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ */
+
+#include "testStelToneReproducer.hpp"
+#include "StelToneReproducer.hpp"
+
+#include <cmath>
+
+QTEST_MAIN(TestStelToneReproducer)
+
+// Number of random luminances and colors
+static const int NB_TONE_VALUES = 100000;
+// Maximum allowed relative error of the lookup tables
+static const double MAX_TONE_RELATIVE_ERROR = 1e-4;
+
+// Return the relative error of value compared to a reference
+static double relativeError(double value, double reference)
+{
+	return std::fabs(value-reference)/qMax(std::fabs(reference), 1e-30);
+}
+
+void TestStelToneReproducer::testLookupTables_data()
+{
+	QTest::addColumn<float>("worldAdaptation");
+	QTest::addColumn<float>("inputScale");
+	QTest::newRow("dark night") << 0.0001f << 0.5f;
+	QTest::newRow("twilight") << 0.01f << 1.5f;
+	QTest::newRow("dusk") << 1.f << 2.5f;
+	QTest::newRow("overcast") << 100.f << 3.5f;
+	QTest::newRow("daylight") << 40000.f << 4.5f;
+}
+
+void TestStelToneReproducer::testLookupTables()
+{
+	QFETCH(float, worldAdaptation);
+	QFETCH(float, inputScale);
+	StelToneReproducer eye;
+	eye.setWorldAdaptationLuminance(worldAdaptation);
+	eye.setInputScale(inputScale);
+
+	// Luminances between 1e-6 and 1e6 cd/m^2 with a uniform distribution of their log, and random xyY colors
+	qsrand(1);
+	for (int i=0;i<NB_TONE_VALUES;++i)
+	{
+		const float lnLuminance = (float)((-6.+12.*qrand()/RAND_MAX)*std::log(10.));
+		const float luminance = std::exp(lnLuminance);
+		const double adaptError = relativeError(eye.adaptLuminanceScaled(luminance), eye.adaptLuminanceExact(luminance)/eye.getMaxDisplayLuminance());
+		QVERIFY2(adaptError<=MAX_TONE_RELATIVE_ERROR, qPrintable(QString("relative error of %1 for the luminance %2").arg(adaptError).arg(luminance)));
+		const double adaptLnError = relativeError(eye.adaptLuminanceScaledLn(lnLuminance, 0.7f), eye.adaptLuminanceScaledLnExact(lnLuminance, 0.7f));
+		QVERIFY2(adaptLnError<=MAX_TONE_RELATIVE_ERROR, qPrintable(QString("relative error of %1 for the log luminance %2").arg(adaptLnError).arg(lnLuminance)));
+
+		Vec3f rgb(0.2f+0.3f*qrand()/RAND_MAX, 0.2f+0.3f*qrand()/RAND_MAX, luminance);
+		Vec3f exactRgb = rgb;
+		eye.xyYToRGB(rgb);
+		eye.xyYToRGBExact(exactRgb);
+		// The RGB components can be close to 0, so compare them to the largest one
+		const float maxComponent = qMax(std::fabs(exactRgb[0]), qMax(std::fabs(exactRgb[1]), std::fabs(exactRgb[2])));
+		for (int c=0;c<3;++c)
+			QVERIFY2(std::fabs(rgb[c]-exactRgb[c])<=MAX_TONE_RELATIVE_ERROR*qMax(maxComponent, 1e-30f), qPrintable(QString("relative error of the color component %1").arg(c)));
+	}
+}